@@ -34,6 +34,8 @@
 const char* const ngx::casper::broker::api::Module::k_json_api_content_type_           = "application/vnd.api+json";
 const char* const ngx::casper::broker::api::Module::k_json_api_content_type_w_charset_ = "application/vnd.api+json;charset=utf-8";
 
+const std::set<std::string> ngx::casper::broker::api::Module::k_supported_content_types_ = { "application/json", "application/json;charset=utf-8",  "application/vnd.api+json", "application/vnd.api+json;charset=utf-8" };
+
 /**
  * @brief Default constructor.
  *
@@ -233,19 +235,19 @@ void ngx::casper::broker::api::Module::OnSessionFetchSucceeded (const bool /* a_
                         break;
                     case NGX_HTTP_POST:
                         json_api_.Post(ctx_.loggable_data_ref_,
-                                       uri_, ctx_.request_.body_,
+                                       uri_, Body(),
                                        std::bind(&ngx::casper::broker::api::Module::OnJSONAPIReply, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4)
                         );
                         break;
                     case NGX_HTTP_DELETE:
                         json_api_.Delete(ctx_.loggable_data_ref_,
-                                         uri_, nullptr != ctx_.request_.body_ ? ctx_.request_.body_ : "",
+                                         uri_, nullptr != Body() ? Body() : "",
                                          std::bind(&ngx::casper::broker::api::Module::OnJSONAPIReply, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4)
                         );
                         break;
                     case NGX_HTTP_PATCH:
                         json_api_.Patch(ctx_.loggable_data_ref_,
-                                        uri_, ctx_.request_.body_,
+                                        uri_, Body(),
                                         std::bind(&ngx::casper::broker::api::Module::OnJSONAPIReply, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4)
                         );
                         break;
@@ -301,7 +303,7 @@ void ngx::casper::broker::api::Module::OnJSONAPIReply (const char* a_uri, const
                 } else {
                     // ... we're good to go ....
                     if ( true == response_object.isMember("meta") && true == response_object["meta"].isMember("job-tube") ) {
-                        const ngx_int_t post_rv = PostJob(ctx_.ngx_ptr_->method, a_uri, nullptr != ctx_.request_.body_ ? ctx_.request_.body_ : "",
+                        const ngx_int_t post_rv = PostJob(ctx_.ngx_ptr_->method, a_uri, nullptr != Body() ? Body() : "",
                                                           /* a_tube */
                                                           response_object["meta"]["job-tube"].asString(),
                                                           /* a_ttr */
@@ -359,7 +361,7 @@ void ngx::casper::broker::api::Module::OnJSONAPIReply (const char* a_uri, const
         /* status_code_    */ NGX_HTTP_INTERNAL_SERVER_ERROR,
         /* status_message_ */ ""
     };
-    const ngx_int_t post_rv = PostJob(ctx_.ngx_ptr_->method, uri_, nullptr != ctx_.request_.body_ ? ctx_.request_.body_ : "",
+    const ngx_int_t post_rv = PostJob(ctx_.ngx_ptr_->method, uri_, nullptr != Body() ? Body() : "",
                                       a_tube,
                                       static_cast<ssize_t>(rv.ttr_),
                                       static_cast<ssize_t>(rv.validity_),
@@ -502,7 +504,7 @@ ngx_int_t ngx::casper::broker::api::Module::Factory (ngx_http_request_t* a_r, bo
         /* in_headers_              */ {},
         /* config_                  */ {},
         /* locale_                  */ "",
-        /* supported_content_types_ */ { "application/json", "application/json;charset=utf-8",  "application/vnd.api+json", "application/vnd.api+json;charset=utf-8" }
+        /* supported_content_types_ */ &k_supported_content_types_
     };
     
     ngx_int_t rv = ngx::casper::broker::Module::WarmUp(ngx_http_casper_broker_api_module, a_r, loc_conf->log_token,
@@ -546,7 +548,7 @@ ngx_int_t ngx::casper::broker::api::Module::Factory (ngx_http_request_t* a_r, bo
     
     return ::ngx::casper::broker::Module::Initialize(config, params,
                                                      [&config, &params, &broker_conf, &loc_conf] () -> ::ngx::casper::broker::Module* {
-                                                         return new ::ngx::casper::broker::api::Module(config, params, *broker_conf, *loc_conf);
+                                                         return new (config.ngx_ptr_) ::ngx::casper::broker::api::Module(config, params, *broker_conf, *loc_conf);
                                                      }
     );
 }
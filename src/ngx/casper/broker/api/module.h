@@ -58,6 +58,7 @@ namespace ngx
                     
                     static const char* const k_json_api_content_type_;
                     static const char* const k_json_api_content_type_w_charset_;
+                    static const std::set<std::string> k_supported_content_types_;
 
                 private: // Helpers
 
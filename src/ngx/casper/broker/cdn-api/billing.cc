@@ -68,7 +68,7 @@ ngx::casper::broker::cdn::api::Billing::~Billing ()
  * @param a_body   Requet body ( if any )
  */
 ngx_int_t ngx::casper::broker::cdn::api::Billing::Process (const uint64_t& a_id,
-                                                           const ngx_uint_t& a_method, const std::map<std::string, std::string>& /* a_headers */,
+                                                           const ngx_uint_t& a_method, const ngx::casper::broker::InHeaders& /* a_headers */,
                                                            const std::map<std::string, std::set<std::string>>& a_params,
                                                            const char* const a_body)
 {
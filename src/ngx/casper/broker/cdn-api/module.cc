@@ -38,6 +38,8 @@
 const char* const ngx::casper::broker::cdn::api::Module::sk_rx_content_type_ = "application/vnd.api+json;charset=utf-8";
 const char* const ngx::casper::broker::cdn::api::Module::sk_tx_content_type_ = "application/vnd.api+json;charset=utf-8";
 
+const std::set<std::string> ngx::casper::broker::cdn::api::Module::sk_supported_content_types_ = { sk_rx_content_type_ };
+
 ngx::casper::broker::cdn::common::db::Sideline::Settings ngx::casper::broker::cdn::api::Module::s_sideline_settings_ = {
     /* tube_     */ "",
     /* ttr_      */ 300, // 5 min
@@ -165,7 +167,7 @@ ngx_int_t ngx::casper::broker::cdn::api::Module::Run ()
     try {
         router_.Enable(std::bind(&ngx::casper::broker::cdn::api::Module::RouteFactory, this, std::placeholders::_1, std::placeholders::_2));
         router_.Process(ctx_.ngx_ptr_->method, ctx_.request_.uri_,
-                        /* a_body */ ( NGX_HTTP_GET != ctx_.ngx_ptr_->method ? ctx_.request_.body_ : nullptr ),
+                        /* a_body */ ( NGX_HTTP_GET != ctx_.ngx_ptr_->method ? Body() : nullptr ),
                         ctx_.request_.headers_,
                         type_, id_, params_,
                         ctx_.response_.asynchronous_
@@ -395,7 +397,7 @@ ngx_int_t ngx::casper::broker::cdn::api::Module::Factory (ngx_http_request_t* a_
         /* in_headers_              */ {},
         /* config_                  */ {},
         /* locale_                  */ "",
-        /* supported_content_types_ */ { sk_rx_content_type_ }
+        /* supported_content_types_ */ &sk_supported_content_types_
     };
 
     ngx_int_t rv = ngx::casper::broker::Module::WarmUp(ngx_http_casper_broker_cdn_api_module, a_r, loc_conf->log_token,
@@ -439,7 +441,7 @@ ngx_int_t ngx::casper::broker::cdn::api::Module::Factory (ngx_http_request_t* a_
 
     return ::ngx::casper::broker::Module::Initialize(config, params,
                                                      [&config, &params, &broker_conf, &loc_conf] () -> ::ngx::casper::broker::Module* {
-                                                         return new ::ngx::casper::broker::cdn::api::Module(config, params, *broker_conf, *loc_conf );
+                                                         return new (config.ngx_ptr_) ::ngx::casper::broker::cdn::api::Module(config, params, *broker_conf, *loc_conf );
                                                      }
     );
 }
@@ -34,6 +34,8 @@
 
 #include "core/ngx_config.h" // ngx_int_t, ngx_uint_t
 
+#include "ngx/casper/broker/in_headers.h"
+
 #include <set>
 #include <map>
 #include <string>
@@ -70,7 +72,7 @@ namespace ngx
                     public: // Pure Virtual Method(s) / Function(s)
                         
                         virtual ngx_int_t Process (const uint64_t& a_id,
-                                                   const ngx_uint_t& a_method, const std::map<std::string, std::string>& a_headers,
+                                                   const ngx_uint_t& a_method, const ngx::casper::broker::InHeaders& a_headers,
                                                    const std::map<std::string, std::set<std::string>>& a_params,
                                                    const char* const a_body) = 0;
                         
@@ -75,7 +75,7 @@ namespace ngx
                     public: // Method(s) / Function(s)
                         
                         void Enable  (Factory a_factory);
-                        void Process (const ngx_uint_t a_method, const std::string& a_uri, const char* const a_body, const std::map<std::string, std::string>& a_headers,
+                        void Process (const ngx_uint_t a_method, const std::string& a_uri, const char* const a_body, const ngx::casper::broker::InHeaders& a_headers,
                                       std::string& o_type, std::string& o_id, std::map<std::string, std::set<std::string>>& o_params, bool& a_asynchronous);
                                                 
                     private: // Inline Method(s) / Function(s)
@@ -138,7 +138,7 @@ ngx::casper::broker::cdn::api::Router::~Router ()
  * @param o_params       Parsed parameters.
  * @param a_asynchronous True if request will be handled asynchronously, false otherwise.
  */
-void ngx::casper::broker::cdn::api::Router::Process (const ngx_uint_t a_method, const std::string& a_uri, const char* const a_body, const std::map<std::string, std::string>& a_headers,
+void ngx::casper::broker::cdn::api::Router::Process (const ngx_uint_t a_method, const std::string& a_uri, const char* const a_body, const ngx::casper::broker::InHeaders& a_headers,
                                                      std::string& o_type, std::string& o_id, std::map<std::string, std::set<std::string>>& o_params, bool& a_asynchronous)
 {
     int                   cs;
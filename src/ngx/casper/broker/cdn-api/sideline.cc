@@ -76,7 +76,7 @@ ngx::casper::broker::cdn::api::Sideline::~Sideline ()
  * @param a_body   Requet body ( if any )
  */
 ngx_int_t ngx::casper::broker::cdn::api::Sideline::Process (const uint64_t& a_id,
-                                                            const ngx_uint_t& a_method, const std::map<std::string, std::string>& a_headers,
+                                                            const ngx_uint_t& a_method, const ngx::casper::broker::InHeaders& a_headers,
                                                             const std::map<std::string, std::set<std::string>>& a_params,
                                                             const char* const a_body)
 {
@@ -120,7 +120,7 @@ ngx_int_t ngx::casper::broker::cdn::api::Sideline::Process (const uint64_t& a_id
 
 const ngx::casper::broker::cdn::api::Sideline::ActivityData& ngx::casper::broker::cdn::api::Sideline::GetActivityData (const uint64_t& /* a_id */,
                                                                                                                        const ngx_uint_t& a_method,
-                                                                                                                       const std::map<std::string, std::string>& a_headers,
+                                                                                                                       const ngx::casper::broker::InHeaders& a_headers,
                                                                                                                        const std::map<std::string, std::set<std::string>>& /* a_params */,
                                                                                                                        const char* const a_body)
 {
@@ -82,13 +82,13 @@ namespace ngx
                     public: // Method(s) / Function(s)
                         
                         ngx_int_t Process (const uint64_t& a_id,
-                                           const ngx_uint_t& a_method, const std::map<std::string, std::string>& a_headers,
+                                           const ngx_uint_t& a_method, const ngx::casper::broker::InHeaders& a_headers,
                                            const std::map<std::string, std::set<std::string>>& a_params,
                                            const char* const a_body);
                     private: // Method(s) / Function(s)
                         
                         const ActivityData& GetActivityData (const uint64_t& a_id,
-                                                             const ngx_uint_t& a_method, const std::map<std::string, std::string>& a_headers,
+                                                             const ngx_uint_t& a_method, const ngx::casper::broker::InHeaders& a_headers,
                                                              const std::map<std::string, std::set<std::string>>& a_params,
                                                              const char* const a_body);
                         
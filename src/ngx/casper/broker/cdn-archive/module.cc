@@ -31,6 +31,8 @@
 
 #include "ngx/casper/broker/cdn-common/exception.h"
 
+#include "ngx/casper/broker/cdn-common/hasher.h"
+
 #include "ngx/casper/broker/tracker.h"
 
 #include "ngx/ngx_utils.h"
@@ -46,6 +48,8 @@
 const char* const ngx::casper::broker::cdn::archive::Module::sk_rx_content_type_ = "application/octet-stream";
 const char* const ngx::casper::broker::cdn::archive::Module::sk_tx_content_type_ = "application/vnd.api+json;charset=utf-8";
 
+const std::set<std::string> ngx::casper::broker::cdn::archive::Module::sk_supported_content_types_ = { "*/*" };
+
 ngx::casper::broker::cdn::Archive::Settings ngx::casper::broker::cdn::archive::Module::s_archive_settings_ = {
     /* directories_ */ {
         /* temporary_prefix_ */ "",
@@ -124,6 +128,7 @@ ngx::casper::broker::cdn::archive::Module::Module (const ngx::casper::broker::Mo
  x_content_disposition_(
     /* a_default */ std::string(reinterpret_cast<const char*>(a_ngx_loc_conf.cdn.response.content_disposition.data), a_ngx_loc_conf.cdn.response.content_disposition.len)
  ),
+ x_validate_integrity_deep_("X-CASPER-VALIDATE-INTEGRITY-DEEP"),
  db_ {
      /* data_ */
      {
@@ -148,6 +153,14 @@ ngx::casper::broker::cdn::archive::Module::Module (const ngx::casper::broker::Mo
      /* registry_*/ nullptr,
      /* billing_ */ nullptr
  },
+ integrity_ {
+     /* ticket_ */ 0,
+     /* check_  */ { /* md_ */ nullptr, /* value_ */ "" }
+ },
+ move_ {
+     /* attrs_  */ {},
+     /* hashes_ */ { /* stamp_ */ "", /* md5_ */ "", /* digest_ */ "" }
+ },
  job_(ctx_, this, a_ngx_loc_conf)
 {
     // ...
@@ -167,6 +180,10 @@ ngx::casper::broker::cdn::archive::Module::Module (const ngx::casper::broker::Mo
         s_archive_settings_.quarantine_.directory_prefix_  = OSAL_NORMALIZE_PATH(std::string(reinterpret_cast<const char*>(a_ngx_cdn_archive_loc_conf.quarantine.directory_prefix.data),a_ngx_cdn_archive_loc_conf.quarantine.directory_prefix.len));
         s_archive_settings_.quarantine_.validity_          = static_cast<size_t>(a_ngx_cdn_archive_loc_conf.quarantine.validity);
     }
+    // ... content digest, algorithm was validated at configuration time ...
+    if ( a_ngx_loc_conf.cdn.integrity.digest.len > 0 ) {
+        archive_.digest(ngx::casper::broker::cdn::Digest::Lookup(std::string(reinterpret_cast<const char*>(a_ngx_loc_conf.cdn.integrity.digest.data), a_ngx_loc_conf.cdn.integrity.digest.len)));
+    }
 }
 
 /**
@@ -180,6 +197,9 @@ ngx::casper::broker::cdn::archive::Module::~Module ()
     if ( nullptr != db_.billing_ ) {
         delete db_.billing_;
     }
+    if ( 0 != integrity_.ticket_ ) {
+        ngx::casper::broker::cdn::Hasher::GetInstance().Cancel(integrity_.ticket_);
+    }
 }
 
 #ifdef __APPLE__
@@ -293,6 +313,7 @@ ngx_int_t ngx::casper::broker::cdn::archive::Module::Setup ()
             {
                 const bool validate_integrity = false;
                 x_validate_integrity_.Set(ctx_.request_.headers_, &validate_integrity);
+                x_validate_integrity_deep_.Set(ctx_.request_.headers_, &validate_integrity);
             }
                 break;
             case NGX_HTTP_POST:
@@ -484,8 +505,7 @@ ngx_int_t ngx::casper::broker::cdn::archive::Module::Run ()
  */
 ngx_int_t ngx::casper::broker::cdn::archive::Module::Perform ()
 {
-    // ... process request ...
-    try {
+    return Perform([this] () {
         switch (ctx_.ngx_ptr_->method) {
             case NGX_HTTP_HEAD:
                 HEAD();
@@ -509,6 +529,21 @@ ngx_int_t ngx::casper::broker::cdn::archive::Module::Perform ()
                 NGX_BROKER_MODULE_SET_HTTP_METHOD_NOT_IMPLEMENTED(ctx_);
                 break;
         }
+    });
+}
+
+/**
+ * @brief Perform a request step and register it's archive operation.
+ *
+ * @param a_callback Function to call.
+ *
+ * @return NGINX return code.
+ */
+ngx_int_t ngx::casper::broker::cdn::archive::Module::Perform (const std::function<void()>& a_callback)
+{
+    // ... process request ...
+    try {
+        a_callback();
     } catch (const ngx::casper::broker::cdn::NotFound& a_not_found) {
         NGX_BROKER_MODULE_SET_NOT_FOUND_ERROR(ctx_, a_not_found.what());
     } catch (const ngx::casper::broker::cdn::Forbidden& a_forbidden) {
@@ -524,6 +559,11 @@ ngx_int_t ngx::casper::broker::cdn::archive::Module::Perform ()
             NGX_BROKER_MODULE_SET_INTERNAL_SERVER_ERROR(ctx_, a_cc_exception.what());
         }
     }
+    // ... waiting for moved file content hashes?
+    if ( NGX_OK == ctx_.response_.return_code_ && 0 != integrity_.ticket_ ) {
+        // ... operation will be registered when they are known ...
+        return ctx_.response_.return_code_;
+    }
     // ... register archive operation ...
     if ( NGX_OK != RegisterSyncOperation() ) {
         // ... something went wrong, try to rollback action ...
@@ -763,8 +803,16 @@ void ngx::casper::broker::cdn::archive::Module::GET ()
         r_info_.new_uri_ = "";
 
         // ... validate file before delivering it?
-        if ( x_validate_integrity_.IsSet() && true == x_validate_integrity_ ) {
-            archive_.Validate('/' + r_info_.old_id_);
+        const bool validate_integrity = ( x_validate_integrity_.IsSet() && true == x_validate_integrity_ );
+        const bool deep_scrub         = ( x_validate_integrity_deep_.IsSet() && true == x_validate_integrity_deep_ );
+        bool       deferred_digest    = false;
+        if ( true == validate_integrity || true == deep_scrub ) {
+            // ... content digest is only calculated if file changed since it was written ( or a deep scrub is requested ),
+            //     when possible, by a worker thread ...
+            deferred_digest = archive_.Validate('/' + r_info_.old_id_, /* a_md5 */ nullptr, /* a_id */ nullptr, /* a_attrs */ nullptr,
+                                                /* a_deep */ deep_scrub,
+                                                /* o_check */ ( true == ngx::casper::broker::cdn::Hasher::GetInstance().enabled() ? &integrity_.check_ : nullptr )
+            );
         }
 
         // ... set redirect headers ...
@@ -781,6 +829,21 @@ void ngx::casper::broker::cdn::archive::Module::GET ()
         ctx_.response_.redirect_.asynchronous_ = false;
         ctx_.response_.status_code_            = NGX_HTTP_OK;
         ctx_.response_.return_code_            = NGX_DECLINED; // synchronous request must return NGX_DECLINED so it can be properly handled in content phase
+
+        // ... waiting for content digest?
+        if ( true == deferred_digest ) {
+            // ... from now on the response will be asynchronous ...
+            ctx_.response_.asynchronous_ = true;
+            ctx_.response_.return_code_  = NGX_OK;
+            integrity_.ticket_ = ngx::casper::broker::cdn::Hasher::GetInstance().Submit(r_info_.old_uri_, integrity_.check_.md_,
+                {
+                    /* success_ */
+                    Deferred<const std::string&, const std::string&>(std::bind(&ngx::casper::broker::cdn::archive::Module::OnContentDigestSucceeded, this, std::placeholders::_1)),
+                    /* failure_ */
+                    Deferred<const ::cc::Exception&>(std::bind(&ngx::casper::broker::cdn::archive::Module::OnContentDigestFailed, this, std::placeholders::_1))
+                }
+            );
+        }
               
         // ... reset r-info ...
         r_info_.old_id_  = "";
@@ -942,6 +1005,25 @@ void ngx::casper::broker::cdn::archive::Module::POST ()
     if ( true == x_moves_uri_.IsSet() && x_moves_uri_ != sk_empty_string_ ) {
         // ... set final attribute(s) ...
         attrs[XATTR_ARCHIVE_PREFIX "com.cldware.archive.content-length"] = std::to_string(db_.sync_data_.old_.size_);
+        // ... hash moved file content in a worker thread?
+        if ( true == ngx::casper::broker::cdn::Hasher::GetInstance().enabled() ) {
+            // ... stamp is taken before reading, any change while calculating MD5 will invalidate it ...
+            move_.attrs_         = attrs;
+            move_.hashes_.stamp_ = ngx::casper::broker::cdn::Archive::Stamp(db_.sync_data_.old_.uri_);
+            // ... from now on the response will be asynchronous, move will be done when hashes are known ...
+            ctx_.response_.asynchronous_ = true;
+            ctx_.response_.return_code_  = NGX_OK;
+            integrity_.ticket_ = ngx::casper::broker::cdn::Hasher::GetInstance().Submit(db_.sync_data_.old_.uri_, archive_.digest(),
+                {
+                    /* success_ */
+                    Deferred<const std::string&, const std::string&>(std::bind(&ngx::casper::broker::cdn::archive::Module::OnMoveContentHashed, this, std::placeholders::_1, std::placeholders::_2)),
+                    /* failure_ */
+                    Deferred<const ::cc::Exception&>(std::bind(&ngx::casper::broker::cdn::archive::Module::OnMoveContentHashFailed, this, std::placeholders::_1))
+                },
+                /* a_md5 */ true
+            );
+            return;
+        }
         // ... move ( includes closing ) and write extended attributes ...
         archive_.Move(db_.sync_data_.old_.uri_, attrs, sk_preserved_upload_attrs_, /* a_backup */ true, r_info_);
     } else {
@@ -1185,6 +1267,93 @@ void ngx::casper::broker::cdn::archive::Module::DELETE ()
     SetNoContentResponse();
 }
 
+#ifdef __APPLE__
+#pragma mark - HELPER METHODS - Integrity
+#endif
+
+/**
+ * @brief This method will be called when the content digest of the file about to be delivered is calculated.
+ *
+ * @param a_value Calculated MD5 or digest.
+ */
+void ngx::casper::broker::cdn::archive::Module::OnContentDigestSucceeded (const std::string& a_value)
+{
+    integrity_.ticket_ = 0;
+    // ... mismatch?
+    if ( 0 != integrity_.check_.value_.compare(a_value) ) {
+        // ... yes, same error as synchronous validation ...
+        OnContentDigestFailed(::cc::Exception(nullptr == integrity_.check_.md_ ? "MD5 mismatch!" : "Digest mismatch!"));
+        return;
+    }
+    // ... no, deliver file ...
+    NGX_BROKER_MODULE_FINALIZE_REQUEST_WITH_INTERNAL_REDIRECT(this);
+}
+
+/**
+ * @brief This method will be called when the content digest of the file about to be delivered can't be calculated or doesn't match.
+ *
+ * @param a_exception Error that occurred.
+ */
+void ngx::casper::broker::cdn::archive::Module::OnContentDigestFailed (const ::cc::Exception& a_exception)
+{
+    integrity_.ticket_ = 0;
+    // ... forget redirect headers ...
+    ctx_.response_.headers_.erase("X-CASPER-CONTENT-TYPE");
+    ctx_.response_.headers_.erase("X-CASPER-CONTENT-DISPOSITION");
+    ctx_.response_.headers_.erase("X-CASPER-FILE-LOCAL-TRY");
+    NGX_BROKER_MODULE_RESET_REDIRECT(ctx_);
+    // ... set error ...
+    NGX_BROKER_MODULE_SET_INTERNAL_SERVER_ERROR(ctx_, a_exception.what());
+    // ... finalize request ...
+    NGX_BROKER_MODULE_FINALIZE_REQUEST(this);
+}
+
+/**
+ * @brief This method will be called when the content hashes of the file about to be moved are calculated.
+ *
+ * @param a_value Calculated digest, or MD5 if no digest algorithm is set.
+ * @param a_md5   Calculated MD5, when a digest algorithm is set.
+ */
+void ngx::casper::broker::cdn::archive::Module::OnMoveContentHashed (const std::string& a_value, const std::string& a_md5)
+{
+    integrity_.ticket_ = 0;
+    if ( nullptr != archive_.digest() ) {
+        move_.hashes_.digest_ = a_value;
+        move_.hashes_.md5_    = a_md5;
+    } else {
+        move_.hashes_.md5_    = a_value;
+    }
+    // ... move ( includes closing ), write extended attributes and register operation ...
+    Perform([this] () {
+        archive_.Move(db_.sync_data_.old_.uri_, move_.attrs_, sk_preserved_upload_attrs_, /* a_backup */ true, r_info_, &move_.hashes_);
+        SetSuccessResponse(r_info_);
+    });
+    // ... operation not registered? we're done ...
+    if ( false == ctx_.response_.asynchronous_ ) {
+        NGX_BROKER_MODULE_FINALIZE_REQUEST(this);
+    }
+}
+
+/**
+ * @brief This method will be called when the content hashes of the file about to be moved can't be calculated.
+ *
+ * @param a_exception Error that occurred.
+ */
+void ngx::casper::broker::cdn::archive::Module::OnMoveContentHashFailed (const ::cc::Exception& a_exception)
+{
+    integrity_.ticket_ = 0;
+    // ... forget new file ...
+    try {
+        archive_.Destroy();
+    } catch (...) {
+        // ... since we're trying to rollback, ignore this error ...
+    }
+    // ... set error ...
+    NGX_BROKER_MODULE_SET_INTERNAL_SERVER_ERROR(ctx_, a_exception.what());
+    // ... finalize request ...
+    NGX_BROKER_MODULE_FINALIZE_REQUEST(this);
+}
+
 #ifdef __APPLE__
 #pragma mark - HELPER METHODS - Billing
 #endif
@@ -1700,7 +1869,7 @@ ngx_int_t ngx::casper::broker::cdn::archive::Module::Factory (ngx_http_request_t
         /* in_headers_              */ {},
         /* config_                  */ {},
         /* locale_                  */ "",
-        /* supported_content_types_ */ { "*/*" }
+        /* supported_content_types_ */ &sk_supported_content_types_
     };
 
     ngx_int_t rv = ngx::casper::broker::Module::WarmUp(ngx_http_casper_broker_cdn_archive_module, a_r, loc_conf->log_token,
@@ -1744,7 +1913,7 @@ ngx_int_t ngx::casper::broker::cdn::archive::Module::Factory (ngx_http_request_t
 
     return ::ngx::casper::broker::Module::Initialize(config, params,
                                                      [&config, &params, &broker_conf, &loc_conf] () -> ::ngx::casper::broker::Module* {
-                                                         return new ::ngx::casper::broker::cdn::archive::Module(config, params, *broker_conf, *loc_conf );
+                                                         return new (config.ngx_ptr_) ::ngx::casper::broker::cdn::archive::Module(config, params, *broker_conf, *loc_conf );
                                                      }
     );
 }
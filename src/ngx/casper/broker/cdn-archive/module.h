@@ -62,6 +62,7 @@ namespace ngx
 
                         static const char* const sk_rx_content_type_;
                         static const char* const sk_tx_content_type_;
+                        static const std::set<std::string> sk_supported_content_types_;
 
                     private: // Data
                         
@@ -77,6 +78,7 @@ namespace ngx
                         XBillingID          x_billing_id_;
                         XBillingType        x_billing_type_;
                         XValidateIntegrity  x_validate_integrity_;
+                        XValidateIntegrity  x_validate_integrity_deep_;
                         
                     private: // Static Data
                         
@@ -92,6 +94,20 @@ namespace ngx
                         } DB;
                         
                         DB                            db_;
+
+                        typedef struct {
+                            uint64_t             ticket_;
+                            Archive::DigestCheck check_;
+                        } Integrity;
+
+                        Integrity                     integrity_;
+
+                        typedef struct {
+                            std::map<std::string, std::string> attrs_;
+                            Archive::ContentHashes             hashes_;
+                        } MoveData;
+
+                        MoveData                      move_;
                         
                     private: // Extensions
                         
@@ -115,6 +131,7 @@ namespace ngx
                     private: // Method(s) / Function(s)
                         
                         ngx_int_t Perform ();
+                        ngx_int_t Perform (const std::function<void()>& a_callback);
                         void      HEAD    ();
                         void      GET     ();
                         void      POST    ();
@@ -136,6 +153,13 @@ namespace ngx
                         void      OnRegisterSyncOperationFailed    (const db::Synchronization::Operation a_operation,
                                                                     const uint16_t a_status, const ::ev::Exception& a_ev_exception);
 
+                    private: // Method(s) / Function(s) - Integrity
+
+                        void      OnContentDigestSucceeded (const std::string& a_value);
+                        void      OnContentDigestFailed    (const ::cc::Exception& a_exception);
+                        void      OnMoveContentHashed      (const std::string& a_value, const std::string& a_md5);
+                        void      OnMoveContentHashFailed  (const ::cc::Exception& a_exception);
+
                     private: // Method(s) / Function(s)
 
                         void SetSuccessResponse     (const Archive::RInfo& a_info, const Json::Value* o_other_attrs = nullptr);
@@ -21,7 +21,17 @@
 
 #include "ngx/casper/broker/cdn-common/act.h"
 
-#include "ngx/casper/broker/cdn-common/ast/evaluator.h"
+#include "cc/types.h" // UINT64_FMT
+
+#include <stdio.h>  // sscanf
+#include <string.h> // strcasecmp
+
+std::map<const Json::Value*, ngx::casper::broker::cdn::ACT::Schema*> ngx::casper::broker::cdn::ACT::s_schemas_;
+
+uint64_t ngx::casper::broker::cdn::ACT::s_generation_ = 0;
+
+const size_t      ngx::casper::broker::cdn::ACT::sk_max_programs_   = 1024;
+const char* const ngx::casper::broker::cdn::ACT::sk_generation_key_ = "__act_generation__";
 
 /**
  * @brief Default constructor.
@@ -30,8 +40,8 @@
  * param a_headers_map
  */
 ngx::casper::broker::cdn::ACT::ACT (const Json::Value& a_config,
-                                    const std::map<std::string, std::string>& a_headers_map)
-    : config_(a_config), headers_map_(a_headers_map)
+                                    const ngx::casper::broker::InHeaders& a_headers_map)
+    : config_(a_config), headers_map_(a_headers_map), schema_(nullptr)
 {
     /* empty */
 }
@@ -41,42 +51,57 @@ ngx::casper::broker::cdn::ACT::ACT (const Json::Value& a_config,
  */
 ngx::casper::broker::cdn::ACT::~ACT ()
 {
-    for ( auto it : numeric_variables_ ) {
-        delete it.second;
-    }
-    numeric_variables_.clear();
+    /* empty */
 }
 
 /**
- * @brief Setup ACT.
+ * @brief Setup ACT, collecting variables values from request headers.
  */
 void ngx::casper::broker::cdn::ACT::Setup ()
 {
-    for ( auto it : numeric_variables_ ) {
-        delete it.second;
-    }
-    numeric_variables_.clear();
-
-    const Json::Value& variables = config_["variables"];
-    for ( auto type : variables.getMemberNames() ) {
-        const Json::Value& var_array = variables[type];
-        if ( 0 == strcasecmp(type.c_str(), "numeric") || 0 == strcasecmp(type.c_str(), "hex") ) {
-            for ( Json::ArrayIndex idx = 0 ; idx < var_array.size() ; ++idx ) {
-                const Json::Value& variable = var_array[idx];
-                numeric_variables_[variable["name"].asString()] = new Variable<uint64_t, XNumber>(
-                     variable["header"].asCString(), static_cast<uint64_t>(variable.get("default", 0).asUInt64()), false == variable["default"].isNull()
-                );
-            }
-        } else {
-            throw cc::Exception("Don't know how to handle ACT variable type '%s'!", type.c_str());
+    // ... schema is built once per config, by Load ...
+    if ( nullptr == schema_ ) {
+        // ... a config replaced at a reused address carries another generation ...
+        const auto it = s_schemas_.find(&config_);
+        if ( s_schemas_.end() == it || it->second->generation_ != config_.get(sk_generation_key_, 0).asUInt64() ) {
+            throw ::cc::Exception("ACT configuration was not loaded!");
         }
+        schema_ = it->second;
+        values_.resize(schema_->slots_.size());
     }
     
-    for ( auto it : numeric_variables_ ) {
-        if ( it.second->can_default_ ) {
-            it.second->value().Set(headers_map_, &it.second->default_);
-        } else {
-            it.second->value().Set(headers_map_);
+    for ( size_t idx = 0 ; idx < schema_->slots_.size() ; ++idx ) {
+        const Schema::Slot& slot = schema_->slots_[idx];
+        const auto it = headers_map_.find(slot.header_);
+        if ( headers_map_.end() == it ) {
+            if ( false == slot.can_default_ ) {
+                throw ::cc::Exception("Can't set header '%s' value - not found in provided map!", slot.header_.c_str());
+            }
+            values_[idx] = slot.default_;
+            continue;
+        }
+        // ... same rules as XNumber: leading spaces, hex ( 0x... ) or decimal ...
+        const char* value_ptr = it->second.c_str();
+        while ( ' ' == value_ptr[0] ) {
+            value_ptr++;
+        }
+        bool valid = ( '\0' != value_ptr[0] );
+        if ( true == valid ) {
+            if ( '0' == value_ptr[0] && 'x' == value_ptr[1] ) {
+                int value = 0;
+                valid = ( 1 == sscanf(value_ptr, "%x", &value) && value >= 0 );
+                if ( true == valid ) {
+                    values_[idx] = static_cast<uint64_t>(value);
+                }
+            } else {
+                valid = ( 1 == sscanf(value_ptr, UINT64_FMT, &values_[idx]) );
+            }
+        }
+        if ( false == valid ) {
+            if ( false == slot.can_default_ ) {
+                throw ::cc::Exception("Can't set header '%s' value - invalid value!", slot.header_.c_str());
+            }
+            values_[idx] = slot.default_;
         }
     }
 }
@@ -101,12 +126,126 @@ void ngx::casper::broker::cdn::ACT::Compile (const std::string& a_expressions,
  */
 uint64_t ngx::casper::broker::cdn::ACT::Evaluate (const std::string& a_expression) const
 {
-    ngx::casper::broker::cdn::common::ast::Evaluator evaluator;
-    return evaluator.Evaluate(a_expression, [this] (const std::string& a_name) -> uint64_t {
-        const auto it = numeric_variables_.find(a_name);
-        if ( numeric_variables_.end() == it ) {
+    if ( nullptr == schema_ ) {
+        throw ::cc::Exception("ACT not setup!");
+    }
+    return Compiled(a_expression).Run(values_.data());
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Build ( or rebuild ) the variables schema for an ACT configuration and stamp it with a new generation.
+ *
+ * @param o_config ACT configuration, must outlive all \link ACT \link objects using it.
+ */
+void ngx::casper::broker::cdn::ACT::Load (Json::Value& o_config)
+{
+    Schema* schema = new Schema(o_config, ++s_generation_);
+    const auto it = s_schemas_.find(&o_config);
+    if ( s_schemas_.end() != it ) {
+        delete it->second;
+        it->second = schema;
+    } else {
+        s_schemas_[&o_config] = schema;
+    }
+    o_config[sk_generation_key_] = static_cast<Json::UInt64>(schema->generation_);
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Obtain a compiled program for an expression, compiling and caching it if needed.
+ *
+ * @param a_expression The pre-compiled expression.
+ *
+ * @return Read-only access to the compiled program.
+ */
+const ngx::casper::broker::cdn::common::ast::Program& ngx::casper::broker::cdn::ACT::Compiled (const std::string& a_expression) const
+{
+    // ... slots are bound to variables declared by this config ...
+    Programs& programs = schema_->programs_;
+    
+    const auto it = programs.find(a_expression);
+    if ( programs.end() != it ) {
+        return *it->second;
+    }
+    
+    // ... compile it ...
+    const std::map<std::string, size_t>& index = schema_->index_;
+    const common::ast::Program* program = new common::ast::Program(a_expression, [&index] (const std::string& a_name) -> size_t {
+        const auto var_it = index.find(a_name);
+        if ( index.end() == var_it ) {
             throw cc::Exception("ACT variable '%s' is not defined!", a_name.c_str());
         }
-        return (const uint64_t&)(it->second->value());
+        return var_it->second;
     });
+    
+    // ... keep cache bounded ...
+    if ( programs.size() >= sk_max_programs_ ) {
+        for ( auto it2 : programs ) {
+            delete it2.second;
+        }
+        programs.clear();
+    }
+    
+    programs[a_expression] = program;
+    
+    return *program;
+}
+
+#ifdef __APPLE__
+#pragma mark - SCHEMA
+#endif
+
+/**
+ * @brief Default constructor.
+ *
+ * @param a_config     ACT configuration.
+ * @param a_generation Generation to stamp on \p a_config.
+ */
+ngx::casper::broker::cdn::ACT::Schema::Schema (const Json::Value& a_config, const uint64_t a_generation)
+    : generation_(a_generation)
+{
+    const Json::Value& variables = a_config["variables"];
+    for ( auto type : variables.getMemberNames() ) {
+        const Json::Value& var_array = variables[type];
+        if ( 0 == strcasecmp(type.c_str(), "numeric") || 0 == strcasecmp(type.c_str(), "hex") ) {
+            for ( Json::ArrayIndex idx = 0 ; idx < var_array.size() ; ++idx ) {
+                const Json::Value& variable = var_array[idx];
+                const Slot slot = {
+                    /* name_        */ variable["name"].asString(),
+                    /* header_      */ variable["header"].asString(),
+                    /* default_     */ static_cast<uint64_t>(variable.get("default", 0).asUInt64()),
+                    /* can_default_ */ false == variable["default"].isNull()
+                };
+                // ... last declaration wins ...
+                const auto it = index_.find(slot.name_);
+                if ( index_.end() != it ) {
+                    slots_[it->second] = slot;
+                } else {
+                    index_[slot.name_] = slots_.size();
+                    slots_.push_back(slot);
+                }
+            }
+        } else {
+            throw cc::Exception("Don't know how to handle ACT variable type '%s'!", type.c_str());
+        }
+    }
+    slots_.shrink_to_fit();
+}
+
+/**
+ * @brief Destructor.
+ */
+ngx::casper::broker::cdn::ACT::Schema::~Schema ()
+{
+    for ( auto it : programs_ ) {
+        delete it.second;
+    }
+    programs_.clear();
 }
@@ -33,6 +33,11 @@
 #include "json/json.h"
 
 #include "ngx/casper/broker/cdn-common/ast/tree.h"
+#include "ngx/casper/broker/cdn-common/ast/program.h"
+
+#include <map>           // std::map
+#include <unordered_map> // std::unordered_map
+#include <vector>        // std::vector
 
 namespace ngx
 {
@@ -48,11 +53,48 @@ namespace ngx
                 
                 class ACT : public ::cc::NonCopyable, public ::cc::NonMovable
                 {
+                    
+                private: // Data Type(s)
+                    
+                    typedef std::unordered_map<std::string, const common::ast::Program*> Programs;
+                    
+                    /**
+                     * @brief Immutable variables table built from an ACT configuration, shared by all requests.
+                     */
+                    class Schema final : public ::cc::NonCopyable, public ::cc::NonMovable
+                    {
+                        
+                    public: // Data Type(s)
+                        
+                        typedef struct {
+                            std::string name_;
+                            std::string header_;
+                            uint64_t    default_;
+                            bool        can_default_;
+                        } Slot;
+                        
+                    public: // Const Data
+                        
+                        const uint64_t                generation_; //!< Generation stamped on the config this schema was built from, by \link ACT::Load \link.
+                        
+                    public: // Data
+                        
+                        std::vector<Slot>             slots_;
+                        std::map<std::string, size_t> index_;
+                        Programs                      programs_;
+                        
+                    public: // Constructor(s) / Destructor
+                        
+                        Schema () = delete;
+                        Schema (const Json::Value& a_config, const uint64_t a_generation);
+                        virtual ~Schema ();
+                        
+                    }; // end of class 'Schema'
            
                 public: // Const Refs
                     
                     const Json::Value&                        config_;
-                    const std::map<std::string, std::string>& headers_map_;
+                    const ngx::casper::broker::InHeaders&     headers_map_;
                     
                 private: // Helpers
                     
@@ -60,12 +102,23 @@ namespace ngx
                     
                 private: // Data
                     
-                    std::map<std::string, Variable<uint64_t, XNumber>*> numeric_variables_;
+                    Schema*                                   schema_;
+                    std::vector<uint64_t>                     values_;
+                    
+                private: // Static Data
+                    
+                    static std::map<const Json::Value*, Schema*> s_schemas_;
+                    static uint64_t                              s_generation_;
+                    
+                private: // Static Const Data
+                    
+                    static const size_t                          sk_max_programs_;
+                    static const char* const                     sk_generation_key_;
 
                 public: // Constructor(s) / Destructor
                     
                     ACT () = delete;
-                    ACT (const Json::Value& a_config, const std::map<std::string, std::string>& a_headers_map);
+                    ACT (const Json::Value& a_config, const ngx::casper::broker::InHeaders& a_headers_map);
                     virtual ~ACT ();
                     
                 public: // Method(s) / Function(s)
@@ -75,6 +128,14 @@ namespace ngx
                                        const std::function<void(const std::string& ,const std::string&)>& a_callback);
                     uint64_t Evaluate (const std::string& a_expression) const;
                     
+                public: // Static Method(s) / Function(s)
+                    
+                    static void Load (Json::Value& o_config);
+                    
+                private: // Method(s) / Function(s)
+                    
+                    const common::ast::Program& Compiled (const std::string& a_expression) const;
+                    
                 }; // end of class 'ACT'
                 
             } // end of namespace 'api'
@@ -22,6 +22,8 @@
 #include "ngx/casper/broker/cdn-common/archive.h"
 
 #include "ngx/casper/broker/cdn-common/exception.h"
+#include "ngx/casper/broker/cdn-common/hasher.h"
+#include "ngx/casper/broker/cdn-common/id_matcher.h"
 
 #include "osal/osalite.h" // INT64_FMT_ZP
 
@@ -31,8 +33,24 @@
 
 #include "cc/b64.h"
 
+#include <sys/stat.h> // stat
+#include <fcntl.h>    // open
+#include <unistd.h>   // close
+#include <errno.h>    // errno
+#include <string.h>   // strerror
+#if defined(__linux__)
+    #include <sys/ioctl.h>   // ioctl
+    #include <linux/fs.h>    // FS_IOC_GETVERSION, FICLONE
+    #include <sys/syscall.h> // __NR_copy_file_range
+#endif
+
 #include <fstream> // std::filebuf, std::istream
-#include <regex>   // std::regex
+
+#ifdef __APPLE__
+    #define NRS_ARCHIVE_MTIME(a_stat) (a_stat).st_mtimespec
+#else
+    #define NRS_ARCHIVE_MTIME(a_stat) (a_stat).st_mtim
+#endif
 
 #define THROW_INTERNAL_ERROR(a_msg) \
     throw ngx::casper::broker::cdn::InternalServerError(\
@@ -65,7 +83,7 @@
     }
 
 #define XATTR_READ_SANITY_CHECK_BARRIER() \
-    if ( nullptr == xattr_ ) { \
+    if ( nullptr == xattr_ && nullptr == snapshot_ ) { \
         THROW_INTERNAL_ERROR("can't be called - URI to local file is not set!"); \
     } \
     if ( \
@@ -100,6 +118,60 @@ const std::set<std::string> ngx::casper::broker::cdn::Archive::sk_validation_exc
 
 const bool ngx::casper::broker::cdn::Archive::sk_content_modification_history_enabled_ = false;
 
+const std::set<std::string> ngx::casper::broker::cdn::Archive::sk_replicated_attrs_ = {
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.id"                     },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.content-type"           },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.content-length"         },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.filename"               },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5"                    },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5.stamp"              },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.digest"                 },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.archivist"              },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.archived.by"            },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.archived.at"            },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.created.by"             },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.created.at"             },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.modified.by"            },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.modified.at"            },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.modified.count"         },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.modified.history"       },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.modified.requestee"     },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.created.by"      },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.created.at"      },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.modified.by"     },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.modified.at"     },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.modified.count"  },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.seal"            },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.billing.id"             },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.billing.type"           },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.permissions.hr"         },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.permissions.ast.r"      },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.permissions.ast.w"      },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.permissions.ast.d"      },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.replication.tag"        },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.replication.data"       },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.replication.seal"       },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.id"                      },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.protocol"                },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.method"                  },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.user-agent"              },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.origin"                  },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.referer"                 },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.ip"                      },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.created.by"              },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.created.at"              },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.uri"                     },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.content-type"            },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.content-length"          },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.md5"                     },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.seal"                    },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.magic.type"              },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.magic.description"       },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.magic.validation"        },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.suspicious.type"         },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.suspicious.offsetted.by" }
+};
+
 /**
  * @brief Default constructor.
  *
@@ -113,12 +185,12 @@ const bool ngx::casper::broker::cdn::Archive::sk_content_modification_history_en
  */
 ngx::casper::broker::cdn::Archive::Archive (const std::string& a_archivist, const std::string& a_writer,
                                             const Json::Value& a_act_config,
-                                            const std::map<std::string, std::string>& a_headers, const ngx::casper::broker::cdn::H2EMap& a_h2e_map,
+                                            const ngx::casper::broker::InHeaders& a_headers, const ngx::casper::broker::cdn::H2EMap& a_h2e_map,
                                             const std::string& a_dir_prefix,
                                             const std::string a_replicator)
     : archivist_(a_archivist), writer_(a_writer),
       act_config_(a_act_config), headers_(a_headers), h2e_map_(a_h2e_map), dir_prefix_(a_dir_prefix), replicator_(a_replicator),
-      mode_(ngx::casper::broker::cdn::Archive::Mode::NotSet), bytes_written_(0), buffer_(nullptr),
+      mode_(ngx::casper::broker::cdn::Archive::Mode::NotSet), bytes_written_(0), digest_md_(nullptr),
       act_(act_config_, headers_),
       xattr_(nullptr)
 {
@@ -148,10 +220,6 @@ ngx::casper::broker::cdn::Archive::~Archive ()
     if ( nullptr != xattr_ ) {
         delete xattr_;
     }
-    // ... release buffer ...
-    if ( nullptr != buffer_ ) {
-        delete [] buffer_;
-    }
 }
 
 #ifdef __APPLE__
@@ -173,6 +241,7 @@ void ngx::casper::broker::cdn::Archive::Open (const std::string& a_path,
         SetLocalInfoFromURLPath(a_path, *this, /* a_append_extension */ false, local_);
         
         // ... LEGACY FILES: check if file exists ...
+        struct stat st;
         if ( local_.ext_.length() > 0 ) {
             // ... legacy file has extension ...
             std::string uri = local_.uri_;
@@ -185,21 +254,25 @@ void ngx::casper::broker::cdn::Archive::Open (const std::string& a_path,
                 uri += '.' + local_.ext_;
             }
             // ... if exists ...
-            if ( true == ::cc::fs::File::Exists(uri) ) {
+            if ( 0 == stat(uri.c_str(), &st) && S_ISREG(st.st_mode) ) {
                 // ... accept it ..
                 local_.uri_  = uri;
-                local_.size_ = ::cc::fs::File::Size(local_.uri_);
-            } else if ( false == ::cc::fs::File::Exists(local_.uri_) ) {
+                local_.size_ = static_cast<uint64_t>(st.st_size);
+            } else if ( 0 != stat(local_.uri_.c_str(), &st) || 0 == S_ISREG(st.st_mode) ) {
                 // ... legacy file does not exists, also the file without extension does not exist either ...
                 throw ngx::casper::broker::cdn::NotFound();
             }
-        } else if ( false == ::cc::fs::File::Exists(local_.uri_) ) {
+        } else if ( 0 != stat(local_.uri_.c_str(), &st) || 0 == S_ISREG(st.st_mode) ) {
             // ... not a legacy file ...
             throw ngx::casper::broker::cdn::NotFound();
         }
 
-        // ... prepare xattrs helper ...
-        xattr_ = new ::cc::fs::file::XAttr(local_.uri_);
+        // ... xattrs snapshot from cache ( if enabled ), revalidated by the stat above ...
+        snapshot_ = ngx::casper::broker::cdn::XAttrsCache::GetInstance().Get(local_.uri_, st);
+        if ( nullptr == snapshot_ ) {
+            // ... prepare xattrs helper ...
+            xattr_ = new ::cc::fs::file::XAttr(local_.uri_);
+        }
         
         // ... open, just for testing purposes only ( exits and obtain xhvn )?
         ngx::casper::broker::cdn::Archive::Mode mode;
@@ -216,6 +289,16 @@ void ngx::casper::broker::cdn::Archive::Open (const std::string& a_path,
         
         // ... set mode.
         mode_ = mode;
+        
+        // ... snapshot is only suitable for read-only access ...
+        if ( ngx::casper::broker::cdn::Archive::Mode::Read != mode_ && nullptr != snapshot_ ) {
+            // ... and it's about to change?
+            if ( ngx::casper::broker::cdn::Archive::Mode::Validate != mode_ ) {
+                ngx::casper::broker::cdn::XAttrsCache::GetInstance().Invalidate(st);
+            }
+            snapshot_.reset();
+            xattr_ = new ::cc::fs::file::XAttr(local_.uri_);
+        }
 
         switch(mode_) {
             case ngx::casper::broker::cdn::Archive::Mode::Modify:
@@ -315,8 +398,8 @@ void ngx::casper::broker::cdn::Archive::Create (const ngx::casper::broker::cdn::
     try {
  
         // ... set common local info setup ...
-        const auto it = h2e_map_.find(a_id.Name());
-        if ( h2e_map_.end() == it ) {
+        const auto it = h2e_map_.Find(a_id.Name());
+        if ( nullptr == it ) {
             throw ::cc::Exception("Unable to setup archive writer: couldn't find '%s' directory component!", a_id.Name().c_str());
         }
         
@@ -334,35 +417,23 @@ void ngx::casper::broker::cdn::Archive::Create (const ngx::casper::broker::cdn::
             throw ::cc::Exception("Unable to setup archive writer: couldn't prepare id - buffer write error!");
         }
         
-        // ... id starts with a prefix ...
+        // ... id starts with a prefix ( uniqueness is ensured when h2e map is loaded ) ...
         local_.id_ = tolower(it->second[0]);
         
-        // ... but make sure only one exists ...
-        size_t prefix_count = false;
-        for ( auto it2 : h2e_map_ ) {
-            if ( it2.second[0] == local_.id_[0] ) {
-                prefix_count += 1;
-            }
-        }
-        if ( prefix_count > 1 ) {
-            throw ngx::casper::broker::cdn::BadRequest("Multiple id prefix options provided, expecting only one!");
-        }
-        
         // ... a reserved id was provided?
         if ( nullptr != a_reserved_id ) {
             // ... yes, validated it ...
-            const std::regex id_expr("([a-z]{1})([a-zA-Z]{2})([a-zA-Z0-9]{6})(\\..+)?", std::regex_constants::ECMAScript);
-            std::smatch match;
-            if ( false == std::regex_search((*a_reserved_id), match, id_expr) || match.size() < 5 ) {
+            ngx::casper::broker::cdn::IDMatcher::Match match;
+            if ( false == ngx::casper::broker::cdn::IDMatcher::Search((*a_reserved_id), ngx::casper::broker::cdn::IDMatcher::Dialect::Archive, &match) ) {
                 throw ::cc::Exception("Unable to setup archive writer: invalid or reserved id '%s'!", a_reserved_id->c_str());
             }
             // ... ensure valid prefix ...
-            const char id_prefix = match[1].str()[0];
+            const char id_prefix = (*a_reserved_id)[match.offset_];
             if ( id_prefix != local_.id_[0] ) {
                 throw ngx::casper::broker::cdn::BadRequest("Invalid id prefix!");
             }
             // ... grab id path component ...
-            tmp_ = match[2].str();
+            tmp_ = a_reserved_id->substr(match.offset_ + ngx::casper::broker::cdn::IDMatcher::k_prefix_length_, ngx::casper::broker::cdn::IDMatcher::k_path_length_);
             // ... append ( 2 chars ) path component to id ...
             id_buffer[16] = tmp_[0];
             id_buffer[17] = tmp_[1];
@@ -373,8 +444,9 @@ void ngx::casper::broker::cdn::Archive::Create (const ngx::casper::broker::cdn::
             local_.path_     = ( dir_prefix_ + it->second + '/' + id_buffer + '/' );
             // ... set uri, name and ext ...
             local_.uri_      = local_.path_;
-            local_.filename_ = match[3].str();
-            local_.ext_      = match[4].str();
+            local_.filename_ = a_reserved_id->substr(match.offset_ + ngx::casper::broker::cdn::IDMatcher::k_prefix_length_ + ngx::casper::broker::cdn::IDMatcher::k_path_length_,
+                                                     ngx::casper::broker::cdn::IDMatcher::k_name_length_);
+            local_.ext_      = a_reserved_id->substr(match.offset_ + ngx::casper::broker::cdn::IDMatcher::k_id_length_, match.ext_length_);
             // ... check if files does not exists ...
             tmp_ = ( local_.uri_ + local_.filename_ + local_.ext_ ) ;
             if ( true == ::cc::fs::File::Exists(tmp_) ) {
@@ -424,6 +496,9 @@ void ngx::casper::broker::cdn::Archive::Create (const ngx::casper::broker::cdn::
         
         // ... prepare MD5 calculation ...
         md5_.Initialize();
+        if ( nullptr != digest_md_ ) {
+            digest_.Initialize(digest_md_);
+        }
        
     } catch (const ngx::casper::broker::cdn::BadRequest& a_bad_request) {
         Reset();
@@ -462,9 +537,13 @@ size_t ngx::casper::broker::cdn::Archive::Write (const unsigned char* const a_da
     
     bytes_written_ += static_cast<uint64_t>(bw);
     
-    // ... update MD5 ...
+    // ... update MD5 and digest ( if any ) in a single pass ...
     if ( bw == a_size ) {
-        md5_.Update(a_data, a_size);
+        if ( nullptr != digest_md_ ) {
+            digest_.Update(a_data, a_size, md5_);
+        } else {
+            md5_.Update(a_data, a_size);
+        }
     }
     
     return bw;
@@ -513,55 +592,29 @@ void ngx::casper::broker::cdn::Archive::Close (const std::map<std::string, std::
         // ... reset ...
         bytes_written_ = 0;
 
-        // ... write attributes now ...
-        SetXAttrs(a_attrs, a_preserving, /* a_excluding */ { XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5" }, /* a_trusted */ false, /* a_seal */ false);
+        // ... stage attributes now ...
+        ngx::casper::broker::cdn::XAttrsBatch batch(*xattr_);
+        StageXAttrs(batch, a_attrs, a_preserving,
+                    /* a_excluding */ { XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5", XATTR_ARCHIVE_PREFIX "com.cldware.archive.digest" },
+                    /* a_trusted */ false
+        );
 
         // ... finalize and save MD5 calculation ...
-        xattr_->Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5", md5_.Finalize());
+        batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5", md5_.Finalize());
+        if ( nullptr != digest_md_ ) {
+            batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.digest", digest_.Finalize());
+        }
+        // ... and remember which content it was calculated for ...
+        batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5.stamp", Stamp(local_.uri_));
+        
+        CloseXAttrs(batch);
         
     } else {
-        // ... write attributes now ...
-        SetXAttrs(a_attrs, a_preserving, /* a_excluding */ {}, /* a_trusted */ false, /* a_seal */ false);
-    }
-    
-    // ... ensure minimum required tracking attributes ...
-    
-    if ( false == xattr_->Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.archivist") ) {
-        xattr_->Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.archivist", archivist_);
-    }
-    if ( false == xattr_->Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.archived.at") ) {
-        xattr_->Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.archived.at", cc::UTCTime::NowISO8601WithTZ());
-    }
-    
-    if ( false == xattr_->Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.created.by") ) {
-        xattr_->Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.created.by", writer_);
-    }
-    if ( false == xattr_->Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.created.at") ) {
-        xattr_->Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.created.at", cc::UTCTime::NowISO8601WithTZ());
-    }
-    
-    // ... seal attributes ...
-    xattr_->Get(XATTR_ARCHIVE_PREFIX "com.cldware.archive.archivist", tmp_);
-    xattr_->Seal(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.seal",
-                 reinterpret_cast<const unsigned char*>(tmp_.c_str()), tmp_.length(),
-                 &sk_validation_excluded_attrs_
-    );
-
-    // ... seal replication attributes ...
-    if ( 0 != replicator_.length() ) {                
-        if ( false == xattr_->Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.replication.tag") ) {
-            tmp_ = ::cc::base64_url_unpadded::encode(replicator_);
-            xattr_->Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.replication.tag", tmp_);
-        } else {
-            xattr_->Get(XATTR_ARCHIVE_PREFIX "com.cldware.archive.replication.tag", tmp_);
-        }
-        xattr_->Seal(XATTR_ARCHIVE_PREFIX "com.cldware.archive.replication.seal",
-                     {
-                        { XATTR_ARCHIVE_PREFIX "com.cldware.archive.replication.tag" },
-                        { XATTR_ARCHIVE_PREFIX "com.cldware.archive.replication.data" }
-                     },
-                     reinterpret_cast<const unsigned char*>(tmp_.c_str()), tmp_.length()
-        );
+        // ... stage attributes now ...
+        ngx::casper::broker::cdn::XAttrsBatch batch(*xattr_);
+        StageXAttrs(batch, a_attrs, a_preserving, /* a_excluding */ {}, /* a_trusted */ false);
+        
+        CloseXAttrs(batch);
     }
     
     // ... set basic info ...
@@ -920,12 +973,15 @@ void ngx::casper::broker::cdn::Archive::Update (const std::string& a_path,
  * @param a_backup     When true a copy of this file will be made and attributes are applied in the new copy,
  *                     otherwise it will be applied directly on provided file URI.
  * @param o_info       Important information to return.
+ * @param a_hashes     When set, \p a_uri content hashes already calculated elsewhere ( e.g. \link Hasher::Submit \link ),
+ *                     otherwise they are calculated here, in the calling thread.
  */
 void ngx::casper::broker::cdn::Archive::Move (const std::string& a_uri,
                                               const std::map<std::string, std::string>& a_attrs,
                                               const std::set<std::string>& a_preserving,
                                               const bool a_backup,
-                                              ngx::casper::broker::cdn::Archive::RInfo& o_info)
+                                              ngx::casper::broker::cdn::Archive::RInfo& o_info,
+                                              const ngx::casper::broker::cdn::Archive::ContentHashes* a_hashes)
 {
     MODE_SANITY_CHECK_BARRIER(ngx::casper::broker::cdn::Archive::Mode::Create);
     
@@ -957,30 +1013,29 @@ void ngx::casper::broker::cdn::Archive::Move (const std::string& a_uri,
     // ... do not trust upload md5 info -
     // ... it could be changed after upload and / or before this API is called ...
     //
-    // ... release previous buffer ( if any ) ...
-    if ( nullptr != buffer_ ) {
-        delete [] buffer_;
-    }
-    // ... allocate new 'read' buffer ...
-    buffer_ = new unsigned char[10485760];
-    // ... initialize MD5 ...
-    md5_.Initialize();
-    bool eof = false; size_t len = 0;
-    ::cc::fs::File fr; fr.Open(a_uri, ::cc::fs::file::Writer::Mode::Read);
-    while ( 0 != ( len = fr.Read(buffer_, 10485760, eof) ) ) {
-        md5_.Update(buffer_, len);
-        if ( true == eof ) {
-            break;
+    ContentHashes hashes;
+    if ( nullptr == a_hashes ) {
+        // ... stamp is taken before reading, any change while calculating MD5 will invalidate it ...
+        hashes.stamp_ = Stamp(a_uri);
+        // ... calculate MD5 and digest ( if any ) in a single pass, read buffer is shared and reused ...
+        if ( nullptr != digest_md_ ) {
+            hashes.digest_ = ngx::casper::broker::cdn::Hasher::GetInstance().Compute(a_uri, digest_md_, &hashes.md5_);
+        } else {
+            hashes.md5_ = ngx::casper::broker::cdn::Hasher::GetInstance().Compute(a_uri);
         }
+        a_hashes = &hashes;
+    }
+    if ( nullptr != digest_md_ ) {
+        swp_xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.digest", a_hashes->digest_);
     }
-    fr.Close();
-    // ... release buffer ...
-    delete [] buffer_;
-    buffer_ = nullptr;
-    //  ... finalize MD5 calculation ...
-    const std::string md5 = md5_.Finalize();
     // ... set 'md5' attribute ...
-    swp_xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5", md5);
+    swp_xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5", a_hashes->md5_);
+    // ... a rename keeps inode and mtime, a copy doesn't ...
+    if ( false == a_backup ) {
+        swp_xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5.stamp", a_hashes->stamp_);
+    } else if ( true == swp_xattrs.Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5.stamp") ) {
+        swp_xattrs.Remove(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5.stamp");
+    }
     // ... copy original attributes ...
     for ( auto it : a_preserving ) {
         if ( true == cur_xattrs.Exists(it) ) {
@@ -1044,9 +1099,7 @@ void ngx::casper::broker::cdn::Archive::IDFromURLPath (const std::string& a_path
     }
     
     // ... validated extracted id ...
-    const std::regex id_expr("([a-z]{1})([a-zA-Z]{2})([a-zA-Z0-9]{6})(\\..+)?", std::regex_constants::ECMAScript);
-    std::smatch match;
-    if ( false == std::regex_search(o_id, match, id_expr) || match.size() < 5 ) {
+    if ( false == ngx::casper::broker::cdn::IDMatcher::Search(o_id, ngx::casper::broker::cdn::IDMatcher::Dialect::Archive) ) {
         throw ngx::casper::broker::cdn::BadRequest(
             "Unable to extract archive ID from URI path '%s' - invalid ID format '%s'!", a_path.c_str(), o_id.c_str()
         );
@@ -1088,10 +1141,16 @@ void ngx::casper::broker::cdn::Archive::Rename (const std::string& a_from, const
  * @param a_md5 MD5 value to be tested.
  * @param a_id  ID to compare to instead of file name ( used by when replicated to a temporary file ).
  * @param a_attrs Attributes to compare against written ones.
+ * @param a_deep  When false, content MD5 is only calculated if file changed since it was last calculated.
+ * @param o_check When set, content digest is not calculated here, algorithm and expected value are written to it
+ *                so the caller can check it elsewhere ( e.g. \link Hasher::Submit \link ).
+ *
+ * @return True if content digest still needs to be checked by the caller ( only when \p o_check is set ), false otherwise.
  */
-void ngx::casper::broker::cdn::Archive::Validate (const std::string& a_path,
+bool ngx::casper::broker::cdn::Archive::Validate (const std::string& a_path,
                                                   const std::string* a_md5, const std::string* a_id,
-                                                  const std::map<std::string,std::string>* a_attrs)
+                                                  const std::map<std::string,std::string>* a_attrs,
+                                                  const bool a_deep, ngx::casper::broker::cdn::Archive::DigestCheck* o_check)
 {
     // ... try to open it in 'patch' mode ...
     Open(a_path, [] (const std::string& /* a_xhvn */) {
@@ -1113,8 +1172,7 @@ void ngx::casper::broker::cdn::Archive::Validate (const std::string& a_path,
         std::string      expected_md5;
         std::string      actual_name;
         std::string      actual_archivist;
-        bool             eof;
-        unsigned char    buffer [1024];
+        bool             pending = false;
 
         ::cc::fs::File file; file.Open(local().uri_, cc::fs::File::Mode::Read);
         // ... id ...
@@ -1138,15 +1196,34 @@ void ngx::casper::broker::cdn::Archive::Validate (const std::string& a_path,
             throw cc::Exception("Size mismatch!");
         }
         // ... md5 ...
-        ::cc::hash::MD5 md5;
-        md5.Initialize();
-        do {
-            md5.Update(buffer, file.Read(buffer, 1024, eof));
-        } while ( false == eof );
         xattr_->Get(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5", expected_md5);
-        if ( 0 != expected_md5.compare(md5.Finalize()) ) {
-            throw cc::Exception("MD5 mismatch!");
+        // ... content changed since md5 was calculated? ( stamp is covered by xattrs seal, checked below ) ...
+        bool rehash = a_deep || false == xattr_->Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5.stamp");
+        if ( false == rehash ) {
+            xattr_->Get(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5.stamp", tmp);
+            rehash = ( 0 != tmp.compare(Stamp(local().uri_)) );
         }
+        if ( true == rehash ) {
+            // ... prefer content digest ( if any, and if supported ) over md5, it's cheaper ...
+            DigestCheck check = { /* md_ */ nullptr, /* value_ */ expected_md5 };
+            if ( true == xattr_->Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.digest") ) {
+                xattr_->Get(XATTR_ARCHIVE_PREFIX "com.cldware.archive.digest", tmp);
+                try {
+                    std::string hex;
+                    check.md_    = ngx::casper::broker::cdn::Digest::Parse(tmp, hex);
+                    check.value_ = tmp;
+                } catch (const ::cc::Exception& /* a_cc_exception */) {
+                    // ... unknown algorithm, fallback to md5 ...
+                }
+            }
+            if ( nullptr != o_check ) {
+                // ... content check is up to the caller ...
+                (*o_check) = check;
+                pending    = true;
+            } else if ( 0 != check.value_.compare(ngx::casper::broker::cdn::Hasher::GetInstance().Compute(local().uri_, check.md_)) ) {
+                throw cc::Exception(nullptr == check.md_ ? "MD5 mismatch!" : "Digest mismatch!");
+            }
+        } // else { /* ... nop, seal check is enough ... */ }
         if ( nullptr != a_md5 ) {
             if ( 0 != expected_md5.compare(*a_md5) ) {
                 throw cc::Exception("MD5 mismatch!");
@@ -1161,6 +1238,13 @@ void ngx::casper::broker::cdn::Archive::Validate (const std::string& a_path,
         // ... ensure xattrs correctly copied ...
         if ( nullptr != a_attrs ) {
             for ( auto lhs_attr : *a_attrs ) {
+                // ... skip local file stamp, it's bound to the file it was taken from,
+                //     and content digest, it depends on destination configuration ( content is checked by md5 ) ...
+                if ( 0 == lhs_attr.first.compare(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5.stamp")
+                        ||
+                     0 == lhs_attr.first.compare(XATTR_ARCHIVE_PREFIX "com.cldware.archive.digest") ) {
+                    continue;
+                }
                 // ... get xattr - must exist ...
                 xattr_->Get(lhs_attr.first, tmp);
                 // ... skip replication data ...
@@ -1177,6 +1261,8 @@ void ngx::casper::broker::cdn::Archive::Validate (const std::string& a_path,
         }
         // ... done ...
         close_archive();
+        // ... caller must check content?
+        return pending;
     } catch (...) {
         // ... done ...
         close_archive();
@@ -1198,6 +1284,10 @@ bool ngx::casper::broker::cdn::Archive::HasXAttr (const std::string& a_name) con
 {
     XATTR_READ_SANITY_CHECK_BARRIER();
     
+    if ( nullptr != snapshot_ ) {
+        return ( snapshot_->end() != snapshot_->find(a_name) );
+    }
+    
     return xattr_->Exists(a_name);
 }
 
@@ -1213,7 +1303,7 @@ void ngx::casper::broker::cdn::Archive::GetXAttr (const std::string& a_name, uin
     
     std::string tmp;
     
-    xattr_->Get(a_name, tmp);
+    GetXAttr(a_name, tmp);
     
     o_value = std::stoull(tmp);
 }
@@ -1228,6 +1318,17 @@ void ngx::casper::broker::cdn::Archive::GetXAttr (const std::string& a_name, std
 {
     XATTR_READ_SANITY_CHECK_BARRIER();
     
+    if ( nullptr != snapshot_ ) {
+        const auto it = snapshot_->find(a_name);
+        if ( snapshot_->end() != it ) {
+            o_value = it->second;
+        } else {
+            // ... not set, let xattr helper report the error ...
+            ::cc::fs::file::XAttr(local_.uri_).Get(a_name, o_value);
+        }
+        return;
+    }
+    
     xattr_->Get(a_name, o_value);
 }
 
@@ -1248,7 +1349,7 @@ void ngx::casper::broker::cdn::Archive::GetXAttrs (std::map<std::string, std::st
     
     std::string tmp;
     for ( auto name : keys ) {
-        xattr_->Get(name, tmp);
+        GetXAttr(name, tmp);
         o_attrs[name] = tmp;
     }
 }
@@ -1262,6 +1363,13 @@ void ngx::casper::broker::cdn::Archive::IterateXAttrs (const std::function<void
 {
     XATTR_READ_SANITY_CHECK_BARRIER();
     
+    if ( nullptr != snapshot_ ) {
+        for ( auto it : (*snapshot_) ) {
+            a_callback(it.first.c_str(), it.second.c_str());
+        }
+        return;
+    }
+    
     xattr_->Iterate(a_callback);
 }
 
@@ -1286,59 +1394,132 @@ void ngx::casper::broker::cdn::Archive::SetXAttrs (const std::map<std::string, s
         XATTR_WRITE_SANITY_CHECK_BARRIER();
     }
     
+    ngx::casper::broker::cdn::XAttrsBatch batch(*xattr_);
+    
+    StageXAttrs(batch, a_attrs, a_preserving, a_excluding, /* a_trusted */ true);
+    
+    batch.Flush();
+    
+    // ... seal xattrs?
+    if ( true == a_seal ) {
+        xattr_->Seal(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.seal", reinterpret_cast<const unsigned
+                     char*>(archivist_.c_str()), archivist_.length(),
+                     &sk_validation_excluded_attrs_
+        );
+    }
+}
+
+/**
+ * @brief Stage a set of extended attributes changes, nothing is written until \link XAttrsBatch::Flush \link is called.
+ *
+ * @param a_batch      Attributes batch.
+ * @param a_attrs      Map of attributes name / value.
+ * @param a_preserving Set of attributes to preserve ( ignoring attrs from a_attrs ).
+ * @param a_excluding  Set of attributes to exclude ( from inode ).
+ * @param a_trusted    True if theres no need to do a sanity check, false otherwise.
+ */
+void ngx::casper::broker::cdn::Archive::StageXAttrs (ngx::casper::broker::cdn::XAttrsBatch& a_batch,
+                                                     const std::map<std::string, std::string>& a_attrs,
+                                                     const std::set<std::string>& a_preserving,
+                                                     const std::set<std::string>& a_excluding,
+                                                     bool a_trusted)
+{
+    if ( false == a_trusted ) {
+        XATTR_WRITE_SANITY_CHECK_BARRIER();
+    }
+    
     for ( auto it : a_attrs ) {
-        if ( a_preserving.end() != a_preserving.find(it.first) && true == xattr_->Exists(it.first) ) {
+        if ( a_preserving.end() != a_preserving.find(it.first) && true == a_batch.Exists(it.first) ) {
             continue;
         }
-        xattr_->Set(it.first, it.second);
+        a_batch.Set(it.first, it.second);
     }
     
     const auto it = a_attrs.find(XATTR_ARCHIVE_PREFIX "com.cldware.archive.permissions.hr");
     if ( a_attrs.end() != it ) {
         for ( auto it2 : { XATTR_ARCHIVE_PREFIX "com.cldware.archive.permissions.ast.r", XATTR_ARCHIVE_PREFIX "com.cldware.archive.permissions.ast.w", XATTR_ARCHIVE_PREFIX "com.cldware.archive.permissions.ast.d" } ) {
-            if ( true == xattr_->Exists(it2) ) {
-                xattr_->Remove(it2);
-            }
+            a_batch.Remove(it2);
         }
-        act_.Compile(it->second, [this] (const std::string& a_key, const std::string& a_value) {
+        act_.Compile(it->second, [&a_batch] (const std::string& a_key, const std::string& a_value) {
             for ( auto ch : a_key ) {
-                xattr_->Set(std::string(XATTR_ARCHIVE_PREFIX "com.cldware.archive.permissions.ast.") + ch, a_value);
+                a_batch.Set(std::string(XATTR_ARCHIVE_PREFIX "com.cldware.archive.permissions.ast.") + ch, a_value);
             }
         });
     }
     
-    std::map<std::string, std::string> attrs;
-    if ( true == xattr_->Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.created.by") ) {
+    if ( true == a_batch.Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.created.by") ) {
         if ( 0 == replicator_.length() ) {
-            if ( true == xattr_->Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.modified.count") ) {
-                xattr_->Get(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.modified.count", tmp_);
-                attrs[XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.modified.count"] = std::to_string((std::strtoull(tmp_.c_str(), nullptr, 0) + 1));
+            if ( true == a_batch.Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.modified.count") ) {
+                a_batch.Get(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.modified.count", tmp_);
+                a_batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.modified.count", std::to_string((std::strtoull(tmp_.c_str(), nullptr, 0) + 1)));
             } else {
-                attrs[XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.modified.count"] = "1";
+                a_batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.modified.count", "1");
             }
-            attrs[XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.modified.by"] = writer_;
-            attrs[XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.modified.at"] = cc::UTCTime::NowISO8601WithTZ();
+            a_batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.modified.by", writer_);
+            a_batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.modified.at", cc::UTCTime::NowISO8601WithTZ());
         }
     } else {
-        attrs[XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.created.by"] = writer_;
-        attrs[XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.created.at"] = cc::UTCTime::NowISO8601WithTZ();
+        a_batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.created.by", writer_);
+        a_batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.created.at", cc::UTCTime::NowISO8601WithTZ());
     }
     
-    for ( auto it2 : attrs ) {
-        xattr_->Set(it2.first, it2.second);
+    for ( auto it3 : a_excluding ) {
+        a_batch.Remove(it3);
     }
+}
+
+/**
+ * @brief Stage minimum required tracking attributes, write all staged attributes and seal them.
+ *
+ * @param a_batch Attributes batch.
+ */
+void ngx::casper::broker::cdn::Archive::CloseXAttrs (ngx::casper::broker::cdn::XAttrsBatch& a_batch)
+{
+    // ... ensure minimum required tracking attributes ...
     
-    for ( auto it3 : a_excluding ) {
-        if ( true == xattr_->Exists(it3) ) {
-            xattr_->Remove(it3);
+    if ( false == a_batch.Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.archivist") ) {
+        a_batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.archivist", archivist_);
+    }
+    if ( false == a_batch.Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.archived.at") ) {
+        a_batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.archived.at", cc::UTCTime::NowISO8601WithTZ());
+    }
+    
+    if ( false == a_batch.Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.created.by") ) {
+        a_batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.created.by", writer_);
+    }
+    if ( false == a_batch.Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.created.at") ) {
+        a_batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.created.at", cc::UTCTime::NowISO8601WithTZ());
+    }
+    
+    // ... replication tag ...
+    std::string replication_tag;
+    if ( 0 != replicator_.length() ) {
+        if ( false == a_batch.Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.replication.tag") ) {
+            replication_tag = ::cc::base64_url_unpadded::encode(replicator_);
+            a_batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.replication.tag", replication_tag);
+        } else {
+            a_batch.Get(XATTR_ARCHIVE_PREFIX "com.cldware.archive.replication.tag", replication_tag);
         }
     }
     
-    // ... seal xattrs?
-    if ( true == a_seal ) {
-        xattr_->Seal(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.seal", reinterpret_cast<const unsigned
-                     char*>(archivist_.c_str()), archivist_.length(),
-                     &sk_validation_excluded_attrs_
+    // ... write all changes at once ...
+    a_batch.Flush();
+    
+    // ... seal attributes ...
+    a_batch.Get(XATTR_ARCHIVE_PREFIX "com.cldware.archive.archivist", tmp_);
+    xattr_->Seal(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.seal",
+                 reinterpret_cast<const unsigned char*>(tmp_.c_str()), tmp_.length(),
+                 &sk_validation_excluded_attrs_
+    );
+
+    // ... seal replication attributes ...
+    if ( 0 != replicator_.length() ) {
+        xattr_->Seal(XATTR_ARCHIVE_PREFIX "com.cldware.archive.replication.seal",
+                     {
+                        { XATTR_ARCHIVE_PREFIX "com.cldware.archive.replication.tag" },
+                        { XATTR_ARCHIVE_PREFIX "com.cldware.archive.replication.data" }
+                     },
+                     reinterpret_cast<const unsigned char*>(replication_tag.c_str()), replication_tag.length()
         );
     }
 }
@@ -1360,11 +1541,11 @@ void ngx::casper::broker::cdn::Archive::Fill (bool a_trusted, ngx::casper::broke
     o_info.old_uri_ = "";
     for ( auto& attr : o_info.attrs_ ) {
         if ( true == attr.optional_ ) {
-            if ( true == xattr_->Exists(attr.name_) ) {
-                xattr_->Get(attr.name_, attr.value_);
+            if ( true == HasXAttr(attr.name_) ) {
+                GetXAttr(attr.name_, attr.value_);
             }
         } else {
-            xattr_->Get(attr.name_, attr.value_);
+            GetXAttr(attr.name_, attr.value_);
         }
     }
 }
@@ -1407,24 +1588,16 @@ void ngx::casper::broker::cdn::Archive::Rename (const std::string& a_from, const
 
     // ... rename ...
     if ( true == a_backup ) {
-        ::cc::fs::File::Copy(a_from, a_to, /* a_overwrite */ true);
+        // ... same filesystem? clone or in-kernel copy, destination inode ( and it's xattrs ) is kept ...
+        ngx::casper::broker::cdn::Archive::CopyData(a_from, a_to, /* a_overwrite */ true);
     } else {
+        // ... same filesystem rename only touches metadata, source xattrs travel with the inode ...
         ::cc::fs::File::Rename(a_from, a_to);
     }
     
-    // ... restore xattrs ...
+    // ... restore only the xattrs that differ and seal them again, if needed ...
     ::cc::fs::file::XAttr dst_xattrs(a_to);
-    for ( auto it : attrs ) {
-        dst_xattrs.Set(it.first, it.second);
-    }
-    
-    // ... seal xattrs, file content was copied as xattrs - must be sealed again  ...
-    std::string archivist;
-    dst_xattrs.Get(XATTR_ARCHIVE_PREFIX "com.cldware.archive.archivist", archivist);
-    dst_xattrs.Seal(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.seal",
-                reinterpret_cast<const unsigned char*>(archivist.c_str()), archivist.length(),
-                &sk_validation_excluded_attrs_
-    );
+    ngx::casper::broker::cdn::Archive::RestoreXAttrs(dst_xattrs, attrs);
     
     // ... update r_info?
     if ( nullptr != o_info ) {
@@ -1473,22 +1646,12 @@ void ngx::casper::broker::cdn::Archive::Copy (const std::string& a_from, const s
         attrs[a_key] = a_value;
     });
     
-    // ... rename ...
-    ::cc::fs::File::Copy(a_from, a_to, a_overwrite);
+    // ... copy ...
+    ngx::casper::broker::cdn::Archive::CopyData(a_from, a_to, a_overwrite);
     
-    // ... restore xattrs ...
+    // ... restore only the xattrs that differ and seal them again, if needed ...
     ::cc::fs::file::XAttr dst_xattrs(a_to);
-    for ( auto it : attrs ) {
-        dst_xattrs.Set(it.first, it.second);
-    }
-    
-    // ... seal xattrs ...
-    std::string archivist;
-    dst_xattrs.Get(XATTR_ARCHIVE_PREFIX "com.cldware.archive.archivist", archivist);
-    dst_xattrs.Seal(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.seal",
-                   reinterpret_cast<const unsigned char*>(archivist.c_str()), archivist.length(),
-                   &sk_validation_excluded_attrs_
-    );
+    ngx::casper::broker::cdn::Archive::RestoreXAttrs(dst_xattrs, attrs);
 
     // ... update o_attrs?
     if ( nullptr != o_attrs ) {
@@ -1508,6 +1671,167 @@ void ngx::casper::broker::cdn::Archive::Copy (const std::string& a_from, const s
 #pragma mark - HELPERS
 #endif
 
+/**
+ * @brief Copy a file content, on the same filesystem by cloning it ( reflink ) or by an in-kernel copy,
+ *        otherwise by falling back to \link ::cc::fs::File::Copy \link.
+ *
+ * @param a_from      Source local URI.
+ * @param a_to        Destination local URI.
+ * @param a_overwrite When true, overwrite destination file ( if any ).
+ *
+ * @remarks When \p a_to already exists and the fast path is taken, it's inode and xattrs are preserved,
+ *          callers must \link RestoreXAttrs \link to drop any xattr that is no longer expected.
+ */
+void ngx::casper::broker::cdn::Archive::CopyData (const std::string& a_from, const std::string& a_to, const bool a_overwrite)
+{
+#if defined(__linux__) && ( defined(FICLONE) || defined(__NR_copy_file_range) )
+    struct stat src_st;
+    struct stat dir_st;
+    const size_t sep = a_to.find_last_of('/');
+    const std::string dir = ( std::string::npos == sep ? "." : ( 0 == sep ? "/" : a_to.substr(0, sep) ) );
+    if ( 0 != stat(a_from.c_str(), &src_st) || 0 != stat(dir.c_str(), &dir_st) || src_st.st_dev != dir_st.st_dev
+        || ( false == a_overwrite && true == ::cc::fs::File::Exists(a_to) ) ) {
+        // ... different filesystems or not an overwrite, let the default implementation handle it ( and it's errors ) ...
+        ::cc::fs::File::Copy(a_from, a_to, a_overwrite);
+        return;
+    }
+    const int src_fd = open(a_from.c_str(), O_RDONLY);
+    if ( -1 == src_fd ) {
+        throw ::cc::Exception("Unable to open '%s': %s!", a_from.c_str(), strerror(errno));
+    }
+    const int dst_fd = open(a_to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, ( src_st.st_mode & 0777 ));
+    if ( -1 == dst_fd ) {
+        const int error = errno;
+        close(src_fd);
+        throw ::cc::Exception("Unable to open '%s': %s!", a_to.c_str(), strerror(error));
+    }
+    bool done = false;
+  #if defined(FICLONE)
+    // ... copy-on-write clone, metadata only ...
+    done = ( 0 == ioctl(dst_fd, FICLONE, src_fd) );
+  #endif
+  #if defined(__NR_copy_file_range)
+    // ... in-kernel copy, no user space buffers ...
+    if ( false == done ) {
+        int     error     = 0;
+        off_t   remaining = src_st.st_size;
+        ssize_t copied    = 0;
+        while ( remaining > 0 ) {
+            copied = syscall(__NR_copy_file_range, src_fd, nullptr, dst_fd, nullptr, static_cast<size_t>(remaining), 0);
+            if ( copied <= 0 ) {
+                error = ( copied < 0 ? errno : 0 );
+                break;
+            }
+            remaining -= copied;
+        }
+        done = ( 0 == remaining );
+        if ( false == done && remaining != src_st.st_size ) {
+            // ... partial copy, can't fallback safely ...
+            close(src_fd);
+            close(dst_fd);
+            throw ::cc::Exception("Unable to copy '%s' to '%s': %s!", a_from.c_str(), a_to.c_str(), 0 != error ? strerror(error) : "short copy");
+        }
+    }
+  #endif
+    close(src_fd);
+    close(dst_fd);
+    if ( false == done ) {
+        // ... not supported by this filesystem ...
+        ::cc::fs::File::Copy(a_from, a_to, /* a_overwrite */ true);
+    }
+#else
+    ::cc::fs::File::Copy(a_from, a_to, a_overwrite);
+#endif
+}
+
+/**
+ * @brief Write only the xattrs whose value differs from the expected ones, remove the unexpected ones and, if any was changed, seal them again.
+ *
+ * @param a_xattrs Destination file xattrs.
+ * @param a_attrs  Expected xattrs.
+ *
+ * @return True if xattrs were changed and sealed, false if they were already as expected.
+ */
+bool ngx::casper::broker::cdn::Archive::RestoreXAttrs (::cc::fs::file::XAttr& a_xattrs, const std::map<std::string, std::string>& a_attrs)
+{
+    static const std::string sk_seal_attr = XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.seal";
+
+    std::map<std::string, std::string> current;
+    a_xattrs.Iterate([&current](const char *const a_key, const char *const a_value) {
+        current[a_key] = a_value;
+    });
+
+    // ... write only what changed, seal is calculated below ...
+    bool changed = false;
+    for ( auto& it : a_attrs ) {
+        const auto c_it = current.find(it.first);
+        if ( current.end() != c_it && c_it->second == it.second ) {
+            continue;
+        }
+        changed = true;
+        if ( sk_seal_attr != it.first ) {
+            a_xattrs.Set(it.first, it.second);
+        }
+    }
+    
+    // ... stale xattrs ( e.g. carried by a renamed inode ) must not survive ...
+    for ( auto& it : current ) {
+        if ( a_attrs.end() == a_attrs.find(it.first) ) {
+            a_xattrs.Remove(it.first);
+            changed = true;
+        }
+    }
+    
+    // ... nothing changed, current seal still applies ...
+    if ( false == changed ) {
+        return false;
+    }
+
+    // ... seal xattrs ...
+    std::string archivist;
+    a_xattrs.Get(XATTR_ARCHIVE_PREFIX "com.cldware.archive.archivist", archivist);
+    a_xattrs.Seal(sk_seal_attr,
+                  reinterpret_cast<const unsigned char*>(archivist.c_str()), archivist.length(),
+                  &sk_validation_excluded_attrs_
+    );
+    
+    return true;
+}
+
+
+/**
+ * @brief Build a file content 'stamp': size, modification time, device, inode and inode generation ( when available ).
+ *
+ * @param a_uri Local file URI.
+ *
+ * @return Stamp string, it will differ if file content was ( or might have been ) changed.
+ */
+std::string ngx::casper::broker::cdn::Archive::Stamp (const std::string& a_uri)
+{
+    struct stat st;
+    if ( 0 != stat(a_uri.c_str(), &st) ) {
+        throw ::cc::Exception("Unable to stat '%s': %s!", a_uri.c_str(), strerror(errno));
+    }
+    int generation = 0;
+#if defined(__linux__)
+    const int fd = open(a_uri.c_str(), O_RDONLY);
+    if ( -1 != fd ) {
+        if ( 0 != ioctl(fd, FS_IOC_GETVERSION, &generation) ) {
+            generation = 0;
+        }
+        close(fd);
+    }
+#endif
+    char buffer[128];
+    const int w = snprintf(buffer, sizeof(buffer) / sizeof(buffer[0]), "%lld:%lld.%09ld:%llu:%llu:%u",
+                           static_cast<long long>(st.st_size),
+                           static_cast<long long>(NRS_ARCHIVE_MTIME(st).tv_sec), static_cast<long>(NRS_ARCHIVE_MTIME(st).tv_nsec),
+                           static_cast<unsigned long long>(st.st_dev), static_cast<unsigned long long>(st.st_ino),
+                           static_cast<unsigned>(generation)
+    );
+    return std::string(buffer, static_cast<size_t>(w));
+}
+
 /**
  * @brief Set modification xattrs for a specific archive.
  *
@@ -1585,13 +1909,10 @@ void ngx::casper::broker::cdn::Archive::SetLocalInfoFromURLPath (const std::stri
     o_local.path_ = a_archive.dir_prefix_;
 
     // ... search for x-header-variable name
-    std::string xhvn;
-    for ( auto it : a_archive.h2e_map_ ) {
-        if ( o_local.id_[0] == it.second.c_str()[0] ) {
-            o_local.xhvn_  = it.first;
-            o_local.path_ += it.second;
-            break;
-        }
+    const auto h2e = a_archive.h2e_map_.Prefix(o_local.id_[0]);
+    if ( nullptr != h2e ) {
+        o_local.xhvn_  = h2e->first;
+        o_local.path_ += h2e->second;
     }
     
     // ... ensure xhvn exist on map ...
@@ -1600,7 +1921,7 @@ void ngx::casper::broker::cdn::Archive::SetLocalInfoFromURLPath (const std::stri
     }
     
     // ... an X-CASPER-<> header must be present ...
-    const auto it = std::find_if(a_archive.headers_.begin(), a_archive.headers_.end(), ngx::casper::broker::cdn::Header<std::string>::KeyComparator(o_local.xhvn_));
+    const auto it = a_archive.headers_.find(o_local.xhvn_);
     if ( a_archive.headers_.end() == it ) {
         throw ngx::casper::broker::cdn::BadRequest("Missing or invalid h2e header value for prefix %s", o_local.xhvn_.c_str());
     }
@@ -1730,16 +2051,19 @@ void ngx::casper::broker::cdn::Archive::SetH2EMap (const std::function<bool(Json
         if ( true == value.isNull() || false == value.isString() || 0 == value.asString().length() ) {
             throw ::cc::Exception(( "Invalid JSON 'h2e' payload - expected '" +  member + "' value to be a valid string!"));
         }
-        o_map[member] = value.asString();
+        // ... also indexes value's first char, throws if it's not unique ...
+        o_map.Set(member, value.asString());
     }
     
-    std::set<char> tmp;
-    for ( auto it : o_map ) {
-        const char ch = it.second.c_str()[0];
-        if ( tmp.end() != tmp.find(ch) ) {
-            throw ::cc::Exception("Duplicated 'h2e' value's first char - first char of each value must be unique!");
+    // ... replicated xattrs arrive as 'x-user-com-cldware-*' headers, translate them now, not per request ...
+    for ( const auto& xattr : sk_replicated_attrs_ ) {
+        std::string header = "x-user-";
+        header.reserve(header.length() + xattr.length() - ( sizeof(XATTR_ARCHIVE_PREFIX) - sizeof(char) ));
+        for ( size_t idx = sizeof(XATTR_ARCHIVE_PREFIX) - sizeof(char) ; idx < xattr.length() ; ++idx ) {
+            const char ch = xattr[idx];
+            header += ( '.' == ch ? '-' : ( '-' == ch ? '_' : ch ) );
         }
-        tmp.insert(ch);
+        o_map.Index(header, xattr);
     }
 }
 
@@ -1852,4 +2176,7 @@ void ngx::casper::broker::cdn::Archive::SetACTConfig (const std::function<bool(J
     }
     
     o_config["variables"] = new_variables;
+    
+    // ... variables schema is immutable from now on, build it once ...
+    ngx::casper::broker::cdn::ACT::Load(o_config);
 }
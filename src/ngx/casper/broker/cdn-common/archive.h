@@ -28,6 +28,9 @@
 
 #include "ngx/casper/broker/cdn-common/types.h"
 #include "ngx/casper/broker/cdn-common/act.h"
+#include "ngx/casper/broker/cdn-common/xattrs_cache.h"
+#include "ngx/casper/broker/cdn-common/xattrs_batch.h"
+#include "ngx/casper/broker/cdn-common/digest.h"
 
 #include "cc/bitwise_enum.h"
 #include "cc/fs/file.h" // XAttr, Writer
@@ -99,6 +102,17 @@ namespace ngx
                         QuarantineSettings  quarantine_;
                     } Settings;
 
+                    typedef struct {
+                        const EVP_MD* md_;    //!< Algorithm, nullptr for MD5.
+                        std::string   value_; //!< Expected value.
+                    } DigestCheck;
+
+                    typedef struct {
+                        std::string   stamp_;  //!< Content stamp, taken before hashing.
+                        std::string   md5_;    //!< Content MD5.
+                        std::string   digest_; //!< Content digest, empty when no digest algorithm is set.
+                    } ContentHashes;
+
                 private: // Data Type(s)
                     
                     typedef struct {
@@ -119,7 +133,7 @@ namespace ngx
                 private: // Const Refs
                     
                     const Json::Value&                        act_config_;
-                    const std::map<std::string, std::string>& headers_;
+                    const ngx::casper::broker::InHeaders&     headers_;
                     const H2EMap&                             h2e_map_;
                     const std::string&                        dir_prefix_;
                     const std::string                         replicator_;
@@ -129,25 +143,28 @@ namespace ngx
                     Mode           mode_;
                     Local          local_;
                     uint64_t       bytes_written_;
-                    unsigned char* buffer_;
                     std::string    tmp_;
+                    const EVP_MD*  digest_md_;
 
                 private: // Helper(s)
                     
                     ACT                           act_;
                     ::cc::fs::file::XAttr*        xattr_;
+                    XAttrsCache::Snapshot         snapshot_;
                     ::cc::fs::file::Writer        fw_;
                     ::cc::hash::MD5               md5_;
+                    Digest                        digest_;
 
                 public: // Static Const Data
                     
                     static const std::set<std::string> sk_validation_excluded_attrs_;
+                    static const std::set<std::string> sk_replicated_attrs_;
                     static const bool                  sk_content_modification_history_enabled_;
 
                 public: // Constructor (s) / Destructor
                     
                     Archive (const std::string& a_archivist, const std::string& a_writer,
-                             const Json::Value& a_act_config, const std::map<std::string, std::string>& a_headers, const H2EMap& a_h2e_map,
+                             const Json::Value& a_act_config, const ngx::casper::broker::InHeaders& a_headers, const H2EMap& a_h2e_map,
                              const std::string& a_dir_prefix, const std::string a_replicator = "");
                     virtual ~Archive ();
                     
@@ -199,19 +216,21 @@ namespace ngx
                                      const std::map<std::string, std::string>& a_attrs,
                                      const std::set<std::string>& a_preserving,
                                      const bool a_backup,
-                                     RInfo& o_info);
+                                     RInfo& o_info, const ContentHashes* a_hashes = nullptr);
                     
                 public: // Rename Helper - Method(s) / Function(s)
                 
                     static void IDFromURLPath (const std::string& a_path,
                                                std::string& o_id, std::string* o_ext = nullptr);
                     static void Rename        (const std::string& a_from, const std::string& a_to);
+                    static std::string Stamp  (const std::string& a_uri);
                     
                 public: // Validation - Method(s) / Function(s)
                     
-                    void Validate   (const std::string& a_path,
+                    bool Validate   (const std::string& a_path,
                                      const std::string* a_md5 = nullptr, const std::string* a_id = nullptr,
-                                     const std::map<std::string,std::string>* a_attrs = nullptr);
+                                     const std::map<std::string,std::string>* a_attrs = nullptr,
+                                     const bool a_deep = true, DigestCheck* o_check = nullptr);
 
                 public: // XAttr Method(s) / Function(s)
                     
@@ -228,6 +247,12 @@ namespace ngx
                                         const std::set<std::string>& a_preserving,
                                         const std::set<std::string>& a_excluding,
                                         bool a_trusted, bool a_seal);
+                    void StageXAttrs   (XAttrsBatch& a_batch,
+                                        const std::map<std::string, std::string>& a_attrs,
+                                        const std::set<std::string>& a_preserving,
+                                        const std::set<std::string>& a_excluding,
+                                        bool a_trusted);
+                    void CloseXAttrs   (XAttrsBatch& a_batch);
                     
                     void Fill          (bool a_trusted, RInfo& o_info);
                     
@@ -239,6 +264,9 @@ namespace ngx
 
                     static void Copy    (const std::string& a_from, const std::string& a_to, const bool a_overwrite,
                                          std::vector<RAttr>* o_attrs);
+
+                    static void CopyData       (const std::string& a_from, const std::string& a_to, const bool a_overwrite);
+                    static bool RestoreXAttrs  (::cc::fs::file::XAttr& a_xattrs, const std::map<std::string, std::string>& a_attrs);
                     
                 private: // Static Method(s) / Function(s)
                     
@@ -266,6 +294,8 @@ namespace ngx
                     const uint64_t&    size  () const;
                     std::string        name  (const std::string& a_suggested) const;
                     const Local&       local () const;
+                    void               digest (const EVP_MD* a_md);
+                    const EVP_MD*      digest () const;
                     
                 private: // Inline Method(s) / Function(s)
                     
@@ -327,6 +357,24 @@ namespace ngx
                     return local_;
                 }
 
+                /**
+                 * @brief Set content digest algorithm, written next to MD5.
+                 *
+                 * @param a_md Algorithm, nullptr to write MD5 only.
+                 */
+                inline void Archive::digest (const EVP_MD* a_md)
+                {
+                    digest_md_ = a_md;
+                }
+
+                /**
+                 * @return Content digest algorithm, nullptr when only MD5 is written.
+                 */
+                inline const EVP_MD* Archive::digest () const
+                {
+                    return digest_md_;
+                }
+
                 /**
                  * @brief Reset current context.
                  */
@@ -343,6 +391,7 @@ namespace ngx
                         delete xattr_;
                         xattr_ = nullptr;
                     }
+                    snapshot_.reset();
                 }
 
                 DEFINE_ENUM_WITH_BITWISE_OPERATORS(Archive::Mode)
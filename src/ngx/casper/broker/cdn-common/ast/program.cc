@@ -0,0 +1,227 @@
+/**
+ * @file program.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ngx/casper/broker/cdn-common/ast/program.h"
+
+#include "cc/exception.h"
+
+#define NRS_AST_PROGRAM_IS_DIGIT(a_c)     ( (a_c) >= '0' && (a_c) <= '9' )
+#define NRS_AST_PROGRAM_IS_HEX_DIGIT(a_c) ( NRS_AST_PROGRAM_IS_DIGIT(a_c) || ( (a_c) >= 'A' && (a_c) <= 'F' ) || ( (a_c) >= 'a' && (a_c) <= 'f' ) )
+#define NRS_AST_PROGRAM_IS_ALPHA(a_c)     ( ( (a_c) >= 'A' && (a_c) <= 'Z' ) || ( (a_c) >= 'a' && (a_c) <= 'z' ) || '_' == (a_c) )
+
+/**
+ * @brief Default constructor.
+ *
+ * @param a_expression 'AST' expression to compile, same grammar as \link Evaluator \link.
+ * @param a_resolver   Function to call to translate a variable name to a slot index.
+ */
+ngx::casper::broker::cdn::common::ast::Program::Program (const std::string& a_expression, const ngx::casper::broker::cdn::common::ast::Program::Resolver& a_resolver)
+    : expression_(a_expression), depth_(0), p_(nullptr), pe_(nullptr)
+{
+    p_  = expression_.c_str();
+    pe_ = expression_.c_str() + expression_.length();
+
+    // ... main := item ';' ...
+    Item(a_resolver, 1);
+    Expect(';');
+    if ( p_ != pe_ ) {
+        Error();
+    }
+
+    // ... compiler state is no longer needed ...
+    p_  = nullptr;
+    pe_ = nullptr;
+
+    instructions_.shrink_to_fit();
+}
+
+/**
+ * @brief Destructor.
+ */
+ngx::casper::broker::cdn::common::ast::Program::~Program ()
+{
+    /* empty */
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Run this program.
+ *
+ * @param a_slots Variables values, indexed by the slots returned by the resolver at compile time.
+ *
+ * @return The expression result.
+ */
+uint64_t ngx::casper::broker::cdn::common::ast::Program::Run (const uint64_t* a_slots) const
+{
+    uint64_t              inline_stack[k_inline_stack_size_];
+    std::vector<uint64_t> heap_stack;
+
+    uint64_t* stack = inline_stack;
+    if ( depth_ > k_inline_stack_size_ ) {
+        heap_stack.resize(depth_);
+        stack = heap_stack.data();
+    }
+
+    size_t top = 0;
+    for ( const auto& instruction : instructions_ ) {
+        switch (instruction.code_) {
+            case OpCode::Constant:
+                stack[top++] = instruction.operand_;
+                break;
+            case OpCode::Variable:
+                stack[top++] = a_slots[instruction.operand_];
+                break;
+            case OpCode::LogicalOr:
+                top--;
+                stack[top - 1] = ( stack[top - 1] || stack[top] ) ? 1 : 0;
+                break;
+            case OpCode::LogicalAnd:
+                top--;
+                stack[top - 1] = ( stack[top - 1] && stack[top] ) ? 1 : 0;
+                break;
+            case OpCode::BitwiseOr:
+                top--;
+                stack[top - 1] = ( 0 != ( stack[top - 1] | stack[top] ) ) ? 1 : 0;
+                break;
+            case OpCode::BitwiseAnd:
+                top--;
+                stack[top - 1] = ( 0 != ( stack[top - 1] & stack[top] ) ) ? 1 : 0;
+                break;
+            case OpCode::RelationalEqual:
+                top--;
+                stack[top - 1] = ( stack[top - 1] == stack[top] ) ? 1 : 0;
+                break;
+            case OpCode::RelationalNotEqual:
+                top--;
+                stack[top - 1] = ( stack[top - 1] != stack[top] ) ? 1 : 0;
+                break;
+        }
+    }
+
+    return ( top > 0 ? stack[0] : 0 );
+}
+
+#ifdef __APPLE__
+#pragma mark - COMPILER
+#endif
+
+/**
+ * @brief Compile an item: variable, decimal or hex number or a nested expression.
+ *
+ * @param a_resolver Function to call to translate a variable name to a slot index.
+ * @param a_depth    Evaluation stack depth required after this item is pushed.
+ */
+void ngx::casper::broker::cdn::common::ast::Program::Item (const ngx::casper::broker::cdn::common::ast::Program::Resolver& a_resolver, size_t a_depth)
+{
+    if ( a_depth > depth_ ) {
+        depth_ = a_depth;
+    }
+
+    // ... operator?
+    OpCode      code   = OpCode::Constant;
+    const char* op_end = p_;
+    if ( pe_ - p_ >= 2 && '|' == p_[0] && '|' == p_[1] ) {
+        code = OpCode::LogicalOr; op_end = p_ + 2;
+    } else if ( pe_ - p_ >= 2 && '&' == p_[0] && '&' == p_[1] ) {
+        code = OpCode::LogicalAnd; op_end = p_ + 2;
+    } else if ( pe_ - p_ >= 2 && '=' == p_[0] && '=' == p_[1] ) {
+        code = OpCode::RelationalEqual; op_end = p_ + 2;
+    } else if ( pe_ - p_ >= 2 && '!' == p_[0] && '=' == p_[1] ) {
+        code = OpCode::RelationalNotEqual; op_end = p_ + 2;
+    } else if ( pe_ - p_ >= 1 && '|' == p_[0] ) {
+        code = OpCode::BitwiseOr; op_end = p_ + 1;
+    } else if ( pe_ - p_ >= 1 && '&' == p_[0] ) {
+        code = OpCode::BitwiseAnd; op_end = p_ + 1;
+    }
+
+    if ( OpCode::Constant != code ) {
+        // ... expression := operator '(' item ',' item ')' ...
+        p_ = op_end;
+        Expect('(');
+        Item(a_resolver, a_depth);
+        Expect(',');
+        Item(a_resolver, a_depth + 1);
+        Expect(')');
+        Emit(code);
+    } else if ( pe_ - p_ >= 3 && '0' == p_[0] && 'x' == p_[1] && NRS_AST_PROGRAM_IS_HEX_DIGIT(p_[2]) ) {
+        // ... hex number ...
+        uint64_t value = 0;
+        for ( p_ += 2 ; p_ < pe_ && NRS_AST_PROGRAM_IS_HEX_DIGIT(*p_) ; ++p_ ) {
+            if ( NRS_AST_PROGRAM_IS_DIGIT(*p_) ) {
+                value = ( value * 16 ) + static_cast<uint64_t>( (*p_) - '0' );
+            } else if ( (*p_) >= 'A' && (*p_) <= 'F' ) {
+                value = ( value * 16 ) + static_cast<uint64_t>( (*p_) - 'A' + 10 );
+            } else {
+                value = ( value * 16 ) + static_cast<uint64_t>( (*p_) - 'a' + 10 );
+            }
+        }
+        Emit(OpCode::Constant, value);
+    } else if ( p_ < pe_ && NRS_AST_PROGRAM_IS_DIGIT(*p_) ) {
+        // ... decimal number ...
+        uint64_t value = 0;
+        for ( ; p_ < pe_ && NRS_AST_PROGRAM_IS_DIGIT(*p_) ; ++p_ ) {
+            value = ( value * 10 ) + static_cast<uint64_t>( (*p_) - '0' );
+        }
+        Emit(OpCode::Constant, value);
+    } else {
+        // ... variable ...
+        const char* start = p_;
+        while ( p_ < pe_ && NRS_AST_PROGRAM_IS_ALPHA(*p_) ) {
+            ++p_;
+        }
+        Emit(OpCode::Variable, static_cast<uint64_t>(a_resolver(std::string(start, static_cast<size_t>(p_ - start)))));
+    }
+}
+
+/**
+ * @brief Consume an expected character.
+ *
+ * @param a_char Expected character.
+ */
+void ngx::casper::broker::cdn::common::ast::Program::Expect (const char a_char)
+{
+    if ( p_ >= pe_ || a_char != (*p_) ) {
+        Error();
+    }
+    ++p_;
+}
+
+/**
+ * @brief Append an instruction.
+ *
+ * @param a_code    Instruction op code.
+ * @param a_operand Instruction operand ( constant value or slot index ), if applicable.
+ */
+void ngx::casper::broker::cdn::common::ast::Program::Emit (const ngx::casper::broker::cdn::common::ast::Program::OpCode a_code, const uint64_t a_operand)
+{
+    instructions_.push_back({ a_code, a_operand });
+}
+
+/**
+ * @brief Report a parse error at the current position.
+ */
+void ngx::casper::broker::cdn::common::ast::Program::Error () const
+{
+    throw ::cc::Exception("Parse error near column %3d: %s", static_cast<int>(p_ - expression_.c_str()), expression_.c_str());
+}
@@ -0,0 +1,144 @@
+/**
+ * @file program.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_NGX_CASPER_BROKER_CDN_COMMON_AST_PROGRAM_H_
+#define NRS_NGX_CASPER_BROKER_CDN_COMMON_AST_PROGRAM_H_
+
+#include "cc/non-copyable.h"
+#include "cc/non-movable.h"
+
+#include <stdint.h> // uint8_t, uint64_t
+#include <string>
+#include <vector>
+#include <functional>
+
+namespace ngx
+{
+
+    namespace casper
+    {
+
+        namespace broker
+        {
+
+            namespace cdn
+            {
+
+                namespace common
+                {
+
+                    namespace ast
+                    {
+
+                        /**
+                         * @brief A pre-compiled 'AST' expression ( as written by \link Tree \link ), ready to be run
+                         *        against a set of variable values addressed by slot index.
+                         */
+                        class Program final : public ::cc::NonCopyable, public ::cc::NonMovable
+                        {
+
+                        public: // Data Type(s)
+
+                            typedef std::function<size_t(const std::string& a_name)> Resolver;
+
+                        private: // Enum(s)
+
+                            enum class OpCode : uint8_t {
+                                Constant,
+                                Variable,
+                                LogicalOr,
+                                LogicalAnd,
+                                BitwiseOr,
+                                BitwiseAnd,
+                                RelationalEqual,
+                                RelationalNotEqual
+                            };
+
+                        private: // Data Type(s)
+
+                            typedef struct {
+                                OpCode   code_;
+                                uint64_t operand_;
+                            } Instruction;
+
+                        private: // Static Const Data
+
+                            static constexpr size_t k_inline_stack_size_ = 32;
+
+                        private: // Const Data
+
+                            const std::string        expression_;
+
+                        private: // Data
+
+                            std::vector<Instruction> instructions_;
+                            size_t                   depth_;
+
+                        private: // Data - compiler only
+
+                            const char*              p_;
+                            const char*              pe_;
+
+                        public: // Constructor(s) / Destructor
+
+                            Program () = delete;
+                            Program (const std::string& a_expression, const Resolver& a_resolver);
+                            virtual ~Program ();
+
+                        public: // Method(s) / Function(s)
+
+                            uint64_t Run (const uint64_t* a_slots) const;
+
+                        public: // Inline Method(s) / Function(s)
+
+                            const std::string& expression () const;
+
+                        private: // Method(s) / Function(s)
+
+                            void   Item      (const Resolver& a_resolver, size_t a_depth);
+                            void   Expect    (const char a_char);
+                            void   Emit      (const OpCode a_code, const uint64_t a_operand = 0);
+                            void   Error     () const;
+
+                        }; // end of class 'Program'
+
+                        /**
+                         * @return The expression this program was compiled from.
+                         */
+                        inline const std::string& Program::expression () const
+                        {
+                            return expression_;
+                        }
+
+                    } // end of namespace 'ast'
+
+                } // end of namespace 'common'
+
+            } // end of namespace 'cdn'
+
+        } // end of namespace 'broker'
+
+    } // end of namespace 'casper'
+
+} // end of namespace 'ngx'
+
+#endif // NRS_NGX_CASPER_BROKER_CDN_COMMON_AST_PROGRAM_H_
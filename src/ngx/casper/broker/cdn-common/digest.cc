@@ -0,0 +1,170 @@
+/**
+ * @file digest.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ngx/casper/broker/cdn-common/digest.h"
+
+#include "cc/exception.h"
+
+#include <algorithm> // std::min
+
+#include <openssl/evp.h>
+#include <openssl/objects.h> // OBJ_nid2sn
+
+/**
+ * @brief Default constructor.
+ */
+ngx::casper::broker::cdn::Digest::Digest ()
+    : ctx_(EVP_MD_CTX_new()), md_(nullptr)
+{
+    if ( nullptr == ctx_ ) {
+        throw ::cc::Exception("Unable to allocate digest context!");
+    }
+}
+
+/**
+ * @brief Destructor.
+ */
+ngx::casper::broker::cdn::Digest::~Digest ()
+{
+    EVP_MD_CTX_free(ctx_);
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Start a new calculation.
+ *
+ * @param a_md Algorithm to use.
+ */
+void ngx::casper::broker::cdn::Digest::Initialize (const EVP_MD* a_md)
+{
+    if ( 1 != EVP_DigestInit_ex(ctx_, a_md, nullptr) ) {
+        throw ::cc::Exception("Unable to initialize %s digest!", Name(a_md).c_str());
+    }
+    md_ = a_md;
+}
+
+/**
+ * @brief Feed data to current calculation.
+ *
+ * @param a_data   Data to hash.
+ * @param a_length Number of bytes to hash.
+ */
+void ngx::casper::broker::cdn::Digest::Update (const unsigned char* a_data, const size_t a_length)
+{
+    if ( 1 != EVP_DigestUpdate(ctx_, a_data, a_length) ) {
+        throw ::cc::Exception("Unable to update %s digest!", Name(md_).c_str());
+    }
+}
+
+/**
+ * @brief Feed the same data to current calculation and to an MD5 one, in a single pass.
+ *
+ * @remarks Data is hashed in small blocks, each one by both algorithms while it's still cached.
+ *
+ * @param a_data   Data to hash.
+ * @param a_length Number of bytes to hash.
+ * @param a_md5    MD5 calculation to update.
+ */
+void ngx::casper::broker::cdn::Digest::Update (const unsigned char* a_data, const size_t a_length, ::cc::hash::MD5& a_md5)
+{
+    for ( size_t offset = 0 ; offset < a_length ; offset += k_block_size_ ) {
+        const size_t length = std::min(k_block_size_, a_length - offset);
+        a_md5.Update(a_data + offset, length);
+        Update(a_data + offset, length);
+    }
+}
+
+/**
+ * @brief Finish current calculation.
+ *
+ * @return Stored representation: '<algorithm>:<lowercase hex digest>'.
+ */
+std::string ngx::casper::broker::cdn::Digest::Finalize ()
+{
+    static const char k_hex [] = "0123456789abcdef";
+
+    unsigned char value[EVP_MAX_MD_SIZE];
+    unsigned int  length = 0;
+    if ( 1 != EVP_DigestFinal_ex(ctx_, value, &length) ) {
+        throw ::cc::Exception("Unable to finalize %s digest!", Name(md_).c_str());
+    }
+
+    std::string rv = Name(md_);
+    rv.reserve(rv.length() + 1 + ( 2 * length ));
+    rv += ':';
+    for ( unsigned int idx = 0 ; idx < length ; ++idx ) {
+        rv += k_hex[( value[idx] >> 4 ) & 0x0F];
+        rv += k_hex[value[idx] & 0x0F];
+    }
+    return rv;
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Translate an algorithm name ( e.g. 'BLAKE2b512', 'SHA512-256' ) to an OpenSSL digest.
+ *
+ * @param a_name Algorithm name.
+ *
+ * @return OpenSSL digest.
+ */
+const EVP_MD* ngx::casper::broker::cdn::Digest::Lookup (const std::string& a_name)
+{
+    const EVP_MD* md = EVP_get_digestbyname(a_name.c_str());
+    if ( nullptr == md ) {
+        throw ::cc::Exception("Unknown or unsupported digest algorithm '%s'!", a_name.c_str());
+    }
+    return md;
+}
+
+/**
+ * @param a_md OpenSSL digest.
+ *
+ * @return Algorithm short name.
+ */
+std::string ngx::casper::broker::cdn::Digest::Name (const EVP_MD* a_md)
+{
+    const char* const sn = ( nullptr != a_md ? OBJ_nid2sn(EVP_MD_type(a_md)) : nullptr );
+    return ( nullptr != sn ? sn : "<unknown>" );
+}
+
+/**
+ * @brief Split a stored digest value.
+ *
+ * @param a_value Value, as written by \link Finalize \link.
+ * @param o_hex   Hex digest.
+ *
+ * @return OpenSSL digest.
+ */
+const EVP_MD* ngx::casper::broker::cdn::Digest::Parse (const std::string& a_value, std::string& o_hex)
+{
+    const size_t separator = a_value.find(':');
+    if ( std::string::npos == separator || 0 == separator ) {
+        throw ::cc::Exception("Invalid digest value '%s'!", a_value.c_str());
+    }
+    o_hex = a_value.substr(separator + 1);
+    return Lookup(a_value.substr(0, separator));
+}
@@ -0,0 +1,103 @@
+/**
+ * @file digest.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_NGX_CASPER_BROKER_CDN_COMMON_DIGEST_H_
+#define NRS_NGX_CASPER_BROKER_CDN_COMMON_DIGEST_H_
+
+#include "cc/non-copyable.h"
+#include "cc/non-movable.h"
+
+#include "cc/hash/md5.h"
+
+#include <openssl/ossl_typ.h> // EVP_MD, EVP_MD_CTX
+
+#include <stddef.h> // size_t
+#include <string>   // std::string
+
+namespace ngx
+{
+
+    namespace casper
+    {
+
+        namespace broker
+        {
+
+            namespace cdn
+            {
+
+                /**
+                 * @brief Content digest calculated with a configurable OpenSSL algorithm, stored next to the legacy MD5.
+                 */
+                class Digest final : public ::cc::NonCopyable, public ::cc::NonMovable
+                {
+
+                private: // Static Const Data
+
+                    static constexpr size_t k_block_size_ = 32 * 1024;
+
+                private: // Data
+
+                    EVP_MD_CTX*   ctx_;
+                    const EVP_MD* md_;
+
+                public: // Constructor(s) / Destructor
+
+                    Digest ();
+                    virtual ~Digest ();
+
+                public: // Method(s) / Function(s)
+
+                    void        Initialize (const EVP_MD* a_md);
+                    void        Update     (const unsigned char* a_data, const size_t a_length);
+                    void        Update     (const unsigned char* a_data, const size_t a_length, ::cc::hash::MD5& a_md5);
+                    std::string Finalize   ();
+
+                public: // Inline Method(s) / Function(s)
+
+                    const EVP_MD* md () const;
+
+                public: // Static Method(s) / Function(s)
+
+                    static const EVP_MD* Lookup (const std::string& a_name);
+                    static std::string   Name   (const EVP_MD* a_md);
+                    static const EVP_MD* Parse  (const std::string& a_value, std::string& o_hex);
+
+                }; // end of class 'Digest'
+
+                /**
+                 * @return Algorithm currently in use, nullptr if not initialized.
+                 */
+                inline const EVP_MD* Digest::md () const
+                {
+                    return md_;
+                }
+
+            } // end of namespace 'cdn'
+
+        } // end of namespace 'broker'
+
+    } // end of namespace 'casper'
+
+} // end of namespace 'ngx'
+
+#endif // NRS_NGX_CASPER_BROKER_CDN_COMMON_DIGEST_H_
@@ -0,0 +1,188 @@
+/**
+ * @file hasher.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ngx/casper/broker/cdn-common/hasher.h"
+
+#include "ngx/casper/broker/cdn-common/digest.h"
+
+#include "cc/fs/file.h"
+#include "cc/hash/md5.h"
+
+#include <memory> // std::shared_ptr
+
+/**
+ * @brief One-shot setup.
+ *
+ * @param a_threads     Number of worker threads to start, 0 disables asynchronous digests.
+ * @param a_buffer_size Size ( in bytes ) of each read buffer, 0 to keep default.
+ */
+void ngx::casper::broker::cdn::Hasher::Startup (const size_t a_threads, const size_t a_buffer_size)
+{
+    if ( a_buffer_size > 0 ) {
+        buffer_size_ = a_buffer_size;
+    }
+    pool_.Startup(a_threads);
+}
+
+/**
+ * @brief Stop all worker threads and forget pending jobs.
+ *
+ * @remarks Running calculations are interrupted at their next read, there's no need to wait for large files to be fully hashed.
+ * @remarks Must be called before \link ::ev::ngx::Bridge \link shutdown.
+ */
+void ngx::casper::broker::cdn::Hasher::Shutdown ()
+{
+    pool_.Shutdown();
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Calculate a file digest in the calling thread.
+ *
+ * @param a_uri Local file URI.
+ * @param a_md  Digest algorithm, nullptr for MD5.
+ * @param o_md5 When set ( and \p a_md is set ), MD5 is also calculated, in the same pass.
+ *
+ * @return MD5 hex string or \link Digest \link value.
+ */
+std::string ngx::casper::broker::cdn::Hasher::Compute (const std::string& a_uri, const EVP_MD* a_md, std::string* o_md5)
+{
+    // ... read buffer is allocated once and reused ...
+    if ( buffer_.size() != buffer_size_ ) {
+        buffer_.resize(buffer_size_);
+    }
+    return Calculate(a_uri, a_md, o_md5, buffer_.data(), buffer_.size());
+}
+
+/**
+ * @brief Schedule a file digest calculation in a worker thread.
+ *
+ * @param a_uri       Local file URI.
+ * @param a_md        Digest algorithm, nullptr for MD5.
+ * @param a_callbacks Functions to call, on main thread, when calculation is done.
+ * @param a_md5       When true ( and \p a_md is set ), MD5 is also calculated, in the same pass, and delivered as success second argument.
+ *
+ * @return Ticket to be used to cancel this job.
+ */
+uint64_t ngx::casper::broker::cdn::Hasher::Submit (const std::string& a_uri, const EVP_MD* a_md, const ngx::casper::broker::cdn::Hasher::Callbacks& a_callbacks,
+                                                   const bool a_md5)
+{
+    const std::shared_ptr<Result> result      = std::make_shared<Result>();
+    const size_t                  buffer_size = buffer_size_;
+    return pool_.Submit([a_uri, a_md, a_md5, buffer_size, result] (const std::atomic<bool>& a_abort) {
+        // ... one read buffer per worker, allocated once ...
+        thread_local std::vector<unsigned char> buffer;
+        if ( buffer.size() != buffer_size ) {
+            buffer.resize(buffer_size);
+        }
+        try {
+            result->value_ = Calculate(a_uri, a_md, ( true == a_md5 ? &result->md5_ : nullptr ), buffer.data(), buffer.size(), &a_abort);
+        } catch (const ::cc::Exception& a_cc_exception) {
+            result->error_ = a_cc_exception.what();
+        } catch (const std::exception& a_std_exception) {
+            result->error_ = a_std_exception.what();
+        } catch (...) {
+            result->error_ = "Unable to calculate digest of '" + a_uri + "'!";
+        }
+    }, [a_callbacks, result] () {
+        if ( 0 == result->error_.length() ) {
+            a_callbacks.success_(result->value_, result->md5_);
+        } else {
+            a_callbacks.failure_(::cc::Exception("%s", result->error_.c_str()));
+        }
+    });
+}
+
+/**
+ * @brief Cancel a previously submitted job, it's callbacks won't be called.
+ *
+ * @param a_ticket Ticket returned by \link Submit \link.
+ */
+void ngx::casper::broker::cdn::Hasher::Cancel (const uint64_t a_ticket)
+{
+    pool_.Cancel(a_ticket);
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Calculate a file digest.
+ *
+ * @param a_uri    Local file URI.
+ * @param a_md     Digest algorithm, nullptr for MD5.
+ * @param o_md5    When set ( and \p a_md is set ), MD5 is also calculated.
+ * @param a_buffer Read buffer.
+ * @param a_size   Read buffer size.
+ * @param a_abort  When set, calculation is interrupted as soon as it's true.
+ *
+ * @return MD5 hex string or \link Digest \link value.
+ */
+std::string ngx::casper::broker::cdn::Hasher::Calculate (const std::string& a_uri, const EVP_MD* a_md, std::string* o_md5,
+                                                         unsigned char* a_buffer, const size_t a_size, const std::atomic<bool>* a_abort)
+{
+    ::cc::hash::MD5                  md5;
+    ngx::casper::broker::cdn::Digest digest;
+
+    const bool with_md5    = ( nullptr == a_md || nullptr != o_md5 );
+    const bool with_digest = ( nullptr != a_md );
+
+    if ( true == with_md5 ) {
+        md5.Initialize();
+    }
+    if ( true == with_digest ) {
+        digest.Initialize(a_md);
+    }
+
+    bool eof = false; size_t len = 0;
+    ::cc::fs::File fr; fr.Open(a_uri, ::cc::fs::File::Mode::Read);
+    while ( 0 != ( len = fr.Read(a_buffer, a_size, eof) ) ) {
+        if ( nullptr != a_abort && true == a_abort->load() ) {
+            fr.Close();
+            throw ::cc::Exception("Calculation of '%s' digest interrupted!", a_uri.c_str());
+        }
+        if ( true == with_md5 && true == with_digest ) {
+            digest.Update(a_buffer, len, md5);
+        } else if ( true == with_digest ) {
+            digest.Update(a_buffer, len);
+        } else {
+            md5.Update(a_buffer, len);
+        }
+        if ( true == eof ) {
+            break;
+        }
+    }
+    fr.Close();
+
+    if ( false == with_digest ) {
+        return md5.Finalize();
+    }
+    if ( nullptr != o_md5 ) {
+        (*o_md5) = md5.Finalize();
+    }
+    return digest.Finalize();
+}
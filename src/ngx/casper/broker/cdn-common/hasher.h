@@ -0,0 +1,142 @@
+/**
+ * @file hasher.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_NGX_CASPER_BROKER_CDN_COMMON_HASHER_H_
+#define NRS_NGX_CASPER_BROKER_CDN_COMMON_HASHER_H_
+
+#include "osal/osal_singleton.h"
+
+#include "ngx/casper/broker/worker_pool.h"
+
+#include "cc/exception.h"
+
+#include <openssl/ossl_typ.h> // EVP_MD
+
+#include <stdint.h> // uint64_t
+
+#include <atomic>     // std::atomic
+#include <functional> // std::function
+#include <string>     // std::string
+#include <vector>     // std::vector
+
+namespace ngx
+{
+
+    namespace casper
+    {
+
+        namespace broker
+        {
+
+            namespace cdn
+            {
+
+                // ---- //
+                class Hasher;
+                class HasherInitializer final : public ::osal::Initializer<Hasher>
+                {
+
+                public: // Constructor(s) / Destructor
+
+                    HasherInitializer (Hasher& a_instance)
+                        : ::osal::Initializer<Hasher>(a_instance)
+                    {
+                        /* empty */
+                    }
+                    virtual ~HasherInitializer ()
+                    {
+                        /* empty */
+                    }
+
+                }; // end of class 'HasherInitializer'
+
+                /**
+                 * @brief Computes archives content digests ( MD5 and / or a \link Digest \link ), either synchronously or in a \link WorkerPool \link,
+                 *        with results delivered back to the main thread.
+                 */
+                class Hasher final : public osal::Singleton<Hasher, HasherInitializer>
+                {
+
+                public: // Data Type(s)
+
+                    typedef struct {
+                        std::function<void(const std::string& a_value, const std::string& a_md5)> success_;
+                        std::function<void(const ::cc::Exception& a_exception)>                   failure_;
+                    } Callbacks;
+
+                private: // Data Type(s)
+
+                    typedef struct {
+                        std::string value_;
+                        std::string md5_;
+                        std::string error_;
+                    } Result;
+
+                private: // Static Const Data
+
+                    static constexpr size_t k_default_buffer_size_ = 4 * 1024 * 1024;
+
+                private: // Data
+
+                    ::ngx::casper::broker::WorkerPool pool_;
+                    size_t                            buffer_size_ = k_default_buffer_size_;
+                    std::vector<unsigned char>        buffer_;
+
+                public: // One-shot Call Method(s) / Function(s)
+
+                    void Startup  (const size_t a_threads, const size_t a_buffer_size);
+                    void Shutdown ();
+
+                public: // Method(s) / Function(s)
+
+                    std::string Compute (const std::string& a_uri, const EVP_MD* a_md = nullptr, std::string* o_md5 = nullptr);
+                    uint64_t    Submit  (const std::string& a_uri, const EVP_MD* a_md, const Callbacks& a_callbacks, const bool a_md5 = false);
+                    void        Cancel  (const uint64_t a_ticket);
+
+                public: // Inline Method(s) / Function(s)
+
+                    bool enabled () const;
+
+                private: // Static Method(s) / Function(s)
+
+                    static std::string Calculate (const std::string& a_uri, const EVP_MD* a_md, std::string* o_md5,
+                                                  unsigned char* a_buffer, const size_t a_size, const std::atomic<bool>* a_abort = nullptr);
+
+                }; // end of class 'Hasher'
+
+                /**
+                 * @return True when worker threads are running, false otherwise.
+                 */
+                inline bool Hasher::enabled () const
+                {
+                    return pool_.enabled();
+                }
+
+            } // end of namespace 'cdn'
+
+        } // end of namespace 'broker'
+
+    } // end of namespace 'casper'
+
+} // end of namespace 'ngx'
+
+#endif // NRS_NGX_CASPER_BROKER_CDN_COMMON_HASHER_H_
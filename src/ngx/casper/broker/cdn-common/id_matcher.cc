@@ -0,0 +1,93 @@
+/**
+ * @file id_matcher.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ngx/casper/broker/cdn-common/id_matcher.h"
+
+#define NRS_ID_MATCHER_IS_LOWER(a_c) ( (a_c) >= 'a' && (a_c) <= 'z' )
+#define NRS_ID_MATCHER_IS_ALPHA(a_c) ( NRS_ID_MATCHER_IS_LOWER(a_c) || ( (a_c) >= 'A' && (a_c) <= 'Z' ) )
+#define NRS_ID_MATCHER_IS_ALNUM(a_c) ( NRS_ID_MATCHER_IS_ALPHA(a_c) || ( (a_c) >= '0' && (a_c) <= '9' ) )
+
+/**
+ * @brief Search for the leftmost archive ID in a string.
+ *
+ * @param a_value   String to search.
+ * @param a_dialect One of \link IDMatcher::Dialect \link.
+ * @param o_match   When not null, ID position and extension length.
+ *
+ * @return True if an ID was found, false otherwise.
+ */
+bool ngx::casper::broker::cdn::IDMatcher::Search (const std::string& a_value, const ngx::casper::broker::cdn::IDMatcher::Dialect a_dialect,
+                                                  ngx::casper::broker::cdn::IDMatcher::Match* o_match)
+{
+    const char* const s      = a_value.c_str();
+    const size_t      length = a_value.length();
+    
+    for ( size_t idx = 0 ; idx + k_id_length_ <= length ; ++idx ) {
+        // ... ([a-z]{1}) ...
+        if ( false == NRS_ID_MATCHER_IS_LOWER(s[idx]) ) {
+            continue;
+        }
+        // ... ([a-zA-Z]{2}) or ([a-zA-Z0-9]{2}) ...
+        bool matched = true;
+        for ( size_t pos = idx + k_prefix_length_ ; pos < idx + k_prefix_length_ + k_path_length_ ; ++pos ) {
+            if ( Dialect::Archive == a_dialect ? false == NRS_ID_MATCHER_IS_ALPHA(s[pos]) : false == NRS_ID_MATCHER_IS_ALNUM(s[pos]) ) {
+                matched = false;
+                break;
+            }
+        }
+        // ... ([a-zA-Z0-9]{6}) ...
+        for ( size_t pos = idx + k_prefix_length_ + k_path_length_ ; true == matched && pos < idx + k_id_length_ ; ++pos ) {
+            if ( false == NRS_ID_MATCHER_IS_ALNUM(s[pos]) ) {
+                matched = false;
+            }
+        }
+        if ( false == matched ) {
+            continue;
+        }
+        // ... found, optional extension is greedy ...
+        if ( nullptr != o_match ) {
+            o_match->offset_     = idx;
+            o_match->ext_length_ = 0;
+            size_t end = idx + k_id_length_;
+            if ( end < length && '.' == s[end] ) {
+                ++end;
+                if ( Dialect::Archive == a_dialect ) {
+                    // ... (\..+)? - ECMAScript '.' does not match line terminators ...
+                    while ( end < length && '\n' != s[end] && '\r' != s[end] ) {
+                        ++end;
+                    }
+                    if ( end > idx + k_id_length_ + 1 ) {
+                        o_match->ext_length_ = end - idx - k_id_length_;
+                    }
+                } else {
+                    // ... (\.[a-z]*)? ...
+                    while ( end < length && NRS_ID_MATCHER_IS_LOWER(s[end]) ) {
+                        ++end;
+                    }
+                    o_match->ext_length_ = end - idx - k_id_length_;
+                }
+            }
+        }
+        return true;
+    }
+    
+    return false;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file id_matcher.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_NGX_CASPER_BROKER_CDN_COMMON_ID_MATCHER_H_
+#define NRS_NGX_CASPER_BROKER_CDN_COMMON_ID_MATCHER_H_
+
+#include <stddef.h> // size_t
+#include <stdint.h> // uint8_t
+
+#include <string> // std::string
+
+namespace ngx
+{
+
+    namespace casper
+    {
+
+        namespace broker
+        {
+
+            namespace cdn
+            {
+
+                /**
+                 * @brief Archive ID matcher, a hand-written replacement for per-call \link std::regex_search \link with:
+                 *
+                 *        - Archive  : ([a-z]{1})([a-zA-Z]{2})([a-zA-Z0-9]{6})(\..+)?
+                 *        - Redirect : ([a-z]{1})([a-zA-Z0-9]{2})([a-zA-Z0-9]{6})(\.[a-z]*)?
+                 *
+                 *        Same ( leftmost, unanchored ) search semantics.
+                 */
+                class IDMatcher final
+                {
+
+                public: // Enum(s)
+
+                    enum class Dialect : uint8_t {
+                        Archive,
+                        Redirect
+                    };
+
+                public: // Data Type(s)
+
+                    typedef struct {
+                        size_t offset_;     //!< ID first character position.
+                        size_t ext_length_; //!< Extension length, including the dot, 0 if none.
+                    } Match;
+
+                public: // Static Const Data
+
+                    static constexpr size_t k_prefix_length_ = 1;
+                    static constexpr size_t k_path_length_   = 2;
+                    static constexpr size_t k_name_length_   = 6;
+                    static constexpr size_t k_id_length_     = k_prefix_length_ + k_path_length_ + k_name_length_;
+
+                public: // Constructor(s) / Destructor
+
+                    IDMatcher () = delete;
+
+                public: // Static Method(s) / Function(s)
+
+                    static bool Search (const std::string& a_value, const Dialect a_dialect, Match* o_match = nullptr);
+
+                }; // end of class 'IDMatcher'
+
+            } // end of namespace 'cdn'
+
+        } // end of namespace 'broker'
+
+    } // end of namespace 'casper'
+
+} // end of namespace 'ngx'
+
+#endif // NRS_NGX_CASPER_BROKER_CDN_COMMON_ID_MATCHER_H_
@@ -22,6 +22,8 @@
 #include "ngx/casper/broker/cdn-common/module.h"
 
 #include "ngx/casper/broker/cdn-common/archive.h"
+#include "ngx/casper/broker/cdn-common/xattrs_cache.h"
+#include "ngx/casper/broker/cdn-common/hasher.h"
 
 #include "ngx/ngx_utils.h"
 
@@ -31,6 +33,9 @@ bool                             ngx::casper::broker::cdn::common::Module::s_h2e
 Json::Value                      ngx::casper::broker::cdn::common::Module::s_ast_config_     = Json::Value(Json::ValueType::nullValue);
 bool                             ngx::casper::broker::cdn::common::Module::s_ast_config_set_ = false;
 
+bool                             ngx::casper::broker::cdn::common::Module::s_xattrs_cache_set_ = false;
+bool                             ngx::casper::broker::cdn::common::Module::s_hasher_set_       = false;
+
 const std::string ngx::casper::broker::cdn::common::Module::sk_empty_string_ = "";
 
 const std::set<std::string> ngx::casper::broker::cdn::common::Module::sk_preserved_upload_attrs_ = {
@@ -266,6 +271,20 @@ ngx_int_t ngx::casper::broker::cdn::common::Module::Setup ()
         }
     }
     
+    // ... xattrs cache ...
+    if ( false == s_xattrs_cache_set_ ) {
+        ngx::casper::broker::cdn::XAttrsCache::GetInstance().Startup(broker_conf->cdn.cache.xattrs);
+        s_xattrs_cache_set_ = true;
+    }
+
+    // ... integrity digests workers ...
+    if ( false == s_hasher_set_ ) {
+        ngx::casper::broker::cdn::Hasher::GetInstance().Startup(broker_conf->cdn.integrity.threads > 0 ? static_cast<size_t>(broker_conf->cdn.integrity.threads) : 0,
+                                                                broker_conf->cdn.integrity.buffer_size
+        );
+        s_hasher_set_ = true;
+    }
+    
     // ... done ...
     return ctx_.response_.return_code_;
 }
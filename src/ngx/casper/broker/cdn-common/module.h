@@ -58,6 +58,8 @@ namespace ngx
                         static bool        s_h2e_map_set_;
                         static Json::Value s_ast_config_;
                         static bool        s_ast_config_set_;
+                        static bool        s_xattrs_cache_set_;
+                        static bool        s_hasher_set_;
 
                     protected: // Data Type(s)
                         
@@ -26,12 +26,16 @@
 #include "cc/non-copyable.h"
 #include "cc/non-movable.h"
 
+#include <array>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <algorithm> // std::find_if
 
 #include "ngx/ngx_utils.h"
 
+#include "ngx/casper/broker/in_headers.h"
+
 #include "cc/exception.h"
 #include "cc/fs/file.h"
 
@@ -111,8 +115,8 @@ namespace ngx
                     bool               IsSet () const;
                     const std::string& Name  () const;
                     
-                    void Set (const std::map<std::string,std::string>& a_headers, const T* a_default = nullptr);
-                    void Set (const std::vector<std::string>& a_allowed, const std::map<std::string,std::string>& a_headers,
+                    void Set (const ngx::casper::broker::InHeaders& a_headers, const T* a_default = nullptr);
+                    void Set (const std::vector<std::string>& a_allowed, const ngx::casper::broker::InHeaders& a_headers,
                               const T* a_default = nullptr, bool a_first_of = false);
                     
                 public: // Operator(s)
@@ -171,9 +175,9 @@ namespace ngx
                     return ( alt_name_.length() > 0 ? alt_name_ : name_ );
                 }
                 
-                template <typename T> void Header<T>::Set (const std::map<std::string,std::string>& a_headers, const T* a_default)
+                template <typename T> void Header<T>::Set (const ngx::casper::broker::InHeaders& a_headers, const T* a_default)
                 {
-                    const auto it = std::find_if(a_headers.begin(), a_headers.end(), KeyComparator(name_));
+                    const auto it = a_headers.find(name_);
                     if ( a_headers.end() == it ) {
                         if ( nullptr == a_default ) {
                             throw ::cc::Exception("Can't set header '%s' value - not found in provided map!", Name().c_str());
@@ -201,14 +205,14 @@ namespace ngx
                     set_ = true;
                 }
                 
-                template <typename T> void Header<T>::Set (const std::vector<std::string>& a_allowed, const std::map<std::string,std::string>& a_headers,
+                template <typename T> void Header<T>::Set (const std::vector<std::string>& a_allowed, const ngx::casper::broker::InHeaders& a_headers,
                                                            const T* a_default, bool a_first_of)
                 {
                     alt_name_ = "";
                     if ( 0 == a_allowed.size() ) {
                         throw ::cc::Exception("Can't set header '%s' value - zero 'allowed' headers provided!", Name().c_str());
                     }
-                    if ( 0 == a_headers.size() ) {
+                    if ( a_headers.end() == a_headers.begin() ) {
                         if ( nullptr == a_default ) {
                             throw ::cc::Exception("Can't set header '%s' value - zero 'headers' key / value provided!", Name().c_str());
                         } else {
@@ -219,7 +223,7 @@ namespace ngx
                     }
                     size_t cnt = 0;
                     for ( auto name : a_allowed ) {
-                        const auto it = std::find_if(a_headers.begin(), a_headers.end(), KeyComparator(name));
+                        const auto it = a_headers.find(name);
                         if ( a_headers.end() == it ) {
                             continue;
                         }
@@ -881,9 +885,110 @@ namespace ngx
                 };
                 
                 //
-                // TYPE DEF(S)
+                // H2EMap
                 //
-                typedef std::map<std::string, std::string> H2EMap;
+                class H2EMap final : public ::cc::NonCopyable, public ::cc::NonMovable
+                {
+                    
+                public: // Data Type(s)
+                    
+                    typedef std::unordered_map<std::string, std::string> Entries;
+                    typedef Entries::value_type                          Entry;
+                    
+                private: // Data
+                    
+                    Entries                       entries_;  //!< Header name to directory component.
+                    std::array<const Entry*, 256> prefixes_; //!< Directory component first char to entry, built once at load time.
+                    Entries                       xattrs_;   //!< Normalized ( lowercase ) header name to xattr key, built once at load time.
+                    
+                public: // Constructor(s) / Destructor
+                    
+                    H2EMap ()
+                    {
+                        prefixes_.fill(nullptr);
+                    }
+                    
+                    virtual ~H2EMap ()
+                    {
+                        /* empty */
+                    }
+                    
+                public: // Method(s) / Function(s)
+                    
+                    /**
+                     * @brief Add an entry, first char of each value must be unique.
+                     *
+                     * @param a_name  Header name.
+                     * @param a_value Directory component.
+                     */
+                    void Set (const std::string& a_name, const std::string& a_value)
+                    {
+                        const unsigned char ch = static_cast<unsigned char>(a_value.c_str()[0]);
+                        if ( nullptr != prefixes_[ch] && a_name != prefixes_[ch]->first ) {
+                            throw ::cc::Exception("Duplicated 'h2e' value's first char - first char of each value must be unique!");
+                        }
+                        const auto it = entries_.find(a_name);
+                        if ( entries_.end() != it ) {
+                            prefixes_[static_cast<unsigned char>(it->second.c_str()[0])] = nullptr;
+                            it->second = a_value;
+                            prefixes_[ch] = &(*it);
+                        } else {
+                            prefixes_[ch] = &(*entries_.insert(std::make_pair(a_name, a_value)).first);
+                        }
+                    }
+                    
+                    /**
+                     * @brief Add a header to xattr key translation.
+                     *
+                     * @param a_header Normalized ( lowercase ) header name.
+                     * @param a_xattr  Xattr key.
+                     */
+                    void Index (const std::string& a_header, const std::string& a_xattr)
+                    {
+                        xattrs_[a_header] = a_xattr;
+                    }
+                    
+                    /**
+                     * @param a_name Header name.
+                     *
+                     * @return Entry for the provided header name, nullptr if not found - single probe.
+                     */
+                    inline const Entry* Find (const std::string& a_name) const
+                    {
+                        const auto it = entries_.find(a_name);
+                        return ( entries_.end() != it ? &(*it) : nullptr );
+                    }
+                    
+                    /**
+                     * @param a_prefix Directory component first char ( an archive id first char ).
+                     *
+                     * @return Entry for the provided prefix, nullptr if not found - single probe.
+                     */
+                    inline const Entry* Prefix (const char a_prefix) const
+                    {
+                        return prefixes_[static_cast<unsigned char>(a_prefix)];
+                    }
+                    
+                    /**
+                     * @param a_header Normalized ( lowercase ) header name.
+                     *
+                     * @return Xattr key for the provided header name, nullptr if not found - single probe, no allocations.
+                     */
+                    inline const std::string* XAttr (const std::string& a_header) const
+                    {
+                        const auto it = xattrs_.find(a_header);
+                        return ( xattrs_.end() != it ? &it->second : nullptr );
+                    }
+                    
+                    /**
+                     * @return Read-only access to all entries.
+                     */
+                    inline const Entries& entries () const
+                    {
+                        return entries_;
+                    }
+                    
+                };
                 
             } // end of namespace 'api'
             
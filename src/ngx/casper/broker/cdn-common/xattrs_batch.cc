@@ -0,0 +1,118 @@
+/**
+ * @file xattrs_batch.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ngx/casper/broker/cdn-common/xattrs_batch.h"
+
+#include "cc/exception.h"
+
+/**
+ * @brief Default constructor, reads all attributes.
+ *
+ * @param a_xattr File extended attributes accessor.
+ */
+ngx::casper::broker::cdn::XAttrsBatch::XAttrsBatch (::cc::fs::file::XAttr& a_xattr)
+    : xattr_(a_xattr)
+{
+    xattr_.Iterate([this](const char *const a_key, const char *const a_value) {
+        loaded_[a_key] = a_value;
+    });
+    attrs_ = loaded_;
+}
+
+/**
+ * @brief Destructor, staged changes that were not flushed are lost.
+ */
+ngx::casper::broker::cdn::XAttrsBatch::~XAttrsBatch ()
+{
+    /* empty */
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Retrieve an attribute value.
+ *
+ * @param a_name  Attribute name.
+ * @param o_value Attribute value.
+ */
+void ngx::casper::broker::cdn::XAttrsBatch::Get (const std::string& a_name, std::string& o_value) const
+{
+    const auto it = attrs_.find(a_name);
+    if ( attrs_.end() == it ) {
+        throw ::cc::Exception("Attribute '%s' does not exist!", a_name.c_str());
+    }
+    o_value = it->second;
+}
+
+/**
+ * @brief Stage an attribute value.
+ *
+ * @param a_name  Attribute name.
+ * @param a_value Attribute value.
+ */
+void ngx::casper::broker::cdn::XAttrsBatch::Set (const std::string& a_name, const std::string& a_value)
+{
+    attrs_[a_name] = a_value;
+    removed_.erase(a_name);
+    // ... only write it if differs from what is on disk ...
+    const auto it = loaded_.find(a_name);
+    if ( loaded_.end() != it && it->second == a_value ) {
+        dirty_.erase(a_name);
+    } else {
+        dirty_.insert(a_name);
+    }
+}
+
+/**
+ * @brief Stage an attribute removal.
+ *
+ * @param a_name Attribute name.
+ */
+void ngx::casper::broker::cdn::XAttrsBatch::Remove (const std::string& a_name)
+{
+    attrs_.erase(a_name);
+    dirty_.erase(a_name);
+    if ( loaded_.end() != loaded_.find(a_name) ) {
+        removed_.insert(a_name);
+    }
+}
+
+/**
+ * @brief Write all staged changes.
+ *
+ * @return Number of attributes written or removed.
+ */
+size_t ngx::casper::broker::cdn::XAttrsBatch::Flush ()
+{
+    const size_t count = dirty_.size() + removed_.size();
+    for ( const auto& name : dirty_ ) {
+        xattr_.Set(name, attrs_[name]);
+    }
+    for ( const auto& name : removed_ ) {
+        xattr_.Remove(name);
+    }
+    dirty_.clear();
+    removed_.clear();
+    loaded_ = attrs_;
+    return count;
+}
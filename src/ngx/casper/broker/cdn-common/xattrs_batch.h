@@ -0,0 +1,117 @@
+/**
+ * @file xattrs_batch.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_NGX_CASPER_BROKER_CDN_COMMON_XATTRS_BATCH_H_
+#define NRS_NGX_CASPER_BROKER_CDN_COMMON_XATTRS_BATCH_H_
+
+#include "cc/non-copyable.h"
+#include "cc/non-movable.h"
+
+#include "cc/fs/file.h" // XAttr
+
+#include <map>    // std::map
+#include <set>    // std::set
+#include <string> // std::string
+
+namespace ngx
+{
+
+    namespace casper
+    {
+
+        namespace broker
+        {
+
+            namespace cdn
+            {
+
+                /**
+                 * @brief Loads all extended attributes of a file in one pass, stages changes in memory and writes only
+                 *        the ones that actually changed when flushed.
+                 */
+                class XAttrsBatch final : public ::cc::NonCopyable, public ::cc::NonMovable
+                {
+
+                private: // Data
+
+                    ::cc::fs::file::XAttr&             xattr_;
+                    std::map<std::string, std::string> loaded_;
+                    std::map<std::string, std::string> attrs_;
+                    std::set<std::string>              dirty_;
+                    std::set<std::string>              removed_;
+
+                public: // Constructor(s) / Destructor
+
+                    XAttrsBatch () = delete;
+                    XAttrsBatch (::cc::fs::file::XAttr& a_xattr);
+                    virtual ~XAttrsBatch ();
+
+                public: // Method(s) / Function(s)
+
+                    void   Get    (const std::string& a_name, std::string& o_value) const;
+                    void   Set    (const std::string& a_name, const std::string& a_value);
+                    void   Remove (const std::string& a_name);
+                    size_t Flush  ();
+
+                public: // Inline Method(s) / Function(s)
+
+                    bool                                      Exists (const std::string& a_name) const;
+                    bool                                      dirty  () const;
+                    const std::map<std::string, std::string>& attrs  () const;
+
+                }; // end of class 'XAttrsBatch'
+
+                /**
+                 * @param a_name Attribute name.
+                 *
+                 * @return True if the attribute exists ( staged changes included ), false otherwise.
+                 */
+                inline bool XAttrsBatch::Exists (const std::string& a_name) const
+                {
+                    return ( attrs_.end() != attrs_.find(a_name) );
+                }
+
+                /**
+                 * @return True if there are staged changes not yet flushed.
+                 */
+                inline bool XAttrsBatch::dirty () const
+                {
+                    return ( dirty_.size() > 0 || removed_.size() > 0 );
+                }
+
+                /**
+                 * @return Read-only access to all attributes, staged changes included.
+                 */
+                inline const std::map<std::string, std::string>& XAttrsBatch::attrs () const
+                {
+                    return attrs_;
+                }
+
+            } // end of namespace 'cdn'
+
+        } // end of namespace 'broker'
+
+    } // end of namespace 'casper'
+
+} // end of namespace 'ngx'
+
+#endif // NRS_NGX_CASPER_BROKER_CDN_COMMON_XATTRS_BATCH_H_
@@ -0,0 +1,185 @@
+/**
+ * @file xattrs_cache.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ngx/casper/broker/cdn-common/xattrs_cache.h"
+
+#include "cc/fs/file.h" // XAttr
+
+#include <time.h> // time
+
+#ifdef __APPLE__
+    #define NRS_XATTRS_CACHE_MTIME(a_stat) (a_stat).st_mtimespec
+    #define NRS_XATTRS_CACHE_CTIME(a_stat) (a_stat).st_ctimespec
+#else
+    #define NRS_XATTRS_CACHE_MTIME(a_stat) (a_stat).st_mtim
+    #define NRS_XATTRS_CACHE_CTIME(a_stat) (a_stat).st_ctim
+#endif
+
+//
+// ... entries changed less than this number of seconds ago are served but not kept,
+//     file system timestamps granularity might not be enough to detect a change done within the same tick ...
+//
+#define NRS_XATTRS_CACHE_MIN_AGE 1
+
+/**
+ * @brief Per-entry memory overhead estimate ( list node, index node, map and shared_ptr bookkeeping ).
+ */
+#define NRS_XATTRS_CACHE_ENTRY_OVERHEAD ( sizeof(ngx::casper::broker::cdn::XAttrsCache::Attrs) + 128 )
+
+/**
+ * @brief Per-attribute memory overhead estimate ( map node ).
+ */
+#define NRS_XATTRS_CACHE_ATTR_OVERHEAD  ( 2 * sizeof(std::string) + 32 )
+
+/**
+ * @brief One-shot setup.
+ *
+ * @param a_limit Maximum amount of memory ( in bytes ) to use, 0 disables cache.
+ */
+void ngx::casper::broker::cdn::XAttrsCache::Startup (const size_t a_limit)
+{
+    stats_.limit_ = a_limit;
+    Evict(stats_.limit_);
+}
+
+/**
+ * @brief Release all cached entries.
+ */
+void ngx::casper::broker::cdn::XAttrsCache::Shutdown ()
+{
+    index_.clear();
+    lru_.clear();
+    stats_.entries_ = 0;
+    stats_.bytes_   = 0;
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Obtain a snapshot of all extended attributes of a file.
+ *
+ * @param a_uri  Local file URI.
+ * @param a_stat File status, as obtained by the caller, used as cache key and to revalidate cached entry.
+ *
+ * @return Attributes snapshot, nullptr if cache is disabled.
+ */
+ngx::casper::broker::cdn::XAttrsCache::Snapshot ngx::casper::broker::cdn::XAttrsCache::Get (const std::string& a_uri, const struct stat& a_stat)
+{
+    if ( false == enabled() ) {
+        return nullptr;
+    }
+
+    const Key             key   = { a_stat.st_dev, a_stat.st_ino };
+    const struct timespec mtime = NRS_XATTRS_CACHE_MTIME(a_stat);
+    const struct timespec ctime = NRS_XATTRS_CACHE_CTIME(a_stat);
+
+    // ... already cached?
+    const auto it = index_.find(key);
+    if ( index_.end() != it ) {
+        const Entry& entry = (*it->second);
+        // ... still valid?
+        if (
+            entry.mtime_.tv_sec == mtime.tv_sec && entry.mtime_.tv_nsec == mtime.tv_nsec
+                &&
+            entry.ctime_.tv_sec == ctime.tv_sec && entry.ctime_.tv_nsec == ctime.tv_nsec
+                &&
+            entry.size_ == a_stat.st_size
+        ) {
+            // ... yes, most recently used ...
+            lru_.splice(lru_.begin(), lru_, it->second);
+            stats_.hits_++;
+            return entry.snapshot_;
+        }
+        // ... no, forget it ...
+        stats_.bytes_ -= entry.footprint_;
+        stats_.entries_--;
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    stats_.misses_++;
+
+    // ... load all attributes ...
+    std::shared_ptr<Attrs> attrs = std::make_shared<Attrs>();
+    size_t footprint = NRS_XATTRS_CACHE_ENTRY_OVERHEAD;
+    ::cc::fs::file::XAttr xattr(a_uri);
+    xattr.Iterate([&attrs, &footprint] (const char* const a_name, const char* const a_value) {
+        const auto e = attrs->emplace(a_name, a_value);
+        footprint += NRS_XATTRS_CACHE_ATTR_OVERHEAD + e.first->first.length() + e.first->second.length();
+    });
+
+    // ... too recent or too big to keep?
+    if ( ( time(nullptr) - ctime.tv_sec ) < NRS_XATTRS_CACHE_MIN_AGE || footprint > stats_.limit_ ) {
+        return attrs;
+    }
+
+    // ... make room for it ...
+    Evict(stats_.limit_ - footprint);
+
+    // ... keep track of it ...
+    lru_.push_front({ key, mtime, ctime, a_stat.st_size, footprint, attrs });
+    index_[key] = lru_.begin();
+    stats_.bytes_ += footprint;
+    stats_.entries_++;
+
+    // ... done ...
+    return attrs;
+}
+
+/**
+ * @brief Forget a cached entry ( if any ).
+ *
+ * @param a_stat File status.
+ */
+void ngx::casper::broker::cdn::XAttrsCache::Invalidate (const struct stat& a_stat)
+{
+    const auto it = index_.find({ a_stat.st_dev, a_stat.st_ino });
+    if ( index_.end() == it ) {
+        return;
+    }
+    stats_.bytes_ -= it->second->footprint_;
+    stats_.entries_--;
+    lru_.erase(it->second);
+    index_.erase(it);
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Evict least recently used entries until memory usage is below a limit.
+ *
+ * @param a_limit Maximum amount of memory ( in bytes ) to keep.
+ */
+void ngx::casper::broker::cdn::XAttrsCache::Evict (const size_t a_limit)
+{
+    while ( stats_.bytes_ > a_limit && lru_.size() > 0 ) {
+        const Entry& entry = lru_.back();
+        stats_.bytes_ -= entry.footprint_;
+        stats_.entries_--;
+        stats_.evictions_++;
+        index_.erase(entry.key_);
+        lru_.pop_back();
+    }
+}
@@ -0,0 +1,170 @@
+/**
+ * @file xattrs_cache.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_NGX_CASPER_BROKER_CDN_COMMON_XATTRS_CACHE_H_
+#define NRS_NGX_CASPER_BROKER_CDN_COMMON_XATTRS_CACHE_H_
+
+#include "osal/osal_singleton.h"
+
+#include <sys/stat.h> // struct stat
+
+#include <functional>    // std::hash
+#include <list>          // std::list
+#include <map>           // std::map
+#include <memory>        // std::shared_ptr
+#include <string>        // std::string
+#include <unordered_map> // std::unordered_map
+
+namespace ngx
+{
+
+    namespace casper
+    {
+
+        namespace broker
+        {
+
+            namespace cdn
+            {
+
+                // ---- //
+                class XAttrsCache;
+                class XAttrsCacheInitializer final : public ::osal::Initializer<XAttrsCache>
+                {
+
+                public: // Constructor(s) / Destructor
+
+                    XAttrsCacheInitializer (XAttrsCache& a_instance)
+                        : ::osal::Initializer<XAttrsCache>(a_instance)
+                    {
+                        /* empty */
+                    }
+                    virtual ~XAttrsCacheInitializer ()
+                    {
+                        /* empty */
+                    }
+
+                }; // end of class 'XAttrsCacheInitializer'
+
+                // ---- //
+                class XAttrsCache final : public osal::Singleton<XAttrsCache, XAttrsCacheInitializer>
+                {
+
+                public: // Data Type(s)
+
+                    typedef std::map<std::string, std::string> Attrs;
+                    typedef std::shared_ptr<const Attrs>       Snapshot;
+
+                    typedef struct {
+                        uint64_t hits_;
+                        uint64_t misses_;
+                        uint64_t evictions_;
+                        size_t   entries_;
+                        size_t   bytes_;
+                        size_t   limit_;
+                    } Stats;
+
+                private: // Data Type(s)
+
+                    typedef struct {
+                        dev_t dev_;
+                        ino_t ino_;
+                    } Key;
+
+                    struct KeyHash {
+                        size_t operator () (const Key& a_key) const
+                        {
+                            return std::hash<uint64_t>()(static_cast<uint64_t>(a_key.ino_)) ^ ( std::hash<uint64_t>()(static_cast<uint64_t>(a_key.dev_)) << 1 );
+                        }
+                    };
+
+                    struct KeyEqual {
+                        bool operator () (const Key& a_lhs, const Key& a_rhs) const
+                        {
+                            return a_lhs.dev_ == a_rhs.dev_ && a_lhs.ino_ == a_rhs.ino_;
+                        }
+                    };
+
+                    typedef struct {
+                        Key             key_;
+                        struct timespec mtime_;
+                        struct timespec ctime_;
+                        off_t           size_;
+                        size_t          footprint_;
+                        Snapshot        snapshot_;
+                    } Entry;
+
+                    typedef std::list<Entry>                                           LRU;
+                    typedef std::unordered_map<Key, LRU::iterator, KeyHash, KeyEqual> Index;
+
+                private: // Data
+
+                    LRU   lru_;
+                    Index index_;
+                    Stats stats_ = { /* hits_ */ 0, /* misses_ */ 0, /* evictions_ */ 0, /* entries_ */ 0, /* bytes_ */ 0, /* limit_ */ 0 };
+
+                public: // One-shot Call Method(s) / Function(s)
+
+                    void Startup  (const size_t a_limit);
+                    void Shutdown ();
+
+                public: // Method(s) / Function(s)
+
+                    Snapshot Get        (const std::string& a_uri, const struct stat& a_stat);
+                    void     Invalidate (const struct stat& a_stat);
+
+                public: // Inline Method(s) / Function(s)
+
+                    bool         enabled () const;
+                    const Stats& stats   () const;
+
+                private: // Method(s) / Function(s)
+
+                    void Evict (const size_t a_limit);
+
+                }; // end of class 'XAttrsCache'
+
+                /**
+                 * @return True when a memory limit is set, false otherwise.
+                 */
+                inline bool XAttrsCache::enabled () const
+                {
+                    return ( stats_.limit_ > 0 );
+                }
+
+                /**
+                 * @return Read-only access to cache counters.
+                 */
+                inline const XAttrsCache::Stats& XAttrsCache::stats () const
+                {
+                    return stats_;
+                }
+
+            } // end of namespace 'cdn'
+
+        } // end of namespace 'broker'
+
+    } // end of namespace 'casper'
+
+} // end of namespace 'ngx'
+
+#endif // NRS_NGX_CASPER_BROKER_CDN_COMMON_XATTRS_CACHE_H_
@@ -22,13 +22,12 @@
 #include "ngx/casper/broker/cdn-download/module.h"
 
 #include "ngx/casper/broker/cdn/errors.h"
+#include "ngx/casper/broker/cdn-common/id_matcher.h"
 
 #include <algorithm>
 
 #include "ngx/ngx_utils.h"
 
-#include <regex>      // std::regex
-
 const char* const ngx::casper::broker::cdn::dl::Module::sk_rx_content_type_ = "application/json";
 const char* const ngx::casper::broker::cdn::dl::Module::sk_tx_content_type_ = "application/json;charset=utf-8";
 
@@ -136,9 +135,7 @@ void ngx::casper::broker::cdn::dl::Module::OnSessionFetchSucceeded (const bool /
 
     ctx_.response_.redirect_.file_ = std::string(uri, 1);
 
-    const std::regex id_expr("([a-z]{1})([a-zA-Z0-9]{2})([a-zA-Z0-9]{6})(\\.[a-z]*)?", std::regex_constants::ECMAScript);
-    std::smatch match;
-    if ( false == std::regex_search(ctx_.response_.redirect_.file_, match, id_expr) || match.size() < 4 ) {
+    if ( false == ngx::casper::broker::cdn::IDMatcher::Search(ctx_.response_.redirect_.file_, ngx::casper::broker::cdn::IDMatcher::Dialect::Redirect) ) {
         NGX_BROKER_MODULE_SET_BAD_REQUEST_ERROR(ctx_, ( "Unable to setup redirect file with invalid id '" + ctx_.response_.redirect_.file_ + "'!").c_str() );
         NGX_BROKER_MODULE_FINALIZE_REQUEST(this);
     } else {
@@ -238,7 +235,7 @@ ngx_int_t ngx::casper::broker::cdn::dl::Module::Factory (ngx_http_request_t* a_r
     
     return ::ngx::casper::broker::cdn::dl::Module::Initialize(config, params,
                                                           [&config, &params, &broker_conf, &loc_conf] () -> ::ngx::casper::broker::Module* {
-                                                              return new ::ngx::casper::broker::cdn::dl::Module(config, params, *broker_conf, *loc_conf);
+                                                              return new (config.ngx_ptr_) ::ngx::casper::broker::cdn::dl::Module(config, params, *broker_conf, *loc_conf);
                                                           }
     );
 }
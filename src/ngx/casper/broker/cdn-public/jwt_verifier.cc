@@ -0,0 +1,376 @@
+/**
+ * @file jwt_verifier.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ngx/casper/broker/cdn-public/jwt_verifier.h"
+
+#include "ngx/casper/broker/exception.h"
+
+#include "cc/exception.h"
+
+#include <openssl/bn.h>
+#include <openssl/ecdsa.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+
+#include <string.h> // memchr, strerror
+#include <errno.h>  // errno
+
+/**
+ * @brief One-shot setup.
+ *
+ * @param a_rsa_public_key_uri PEM encoded public key file URI ( RSA, EC P-256 or Ed25519 ).
+ * @param a_allowed_iss        JSON array of accepted issuers.
+ * @param a_limit              Maximum number of verified tokens to keep, 0 disables cache.
+ */
+void ngx::casper::broker::cdn::pub::JWTVerifier::Startup (const std::string& a_rsa_public_key_uri, const Json::Value& a_allowed_iss, const size_t a_limit)
+{
+    key_uri_ = a_rsa_public_key_uri;
+    allowed_iss_.clear();
+    for ( Json::ArrayIndex idx = 0 ; idx < a_allowed_iss.size() ; ++idx ) {
+        allowed_iss_.insert(a_allowed_iss[idx].asString());
+    }
+    if ( nullptr == md_ctx_ ) {
+        md_ctx_ = EVP_MD_CTX_new();
+    }
+    stats_.limit_ = a_limit;
+    Evict(stats_.limit_);
+}
+
+/**
+ * @brief Release key, verification context and all cached entries.
+ */
+void ngx::casper::broker::cdn::pub::JWTVerifier::Shutdown ()
+{
+    Flush();
+    if ( nullptr != key_ ) {
+        EVP_PKEY_free(key_);
+        key_ = nullptr;
+    }
+    if ( nullptr != md_ctx_ ) {
+        EVP_MD_CTX_free(md_ctx_);
+        md_ctx_ = nullptr;
+    }
+    key_checked_at_ = 0;
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Verify a JWT signature and issuer, registered time claims are NOT checked here.
+ *
+ * @param a_jwt JWT, as produced by \link ::cc::auth::JWT::Encode \link.
+ * @param a_now Current UTC time, in seconds.
+ *
+ * @return Verified payload.
+ */
+ngx::casper::broker::cdn::pub::JWTVerifier::Payload ngx::casper::broker::cdn::pub::JWTVerifier::Verify (const std::string& a_jwt, const int64_t a_now)
+{
+    // ... key rotated?
+    LoadKey(a_now);
+
+    // ... already verified?
+    const auto it = index_.find(a_jwt);
+    if ( index_.end() != it ) {
+        stats_.hits_++;
+        const Payload payload = it->second->payload_;
+        if ( it->second->exp_ <= a_now ) {
+            // ... signature is still valid, but it's no longer worth keeping ...
+            lru_.erase(it->second);
+            index_.erase(it);
+            stats_.entries_--;
+        } else {
+            // ... most recently used ...
+            lru_.splice(lru_.begin(), lru_, it->second);
+        }
+        return payload;
+    }
+
+    stats_.misses_++;
+
+    const Payload payload = Decode(a_jwt);
+
+    // ... keep it until it expires ...
+    const Json::Value& exp = payload->get("exp", Json::Value::null);
+    if ( stats_.limit_ > 0 && true == exp.isNumeric() && exp.asInt64() > a_now ) {
+        Evict(stats_.limit_ - 1);
+        lru_.push_front({ a_jwt, exp.asInt64(), payload });
+        index_[a_jwt] = lru_.begin();
+        stats_.entries_++;
+    }
+
+    return payload;
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Load or reload public key, if file changed ( checked at most once per second ).
+ *
+ * @param a_now Current UTC time, in seconds.
+ */
+void ngx::casper::broker::cdn::pub::JWTVerifier::LoadKey (const int64_t a_now)
+{
+    if ( nullptr != key_ && a_now == key_checked_at_ ) {
+        return;
+    }
+
+    struct stat st;
+    if ( 0 != stat(key_uri_.c_str(), &st) ) {
+        throw ::cc::Exception("Unable to access JWT public key file '%s': %s!", key_uri_.c_str(), strerror(errno));
+    }
+    key_checked_at_ = a_now;
+
+    // ... unchanged?
+    if ( nullptr != key_ && st.st_ino == key_stat_.st_ino && st.st_size == key_stat_.st_size && st.st_mtime == key_stat_.st_mtime ) {
+        return;
+    }
+
+    BIO* bio = BIO_new_file(key_uri_.c_str(), "r");
+    if ( nullptr == bio ) {
+        throw ::cc::Exception("Unable to open JWT public key file '%s'!", key_uri_.c_str());
+    }
+
+    // ... 'PUBLIC KEY' or 'RSA PUBLIC KEY' ...
+    EVP_PKEY* key = PEM_read_bio_PUBKEY(bio, nullptr, nullptr, nullptr);
+    if ( nullptr == key && 1 == BIO_reset(bio) ) {
+        RSA* rsa = PEM_read_bio_RSAPublicKey(bio, nullptr, nullptr, nullptr);
+        if ( nullptr != rsa ) {
+            key = EVP_PKEY_new();
+            if ( nullptr == key || 1 != EVP_PKEY_assign_RSA(key, rsa) ) {
+                RSA_free(rsa);
+                if ( nullptr != key ) {
+                    EVP_PKEY_free(key);
+                    key = nullptr;
+                }
+            }
+        }
+    }
+    BIO_free(bio);
+
+    if ( nullptr == key ) {
+        throw ::cc::Exception("Unable to load JWT public key from '%s'!", key_uri_.c_str());
+    }
+
+    if ( nullptr != key_ ) {
+        EVP_PKEY_free(key_);
+    }
+    key_      = key;
+    key_stat_ = st;
+    stats_.key_loads_++;
+
+    // ... previously verified tokens are no longer trusted ...
+    Flush();
+}
+
+/**
+ * @brief Decode a JWT and verify it's signature and issuer.
+ *
+ * @param a_jwt JWT.
+ *
+ * @return Verified payload.
+ */
+ngx::casper::broker::cdn::pub::JWTVerifier::Payload ngx::casper::broker::cdn::pub::JWTVerifier::Decode (const std::string& a_jwt)
+{
+    //
+    // <header>.<payload>.<signature>
+    //
+    const char* const start     = a_jwt.c_str();
+    const char* const end       = start + a_jwt.length();
+    const char* const header_e  = static_cast<const char*>(memchr(start, '.', a_jwt.length()));
+    const char* const payload_e = ( nullptr != header_e ? static_cast<const char*>(memchr(header_e + 1, '.', static_cast<size_t>(end - header_e - 1))) : nullptr );
+    if ( nullptr == payload_e || nullptr != memchr(payload_e + 1, '.', static_cast<size_t>(end - payload_e - 1)) ) {
+        throw ngx::casper::broker::Exception("bad_request", "JWT: %s!", "invalid format");
+    }
+
+    // ... header, algorithm must match key type ...
+    const Json::Value header = DecodeJSON(start, static_cast<size_t>(header_e - start), "header");
+    const Json::Value& alg   = header.get("alg", Json::Value::null);
+    const int          type  = EVP_PKEY_id(key_);
+    const EVP_MD*      md    = nullptr;
+    bool               ecdsa = false;
+    bool               known = false;
+    if ( true == alg.isString() ) {
+        if ( EVP_PKEY_RSA == type && 0 == strcmp(alg.asCString(), "RS256") ) {
+            md = EVP_sha256(); known = true;
+        } else if ( EVP_PKEY_RSA == type && 0 == strcmp(alg.asCString(), "RS384") ) {
+            md = EVP_sha384(); known = true;
+        } else if ( EVP_PKEY_RSA == type && 0 == strcmp(alg.asCString(), "RS512") ) {
+            md = EVP_sha512(); known = true;
+        } else if ( EVP_PKEY_EC == type && 0 == strcmp(alg.asCString(), "ES256") ) {
+            md = EVP_sha256(); known = true; ecdsa = true;
+        } else if ( EVP_PKEY_ED25519 == type && 0 == strcmp(alg.asCString(), "EdDSA") ) {
+            known = true;
+        }
+    }
+    if ( false == known ) {
+        throw ngx::casper::broker::Exception("bad_request", "JWT: %s!", "unsupported algorithm");
+    }
+
+    // ... signature ...
+    std::string signature;
+    if ( false == B64URLDecode(payload_e + 1, static_cast<size_t>(end - payload_e - 1), signature) ) {
+        throw ngx::casper::broker::Exception("bad_request", "JWT: %s!", "invalid signature encoding");
+    }
+    // ... ES256 signature is r || s, OpenSSL wants DER ...
+    if ( true == ecdsa ) {
+        if ( 64 != signature.length() ) {
+            throw ngx::casper::broker::Exception("bad_request", "JWT: %s!", "invalid signature length");
+        }
+        ECDSA_SIG* ec_sig = ECDSA_SIG_new();
+        BIGNUM*    r      = BN_bin2bn(reinterpret_cast<const unsigned char*>(signature.c_str()), 32, nullptr);
+        BIGNUM*    s      = BN_bin2bn(reinterpret_cast<const unsigned char*>(signature.c_str()) + 32, 32, nullptr);
+        unsigned char* der = nullptr;
+        int            len = -1;
+        if ( nullptr != ec_sig && nullptr != r && nullptr != s && 1 == ECDSA_SIG_set0(ec_sig, r, s) ) {
+            r = s = nullptr; // ... owned by ec_sig ...
+            len = i2d_ECDSA_SIG(ec_sig, &der);
+        }
+        BN_free(r);
+        BN_free(s);
+        ECDSA_SIG_free(ec_sig);
+        if ( len <= 0 ) {
+            throw ngx::casper::broker::Exception("bad_request", "JWT: %s!", "invalid signature");
+        }
+        signature.assign(reinterpret_cast<const char*>(der), static_cast<size_t>(len));
+        OPENSSL_free(der);
+    }
+    EVP_MD_CTX_reset(md_ctx_);
+    if (
+        1 != EVP_DigestVerifyInit(md_ctx_, nullptr, md, nullptr, key_)
+            ||
+        1 != EVP_DigestVerify(md_ctx_, reinterpret_cast<const unsigned char*>(signature.c_str()), signature.length(),
+                              reinterpret_cast<const unsigned char*>(start), static_cast<size_t>(payload_e - start))
+    ) {
+        throw ngx::casper::broker::Exception("bad_request", "JWT: %s!", "signature verification failed");
+    }
+
+    // ... payload ...
+    std::shared_ptr<Json::Value> payload = std::make_shared<Json::Value>(DecodeJSON(header_e + 1, static_cast<size_t>(payload_e - header_e - 1), "payload"));
+    const Json::Value& iss = payload->get("iss", Json::Value::null);
+    if ( false == iss.isString() || allowed_iss_.end() == allowed_iss_.find(iss.asString()) ) {
+        throw ngx::casper::broker::Exception("bad_request", "JWT: %s!", "issuer not allowed");
+    }
+
+    return payload;
+}
+
+/**
+ * @brief Decode a base64url encoded JSON object.
+ *
+ * @param a_data   Encoded data.
+ * @param a_length Encoded data length.
+ * @param a_what   Part name, for error reporting purposes.
+ *
+ * @return Decoded JSON object.
+ */
+Json::Value ngx::casper::broker::cdn::pub::JWTVerifier::DecodeJSON (const char* const a_data, const size_t a_length, const char* const a_what)
+{
+    std::string json;
+    Json::Value object;
+    if ( false == B64URLDecode(a_data, a_length, json) || false == json_reader_.parse(json, object, false) || false == object.isObject() ) {
+        throw ngx::casper::broker::Exception("bad_request", "JWT: invalid %s!", a_what);
+    }
+    return object;
+}
+
+/**
+ * @brief Forget all cached entries.
+ */
+void ngx::casper::broker::cdn::pub::JWTVerifier::Flush ()
+{
+    index_.clear();
+    lru_.clear();
+    stats_.entries_ = 0;
+}
+
+/**
+ * @brief Evict least recently used entries until the number of entries is below a limit.
+ *
+ * @param a_limit Maximum number of entries to keep.
+ */
+void ngx::casper::broker::cdn::pub::JWTVerifier::Evict (const size_t a_limit)
+{
+    while ( lru_.size() > a_limit ) {
+        index_.erase(lru_.back().token_);
+        lru_.pop_back();
+        stats_.entries_--;
+        stats_.evictions_++;
+    }
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Decode base64url ( or base64 ) data, padding is optional.
+ *
+ * @param a_data   Encoded data.
+ * @param a_length Encoded data length.
+ * @param o_data   Decoded data.
+ *
+ * @return True on success, false if data is not properly encoded.
+ */
+bool ngx::casper::broker::cdn::pub::JWTVerifier::B64URLDecode (const char* const a_data, const size_t a_length, std::string& o_data)
+{
+    o_data.clear();
+    o_data.reserve(( a_length * 3 ) / 4);
+
+    uint32_t buffer = 0;
+    int      bits   = 0;
+    size_t   idx    = 0;
+    for ( ; idx < a_length && '=' != a_data[idx] ; ++idx ) {
+        const char c = a_data[idx];
+        uint32_t   v;
+        if ( c >= 'A' && c <= 'Z' ) {
+            v = static_cast<uint32_t>(c - 'A');
+        } else if ( c >= 'a' && c <= 'z' ) {
+            v = static_cast<uint32_t>(c - 'a' + 26);
+        } else if ( c >= '0' && c <= '9' ) {
+            v = static_cast<uint32_t>(c - '0' + 52);
+        } else if ( '-' == c || '+' == c ) {
+            v = 62;
+        } else if ( '_' == c || '/' == c ) {
+            v = 63;
+        } else {
+            return false;
+        }
+        buffer = ( buffer << 6 ) | v;
+        bits  += 6;
+        if ( bits >= 8 ) {
+            bits -= 8;
+            o_data += static_cast<char>(( buffer >> bits ) & 0xFF);
+        }
+    }
+    // ... only padding is allowed after data ...
+    for ( ; idx < a_length ; ++idx ) {
+        if ( '=' != a_data[idx] ) {
+            return false;
+        }
+    }
+
+    return ( bits < 6 );
+}
@@ -0,0 +1,161 @@
+/**
+ * @file jwt_verifier.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_NGX_CASPER_BROKER_CDN_PUBLIC_JWT_VERIFIER_H_
+#define NRS_NGX_CASPER_BROKER_CDN_PUBLIC_JWT_VERIFIER_H_
+
+#include "osal/osal_singleton.h"
+
+#include "json/json.h"
+
+#include <openssl/ossl_typ.h> // EVP_PKEY, EVP_MD_CTX
+
+#include <sys/stat.h> // struct stat
+
+#include <stdint.h>      // int64_t
+#include <list>          // std::list
+#include <memory>        // std::shared_ptr
+#include <set>           // std::set
+#include <string>        // std::string
+#include <unordered_map> // std::unordered_map
+
+namespace ngx
+{
+
+    namespace casper
+    {
+
+        namespace broker
+        {
+
+            namespace cdn
+            {
+
+                namespace pub
+                {
+
+                    // ---- //
+                    class JWTVerifier;
+                    class JWTVerifierInitializer final : public ::osal::Initializer<JWTVerifier>
+                    {
+
+                    public: // Constructor(s) / Destructor
+
+                        JWTVerifierInitializer (JWTVerifier& a_instance)
+                            : ::osal::Initializer<JWTVerifier>(a_instance)
+                        {
+                            /* empty */
+                        }
+                        virtual ~JWTVerifierInitializer ()
+                        {
+                            /* empty */
+                        }
+
+                    }; // end of class 'JWTVerifierInitializer'
+
+                    // ---- //
+                    class JWTVerifier final : public osal::Singleton<JWTVerifier, JWTVerifierInitializer>
+                    {
+
+                    public: // Data Type(s)
+
+                        typedef std::shared_ptr<const Json::Value> Payload;
+
+                        typedef struct {
+                            uint64_t hits_;
+                            uint64_t misses_;
+                            uint64_t evictions_;
+                            uint64_t key_loads_;
+                            size_t   entries_;
+                            size_t   limit_;
+                        } Stats;
+
+                    private: // Data Type(s)
+
+                        typedef struct {
+                            std::string token_;
+                            int64_t     exp_;
+                            Payload     payload_;
+                        } Entry;
+
+                        typedef std::list<Entry>                                LRU;
+                        typedef std::unordered_map<std::string, LRU::iterator> Index;
+
+                    private: // Data
+
+                        std::string           key_uri_;
+                        std::set<std::string> allowed_iss_;
+                        EVP_PKEY*             key_            = nullptr;
+                        struct stat           key_stat_;
+                        int64_t               key_checked_at_ = 0;
+                        EVP_MD_CTX*           md_ctx_         = nullptr;
+                        Json::Reader          json_reader_;
+                        LRU                   lru_;
+                        Index                 index_;
+                        Stats                 stats_ = { /* hits_ */ 0, /* misses_ */ 0, /* evictions_ */ 0, /* key_loads_ */ 0, /* entries_ */ 0, /* limit_ */ 0 };
+
+                    public: // One-shot Call Method(s) / Function(s)
+
+                        void Startup  (const std::string& a_rsa_public_key_uri, const Json::Value& a_allowed_iss, const size_t a_limit);
+                        void Shutdown ();
+
+                    public: // Method(s) / Function(s)
+
+                        Payload Verify (const std::string& a_jwt, const int64_t a_now);
+
+                    public: // Inline Method(s) / Function(s)
+
+                        const Stats& stats () const;
+
+                    private: // Method(s) / Function(s)
+
+                        void        LoadKey    (const int64_t a_now);
+                        Payload     Decode     (const std::string& a_jwt);
+                        Json::Value DecodeJSON (const char* const a_data, const size_t a_length, const char* const a_what);
+                        void        Flush      ();
+                        void        Evict      (const size_t a_limit);
+
+                    private: // Static Method(s) / Function(s)
+
+                        static bool B64URLDecode (const char* const a_data, const size_t a_length, std::string& o_data);
+
+                    }; // end of class 'JWTVerifier'
+
+                    /**
+                     * @return Read-only access to cache counters.
+                     */
+                    inline const JWTVerifier::Stats& JWTVerifier::stats () const
+                    {
+                        return stats_;
+                    }
+
+                } // end of namespace 'pub'
+
+            } // end of namespace 'cdn'
+
+        } // end of namespace 'broker'
+
+    } // end of namespace 'casper'
+
+} // end of namespace 'ngx'
+
+#endif // NRS_NGX_CASPER_BROKER_CDN_PUBLIC_JWT_VERIFIER_H_
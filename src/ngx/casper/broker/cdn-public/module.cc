@@ -27,6 +27,8 @@
 
 #include "ngx/casper/broker/cdn-public/module/version.h"
 
+#include "ngx/casper/broker/cdn-public/jwt_verifier.h"
+
 #include "ngx/casper/broker/cdn-common/errors.h"
 
 #include "ngx/casper/broker/cdn-common/exception.h"
@@ -35,12 +37,13 @@
 
 #include "ngx/version.h"
 
-#include "cc/auth/jwt.h"
-#include "cc/auth/exception.h"
+#include "cc/auth/jwt.h" // MakeBrowsersUnhappy
 
 const char* const ngx::casper::broker::cdn::pub::Module::sk_rx_content_type_ = "application/octet-stream";
 const char* const ngx::casper::broker::cdn::pub::Module::sk_tx_content_type_ = "application/vnd.api+json;charset=utf-8";
 
+const std::set<std::string> ngx::casper::broker::cdn::pub::Module::sk_supported_content_types_ = { "*/*" };
+
 ngx::casper::broker::cdn::Archive::Settings ngx::casper::broker::cdn::pub::Module::s_public_archive_settings_ = {
     /* directories_ */ {
         /* temporary_prefix_ */ "",
@@ -152,6 +155,9 @@ x_content_disposition_(
                 NGX_BROKER_MODULE_SET_INTERNAL_SERVER_ERROR(ctx_, "Unable to parse 'jwt_iss' directive data!");
             } else if ( true == s_jwt_config_.allowed_iss_.isNull() || Json::ValueType::arrayValue != s_jwt_config_.allowed_iss_.type() || 0 == s_jwt_config_.allowed_iss_.size() ) {
                 NGX_BROKER_MODULE_SET_INTERNAL_SERVER_ERROR(ctx_, "Invalid 'jwt_iss' directive data format!");
+            } else {
+                ngx::casper::broker::cdn::pub::JWTVerifier::GetInstance().Startup(s_jwt_config_.rsa_public_key_uri_, s_jwt_config_.allowed_iss_,
+                                                                                 static_cast<size_t>(a_ngx_loc_conf.jwt_cache_max_entries));
             }
             s_jwt_config_.set_ = true;
         } catch (const Json::Exception& a_json_exception) {
@@ -224,74 +230,57 @@ ngx_int_t ngx::casper::broker::cdn::pub::Module::Setup ()
 
     try {
         
-        for ( Json::ArrayIndex idx = 0; idx < s_jwt_config_.allowed_iss_.size() ; ++idx ) {
-            
-            // .. try to decode JWT w/ current 'ISS'...
-            ::cc::auth::JWT jwt(s_jwt_config_.allowed_iss_[idx].asCString());
-            
-            try {
-                
-                jwt.Decode(b64, s_jwt_config_.rsa_public_key_uri_);
-                                
-                const Json::Value exp = jwt.GetRegisteredClaim(::cc::auth::JWT::RegisteredClaim::EXP);
-                if ( true == exp.isNull() ) {
-                    NGX_BROKER_MODULE_THROW_EXCEPTION(ctx_, "JWT %s claim is required!", "exp");
-                }
-                if ( exp.asInt64() <= static_cast<Json::Int64>(now) ) {
-                    NGX_BROKER_MODULE_THROW_EXCEPTION(ctx_, "JWT is %s!", "expired");
-                }
-                
-                const Json::Value nbf = jwt.GetRegisteredClaim(::cc::auth::JWT::RegisteredClaim::NBF);
-                if ( false == nbf.isNull() && nbf.asInt64() > static_cast<Json::Int64>(now) ) {
-                    NGX_BROKER_MODULE_THROW_EXCEPTION(ctx_, "JWT is %s!", "ahead of time");
-                }
-                                
-                //
-                // expected payload object 'archive'
-                // ...
-                // "archive": {
-                //     "id:" <string>,
-                //     "entity_id": <numeric>,
-                //     "user_id": <numeric>
-                // }
-                // ....
-                //
-                
-                const Json::Value archive = jwt.GetUnregisteredClaim("archive");
-                if ( true == archive.isNull() || false == archive.isObject() ) {
-                    NGX_BROKER_MODULE_THROW_EXCEPTION(ctx_, "JWT unregistered claim '%s': not set or invalid!", "archive");
-                }
-
-                // ... fake headers so we can keep the archive module behaviour ...
-                for ( auto& member : { std::string("entity_id"), std::string("user_id") } ) {
-                    if ( true == archive.isMember(member) && true == archive[member].isConvertibleTo(Json::ValueType::stringValue) ) {
-                        std::string key = member; std::replace(key.begin(), key.end(), '_', '-');
-                        fake_headers_["x-casper-" + key] = archive[member].asString();
-                    }
-                }
-                fake_headers_["X-CASPER-MODULE-MASK"] = "0x20000000";
-                
-                const Json::Value& id = archive.get("id", Json::Value::null);
-                if ( true == id.isNull() || false == id.isString()|| 0 == id.asString().length() ) {
-                    NGX_BROKER_MODULE_THROW_EXCEPTION(ctx_, "Invalid or missing '%s': field!", "id");
-                }
-                
-                // ... simulate uri ...
-                uri_ = '/' + id.asString();
-                
-                // ... x_id_ is set ...
-                ctx_.response_.return_code_ = NGX_OK;
-                
-                // ... we're done here  ...
-                break;
-                
-            }  catch (const ::cc::auth::Exception& a_cc_auth_exception) {
-                // ... track exception ...
-                NGX_BROKER_MODULE_SET_BAD_REQUEST_EXCEPTION(ctx_, a_cc_auth_exception);
+        // ... verify signature and 'ISS' ( public key and recently verified tokens are kept per worker ) ...
+        const ngx::casper::broker::cdn::pub::JWTVerifier::Payload payload = ngx::casper::broker::cdn::pub::JWTVerifier::GetInstance().Verify(b64, now);
+        
+        const Json::Value& exp = payload->get("exp", Json::Value::null);
+        if ( true == exp.isNull() ) {
+            NGX_BROKER_MODULE_THROW_EXCEPTION(ctx_, "JWT %s claim is required!", "exp");
+        }
+        if ( exp.asInt64() <= static_cast<Json::Int64>(now) ) {
+            NGX_BROKER_MODULE_THROW_EXCEPTION(ctx_, "JWT is %s!", "expired");
+        }
+        
+        const Json::Value& nbf = payload->get("nbf", Json::Value::null);
+        if ( false == nbf.isNull() && nbf.asInt64() > static_cast<Json::Int64>(now) ) {
+            NGX_BROKER_MODULE_THROW_EXCEPTION(ctx_, "JWT is %s!", "ahead of time");
+        }
+        
+        //
+        // expected payload object 'archive'
+        // ...
+        // "archive": {
+        //     "id:" <string>,
+        //     "entity_id": <numeric>,
+        //     "user_id": <numeric>
+        // }
+        // ....
+        //
+        
+        const Json::Value& archive = payload->get("archive", Json::Value::null);
+        if ( true == archive.isNull() || false == archive.isObject() ) {
+            NGX_BROKER_MODULE_THROW_EXCEPTION(ctx_, "JWT unregistered claim '%s': not set or invalid!", "archive");
+        }
+        
+        // ... fake headers so we can keep the archive module behaviour ...
+        for ( auto& member : { std::string("entity_id"), std::string("user_id") } ) {
+            if ( true == archive.isMember(member) && true == archive[member].isConvertibleTo(Json::ValueType::stringValue) ) {
+                std::string key = member; std::replace(key.begin(), key.end(), '_', '-');
+                fake_headers_["x-casper-" + key] = archive[member].asString();
             }
-            
-            // ... 'ISS' not accepted, try next one ...
         }
+        fake_headers_["X-CASPER-MODULE-MASK"] = "0x20000000";
+        
+        const Json::Value& id = archive.get("id", Json::Value::null);
+        if ( true == id.isNull() || false == id.isString()|| 0 == id.asString().length() ) {
+            NGX_BROKER_MODULE_THROW_EXCEPTION(ctx_, "Invalid or missing '%s': field!", "id");
+        }
+        
+        // ... simulate uri ...
+        uri_ = '/' + id.asString();
+        
+        // ... x_id_ is set ...
+        ctx_.response_.return_code_ = NGX_OK;
         
     } catch (const Json::Exception& a_json_exception) {
         // ... track exception ...
@@ -299,6 +288,9 @@ ngx_int_t ngx::casper::broker::cdn::pub::Module::Setup ()
     } catch (const ngx::casper::broker::Exception& a_broker_exception) {
         // ... track exception ...
         NGX_BROKER_MODULE_SET_BAD_REQUEST_EXCEPTION(ctx_, a_broker_exception);
+    } catch (const ::cc::Exception& a_cc_exception) {
+        // ... public key not available ...
+        NGX_BROKER_MODULE_SET_INTERNAL_SERVER_ERROR(ctx_, a_cc_exception.what());
     }
     // ... done ...
     return ctx_.response_.return_code_;
@@ -678,7 +670,7 @@ ngx_int_t ngx::casper::broker::cdn::pub::Module::Factory (ngx_http_request_t* a_
         /* in_headers_              */ {},
         /* config_                  */ {},
         /* locale_                  */ "",
-        /* supported_content_types_ */ { "*/*" }
+        /* supported_content_types_ */ &sk_supported_content_types_
     };
 
     ngx_int_t rv = ngx::casper::broker::Module::WarmUp(ngx_http_casper_broker_cdn_public_module, a_r, loc_conf->log_token,
@@ -722,7 +714,7 @@ ngx_int_t ngx::casper::broker::cdn::pub::Module::Factory (ngx_http_request_t* a_
 
     return ::ngx::casper::broker::Module::Initialize(config, params,
                                                      [&config, &params, &broker_conf, &loc_conf] () -> ::ngx::casper::broker::Module* {
-                                                         return new ::ngx::casper::broker::cdn::pub::Module(config, params, *broker_conf, *loc_conf );
+                                                         return new (config.ngx_ptr_) ::ngx::casper::broker::cdn::pub::Module(config, params, *broker_conf, *loc_conf );
                                                      }
     );
 }
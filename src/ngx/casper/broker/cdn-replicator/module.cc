@@ -31,6 +31,8 @@
 
 #include "ngx/casper/broker/cdn-common/exception.h"
 
+#include "ngx/casper/broker/cdn-common/hasher.h"
+
 #include "ngx/version.h"
 
 #include <regex>   // std::regex
@@ -38,6 +40,8 @@
 const char* const ngx::casper::broker::cdn::replicator::Module::sk_rx_content_type_ = "application/octet-stream";
 const char* const ngx::casper::broker::cdn::replicator::Module::sk_tx_content_type_ = "application/vnd.api+json;charset=utf-8";
 
+const std::set<std::string> ngx::casper::broker::cdn::replicator::Module::sk_supported_content_types_ = { "*/*" };
+
 ngx::casper::broker::cdn::replicator::Module::Config ngx::casper::broker::cdn::replicator::Module::s_config_ = {
     /* replicator_dir_prefix_ */ "",
     /* loaded_                */ false
@@ -96,7 +100,11 @@ ngx::casper::broker::cdn::replicator::Module::Module (const ngx::casper::broker:
                                            }
  ),
     archive_(/* a_archivist */ NGX_INFO, /* a_writer */ NGX_CASPER_BROKER_CDN_REPLICATOR_MODULE_INFO, s_ast_config_, ctx_.request_.headers_, s_h2e_map_, s_config_.replicator_dir_prefix_, /* a_replicator */ NGX_CASPER_BROKER_CDN_REPLICATOR_MODULE_INFO),
-    x_id_("X-NUMERIC-ID"), x_moves_uri_("X-STRING-ID"), x_replaces_id_("X-CASPER-REPLACES-ID")
+    x_id_("X-NUMERIC-ID"), x_moves_uri_("X-STRING-ID"), x_replaces_id_("X-CASPER-REPLACES-ID"),
+    integrity_ {
+        /* ticket_ */ 0,
+        /* check_  */ { /* md_ */ nullptr, /* value_ */ "" }
+    }
 {
     // ...
     body_read_supported_methods_ = {
@@ -115,6 +123,10 @@ ngx::casper::broker::cdn::replicator::Module::Module (const ngx::casper::broker:
         }
         s_config_.loaded_ = true;
     }
+    // ... content digest, algorithm was validated at configuration time ...
+    if ( a_ngx_loc_conf.cdn.integrity.digest.len > 0 ) {
+        archive_.digest(ngx::casper::broker::cdn::Digest::Lookup(std::string(reinterpret_cast<const char*>(a_ngx_loc_conf.cdn.integrity.digest.data), a_ngx_loc_conf.cdn.integrity.digest.len)));
+    }
 }
 
 /**
@@ -122,7 +134,9 @@ ngx::casper::broker::cdn::replicator::Module::Module (const ngx::casper::broker:
  */
 ngx::casper::broker::cdn::replicator::Module::~Module ()
 {
-    /* empty */
+    if ( 0 != integrity_.ticket_ ) {
+        ngx::casper::broker::cdn::Hasher::GetInstance().Cancel(integrity_.ticket_);
+    }
 }
 
 #ifdef __APPLE__
@@ -221,20 +235,28 @@ ngx_int_t ngx::casper::broker::cdn::replicator::Module::Setup ()
     }
     
     // ... grab xattrs to replicate ...
-    for ( auto attr : ctx_.request_.headers_ ) {
+    for ( const auto& attr : ctx_.request_.headers_ ) {
         // ... if it's not an user.com.cldware.archive xattr ...
         if ( 0 != strncasecmp(attr.first.c_str(), "x-user-com-cldware-", sizeof(char) * 19) ) {
             // ... next ...
             continue;
         }
-        // .. translate key to . notation ...
-        std::string key = attr.first;
-        std::replace(key.begin(), key.end(), '-', '.');
-        std::replace(key.begin(), key.end(), '_', '-');
-        // ... skip 'x-user-' ...
-        key = XATTR_ARCHIVE_PREFIX + std::string(key, sizeof(char) * 7, std::string::npos);
+        // ... known xattr? key was translated when h2e map was loaded ...
+        const std::string* known = s_h2e_map_.XAttr(attr.first);
+        if ( nullptr != known ) {
+            replication_.old_.xattrs_[*known] = attr.second;
+            continue;
+        }
+        // ... translate key to . notation, skipping 'x-user-', in a single pass ...
+        std::string key;
+        key.reserve(sizeof(XATTR_ARCHIVE_PREFIX) - sizeof(char) + attr.first.length() - ( sizeof(char) * 7 ));
+        key = XATTR_ARCHIVE_PREFIX;
+        for ( size_t idx = sizeof(char) * 7 ; idx < attr.first.length() ; ++idx ) {
+            const char ch = attr.first[idx];
+            key += ( '-' == ch ? '.' : ( '_' == ch ? '-' : ch ) );
+        }
         // ... track xattr ...
-        replication_.old_.xattrs_[key] = attr.second;
+        replication_.old_.xattrs_[std::move(key)] = attr.second;
     }
 
     // ... intercept body?
@@ -384,10 +406,12 @@ ngx_int_t ngx::casper::broker::cdn::replicator::Module::Run ()
             NGX_BROKER_MODULE_SET_INTERNAL_SERVER_ERROR(ctx_, a_cc_exception.what());
         }
     }
-    // ... since there is no async operations ...
+    // ... the only async operation is content digest validation ...
     if ( NGX_OK != ctx_.response_.return_code_ ) {
         // ... something went wrong, try to rollback action ...
         TryRollback();
+    } else if ( 0 != integrity_.ticket_ ) {
+        // ... commit or rollback when content digest is known ...
     } else {
         // ... commit and we're done ...
         Commit();
@@ -531,27 +555,60 @@ void ngx::casper::broker::cdn::replicator::Module::SetReplicationInfoAttr (const
 /**
  * @brief Validate new written file, on success set final response.
  *
+ * @remarks When \link Hasher \link worker threads are running, content digest is calculated there and response is set asynchronously.
+ *
  * @param a_info New file basic information.
  */
 void ngx::casper::broker::cdn::replicator::Module::ValidateAndSetResponse (const ngx::casper::broker::cdn::Archive::RInfo& a_info)
 {
+    ngx::casper::broker::cdn::Archive::DigestCheck* check = ( true == ngx::casper::broker::cdn::Hasher::GetInstance().enabled() ? &integrity_.check_ : nullptr );
+    
+    bool deferred_digest;
     // ... now validate file integrity ...
     if ( NGX_HTTP_POST == ctx_.ngx_ptr_->method ) {
         // ... id should be aready set correctly ...
-        archive_.Validate(ctx_.request_.uri_ + "/" + replication_.new_.id_,
-                          &replication_.old_.xattrs_[XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5"],
-                          /* a_id */ nullptr,
-                          &replication_.old_.xattrs_
+        deferred_digest = archive_.Validate(ctx_.request_.uri_ + "/" + replication_.new_.id_,
+                                            &replication_.old_.xattrs_[XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5"],
+                                            /* a_id */ nullptr,
+                                            &replication_.old_.xattrs_,
+                                            /* a_deep */ true, /* o_check */ check
         );
     } else {
         // ... since we are writing to a temporary file, id must be compared agains it's xattr ...
-        archive_.Validate(ctx_.request_.uri_ + "/" + replication_.new_.id_,
-                          &replication_.old_.xattrs_[XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5"],
-                          &replication_.new_.xattrs_[XATTR_ARCHIVE_PREFIX "com.cldware.archive.id"],
-                          &replication_.old_.xattrs_
+        deferred_digest = archive_.Validate(ctx_.request_.uri_ + "/" + replication_.new_.id_,
+                                            &replication_.old_.xattrs_[XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5"],
+                                            &replication_.new_.xattrs_[XATTR_ARCHIVE_PREFIX "com.cldware.archive.id"],
+                                            &replication_.old_.xattrs_,
+                                            /* a_deep */ true, /* o_check */ check
+        );
+    }
+    
+    // ... waiting for content digest?
+    if ( true == deferred_digest ) {
+        // ... from now on the response will be asynchronous ...
+        ctx_.response_.asynchronous_ = true;
+        ctx_.response_.return_code_  = NGX_OK;
+        integrity_.ticket_ = ngx::casper::broker::cdn::Hasher::GetInstance().Submit(a_info.new_uri_, integrity_.check_.md_,
+            {
+                /* success_ */
+                Deferred<const std::string&, const std::string&>(std::bind(&ngx::casper::broker::cdn::replicator::Module::OnContentDigestSucceeded, this, std::placeholders::_1)),
+                /* failure_ */
+                Deferred<const ::cc::Exception&>(std::bind(&ngx::casper::broker::cdn::replicator::Module::OnContentDigestFailed, this, std::placeholders::_1))
+            }
         );
+        return;
     }
     
+    SetResponse(a_info);
+}
+
+/**
+ * @brief Set final response.
+ *
+ * @param a_info New file basic information.
+ */
+void ngx::casper::broker::cdn::replicator::Module::SetResponse (const ngx::casper::broker::cdn::Archive::RInfo& a_info)
+{
     // ... prepare response ...
     json_value_               = Json::Value(Json::ValueType::objectValue);
     json_value_["id"  ]       = replication_.new_.xattrs_[XATTR_ARCHIVE_PREFIX "com.cldware.archive.id"];
@@ -582,6 +639,52 @@ void ngx::casper::broker::cdn::replicator::Module::ValidateAndSetResponse (const
     ctx_.response_.return_code_ = NGX_OK;
 }
 
+#ifdef __APPLE__
+#pragma mark - HELPER METHODS - Integrity
+#endif
+
+/**
+ * @brief This method will be called when the content digest of the replicated file is calculated.
+ *
+ * @param a_value Calculated MD5 or digest.
+ */
+void ngx::casper::broker::cdn::replicator::Module::OnContentDigestSucceeded (const std::string& a_value)
+{
+    integrity_.ticket_ = 0;
+    // ... mismatch?
+    if ( 0 != integrity_.check_.value_.compare(a_value) ) {
+        // ... yes, same error as synchronous validation ...
+        OnContentDigestFailed(::cc::Exception(nullptr == integrity_.check_.md_ ? "MD5 mismatch!" : "Digest mismatch!"));
+        return;
+    }
+    // ... no, accept new file ...
+    try {
+        SetResponse(r_info_);
+        Commit();
+    } catch (const ::cc::Exception& a_cc_exception) {
+        TryRollback();
+        NGX_BROKER_MODULE_SET_INTERNAL_SERVER_ERROR(ctx_, a_cc_exception.what());
+    }
+    // ... finalize request ...
+    NGX_BROKER_MODULE_FINALIZE_REQUEST(this);
+}
+
+/**
+ * @brief This method will be called when the content digest of the replicated file can't be calculated.
+ *
+ * @param a_exception Error that occurred.
+ */
+void ngx::casper::broker::cdn::replicator::Module::OnContentDigestFailed (const ::cc::Exception& a_exception)
+{
+    integrity_.ticket_ = 0;
+    // ... keep 'old' or 'current' file ...
+    TryRollback();
+    // ... set error ...
+    NGX_BROKER_MODULE_SET_INTERNAL_SERVER_ERROR(ctx_, a_exception.what());
+    // ... finalize request ...
+    NGX_BROKER_MODULE_FINALIZE_REQUEST(this);
+}
+
 #ifdef __APPLE__
 #pragma mark - HELPER METHODS - Commit & Rollback
 #endif
@@ -673,7 +776,7 @@ ngx_int_t ngx::casper::broker::cdn::replicator::Module::Factory (ngx_http_reques
         /* in_headers_              */ {},
         /* config_                  */ {},
         /* locale_                  */ "",
-        /* supported_content_types_ */ { "*/*" }
+        /* supported_content_types_ */ &sk_supported_content_types_
     };
 
     ngx_int_t rv = ngx::casper::broker::Module::WarmUp(ngx_http_casper_broker_cdn_replicator_module, a_r, loc_conf->log_token,
@@ -717,7 +820,7 @@ ngx_int_t ngx::casper::broker::cdn::replicator::Module::Factory (ngx_http_reques
 
     return ::ngx::casper::broker::Module::Initialize(config, params,
                                                      [&config, &params, &broker_conf, &loc_conf] () -> ::ngx::casper::broker::Module* {
-                                                         return new ::ngx::casper::broker::cdn::replicator::Module(config, params, *broker_conf, *loc_conf );
+                                                         return new (config.ngx_ptr_) ::ngx::casper::broker::cdn::replicator::Module(config, params, *broker_conf, *loc_conf );
                                                      }
     );
 }
@@ -59,6 +59,7 @@ namespace ngx
 
                         static const char* const sk_rx_content_type_;
                         static const char* const sk_tx_content_type_;
+                        static const std::set<std::string> sk_supported_content_types_;
 
                     private: // Data Types
                         
@@ -90,6 +91,13 @@ namespace ngx
                         XStringID           x_replaces_id_;
                         XArchivedBy         x_replicator_agent_;
                         ReplicationData     replication_;
+                        
+                        typedef struct {
+                            uint64_t             ticket_;
+                            Archive::DigestCheck check_;
+                        } Integrity;
+                        
+                        Integrity           integrity_;
                                                 
                     protected: // Constructor(s)
 
@@ -117,6 +125,14 @@ namespace ngx
                         
                         void SetReplicationInfoAttr (const char* const a_operation);
                         void ValidateAndSetResponse (const Archive::RInfo& a_info);
+                        void SetResponse            (const Archive::RInfo& a_info);
+                        
+                    private: // Method(s) / Function(s) - Integrity
+
+                        void OnContentDigestSucceeded (const std::string& a_value);
+                        void OnContentDigestFailed    (const ::cc::Exception& a_exception);
+                        
+                    private: // Method(s) / Function(s)
                         
                         void Commit                 ();
                         void TryRollback            ();
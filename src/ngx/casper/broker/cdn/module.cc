@@ -28,6 +28,8 @@
 const char* const ngx::casper::broker::cdn::Module::sk_rx_content_type_ = "application/json";
 const char* const ngx::casper::broker::cdn::Module::sk_tx_content_type_ = "application/json;charset=utf-8";
 
+const std::set<std::string> ngx::casper::broker::cdn::Module::sk_supported_content_types_ = { "application/json", "application/text" };
+
 /**
  * @brief Default constructor.
  *
@@ -90,10 +92,10 @@ ngx_int_t ngx::casper::broker::cdn::Module::Run ()
             break;
         }
         case NGX_HTTP_POST:
-            if ( nullptr == ctx_.request_.body_ ) {
+            if ( nullptr == Body() ) {
                 return NGX_BROKER_MODULE_SET_BAD_REQUEST_ERROR_I18N(ctx_, "BROKER_MISSING_OR_INVALID_BODY_ERROR");
             } else {
-                jwt_b64 = ctx_.request_.body_;
+                jwt_b64 = Body();
             }
             break;
         default:
@@ -147,7 +149,7 @@ ngx_int_t ngx::casper::broker::cdn::Module::Factory (ngx_http_request_t* a_r, bo
         /* in_headers_              */ {},
         /* config_                  */ {},
         /* locale_                  */ "",
-        /* supported_content_types_ */ { "application/json", "application/text" }
+        /* supported_content_types_ */ &sk_supported_content_types_
     };
     
     ngx_int_t rv = ngx::casper::broker::Module::WarmUp(ngx_http_casper_broker_cdn_module, a_r, loc_conf->log_token,
@@ -193,7 +195,7 @@ ngx_int_t ngx::casper::broker::cdn::Module::Factory (ngx_http_request_t* a_r, bo
     
     return ::ngx::casper::broker::Module::Initialize(config, params,
                                                      [&config, &params, &broker_conf, &loc_conf] () -> ::ngx::casper::broker::Module* {
-                                                         return new ::ngx::casper::broker::cdn::Module(config, params, *broker_conf, *loc_conf);
+                                                         return new (config.ngx_ptr_) ::ngx::casper::broker::cdn::Module(config, params, *broker_conf, *loc_conf);
                                                      }
     );
 }
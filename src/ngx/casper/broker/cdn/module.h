@@ -50,6 +50,7 @@ namespace ngx
 
                     static const char* const sk_rx_content_type_;
                     static const char* const sk_tx_content_type_;
+                    static const std::set<std::string> sk_supported_content_types_;
 
                 private: // Const Data
 
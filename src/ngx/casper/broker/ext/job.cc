@@ -21,6 +21,8 @@
 
 #include "ngx/casper/broker/ext/job.h"
 
+#include "ngx/casper/broker/ext/job_channels.h"
+
 #include "cc/b64.h"
 
 #include "ev/beanstalk/producer.h"
@@ -35,6 +37,24 @@
 
 #include "ngx/version.h"
 
+ngx::casper::broker::ext::Job::Producers ngx::casper::broker::ext::Job::s_producers_;
+uint64_t                                 ngx::casper::broker::ext::Job::s_producers_clock_ = 0;
+
+const size_t ngx::casper::broker::ext::Job::sk_max_producers_ = 32;
+
+//
+// KEYS[1] - job key ( '<service id>:jobs:<tube>:<id>' )
+// ARGV[1] - initial status
+// ARGV[2] - expires in ( seconds )
+//
+// Returns 1.
+//
+ngx::casper::broker::Script ngx::casper::broker::ext::Job::s_submit_script_(
+    "redis.call('HSET', KEYS[1], 'status', ARGV[1])\n"
+    "redis.call('EXPIRE', KEYS[1], ARGV[2])\n"
+    "return 1\n"
+);
+
 /**
  * @brief Default constructor.
  *
@@ -130,15 +150,15 @@ ngx::casper::broker::ext::Job::Job (ngx::casper::broker::Module::CTX& a_ctx, ngx
     // ... if no error set ...
     if ( NGX_OK == ctx_.response_.return_code_ ) {
         // ... casper-extra-job-params ...
-        const auto casper_extra_job_params_it = a_params.in_headers_.find("casper-extra-job-params");
-        if ( a_params.in_headers_.end() != casper_extra_job_params_it ) {
+        std::string casper_extra_job_params;
+        if ( true == a_params.in_headers_.Get("casper-extra-job-params", casper_extra_job_params) ) {
             // ... decode and parse 'casper-extra-job-params' data ...
             std::string payload;
             try {
-                payload = ::cc::base64_url_unpadded::decode<std::string>(casper_extra_job_params_it->second);
+                payload = ::cc::base64_url_unpadded::decode<std::string>(casper_extra_job_params);
             } catch (...) {
                 try {
-                    payload = ::cc::base64_rfc4648::decode<std::string>(casper_extra_job_params_it->second);
+                    payload = ::cc::base64_rfc4648::decode<std::string>(casper_extra_job_params);
                 } catch (const std::domain_error& a_d_e) {
                     NGX_BROKER_MODULE_SET_BAD_REQUEST_ERROR(ctx_,
                             ( std::string("An error occurred while decoding 'casper-extra-job-params': ") +  a_d_e.what() ).c_str()
@@ -225,7 +245,7 @@ ngx::casper::broker::ext::Job::Job (ngx::casper::broker::Module::CTX& a_ctx, ngx
 ngx::casper::broker::ext::Job::~Job ()
 {
     ::ev::scheduler::Scheduler::GetInstance().Unregister(this);
-    ::ev::redis::subscriptions::Manager::GetInstance().Unubscribe(this);
+    ngx::casper::broker::ext::JobChannels::GetInstance().Unsubscribe(this);
 }
 
 #ifdef __APPLE__
@@ -377,67 +397,94 @@ ngx_int_t ngx::casper::broker::ext::Job::Submit (const Json::Value& a_object,
     job_expires_in_  = job_validity_ + job_ttr_;
     job_tube_        = job_object_["tube"].asString();
 
-    // ... yes ... run a task to reserve it ...
+    // ... yes ... run a task to reserve it, id allocation ...
     module_ptr_->NewTask([this] () -> ::ev::Object* {
                          
         // ...  get new job id ...
         return new ::ev::redis::Request(ctx_.loggable_data_ref_, "INCR", {
-            /* key   */ job_id_key_
+            /* key */ job_id_key_
         });
                          
-     })->Then([this] (::ev::Object* a_object_prev) -> ::ev::Object* {
+    })->Finally([this, a_success_callback, a_failure_callback] (::ev::Object* a_object_prev) {
         
         //
         // INCR:
         //
         // - An integer reply is expected:
         //
-        //  - the value of key after the increment
+        //  - the value of job id key after the increment
         //
         const ::ev::redis::Value& value = ::ev::redis::Reply::EnsureIntegerReply(a_object_prev);
         
         job_object_["id"] = std::to_string(value.Integer());
         
         // ... set job key ...
-        job_key_     = ( module_ptr_->service_id_ + ":jobs:" + job_object_["tube"].asString() + ':' + job_object_["id"].asString() );
-        job_channel_ = ( module_ptr_->service_id_ + ':' + job_object_["tube"].asString() + ':' + job_object_["id"].asString() );
+        job_key_     = ( module_ptr_->service_id_ + ":jobs:" + job_tube_ + ':' + job_object_["id"].asString() );
+        job_channel_ = ( module_ptr_->service_id_ + ':' + job_tube_ + ':' + job_object_["id"].asString() );
+
+        // ... patch job id and tube ...
+        job_object_["payload"]["id"] = job_object_["id"];
+        if ( false == job_object_["payload"].isMember("tube") ) {
+            job_object_["payload"]["tube"] = job_tube_;
+        }
         
-        // ... first, set queued status ...
-        return new ::ev::redis::Request(ctx_.loggable_data_ref_, "HSET", {
-            /* key   */ job_key_,
-            /* field */ "status", "{\"status\":\"queued\"}"
-        });
+        // ... queued status and expiration, in a single round trip ...
+        Queue(a_success_callback, a_failure_callback, /* a_retry */ true);
         
-    })->Then([this] (::ev::Object* a_object_prev) -> ::ev::Object* {
+    })->Catch([this, a_failure_callback] (const ::ev::Exception& a_ev_exception) {
         
-        //
-        // HSET:
-        //
-        // - An integer reply is expected:
-        //
-        //  - 1 if field is a new field in the hash and value was set.
-        //  - 0 if field already exists in the hash and the value was updated.
-        //
-        (void)::ev::redis::Reply::EnsureIntegerReply(a_object_prev);
+        OnSubmitFailure(a_failure_callback, a_ev_exception);
+        
+    });
+    
+    // ... if not controlled externally ...
+    if ( nullptr == a_success_callback ) {
+        // ... job id reservation is an asynchronous operation ...
+        // ... so this module response is also asynchronous ...
+        ctx_.response_.asynchronous_ = true;
+        ctx_.response_.return_code_ = NGX_OK;
+        // ... we're done ...
+        return ctx_.response_.return_code_;
+    } else {
+        // ... we're done ...
+        return NGX_OK;
+    }
+    
+}
+
+/**
+ * @brief Set a reserved job queued status and expiration, then put it to beanstalkd.
+ *
+ * @param a_success_callback
+ * @param a_failure_callback
+ * @param a_retry            When true, and the server doesn't know the script, it's sent again ( once, now with EVAL ).
+ */
+void ngx::casper::broker::ext::Job::Queue (const std::function<void()> a_success_callback,
+                                           const std::function<void(const ::ev::Exception&)> a_failure_callback,
+                                           const bool a_retry)
+{
+    module_ptr_->NewTask([this] () -> ::ev::Object* {
         
-        return new ::ev::redis::Request(ctx_.loggable_data_ref_, "EXPIRE", { job_key_, std::to_string(job_expires_in_) });
+        // ... set job status and expiration, job key is declared so the script can run on a REDIS cluster ...
+        return s_submit_script_.NewRequest(ctx_.loggable_data_ref_,
+                                           /* a_keys */ { job_key_ },
+                                           /* a_args */ {
+                                               /* status */ "{\"status\":\"queued\"}",
+                                               /* expire */ std::to_string(job_expires_in_)
+                                           }
+        );
         
     })->Finally([this, a_success_callback] (::ev::Object* a_object_prev) {
         
         //
-        // EXPIRE:
+        // EVAL / EVALSHA:
         //
-        // Integer reply, specifically:
-        // - 1 if the timeout was set.
-        // - 0 if key does not exist or the timeout could not be set.
+        // - An integer reply is expected.
         //
-        ::ev::redis::Reply::EnsureIntegerReply(a_object_prev, 1);
-
-        // ... patch job id and tube ...
-        job_object_["payload"]["id"] = job_object_["id"];
-        if ( false == job_object_["payload"].isMember("tube") ) {
-            job_object_["payload"]["tube"] = job_tube_;
-        }
+        ::ev::redis::Reply::EnsureIntegerReply(a_object_prev);
+        
+        // ... script is now cached by the server, next submissions can use it's SHA1 ...
+        s_submit_script_.Loaded();
 
         if ( nullptr == a_success_callback ) {
             // ...ADD the job to beanstalkd and wait for reply ...
@@ -447,13 +494,7 @@ ngx_int_t ngx::casper::broker::ext::Job::Submit (const Json::Value& a_object,
             // ... connect and sent job ...
             try {
                 
-                ::ev::beanstalk::Producer producer(beanstalk_config_, job_tube_);
-                
-                const int64_t status = producer.Put(json_writer_.write(job_object_["payload"]),
-                                                    /* a_priority = 0 */ 0,
-                                                    /* a_delay = 0 */ 0,
-                                                    static_cast<uint32_t>(job_ttr_)
-                );
+                const int64_t status = PutJob(job_tube_, json_writer_.write(job_object_["payload"]));
                 
                 if ( status < 0 ) {
                     throw ::ev::Exception("Beanstalk producer returned with error code ( " +  std::to_string(status) + " ) " + ::ev::beanstalk::Producer::ErrorCodeToString(status) + ", while adding job '"
@@ -469,32 +510,36 @@ ngx_int_t ngx::casper::broker::ext::Job::Submit (const Json::Value& a_object,
             a_success_callback();
         }
         
-    })->Catch([this, a_failure_callback] (const ::ev::Exception& a_ev_exception) {
+    })->Catch([this, a_success_callback, a_failure_callback, a_retry] (const ::ev::Exception& a_ev_exception) {
         
-        if ( nullptr == a_failure_callback ) {
-            // ... and error occurred while trying to subscribe a REDIS channel ...
-            NGX_BROKER_MODULE_SET_INTERNAL_SERVER_EXCEPTION(ctx_, a_ev_exception);
-            NGX_BROKER_MODULE_FINALIZE_REQUEST_WITH_ERRORS_SERIALIZATION_RESPONSE(module_ptr_);
-        } else {
-            // ... notify caller ...
-            a_failure_callback(a_ev_exception);
+        // ... script flushed or server restarted? nothing was run, send it's source again ...
+        if ( true == s_submit_script_.Forget(a_ev_exception) && true == a_retry ) {
+            Queue(a_success_callback, a_failure_callback, /* a_retry */ false);
+            return;
         }
         
+        OnSubmitFailure(a_failure_callback, a_ev_exception);
+        
     });
-    
-    // ... if not controlled externally ...
-    if ( nullptr == a_success_callback ) {
-        // ... job id reservation is an asynchronous operation ...
-        // ... so this module response is also asynchronous ...
-        ctx_.response_.asynchronous_ = true;
-        ctx_.response_.return_code_ = NGX_OK;
-        // ... we're done ...
-        return ctx_.response_.return_code_;
+}
+
+/**
+ * @brief Report a job submission failure.
+ *
+ * @param a_failure_callback
+ * @param a_ev_exception
+ */
+void ngx::casper::broker::ext::Job::OnSubmitFailure (const std::function<void(const ::ev::Exception&)> a_failure_callback,
+                                                     const ::ev::Exception& a_ev_exception)
+{
+    if ( nullptr == a_failure_callback ) {
+        // ... and error occurred while trying to subscribe a REDIS channel ...
+        NGX_BROKER_MODULE_SET_INTERNAL_SERVER_EXCEPTION(ctx_, a_ev_exception);
+        NGX_BROKER_MODULE_FINALIZE_REQUEST_WITH_ERRORS_SERIALIZATION_RESPONSE(module_ptr_);
     } else {
-        // ... we're done ...
-        return NGX_OK;
+        // ... notify caller ...
+        a_failure_callback(a_ev_exception);
     }
-    
 }
 
 #ifdef __APPLE__
@@ -578,6 +623,68 @@ ngx_int_t ngx::casper::broker::ext::Job::HandleRedirect (const Json::Value& a_ob
 #pragma mark -
 #endif
 
+/**
+ * @brief Add a job to a beanstalkd tube, reusing this worker's connection to that tube.
+ *
+ * @param a_tube    Tube name.
+ * @param a_payload Job payload.
+ *
+ * @return Beanstalk producer status, < 0 on error.
+ */
+int64_t ngx::casper::broker::ext::Job::PutJob (const std::string& a_tube, const std::string& a_payload)
+{
+    // ... one retry, a pooled connection might have been dropped by the server or the send might fail ...
+    for ( size_t attempt = 0 ; attempt < 2 ; ++attempt ) {
+        const bool last_attempt = ( 1 == attempt );
+        auto it = s_producers_.find(a_tube);
+        try {
+            // ... connect only when there's no connection to this tube yet ...
+            if ( s_producers_.end() == it ) {
+                // ... pool is full? evict the least recently used connection ...
+                if ( s_producers_.size() >= sk_max_producers_ ) {
+                    auto lru = s_producers_.begin();
+                    for ( auto p_it = s_producers_.begin() ; s_producers_.end() != p_it ; ++p_it ) {
+                        if ( p_it->second.last_used_ < lru->second.last_used_ ) {
+                            lru = p_it;
+                        }
+                    }
+                    s_producers_.erase(lru);
+                }
+                it = s_producers_.emplace(a_tube, PooledProducer { std::unique_ptr<::ev::beanstalk::Producer>(new ::ev::beanstalk::Producer(beanstalk_config_, a_tube)), 0 }).first;
+            }
+            it->second.last_used_ = ++s_producers_clock_;
+            const int64_t status = it->second.producer_->Put(a_payload,
+                                                             /* a_priority = 0 */ 0,
+                                                             /* a_delay = 0 */ 0,
+                                                             static_cast<uint32_t>(job_ttr_)
+            );
+            if ( status < 0 ) {
+                // ... connection state is unknown, don't keep it ...
+                s_producers_.erase(a_tube);
+                // ... send or receive failed? retry with a fresh connection ...
+                if ( BS_STATUS_FAIL == status && false == last_attempt ) {
+                    continue;
+                }
+            }
+            return status;
+        } catch (const ::Beanstalk::ConnectException& a_btc_exception) {
+            s_producers_.erase(a_tube);
+            // ... nothing else to try ...
+            if ( true == last_attempt ) {
+                throw;
+            }
+        } catch (const std::exception& a_std_exception) {
+            s_producers_.erase(a_tube);
+            // ... nothing else to try, report it as a failed send ...
+            if ( true == last_attempt ) {
+                return BS_STATUS_FAIL;
+            }
+        }
+    }
+    // ... unreachable, last attempt always returns or throws ...
+    return BS_STATUS_FAIL;
+}
+
 /**
  * @brief Schedule a job.
  *
@@ -588,23 +695,25 @@ ngx_int_t ngx::casper::broker::ext::Job::HandleRedirect (const Json::Value& a_ob
 ngx_int_t ngx::casper::broker::ext::Job::ScheduleJob (const std::string& a_name)
 {
     try {
-        // ... first a REDIS channel must be subscribed ....
-        ::ev::redis::subscriptions::Manager::GetInstance().SubscribeChannels(/* a_channels */
-                                                                             { a_name },
-                                                                             /* a_status_callback */
-                                                                             std::bind(&ngx::casper::broker::ext::Job::JobSubscriptionCallback, this, std::placeholders::_1, std::placeholders::_2),
-                                                                             /* a_data_callback */
-                                                                             std::bind(&ngx::casper::broker::ext::Job::JobMessageCallback, this, std::placeholders::_1, std::placeholders::_2),
-                                                                             /* a_client */
-                                                                             this
-        );
-        
-        // ... REDIS channel subscription is an asynchronous operation ...
-        // ... so this module response ...
+        // ... REDIS pattern subscription might be an asynchronous operation ...
+        // ... so this module response is also asynchronous ( job is put only after listen returns, even if pattern is already subscribed ) ...
         ctx_.response_.asynchronous_ = true ;
         ctx_.response_.return_code_  = NGX_OK;
         
-        return ctx_.response_.return_code_;
+        // ... first a REDIS channel must be listened, through this tube shared pattern subscription ...
+        ngx::casper::broker::ext::JobChannels::GetInstance().Listen(/* a_pattern */
+                                                                    module_ptr_->service_id_ + ':' + job_tube_ + ":*",
+                                                                    /* a_channel */
+                                                                    a_name,
+                                                                    /* a_status_callback */
+                                                                    std::bind(&ngx::casper::broker::ext::Job::JobSubscriptionCallback, this, std::placeholders::_1, std::placeholders::_2),
+                                                                    /* a_data_callback */
+                                                                    std::bind(&ngx::casper::broker::ext::Job::JobMessageCallback, this, std::placeholders::_1, std::placeholders::_2),
+                                                                    /* a_client */
+                                                                    this
+        );
+        
+        return NGX_OK;
         
     } catch (const ::ev::Exception& a_ev_exception) {
         // ... and error occurred while trying to subscribe a REDIS channel ...
@@ -639,8 +748,6 @@ EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK ngx::casper::broker::ext::Job::
             
             // ... connect and sent job ...
             try {
-                                
-                ::ev::beanstalk::Producer producer(beanstalk_config_, tube);
                 
                 const std::string payload = json_writer_.write(job_object_["payload"]);
                 
@@ -726,11 +833,7 @@ EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK ngx::casper::broker::ext::Job::
                 // ... accepted?
                 if ( true == accepted ) {
 
-                    const int64_t status = producer.Put(payload,
-                                                        /* a_priority = 0 */ 0,
-                                                        /* a_delay = 0 */ 0,
-                                                        static_cast<uint32_t>(job_ttr_)
-                    );
+                    const int64_t status = PutJob(tube, payload);
                     if ( status < 0 ) {
                         // ... an error must be set ...
                         NGX_BROKER_MODULE_SET_INTERNAL_SERVER_ERROR(ctx_,
@@ -839,7 +942,7 @@ EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK ngx::casper::broker::ext::Job::
             );
             
             // ... stop accepting messages from this job ...
-            ::ev::redis::subscriptions::Manager::GetInstance().Unubscribe(this);
+            ngx::casper::broker::ext::JobChannels::GetInstance().Unsubscribe(this);
             
             // ... we must finalize request with errors serialization ...
             return [this] () {
@@ -850,7 +953,7 @@ EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK ngx::casper::broker::ext::Job::
         } else if ( '*' == a_message.c_str()[0] || '!' == a_message.c_str()[0] ) {
             
             // ... stop accepting messages from this job ...
-            ::ev::redis::subscriptions::Manager::GetInstance().Unubscribe(this);
+            ngx::casper::broker::ext::JobChannels::GetInstance().Unsubscribe(this);
 
             // ... straight response ...
             
@@ -1002,7 +1105,7 @@ EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK ngx::casper::broker::ext::Job::
             // ... if an error is set ...
             if ( NGX_HTTP_INTERNAL_SERVER_ERROR == ctx_.response_.status_code_ ) {
                 // ... stop accepting messages from this job ...
-                ::ev::redis::subscriptions::Manager::GetInstance().Unubscribe(this);
+                ngx::casper::broker::ext::JobChannels::GetInstance().Unsubscribe(this);
                 // ... we must finalize request with errors serialization ...
                 return [this] () {
                     // ... and we're done ...
@@ -1040,7 +1143,7 @@ EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK ngx::casper::broker::ext::Job::
                 } else {
                     
                     // ... stop accepting messages from this job ...
-                    ::ev::redis::subscriptions::Manager::GetInstance().Unubscribe(this);
+                    ngx::casper::broker::ext::JobChannels::GetInstance().Unsubscribe(this);
 
                     // ... response codes already set ...
                     
@@ -1055,7 +1158,7 @@ EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK ngx::casper::broker::ext::Job::
             } else if ( 0 == strcasecmp(action.asCString(), "response") ) {
                 
                 // ... stop accepting messages from this job ...
-                ::ev::redis::subscriptions::Manager::GetInstance().Unubscribe(this);
+                ngx::casper::broker::ext::JobChannels::GetInstance().Unsubscribe(this);
 
                 // ... 'response' action ...
                 
@@ -1093,7 +1196,7 @@ EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK ngx::casper::broker::ext::Job::
     }
     
     // ... stop accepting messages from this job ...
-    ::ev::redis::subscriptions::Manager::GetInstance().Unubscribe(this);
+    ngx::casper::broker::ext::JobChannels::GetInstance().Unsubscribe(this);
 
     // ... if we've reached here ( at least on error should be already set ) ...
     return [this] () {
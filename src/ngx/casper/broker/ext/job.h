@@ -27,13 +27,17 @@
 
 #include "ngx/casper/broker/module/ngx_http_casper_broker_module.h"
 
+#include "ngx/casper/broker/script.h"
+
 #include "json/json.h"
 
 #include <map>    // std::map
+#include <memory> // std::unique_ptr
 #include <string> // std::string
 
 #include "ev/loggable.h"
 #include "ev/beanstalk/config.h"
+#include "ev/beanstalk/producer.h"
 #include "ev/redis/subscriptions/manager.h"
 
 #include "ev/scheduler/scheduler.h"
@@ -61,6 +65,15 @@ namespace ngx
                         unsigned    unsigned_value_;
                     };
                     
+                private: // Data Type(s)
+                    
+                    typedef struct {
+                        std::unique_ptr<::ev::beanstalk::Producer> producer_;  //!< Connection to a tube.
+                        uint64_t                                   last_used_; //!< Value of \link s_producers_clock_ \link when last used.
+                    } PooledProducer;
+                    
+                    typedef std::map<std::string, PooledProducer> Producers;
+                    
                 protected: // data
                     
                     Json::Value             jwt_allowed_iss_;
@@ -82,6 +95,16 @@ namespace ngx
                     
                     PrimitiveProtocolEntry  primitive_protocol_ [3];
                     
+                private: // Static Data
+                    
+                    static Producers        s_producers_;
+                    static uint64_t         s_producers_clock_;
+                    static broker::Script   s_submit_script_;
+                    
+                private: // Static Const Data
+                    
+                    static const size_t      sk_max_producers_;
+                    
                 public: // Constructor(s)
 
                     Job (broker::Module::CTX& a_ctx, Module* a_module,
@@ -107,6 +130,12 @@ namespace ngx
                     
                 private:  // Method(s) / Function(s)
                     
+                    void                                             Queue                   (const std::function<void()> a_success_callback,
+                                                                                              const std::function<void(const ::ev::Exception&)> a_failure_callback,
+                                                                                              const bool a_retry);
+                    void                                             OnSubmitFailure         (const std::function<void(const ::ev::Exception&)> a_failure_callback,
+                                                                                              const ::ev::Exception& a_ev_exception);
+                    int64_t                                          PutJob                  (const std::string& a_tube, const std::string& a_payload);
                     ngx_int_t                                        ScheduleJob             (const std::string& a_name);
                     EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK JobSubscriptionCallback (const std::string& a_name, const ::ev::redis::subscriptions::Manager::Status& a_status);
                     EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK JobMessageCallback      (const std::string& a_name, const std::string & a_message);
@@ -0,0 +1,243 @@
+/**
+ * @file job_channels.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ngx/casper/broker/ext/job_channels.h"
+
+#include <vector> // std::vector
+
+/**
+ * @brief Forget all listeners and stop listening to all patterns.
+ */
+void ngx::casper::broker::ext::JobChannels::Shutdown ()
+{
+    if ( true == registered_ ) {
+        ::ev::scheduler::Scheduler::GetInstance().Unregister(this);
+        registered_ = false;
+    }
+    ready_.clear();
+    if ( patterns_.size() > 0 ) {
+        ::ev::redis::subscriptions::Manager::GetInstance().Unubscribe(this);
+        patterns_.clear();
+    }
+    listeners_.clear();
+    clients_.clear();
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Listen to a channel through a shared pattern subscription.
+ *
+ * @param a_pattern         Pattern that matches \p a_channel, subscribed once and kept.
+ * @param a_channel         Channel name.
+ * @param a_status_callback Function to call when \p a_channel is ready ( it's pattern is subscribed ), if already so it's called on next loop iteration.
+ * @param a_data_callback   Function to call when a message is published to \p a_channel.
+ * @param a_client          Listener owner, only one channel per client is tracked.
+ */
+void ngx::casper::broker::ext::JobChannels::Listen (const std::string& a_pattern, const std::string& a_channel,
+                                                    const ngx::casper::broker::ext::JobChannels::StatusCallback a_status_callback,
+                                                    const ngx::casper::broker::ext::JobChannels::DataCallback a_data_callback,
+                                                    ::ev::redis::subscriptions::Manager::Client* a_client)
+{
+    Unsubscribe(a_client);
+
+    listeners_[a_channel] = { a_pattern, a_status_callback, a_data_callback, a_client, /* ready_ */ false };
+    clients_[a_client]    = a_channel;
+
+    const auto it = patterns_.find(a_pattern);
+    if ( patterns_.end() == it ) {
+        // ... first listener of this pattern, subscribe it ...
+        patterns_[a_pattern] = PatternStatus::Subscribing;
+        try {
+            ::ev::redis::subscriptions::Manager::GetInstance().SubscribePatterns(/* a_patterns */
+                                                                                 { a_pattern },
+                                                                                 /* a_status_callback */
+                                                                                 std::bind(&ngx::casper::broker::ext::JobChannels::OnPatternStatusChanged, this, std::placeholders::_1, std::placeholders::_2),
+                                                                                 /* a_data_callback */
+                                                                                 std::bind(&ngx::casper::broker::ext::JobChannels::OnPatternMessage, this, std::placeholders::_1, std::placeholders::_2),
+                                                                                 /* a_client */
+                                                                                 this
+            );
+        } catch (const ::ev::Exception& /* a_ev_exception */) {
+            patterns_.erase(a_pattern);
+            Unsubscribe(a_client);
+            throw;
+        }
+    } else if ( PatternStatus::Subscribed == it->second ) {
+        // ... already subscribed, channel is ready but caller might still be inside a scheduler task, so notify it from a zero delay callout ...
+        if ( false == registered_ ) {
+            ::ev::scheduler::Scheduler::GetInstance().Register(this);
+            registered_ = true;
+        }
+        ready_.push_back(a_channel);
+        if ( 1 == ready_.size() ) {
+            ::ev::scheduler::Scheduler::GetInstance().SetClientTimeout(/* a_client */ this, /* a_ms */ 0,
+                                                                       /* a_callback */
+                                                                       [this] () {
+                                                                           NotifyReady();
+                                                                       }
+            );
+        }
+    }
+}
+
+/**
+ * @brief Stop delivering messages to a client, it's pattern subscription is kept for other ( and future ) listeners.
+ *
+ * @param a_client Listener owner.
+ */
+void ngx::casper::broker::ext::JobChannels::Unsubscribe (::ev::redis::subscriptions::Manager::Client* a_client)
+{
+    const auto it = clients_.find(a_client);
+    if ( clients_.end() == it ) {
+        return;
+    }
+    listeners_.erase(it->second);
+    clients_.erase(it);
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief This method will be called when REDIS connection was lost.
+ */
+void ngx::casper::broker::ext::JobChannels::OnREDISConnectionLost ()
+{
+    // ... patterns must be subscribed again, listeners are notified ...
+    std::vector<::ev::redis::subscriptions::Manager::Client*> clients;
+    clients.reserve(clients_.size());
+    for ( const auto& it : clients_ ) {
+        clients.push_back(it.first);
+    }
+    patterns_.clear();
+    listeners_.clear();
+    clients_.clear();
+    for ( auto client : clients ) {
+        client->OnREDISConnectionLost();
+    }
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief This method will be called when the status of a pattern subscription has changed.
+ *
+ * @param a_name   Pattern.
+ * @param a_status Subscription status.
+ *
+ * @return
+ */
+EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK ngx::casper::broker::ext::JobChannels::OnPatternStatusChanged (const std::string& a_name,
+                                                                                                                const ::ev::redis::subscriptions::Manager::Status& a_status)
+{
+    const bool subscribed = ( ::ev::redis::subscriptions::Manager::Status::Subscribed == a_status );
+    switch (a_status) {
+        case ::ev::redis::subscriptions::Manager::Status::Subscribing:
+            patterns_[a_name] = PatternStatus::Subscribing;
+            return nullptr;
+        case ::ev::redis::subscriptions::Manager::Status::Subscribed:
+            patterns_[a_name] = PatternStatus::Subscribed;
+            break;
+        default:
+            patterns_.erase(a_name);
+            break;
+    }
+
+    // ... notify this pattern listeners, a listener is made ready only once ...
+    std::vector<std::string> channels;
+    for ( const auto& it : listeners_ ) {
+        if ( a_name == it.second.pattern_ && ( false == subscribed || false == it.second.ready_ ) ) {
+            channels.push_back(it.first);
+        }
+    }
+
+    std::vector<EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK> callbacks;
+    for ( const auto& channel : channels ) {
+        const auto it = listeners_.find(channel);
+        if ( listeners_.end() == it ) {
+            continue;
+        }
+        it->second.ready_ = subscribed;
+        const StatusCallback                                   status_callback = it->second.status_callback_;
+        const EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK callback        = status_callback(channel, a_status);
+        if ( nullptr != callback ) {
+            callbacks.push_back(callback);
+        }
+    }
+
+    if ( 0 == callbacks.size() ) {
+        return nullptr;
+    }
+
+    return [callbacks] () {
+        for ( const auto& callback : callbacks ) {
+            callback();
+        }
+    };
+}
+
+/**
+ * @brief Notify listeners of already subscribed patterns that their channel is ready.
+ */
+void ngx::casper::broker::ext::JobChannels::NotifyReady ()
+{
+    std::vector<std::string> channels;
+    channels.swap(ready_);
+    for ( const auto& channel : channels ) {
+        // ... listener might be gone ( unsubscribed or connection lost ) or already notified ...
+        const auto it = listeners_.find(channel);
+        if ( listeners_.end() == it || true == it->second.ready_ ) {
+            continue;
+        }
+        it->second.ready_ = true;
+        const StatusCallback                                   status_callback = it->second.status_callback_;
+        const EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK callback        = status_callback(channel, ::ev::redis::subscriptions::Manager::Status::Subscribed);
+        if ( nullptr != callback ) {
+            callback();
+        }
+    }
+}
+
+/**
+ * @brief This method will be called when a message is published to a channel that matches a subscribed pattern.
+ *
+ * @param a_name    Channel name.
+ * @param a_message Message.
+ *
+ * @return
+ */
+EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK ngx::casper::broker::ext::JobChannels::OnPatternMessage (const std::string& a_name, const std::string& a_message)
+{
+    // ... no one waiting, job was cancelled, timed out or belongs to another worker ...
+    const auto it = listeners_.find(a_name);
+    if ( listeners_.end() == it || false == it->second.ready_ ) {
+        return nullptr;
+    }
+    // ... listener might be erased by it's own callback ...
+    const DataCallback callback = it->second.data_callback_;
+    return callback(a_name, a_message);
+}
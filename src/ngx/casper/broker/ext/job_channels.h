@@ -0,0 +1,143 @@
+/**
+ * @file job_channels.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_NGX_CASPER_BROKER_EXT_JOB_CHANNELS_H_
+#define NRS_NGX_CASPER_BROKER_EXT_JOB_CHANNELS_H_
+
+#include "osal/osal_singleton.h"
+
+#include "ev/redis/subscriptions/manager.h"
+
+#include "ev/scheduler/scheduler.h"
+
+#include <stdint.h>      // uint8_t
+#include <functional>    // std::function
+#include <map>           // std::map
+#include <string>        // std::string
+#include <unordered_map> // std::unordered_map
+#include <vector>        // std::vector
+
+namespace ngx
+{
+
+    namespace casper
+    {
+
+        namespace broker
+        {
+
+            namespace ext
+            {
+
+                // ---- //
+                class JobChannels;
+                class JobChannelsInitializer final : public ::osal::Initializer<JobChannels>
+                {
+
+                public: // Constructor(s) / Destructor
+
+                    JobChannelsInitializer (JobChannels& a_instance)
+                        : ::osal::Initializer<JobChannels>(a_instance)
+                    {
+                        /* empty */
+                    }
+                    virtual ~JobChannelsInitializer ()
+                    {
+                        /* empty */
+                    }
+
+                }; // end of class 'JobChannelsInitializer'
+
+                /**
+                 * @brief Per worker, long-lived, REDIS pattern subscriptions shared by all jobs waiting for a reply.
+                 *
+                 *        A job channel is ready as soon as it's pattern is subscribed, so only the first job of a pattern pays a SUBSCRIBE round trip.
+                 */
+                class JobChannels final : public osal::Singleton<JobChannels, JobChannelsInitializer>, public ::ev::redis::subscriptions::Manager::Client, public ::ev::scheduler::Client
+                {
+
+                public: // Data Type(s)
+
+                    typedef std::function<EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK(const std::string& a_name, const ::ev::redis::subscriptions::Manager::Status& a_status)> StatusCallback;
+                    typedef std::function<EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK(const std::string& a_name, const std::string& a_message)>                             DataCallback;
+
+                private: // Enum(s)
+
+                    enum class PatternStatus : uint8_t {
+                        Subscribing,
+                        Subscribed
+                    };
+
+                private: // Data Type(s)
+
+                    typedef struct {
+                        std::string                                  pattern_;
+                        StatusCallback                               status_callback_;
+                        DataCallback                                 data_callback_;
+                        ::ev::redis::subscriptions::Manager::Client* client_;
+                        bool                                         ready_;
+                    } Listener;
+
+                    typedef std::map<std::string, PatternStatus>                                       Patterns;
+                    typedef std::unordered_map<std::string, Listener>                                  Listeners;
+                    typedef std::unordered_map<::ev::redis::subscriptions::Manager::Client*, std::string> Clients;
+
+                private: // Data
+
+                    Patterns                 patterns_;
+                    Listeners                listeners_;
+                    Clients                  clients_;
+                    std::vector<std::string> ready_;      //!< channels whose pattern was already subscribed, notified on next loop iteration
+                    bool                     registered_ = false;
+
+                public: // One-shot Call Method(s) / Function(s)
+
+                    void Shutdown ();
+
+                public: // Method(s) / Function(s)
+
+                    void Listen      (const std::string& a_pattern, const std::string& a_channel,
+                                      const StatusCallback a_status_callback, const DataCallback a_data_callback,
+                                      ::ev::redis::subscriptions::Manager::Client* a_client);
+                    void Unsubscribe (::ev::redis::subscriptions::Manager::Client* a_client);
+
+                public: // Inherited Method(s) / Function(s) - from ::ev::redis::subscriptions::Manager::Client
+
+                    virtual void OnREDISConnectionLost ();
+
+                private: // Method(s) / Function(s)
+
+                    EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK OnPatternStatusChanged (const std::string& a_name, const ::ev::redis::subscriptions::Manager::Status& a_status);
+                    EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK OnPatternMessage       (const std::string& a_name, const std::string& a_message);
+                    void                                             NotifyReady            ();
+
+                }; // end of class 'JobChannels'
+
+            } // end of namespace 'ext'
+
+        } // end of namespace 'broker'
+
+    } // end of namespace 'casper'
+
+} // end of namespace 'ngx'
+
+#endif // NRS_NGX_CASPER_BROKER_EXT_JOB_CHANNELS_H_
@@ -21,8 +21,12 @@
 
 #include "ngx/casper/broker/ext/session.h"
 
+#include "ngx/casper/broker/module/ngx_http_casper_broker_module.h"
+
 #include "ngx/ngx_utils.h"
 
+bool ngx::casper::broker::ext::Session::s_cache_set_ = false;
+
 /**
  * @brief Default constructor.
  *
@@ -40,17 +44,26 @@ ngx::casper::broker::ext::Session::Session (ngx::casper::broker::Module::CTX& a_
                /* a_test_maintenance_flag */ true
       )
 {
+    // ... per-worker session cache ...
+    if ( false == s_cache_set_ ) {
+        ngx_http_casper_broker_module_loc_conf_t* broker_conf = (ngx_http_casper_broker_module_loc_conf_t*)ngx_http_get_module_loc_conf(a_ctx.ngx_ptr_, ngx_http_casper_broker_module);
+        if ( NULL != broker_conf ) {
+            ngx::casper::broker::ext::SessionCache::GetInstance().Startup(static_cast<size_t>(broker_conf->session.cache.max_entries),
+                                                                          static_cast<uint64_t>(broker_conf->session.cache.ttl));
+            s_cache_set_ = true;
+        }
+    }
     // ... if no error set ...
     if ( NGX_OK == ctx_.response_.return_code_ ) {
         const uint16_t prev_status_code = a_ctx.response_.status_code_;
         // ... ensure authorization header exists ...
-        auto authorization_it = a_params.in_headers_.find("authorization");
-        if ( a_params.in_headers_.end() == authorization_it ) {
+        std::string authorization;
+        if ( false == a_params.in_headers_.Get("authorization", authorization) ) {
             NGX_BROKER_MODULE_SET_BAD_REQUEST_ERROR_I18N(ctx_, "BROKER_MISSING_AUTHORIZATION_HEADER");
         } else {
             std::string type;
             std::string credentials;
-            const ngx_int_t authorization_parsing = ngx::utls::nrs_ngx_parse_authorization((authorization_it->first + ": " + authorization_it->second), type, credentials);
+            const ngx_int_t authorization_parsing = ngx::utls::nrs_ngx_parse_authorization(("authorization: " + authorization), type, credentials);
             if ( NGX_OK == authorization_parsing ) {
                 if ( 0 != strcasecmp(type.c_str(), "bearer") ) {
                     // ... unsupported authorization header type ...
@@ -59,7 +72,8 @@ ngx::casper::broker::ext::Session::Session (ngx::casper::broker::Module::CTX& a_
                     // ... invalid authorization header value ...
                     NGX_BROKER_MODULE_SET_BAD_REQUEST_ERROR_I18N(ctx_, "BROKER_INVALID_AUTHORIZATION_HEADER_VALUE");
                 } else {
-                    session_.SetToken(credentials);
+                    token_ = credentials;
+                    session_.SetToken(token_);
                 }
             } else {
                 // ... invalid ...
@@ -75,7 +89,8 @@ ngx::casper::broker::ext::Session::Session (ngx::casper::broker::Module::CTX& a_
             ngx_str_t session_cookie_value = ngx_null_string;
             if ( NGX_DECLINED != ngx_http_parse_multi_header_lines(&a_ctx.ngx_ptr_->headers_in.cookies, &session_cookie_name, &session_cookie_value) ) {
                 // ... accept cookie value ...
-                session_.SetToken(std::string(reinterpret_cast<char const*>(session_cookie_value.data), session_cookie_value.len));
+                token_ = std::string(reinterpret_cast<char const*>(session_cookie_value.data), session_cookie_value.len);
+                session_.SetToken(token_);
                 // ... rollback status ...
                 a_ctx.response_.status_code_ = prev_status_code;
                 a_ctx.response_.return_code_ = NGX_OK;
@@ -132,31 +147,52 @@ ngx_int_t ngx::casper::broker::ext::Session::Fetch (std::function<void(const boo
     // ... assume request will be asynchronous ....
     ctx_.response_.asynchronous_ = true;
     
+    // ... already fetched by this or other request?
+    ngx::casper::broker::ext::SessionCache& cache = ngx::casper::broker::ext::SessionCache::GetInstance();
+    if ( nullptr == shared_session_ && true == cache.enabled() && false == session_.Data().token_is_valid_ ) {
+        shared_session_ = cache.Get(module_ptr_->service_id_, token_);
+        if ( nullptr == shared_session_ ) {
+            // ... not cached, fetch a session that can be shared ...
+            shared_session_ = std::make_shared<::ev::casper::Session>(/* a_loggable_data        */ cache.loggable_data(),
+                                                                      /* a_iss                  */ "nginx-broker",
+                                                                      /* a_sid                  */ module_ptr_->service_id_,
+                                                                      /* a_token_prefix         */ module_ptr_->service_id_ + ":oauth:access_token:",
+                                                                      /* a_test_maintenance_flag */ true
+            );
+            shared_session_->SetToken(token_);
+        }
+    }
+    
     // ... fetch session or already set?
     // ... session data is ...
-    if ( false == session_.Data().token_is_valid_ ) {
+    ::ev::casper::Session& session = ( nullptr != shared_session_ ? *shared_session_ : session_ );
+    if ( false == session.Data().token_is_valid_ ) {
         // ... token is invalid or not validated yet ...
-        session_.Fetch(/* a_success_callback */
-                       [this] (const ev::casper::Session::DataT& /* a_data */) {
-                           // ... notify ready ...
-                           success_callback_(/* a_async_request */ true, /* a_session */ session_);
-                       },
-                       /* a_invalid_callback */
-                       [this] (const ev::casper::Session::DataT& /* a_data */ ) {
-                           ctx_.response_.headers_["WWW-Authenticate"] =
-                           "Bearer realm=\"api\", error=\"invalid_token\", error_description=\"The access token provided is expired, revoked, malformed, or invalid for other reasons.\"";
-                           NGX_BROKER_MODULE_SET_ERROR_I18N(ctx_, NGX_HTTP_UNAUTHORIZED, "AUTH_INVALID_SESSION_ID");
-                           failure_callback_();
-                       },
-                       /* a_failure_callback */
-                       [this] (const ev::casper::Session::DataT& /* a_data */, const ::ev::Exception& a_ev_exception){
-                           NGX_BROKER_MODULE_SET_ERROR_I18N_I(ctx_, NGX_HTTP_INTERNAL_SERVER_ERROR, "BROKER_REDIS_RESPONSE_ERROR", a_ev_exception.what());
-                           failure_callback_();
-                       }
+        session.Fetch(/* a_success_callback */
+                      [this] (const ev::casper::Session::DataT& /* a_data */) {
+                          // ... share it with following requests ...
+                          if ( nullptr != shared_session_ ) {
+                              ngx::casper::broker::ext::SessionCache::GetInstance().Set(module_ptr_->service_id_, token_, shared_session_);
+                          }
+                          // ... notify ready ...
+                          success_callback_(/* a_async_request */ true, /* a_session */ session());
+                      },
+                      /* a_invalid_callback */
+                      [this] (const ev::casper::Session::DataT& /* a_data */ ) {
+                          ctx_.response_.headers_["WWW-Authenticate"] =
+                          "Bearer realm=\"api\", error=\"invalid_token\", error_description=\"The access token provided is expired, revoked, malformed, or invalid for other reasons.\"";
+                          NGX_BROKER_MODULE_SET_ERROR_I18N(ctx_, NGX_HTTP_UNAUTHORIZED, "AUTH_INVALID_SESSION_ID");
+                          failure_callback_();
+                      },
+                      /* a_failure_callback */
+                      [this] (const ev::casper::Session::DataT& /* a_data */, const ::ev::Exception& a_ev_exception){
+                          NGX_BROKER_MODULE_SET_ERROR_I18N_I(ctx_, NGX_HTTP_INTERNAL_SERVER_ERROR, "BROKER_REDIS_RESPONSE_ERROR", a_ev_exception.what());
+                          failure_callback_();
+                      }
         );
     } else {
         // ... notify ready ...
-        success_callback_(/* a_async_request */ true, /* a_session */ session_);
+        success_callback_(/* a_async_request */ true, /* a_session */ session);
     }
     
     // ... an error occurred?
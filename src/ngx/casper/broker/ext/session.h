@@ -25,6 +25,8 @@
 
 #include "ngx/casper/broker/ext/base.h"
 
+#include "ngx/casper/broker/ext/session_cache.h"
+
 #include "ev/casper/session.h"
 
 #include <functional>
@@ -44,10 +46,19 @@ namespace ngx
                 class Session : public ext::Base
                 {
                     
+                private: // Static Data
+                    
+                    static bool s_cache_set_;
+                    
                 protected: // Data
                     
                     ::ev::casper::Session session_;
                     
+                private: // Data
+                    
+                    std::string              token_;
+                    SessionCache::SessionPtr shared_session_;
+                    
                 private: // Ptr Func
                     
                     std::function<void(const bool a_async_request, const ::ev::casper::Session& a_session)> success_callback_;
@@ -63,8 +74,20 @@ namespace ngx
                     virtual ngx_int_t Fetch (std::function<void(const bool a_async_request, const ::ev::casper::Session& a_session)> a_success,
                                              std::function<void()> a_failure = nullptr);
                     
+                private: // Inline Method(s) / Function(s)
+                    
+                    const ::ev::casper::Session& session () const;
+                    
                 }; // end of Job
                 
+                /**
+                 * @return The session being fetched: a shared, cached, one or this request's own one.
+                 */
+                inline const ::ev::casper::Session& Session::session () const
+                {
+                    return ( nullptr != shared_session_ ? *shared_session_ : session_ );
+                }
+                
             } // end of namespace 'ext'
             
         } // end of namespace 'broker'
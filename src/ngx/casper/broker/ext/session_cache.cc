@@ -0,0 +1,433 @@
+/**
+ * @file session_cache.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ngx/casper/broker/ext/session_cache.h"
+
+#include "ev/ngx/includes.h" // ngx_current_msec
+
+#include "ev/redis/request.h"
+#include "ev/redis/reply.h"
+
+#include <openssl/sha.h> // SHA256
+
+#include <string.h> // strlen
+
+const char* const ngx::casper::broker::ext::SessionCache::sk_channel_suffix_    = ":oauth:session:revoked";
+const char* const ngx::casper::broker::ext::SessionCache::sk_flush_all_message_ = "*";
+
+/**
+ * @brief One-shot setup.
+ *
+ * @param a_limit Maximum number of sessions to keep, 0 disables cache.
+ * @param a_ttl   Maximum entry age, in milliseconds, 0 disables cache.
+ */
+void ngx::casper::broker::ext::SessionCache::Startup (const size_t a_limit, const uint64_t a_ttl)
+{
+    if ( nullptr == loggable_data_ptr_ ) {
+        loggable_data_ptr_ = new ::ev::Loggable::Data {
+            /* owner_ptr */ this,
+            /* ip_addr_  */ "127.0.0.1",
+            /* module_   */ "session_cache",
+            /* tag_      */ "session_cache"
+        };
+    }
+    stats_.limit_ = a_limit;
+    stats_.ttl_   = a_ttl;
+    Evict(stats_.limit_);
+    // ... sessions lifetime is read before caching them ...
+    if ( true == enabled() ) {
+        ::ev::scheduler::Scheduler::GetInstance().Register(this);
+    }
+}
+
+/**
+ * @brief Release all cached entries and cancel invalidation subscriptions.
+ */
+void ngx::casper::broker::ext::SessionCache::Shutdown ()
+{
+    ::ev::scheduler::Scheduler::GetInstance().Unregister(this);
+    if ( channels_.size() > 0 ) {
+        ::ev::redis::subscriptions::Manager::GetInstance().Unubscribe(this);
+        channels_.clear();
+    }
+    index_.clear();
+    pending_.clear();
+    lru_.clear();
+    stats_.entries_ = 0;
+    stats_.limit_   = 0;
+    if ( nullptr != loggable_data_ptr_ ) {
+        delete loggable_data_ptr_;
+        loggable_data_ptr_ = nullptr;
+    }
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Obtain a previously fetched session.
+ *
+ * @param a_sid   Service ID.
+ * @param a_token Access token.
+ *
+ * @return Cached session, nullptr if not cached, expired or cache is disabled.
+ */
+ngx::casper::broker::ext::SessionCache::SessionPtr ngx::casper::broker::ext::SessionCache::Get (const std::string& a_sid, const std::string& a_token)
+{
+    if ( false == enabled() ) {
+        return nullptr;
+    }
+
+    const auto it = index_.find(Key(a_sid, a_token));
+    if ( index_.end() == it ) {
+        stats_.misses_++;
+        return nullptr;
+    }
+
+    // ... too old or session expired?
+    const uint64_t now = static_cast<uint64_t>(ngx_current_msec);
+    const uint64_t age = now - it->second->inserted_at_;
+    if ( now >= it->second->expires_at_ ) {
+        // ... yes, forget it ...
+        Erase(it);
+        stats_.expirations_++;
+        stats_.misses_++;
+        return nullptr;
+    }
+
+    // ... most recently used ...
+    lru_.splice(lru_.begin(), lru_, it->second);
+    stats_.hits_++;
+    if ( age > stats_.max_age_ ) {
+        stats_.max_age_ = age;
+    }
+
+    return it->second->session_;
+}
+
+/**
+ * @brief Keep track of a successfully fetched session.
+ *
+ * @param a_sid     Service ID.
+ * @param a_token   Access token.
+ * @param a_session Fetched session.
+ */
+void ngx::casper::broker::ext::SessionCache::Set (const std::string& a_sid, const std::string& a_token, const ngx::casper::broker::ext::SessionCache::SessionPtr& a_session)
+{
+    if ( false == enabled() ) {
+        return;
+    }
+
+    // ... sessions are only kept while revocations can be delivered ...
+    if ( false == Subscribe(a_sid) ) {
+        return;
+    }
+
+    // ... mark it as pending, a revocation received while waiting for PTTL reply removes this mark ...
+    const std::string key    = Key(a_sid, a_token);
+    const uint64_t    ticket = ++pending_ticket_;
+    pending_[key] = { a_sid + sk_channel_suffix_, ticket };
+
+    // ... an entry can't outlive it's session, read token remaining lifetime first ...
+    const std::string token_key = a_sid + ":oauth:access_token:" + a_token;
+    NewTask([this, token_key] () -> ::ev::Object* {
+
+        return new ::ev::redis::Request(*loggable_data_ptr_, "PTTL", { token_key });
+
+    })->Finally([this, key, ticket, a_sid, a_session] (::ev::Object* a_object) {
+
+        // ... revoked ( or flushed ) meanwhile, or superseded by a newer call?
+        const auto p_it = pending_.find(key);
+        if ( pending_.end() == p_it || ticket != p_it->second.ticket_ ) {
+            // ... yes, don't cache it ...
+            return;
+        }
+        pending_.erase(p_it);
+
+        //
+        // PTTL:
+        //
+        // - An integer reply is expected:
+        //
+        //  - remaining time to live in milliseconds, -1 if key has no expiration, -2 if key does not exist.
+        //
+        const ::ev::redis::Value& value = ::ev::redis::Reply::EnsureIntegerReply(a_object);
+        if ( -2 == value.Integer() || 0 == value.Integer() || false == enabled() ) {
+            // ... gone or disabled meanwhile, don't cache it ...
+            return;
+        }
+        uint64_t ttl = stats_.ttl_;
+        if ( value.Integer() > 0 && static_cast<uint64_t>(value.Integer()) < ttl ) {
+            ttl = static_cast<uint64_t>(value.Integer());
+        }
+        Insert(key, a_sid, a_session, ttl);
+
+    })->Catch([this, key, ticket] (const ::ev::Exception& /* a_ev_exception */) {
+        // ... not cached this time ...
+        const auto p_it = pending_.find(key);
+        if ( pending_.end() != p_it && ticket == p_it->second.ticket_ ) {
+            pending_.erase(p_it);
+        }
+    });
+}
+
+/**
+ * @brief Keep track of a session.
+ *
+ * @param a_key     Entry key, see \link Key \link.
+ * @param a_sid     Service ID.
+ * @param a_session Fetched session.
+ * @param a_ttl     Entry maximum age, in milliseconds.
+ */
+void ngx::casper::broker::ext::SessionCache::Insert (const std::string& a_key, const std::string& a_sid,
+                                                     const ngx::casper::broker::ext::SessionCache::SessionPtr& a_session, const uint64_t a_ttl)
+{
+    // ... replace previous entry ( if any ) ...
+    const auto it = index_.find(a_key);
+    if ( index_.end() != it ) {
+        Erase(it);
+    }
+
+    // ... make room for it ...
+    Evict(stats_.limit_ - 1);
+
+    // ... keep track of it ...
+    const uint64_t now = static_cast<uint64_t>(ngx_current_msec);
+    lru_.push_front({ a_key, a_sid + sk_channel_suffix_, now, now + a_ttl, a_session });
+    index_[a_key] = lru_.begin();
+    stats_.entries_++;
+}
+
+/**
+ * @brief Forget a cached session ( if any ).
+ *
+ * @param a_sid   Service ID.
+ * @param a_token Access token.
+ */
+void ngx::casper::broker::ext::SessionCache::Invalidate (const std::string& a_sid, const std::string& a_token)
+{
+    const std::string key = Key(a_sid, a_token);
+    // ... a pending \link Set \link must not store it ...
+    pending_.erase(key);
+    const auto it = index_.find(key);
+    if ( index_.end() == it ) {
+        return;
+    }
+    Erase(it);
+    stats_.invalidations_++;
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief This method will be called when REDIS connection was lost.
+ */
+void ngx::casper::broker::ext::SessionCache::OnREDISConnectionLost ()
+{
+    // ... revocations might have been missed, trust nothing ...
+    channels_.clear();
+    Flush("");
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Build an entry key.
+ *
+ * @param a_sid   Service ID.
+ * @param a_token Access token.
+ *
+ * @return Service ID and SHA256 hex digest of token, tokens are not kept as plain text keys.
+ */
+std::string ngx::casper::broker::ext::SessionCache::Key (const std::string& a_sid, const std::string& a_token) const
+{
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char*>(a_token.c_str()), a_token.length(), digest);
+
+    static const char* const k_hex = "0123456789abcdef";
+
+    std::string key;
+    key.reserve(a_sid.length() + 1 + SHA256_DIGEST_LENGTH * 2);
+    key += a_sid;
+    key += ':';
+    for ( size_t idx = 0 ; idx < SHA256_DIGEST_LENGTH ; ++idx ) {
+        key += k_hex[( digest[idx] >> 4 ) & 0x0F];
+        key += k_hex[digest[idx] & 0x0F];
+    }
+    return key;
+}
+
+/**
+ * @brief Ensure a service revocations channel is subscribed.
+ *
+ * @param a_sid Service ID.
+ *
+ * @return True if channel is already subscribed, false if subscription is pending or failed.
+ */
+bool ngx::casper::broker::ext::SessionCache::Subscribe (const std::string& a_sid)
+{
+    const std::string channel = a_sid + sk_channel_suffix_;
+
+    const auto it = channels_.find(channel);
+    if ( channels_.end() != it ) {
+        return ( ChannelStatus::Subscribed == it->second );
+    }
+
+    try {
+        channels_[channel] = ChannelStatus::Subscribing;
+        ::ev::redis::subscriptions::Manager::GetInstance().SubscribeChannels(/* a_channels */
+                                                                             { channel },
+                                                                             /* a_status_callback */
+                                                                             std::bind(&ngx::casper::broker::ext::SessionCache::OnChannelStatusChanged, this, std::placeholders::_1, std::placeholders::_2),
+                                                                             /* a_data_callback */
+                                                                             std::bind(&ngx::casper::broker::ext::SessionCache::OnChannelMessage, this, std::placeholders::_1, std::placeholders::_2),
+                                                                             /* a_client */
+                                                                             this
+        );
+    } catch (const ::ev::Exception& /* a_ev_exception */) {
+        // ... not cached this time, try again next time ...
+        channels_.erase(channel);
+    }
+
+    return false;
+}
+
+/**
+ * @brief Forget all cached sessions received by a channel.
+ *
+ * @param a_channel Channel name, empty to forget all sessions.
+ */
+void ngx::casper::broker::ext::SessionCache::Flush (const std::string& a_channel)
+{
+    // ... pending \link Set \link calls must not store them ...
+    for ( auto it = pending_.begin() ; pending_.end() != it ; ) {
+        if ( 0 == a_channel.length() || a_channel == it->second.channel_ ) {
+            it = pending_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for ( auto it = lru_.begin() ; lru_.end() != it ; ) {
+        if ( 0 == a_channel.length() || a_channel == it->channel_ ) {
+            index_.erase(it->key_);
+            it = lru_.erase(it);
+            stats_.entries_--;
+            stats_.invalidations_++;
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * @brief Forget an entry.
+ *
+ * @param a_it Index iterator.
+ */
+void ngx::casper::broker::ext::SessionCache::Erase (const ngx::casper::broker::ext::SessionCache::Index::iterator& a_it)
+{
+    lru_.erase(a_it->second);
+    index_.erase(a_it);
+    stats_.entries_--;
+}
+
+/**
+ * @brief Create a new task.
+ *
+ * @param a_callback The first callback to be performed.
+ */
+::ev::scheduler::Task* ngx::casper::broker::ext::SessionCache::NewTask (const EV_TASK_PARAMS& a_callback)
+{
+    return new ::ev::scheduler::Task(a_callback,
+                                     [this](::ev::scheduler::Task* a_task) {
+                                         ::ev::scheduler::Scheduler::GetInstance().Push(this, a_task);
+                                     }
+    );
+}
+
+/**
+ * @brief Evict least recently used entries until the number of entries is below a limit.
+ *
+ * @param a_limit Maximum number of entries to keep.
+ */
+void ngx::casper::broker::ext::SessionCache::Evict (const size_t a_limit)
+{
+    while ( lru_.size() > a_limit ) {
+        index_.erase(lru_.back().key_);
+        lru_.pop_back();
+        stats_.entries_--;
+        stats_.evictions_++;
+    }
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief This method will be called when the status of a revocations channel subscription has changed.
+ *
+ * @param a_name   Channel name.
+ * @param a_status Subscription status.
+ *
+ * @return
+ */
+EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK ngx::casper::broker::ext::SessionCache::OnChannelStatusChanged (const std::string& a_name,
+                                                                                                                 const ::ev::redis::subscriptions::Manager::Status& a_status)
+{
+    switch (a_status) {
+        case ::ev::redis::subscriptions::Manager::Status::Subscribing:
+            channels_[a_name] = ChannelStatus::Subscribing;
+            break;
+        case ::ev::redis::subscriptions::Manager::Status::Subscribed:
+            channels_[a_name] = ChannelStatus::Subscribed;
+            break;
+        default:
+            // ... no longer subscribed, revocations would be missed ...
+            channels_.erase(a_name);
+            Flush(a_name);
+            break;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief This method will be called when a revocation message is received.
+ *
+ * @param a_name    Channel name, '<service id>:oauth:session:revoked'.
+ * @param a_message Revoked access token or '*' to forget all of this service sessions.
+ *
+ * @return
+ */
+EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK ngx::casper::broker::ext::SessionCache::OnChannelMessage (const std::string& a_name, const std::string& a_message)
+{
+    if ( 0 == a_message.compare(sk_flush_all_message_) ) {
+        Flush(a_name);
+    } else {
+        Invalidate(a_name.substr(0, a_name.length() - strlen(sk_channel_suffix_)), a_message);
+    }
+    return nullptr;
+}
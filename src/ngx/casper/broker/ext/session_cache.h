@@ -0,0 +1,205 @@
+/**
+ * @file session_cache.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_NGX_CASPER_BROKER_EXT_SESSION_CACHE_H_
+#define NRS_NGX_CASPER_BROKER_EXT_SESSION_CACHE_H_
+
+#include "osal/osal_singleton.h"
+
+#include "ev/loggable.h"
+#include "ev/casper/session.h"
+#include "ev/redis/subscriptions/manager.h"
+#include "ev/scheduler/scheduler.h"
+
+#include <stdint.h>      // uint64_t
+#include <list>          // std::list
+#include <map>           // std::map
+#include <memory>        // std::shared_ptr
+#include <string>        // std::string
+#include <unordered_map> // std::unordered_map
+
+namespace ngx
+{
+
+    namespace casper
+    {
+
+        namespace broker
+        {
+
+            namespace ext
+            {
+
+                // ---- //
+                class SessionCache;
+                class SessionCacheInitializer final : public ::osal::Initializer<SessionCache>
+                {
+
+                public: // Constructor(s) / Destructor
+
+                    SessionCacheInitializer (SessionCache& a_instance)
+                        : ::osal::Initializer<SessionCache>(a_instance)
+                    {
+                        /* empty */
+                    }
+                    virtual ~SessionCacheInitializer ()
+                    {
+                        /* empty */
+                    }
+
+                }; // end of class 'SessionCacheInitializer'
+
+                // ---- //
+                class SessionCache final : public osal::Singleton<SessionCache, SessionCacheInitializer>, public ::ev::redis::subscriptions::Manager::Client, public ::ev::scheduler::Client
+                {
+
+                public: // Data Type(s)
+
+                    typedef std::shared_ptr<::ev::casper::Session> SessionPtr;
+
+                    typedef struct {
+                        uint64_t hits_;
+                        uint64_t misses_;
+                        uint64_t evictions_;
+                        uint64_t expirations_;
+                        uint64_t invalidations_;
+                        size_t   entries_;
+                        size_t   limit_;
+                        uint64_t ttl_;      //!< Maximum entry age, in milliseconds.
+                        uint64_t max_age_;  //!< Oldest entry age ( in milliseconds ) ever served, the observed staleness window.
+                    } Stats;
+
+                private: // Enum(s)
+
+                    enum class ChannelStatus : uint8_t {
+                        Subscribing,
+                        Subscribed
+                    };
+
+                private: // Data Type(s)
+
+                    typedef struct {
+                        std::string key_;
+                        std::string channel_;
+                        uint64_t    inserted_at_;
+                        uint64_t    expires_at_;  //!< min(ttl, session remaining lifetime), in ngx_current_msec units.
+                        SessionPtr  session_;
+                    } Entry;
+
+                    typedef struct {
+                        std::string channel_;
+                        uint64_t    ticket_;      //!< Distinguishes overlapping \link Set \link calls for the same key.
+                    } Pending;
+
+                    typedef std::list<Entry>                                LRU;
+                    typedef std::unordered_map<std::string, LRU::iterator> Index;
+                    typedef std::unordered_map<std::string, Pending>       PendingIndex;
+                    typedef std::map<std::string, ChannelStatus>           Channels;
+
+                private: // Static Const Data
+
+                    static const char* const sk_channel_suffix_;
+                    static const char* const sk_flush_all_message_;
+
+                private: // Data
+
+                    LRU                   lru_;
+                    Index                 index_;
+                    PendingIndex          pending_;        //!< Entries waiting for PTTL reply, a revocation meanwhile removes them.
+                    uint64_t              pending_ticket_ = 0;
+                    Channels              channels_;
+                    ::ev::Loggable::Data* loggable_data_ptr_ = nullptr;
+                    Stats                 stats_ = {
+                        /* hits_          */ 0, /* misses_  */ 0, /* evictions_ */ 0, /* expirations_ */ 0, /* invalidations_ */ 0,
+                        /* entries_       */ 0, /* limit_   */ 0, /* ttl_       */ 0, /* max_age_     */ 0
+                    };
+
+                public: // One-shot Call Method(s) / Function(s)
+
+                    void Startup  (const size_t a_limit, const uint64_t a_ttl);
+                    void Shutdown ();
+
+                public: // Method(s) / Function(s)
+
+                    SessionPtr Get        (const std::string& a_sid, const std::string& a_token);
+                    void       Set        (const std::string& a_sid, const std::string& a_token, const SessionPtr& a_session);
+                    void       Invalidate (const std::string& a_sid, const std::string& a_token);
+
+                public: // Inherited Method(s) / Function(s) - from ::ev::redis::subscriptions::Manager::Client
+
+                    virtual void OnREDISConnectionLost ();
+
+                public: // Inline Method(s) / Function(s)
+
+                    bool                  enabled       () const;
+                    const Stats&          stats         () const;
+                    ::ev::Loggable::Data& loggable_data () const;
+
+                private: // Method(s) / Function(s)
+
+                    std::string Key       (const std::string& a_sid, const std::string& a_token) const;
+                    bool        Subscribe (const std::string& a_sid);
+                    void        Flush     (const std::string& a_channel);
+                    void        Erase     (const Index::iterator& a_it);
+                    void        Evict     (const size_t a_limit);
+                    void        Insert    (const std::string& a_key, const std::string& a_sid, const SessionPtr& a_session, const uint64_t a_ttl);
+
+                    ::ev::scheduler::Task* NewTask (const EV_TASK_PARAMS& a_callback);
+
+                    EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK OnChannelStatusChanged (const std::string& a_name, const ::ev::redis::subscriptions::Manager::Status& a_status);
+                    EV_REDIS_SUBSCRIPTIONS_DATA_POST_NOTIFY_CALLBACK OnChannelMessage       (const std::string& a_name, const std::string& a_message);
+
+                }; // end of class 'SessionCache'
+
+                /**
+                 * @return True when an entries limit is set, false otherwise.
+                 */
+                inline bool SessionCache::enabled () const
+                {
+                    return ( stats_.limit_ > 0 && stats_.ttl_ > 0 && nullptr != loggable_data_ptr_ );
+                }
+
+                /**
+                 * @return Read-only access to cache counters.
+                 */
+                inline const SessionCache::Stats& SessionCache::stats () const
+                {
+                    return stats_;
+                }
+
+                /**
+                 * @return Worker lifetime loggable data, to be used by cached sessions.
+                 */
+                inline ::ev::Loggable::Data& SessionCache::loggable_data () const
+                {
+                    return *loggable_data_ptr_;
+                }
+
+            } // end of namespace 'ext'
+
+        } // end of namespace 'broker'
+
+    } // end of namespace 'casper'
+
+} // end of namespace 'ngx'
+
+#endif // NRS_NGX_CASPER_BROKER_EXT_SESSION_CACHE_H_
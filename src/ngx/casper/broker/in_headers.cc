@@ -0,0 +1,266 @@
+/**
+ * @file in_headers.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ngx/casper/broker/in_headers.h"
+
+#include <algorithm> // std::transform
+#include <ctype.h>   // tolower
+#include <string.h>  // strlen
+
+/**
+ * @brief Default constructor.
+ */
+ngx::casper::broker::InHeaders::InHeaders ()
+    : part_(nullptr)
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor.
+ */
+ngx::casper::broker::InHeaders::~InHeaders ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Find a header.
+ *
+ * @param a_name Header name, case-insensitive.
+ *
+ * @remarks When a header is repeated the last occurrence wins.
+ *
+ * @return Header element, nullptr if not found or if it has no value.
+ */
+const ngx_table_elt_t* ngx::casper::broker::InHeaders::Find (const char* const a_name) const
+{
+    if ( nullptr == part_ ) {
+        return nullptr;
+    }
+    
+    const size_t           length = strlen(a_name);
+    const ngx_table_elt_t* found  = nullptr;
+    
+    const ngx_list_part_t* list_part = part_;
+    while ( NULL != list_part ) {
+        // ... for each element ...
+        const ngx_table_elt_t* header = (const ngx_table_elt_t*)list_part->elts;
+        for ( ngx_uint_t index = 0 ; list_part->nelts > index ; ++index ) {
+            // ... same length and name?
+            if ( length == header[index].key.len && 0 < header[index].value.len
+                    &&
+                 0 == ngx_strncasecmp(header[index].key.data, (u_char*)a_name, length) ) {
+                found = &header[index];
+            }
+        }
+        // ... next...
+        list_part = list_part->next;
+    }
+    
+    return found;
+}
+
+/**
+ * @brief Obtain a header value.
+ *
+ * @param a_name  Header name, case-insensitive.
+ * @param o_value Header value, untouched if not found.
+ *
+ * @return True if found, false otherwise.
+ */
+bool ngx::casper::broker::InHeaders::Get (const char* const a_name, std::string& o_value) const
+{
+    const ngx_table_elt_t* header = Find(a_name);
+    if ( nullptr == header ) {
+        return false;
+    }
+    o_value.assign(reinterpret_cast<const char*>(header->value.data), header->value.len);
+    return true;
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @return Iterator to the first visible header.
+ */
+ngx::casper::broker::InHeaders::const_iterator ngx::casper::broker::InHeaders::begin () const
+{
+    if ( nullptr == part_ ) {
+        return end();
+    }
+    const ngx_list_part_t* part  = part_;
+    ngx_uint_t             index = 0;
+    Settle(part, index);
+    return const_iterator(part, index);
+}
+
+/**
+ * @return Past the end iterator.
+ */
+ngx::casper::broker::InHeaders::const_iterator ngx::casper::broker::InHeaders::end () const
+{
+    return const_iterator(nullptr, 0);
+}
+
+/**
+ * @brief Find a header.
+ *
+ * @param a_name Header name, case-insensitive.
+ *
+ * @return Iterator to the last occurrence of header, \link end \link if not found or if it has no value.
+ */
+ngx::casper::broker::InHeaders::const_iterator ngx::casper::broker::InHeaders::find (const std::string& a_name) const
+{
+    if ( nullptr == part_ ) {
+        return end();
+    }
+
+    const ngx_list_part_t* found_part  = nullptr;
+    ngx_uint_t             found_index = 0;
+
+    const ngx_list_part_t* list_part = part_;
+    while ( NULL != list_part ) {
+        const ngx_table_elt_t* header = (const ngx_table_elt_t*)list_part->elts;
+        for ( ngx_uint_t index = 0 ; list_part->nelts > index ; ++index ) {
+            if ( a_name.length() == header[index].key.len && 0 < header[index].value.len
+                    &&
+                 0 == ngx_strncasecmp(header[index].key.data, (u_char*)a_name.c_str(), a_name.length()) ) {
+                found_part  = list_part;
+                found_index = index;
+            }
+        }
+        list_part = list_part->next;
+    }
+
+    return const_iterator(found_part, found_index);
+}
+
+/**
+ * @return Number of visible headers.
+ */
+size_t ngx::casper::broker::InHeaders::size () const
+{
+    size_t count = 0;
+    for ( auto it = begin() ; end() != it ; ++it ) {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Move a position forward until it points to a visible header, or past the end.
+ *
+ * @param a_part  List part, nullptr when past the end.
+ * @param a_index Element index within part.
+ */
+void ngx::casper::broker::InHeaders::Settle (const ngx_list_part_t*& a_part, ngx_uint_t& a_index)
+{
+    while ( NULL != a_part ) {
+        // ... past this part?
+        if ( a_index >= a_part->nelts ) {
+            a_part  = a_part->next;
+            a_index = 0;
+            continue;
+        }
+        const ngx_table_elt_t& header  = ((const ngx_table_elt_t*)a_part->elts)[a_index];
+        bool                   visible = ( 0 < header.key.len && 0 < header.value.len );
+        // ... repeated later on? last one wins ...
+        const ngx_list_part_t* part  = a_part;
+        ngx_uint_t             index = a_index + 1;
+        while ( true == visible && NULL != part ) {
+            const ngx_table_elt_t* other = (const ngx_table_elt_t*)part->elts;
+            for ( ; part->nelts > index ; ++index ) {
+                if ( header.key.len == other[index].key.len && 0 < other[index].value.len
+                        &&
+                     0 == ngx_strncasecmp(header.key.data, other[index].key.data, header.key.len) ) {
+                    visible = false;
+                    break;
+                }
+            }
+            part  = part->next;
+            index = 0;
+        }
+        if ( true == visible ) {
+            return;
+        }
+        a_index++;
+    }
+    a_index = 0;
+}
+
+#ifdef __APPLE__
+#pragma mark - const_iterator
+#endif
+
+/**
+ * @brief Default constructor.
+ *
+ * @param a_part  List part, nullptr when past the end.
+ * @param a_index Element index within part.
+ */
+ngx::casper::broker::InHeaders::const_iterator::const_iterator (const ngx_list_part_t* a_part, const ngx_uint_t a_index)
+    : part_(a_part), index_(a_index)
+{
+    /* empty */
+}
+
+/**
+ * @return Lowercased header name and value, copied now.
+ */
+ngx::casper::broker::InHeaders::const_iterator::reference ngx::casper::broker::InHeaders::const_iterator::operator* () const
+{
+    const ngx_table_elt_t& header = ((const ngx_table_elt_t*)part_->elts)[index_];
+    value_.first.assign(reinterpret_cast<char const*>(header.key.data), header.key.len);
+    std::transform(value_.first.begin(), value_.first.end(), value_.first.begin(), ::tolower);
+    value_.second.assign(reinterpret_cast<char const*>(header.value.data), header.value.len);
+    return value_;
+}
+
+/**
+ * @return Lowercased header name and value, copied now.
+ */
+ngx::casper::broker::InHeaders::const_iterator::pointer ngx::casper::broker::InHeaders::const_iterator::operator-> () const
+{
+    return &(operator*());
+}
+
+/**
+ * @brief Prefix increment.
+ */
+ngx::casper::broker::InHeaders::const_iterator& ngx::casper::broker::InHeaders::const_iterator::operator++ ()
+{
+    index_++;
+    ngx::casper::broker::InHeaders::Settle(part_, index_);
+    return *this;
+}
+
+/**
+ * @brief Postfix increment.
+ */
+ngx::casper::broker::InHeaders::const_iterator ngx::casper::broker::InHeaders::const_iterator::operator++ (int)
+{
+    const_iterator tmp = *this;
+    ++(*this);
+    return tmp;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file in_headers.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_NGX_CASPER_BROKER_IN_HEADERS_H_
+#define NRS_NGX_CASPER_BROKER_IN_HEADERS_H_
+
+#include <string>   // std::string
+#include <iterator> // std::forward_iterator_tag
+#include <utility>  // std::pair
+#include <stddef.h> // ptrdiff_t
+
+#include "ev/ngx/includes.h"
+
+namespace ngx
+{
+
+    namespace casper
+    {
+
+        namespace broker
+        {
+
+            /**
+             * @brief Read-only, case-insensitive view over a request 'in' headers.
+             *
+             *        Lookups walk nginx's own headers list, nothing is copied.
+             *        It can also be used as a read-only std::map<std::string, std::string> with lowercased keys:
+             *        repeated headers are visited once ( last occurrence wins ) and headers without value are skipped.
+             */
+            class InHeaders final
+            {
+
+            public: // Data Type(s)
+
+                /**
+                 * @brief Forward iterator, each header is only copied to a lowercased key / value pair when dereferenced.
+                 */
+                class const_iterator final
+                {
+
+                    friend class InHeaders;
+
+                public: // Data Type(s)
+
+                    typedef std::forward_iterator_tag                iterator_category;
+                    typedef std::pair<std::string, std::string>      value_type;
+                    typedef ptrdiff_t                                difference_type;
+                    typedef const value_type*                        pointer;
+                    typedef const value_type&                        reference;
+
+                private: // Data
+
+                    const ngx_list_part_t* part_;
+                    ngx_uint_t             index_;
+                    mutable value_type     value_;
+
+                private: // Constructor(s)
+
+                    const_iterator (const ngx_list_part_t* a_part, const ngx_uint_t a_index);
+
+                public: // Operator(s)
+
+                    reference       operator*  () const;
+                    pointer         operator-> () const;
+                    const_iterator& operator++ ();
+                    const_iterator  operator++ (int);
+
+                    inline bool operator== (const const_iterator& a_other) const
+                    {
+                        return ( part_ == a_other.part_ && index_ == a_other.index_ );
+                    }
+
+                    inline bool operator!= (const const_iterator& a_other) const
+                    {
+                        return false == ( *this == a_other );
+                    }
+
+                }; // end of class 'const_iterator'
+
+            private: // Data
+
+                const ngx_list_part_t* part_; //!< First part of the headers list, nullptr when not bound.
+
+            public: // Constructor(s) / Destructor
+
+                InHeaders ();
+                virtual ~InHeaders ();
+
+            public: // Method(s) / Function(s)
+
+                const ngx_table_elt_t* Find (const char* const a_name) const;
+                bool                   Get  (const char* const a_name, std::string& o_value) const;
+
+            public: // Method(s) / Function(s) - std::map like, read-only
+
+                const_iterator begin () const;
+                const_iterator end   () const;
+                const_iterator find  (const std::string& a_name) const;
+                size_t         size  () const;
+
+            public: // Inline Method(s) / Function(s)
+
+                void Bind (ngx_http_request_t* a_r);
+                void Bind (const ngx_list_t* a_list);
+
+            private: // Static Method(s) / Function(s)
+
+                static void Settle (const ngx_list_part_t*& a_part, ngx_uint_t& a_index);
+
+            }; // end of class 'InHeaders'
+
+            /**
+             * @brief Bind this view to a request.
+             *
+             * @param a_r
+             */
+            inline void InHeaders::Bind (ngx_http_request_t* a_r)
+            {
+                part_ = ( nullptr != a_r ? &a_r->headers_in.headers.part : nullptr );
+            }
+
+            /**
+             * @brief Bind this view to a headers list, laid out as nginx's request 'in' headers.
+             *
+             * @param a_list
+             */
+            inline void InHeaders::Bind (const ngx_list_t* a_list)
+            {
+                part_ = ( nullptr != a_list ? &a_list->part : nullptr );
+            }
+
+        } // end of namespace 'broker'
+
+    } // end of namespace 'casper'
+
+} // end of namespace 'ngx'
+
+#endif // NRS_NGX_CASPER_BROKER_IN_HEADERS_H_
@@ -32,6 +32,13 @@
 
 #include <algorithm>
 
+const std::set<std::string> ngx::casper::broker::jobify::Module::sk_supported_content_types_ = {
+    "application/json", "application/json; charset=UTF-8",
+    "application/vnd.api+json", "application/vnd.api+json;charset=utf-8'",
+    "text/plain", "text/plain; charset=UTF-8",
+    "application/x-www-form-urlencoded"
+};
+
 /**
  * @brief Default constructor.
  *
@@ -154,7 +161,7 @@ ngx_int_t ngx::casper::broker::jobify::Module::Run ()
         /* status_code_    */ NGX_HTTP_INTERNAL_SERVER_ERROR,
         /* status_message_ */ ""
     };
-    const ngx_int_t post_rv = PostJob(ctx_.ngx_ptr_->method, uri_, nullptr != ctx_.request_.body_ ? ctx_.request_.body_ : "",
+    const ngx_int_t post_rv = PostJob(ctx_.ngx_ptr_->method, uri_, nullptr != Body() ? Body() : "",
                                       a_tube,
                                       static_cast<ssize_t>(rv.ttr_),
                                       static_cast<ssize_t>(rv.validity_)
@@ -263,12 +270,7 @@ ngx_int_t ngx::casper::broker::jobify::Module::Factory (ngx_http_request_t* a_r,
         /* in_headers_              */ {},
         /* config_                  */ {},
         /* locale_                  */ "",
-        /* supported_content_types_ */ {
-            "application/json", "application/json; charset=UTF-8",
-            "application/vnd.api+json", "application/vnd.api+json;charset=utf-8'",
-            "text/plain", "text/plain; charset=UTF-8",
-            "application/x-www-form-urlencoded"        
-        }
+        /* supported_content_types_ */ &sk_supported_content_types_
     };
     
     ngx_int_t rv = ngx::casper::broker::Module::WarmUp(ngx_http_casper_broker_jobify_module, a_r, loc_conf->log_token,
@@ -312,7 +314,7 @@ ngx_int_t ngx::casper::broker::jobify::Module::Factory (ngx_http_request_t* a_r,
     
     return ::ngx::casper::broker::Module::Initialize(config, params,
                                                      [&config, &params, &broker_conf, &loc_conf] () -> ::ngx::casper::broker::Module* {
-                                                         return new ::ngx::casper::broker::jobify::Module(config, params, *broker_conf, *loc_conf);
+                                                         return new (config.ngx_ptr_) ::ngx::casper::broker::jobify::Module(config, params, *broker_conf, *loc_conf);
                                                      }
     );
 }
@@ -51,6 +51,10 @@ namespace ngx
                 class Module final : public ::ngx::casper::broker::Module
                 {
 
+                public: // Static Const Data
+
+                    static const std::set<std::string> sk_supported_content_types_;
+
                 private: // Helpers
 
                     Json::Reader              json_reader_;
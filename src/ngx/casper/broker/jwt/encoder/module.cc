@@ -23,21 +23,24 @@
 
 #include "ngx/casper/broker/jwt/encoder/errors.h"
 
-#include "ngx/casper/broker/exception.h"
+#include "ngx/casper/broker/jwt/encoder/signer.h"
 
-#include "cc/auth/jwt.h"
-#include "cc/auth/exception.h"
+#include "ngx/casper/broker/exception.h"
 
 #include "json/json.h"
 
-#include "cc/auth/jwt.h"
-#include "cc/auth/exception.h"
+#include "cc/utc_time.h"
+#include "cc/exception.h"
 
 #include <algorithm>
 
 const char* const ngx::casper::broker::jwt::encoder::Module::k_json_jwt_encoder_content_type_           = "application/text";
 const char* const ngx::casper::broker::jwt::encoder::Module::k_json_jwt_encoder_content_type_w_charset_ = "application/text;charset=utf-8";
 
+const std::set<std::string> ngx::casper::broker::jwt::encoder::Module::k_supported_content_types_ = { "application/json" };
+
+bool ngx::casper::broker::jwt::encoder::Module::s_signer_set_ = false;
+
 /**
  * @brief Default constructor.
  *
@@ -53,6 +56,18 @@ ngx::casper::broker::jwt::encoder::Module::Module (const ngx::casper::broker::Mo
     jwt_public_rsa_key_  = std::string(reinterpret_cast<const char*>(a_ngx_loc_conf.rsa_public_key.data), a_ngx_loc_conf.rsa_public_key.len);
     jwt_private_rsa_key_ = std::string(reinterpret_cast<const char*>(a_ngx_loc_conf.rsa_private_key.data), a_ngx_loc_conf.rsa_private_key.len);
     jwt_duration_        = static_cast<uint64_t>(a_ngx_loc_conf.duration);
+    jwt_algorithm_       = ngx::casper::broker::jwt::encoder::Signer::Algorithm::RS256;
+    // ... signature algorithm, already validated when configuration was loaded ...
+    (void)ngx::casper::broker::jwt::encoder::Signer::ParseAlgorithm(std::string(reinterpret_cast<const char*>(a_ngx_loc_conf.algorithm.data), a_ngx_loc_conf.algorithm.len), jwt_algorithm_);
+    // ... one-shot signer setup, keys and signing context are kept per worker ...
+    if ( false == s_signer_set_ ) {
+        try {
+            ngx::casper::broker::jwt::encoder::Signer::GetInstance().Startup();
+            s_signer_set_ = true;
+        } catch (const ::cc::Exception& a_cc_exception) {
+            NGX_BROKER_MODULE_SET_INTERNAL_SERVER_ERROR(ctx_, a_cc_exception.what());
+        }
+    }
 }
 
 /**
@@ -91,7 +106,7 @@ ngx_int_t ngx::casper::broker::jwt::encoder::Module::Run ()
     ctx_.response_.return_code_ = NGX_ERROR;    
     
     // ... 'body' must be present ...
-    if ( nullptr == ctx_.request_.body_ ) {
+    if ( nullptr == Body() ) {
         // ... or we're done ...
         return NGX_BROKER_MODULE_SET_BAD_REQUEST_ERROR_I18N(ctx_, "BROKER_MISSING_OR_INVALID_BODY_ERROR");
     }
@@ -100,7 +115,7 @@ ngx_int_t ngx::casper::broker::jwt::encoder::Module::Run ()
         
         Json::Value  object ;
         Json::Reader reader;
-        if ( false == reader.parse(ctx_.request_.body_, object, false)  ) {
+        if ( false == reader.parse(Body(), object, false)  ) {
             const auto errors = reader.getStructuredErrors();
             if ( errors.size() > 0 ) {
                 throw ngx::casper::broker::Exception("bad_request",
@@ -112,20 +127,23 @@ ngx_int_t ngx::casper::broker::jwt::encoder::Module::Run ()
             }
         }
 
-        cc::auth::JWT jwt(jwt_iss_.c_str());
-
         // ... check if there are any reseved claims ...
         for ( auto member : object.getMemberNames() ) {
-            if ( true == jwt.IsRegisteredClaim(member) ) {
+            if ( true == ngx::casper::broker::jwt::encoder::Signer::IsRegisteredClaim(member) ) {
                 throw ngx::casper::broker::Exception("bad_request",
                                                      "Invalid JSON field name '%s' - it's a JWT registered claim!",
                                                      member.c_str()
                 );
             }
-            jwt.SetUnregisteredClaim(member, object[member]);
         }
         
-        const std::string encoded_jwt = jwt.Encode(jwt_duration_, jwt_private_rsa_key_);
+        // ... registered claims ...
+        const int64_t now = cc::UTCTime::Now();
+        object["iss"] = jwt_iss_;
+        object["iat"] = static_cast<Json::Int64>(now);
+        object["exp"] = static_cast<Json::Int64>(now + static_cast<int64_t>(jwt_duration_));
+        
+        const std::string encoded_jwt = ngx::casper::broker::jwt::encoder::Signer::GetInstance().Sign(jwt_algorithm_, jwt_private_rsa_key_, object, now);
         
         const bool as_json = ( ctx_.request_.headers_.end() != ctx_.request_.headers_.find("accept") );
         if ( true == as_json ) {
@@ -151,8 +169,8 @@ ngx_int_t ngx::casper::broker::jwt::encoder::Module::Run ()
         return NGX_BROKER_MODULE_SET_BAD_REQUEST_EXCEPTION(ctx_, a_json_exception);
     } catch (const ngx::casper::broker::Exception& a_broker_exception) {
         return NGX_BROKER_MODULE_SET_BAD_REQUEST_EXCEPTION(ctx_, a_broker_exception);
-    } catch (const cc::auth::Exception& a_auth_exception) {
-        return NGX_BROKER_MODULE_SET_BAD_REQUEST_EXCEPTION(ctx_, a_auth_exception);
+    } catch (const ::cc::Exception& a_cc_exception) {
+        return NGX_BROKER_MODULE_SET_INTERNAL_SERVER_ERROR(ctx_, a_cc_exception.what());
     }
     
     // ... we're done ...
@@ -187,7 +205,7 @@ ngx_int_t ngx::casper::broker::jwt::encoder::Module::Factory (ngx_http_request_t
         /* in_headers_              */ {},
         /* config_                  */ {},
         /* locale_                  */ "",
-        /* supported_content_types_ */ { "application/json" }
+        /* supported_content_types_ */ &k_supported_content_types_
     };
 
     ngx_int_t rv = ngx::casper::broker::Module::WarmUp(ngx_http_casper_broker_jwt_encoder_module, a_r, loc_conf->log_token,
@@ -237,7 +255,7 @@ ngx_int_t ngx::casper::broker::jwt::encoder::Module::Factory (ngx_http_request_t
     
     return ::ngx::casper::broker::Module::Initialize(config, params,
                                                      [&config, &params, &loc_conf] () -> ::ngx::casper::broker::Module* {
-                                                         return new ::ngx::casper::broker::jwt::encoder::Module(config, params, *loc_conf);
+                                                         return new (config.ngx_ptr_) ::ngx::casper::broker::jwt::encoder::Module(config, params, *loc_conf);
                                                      }
     );
 }
@@ -27,6 +27,8 @@
 
 #include "ngx/casper/broker/jwt/encoder/module/ngx_http_casper_broker_jwt_encoder_module.h"
 
+#include "ngx/casper/broker/jwt/encoder/signer.h"
+
 #include "json/json.h"
 
 #include <map>    // std::map
@@ -54,13 +56,19 @@ namespace ngx
                         
                         static const char* const k_json_jwt_encoder_content_type_;
                         static const char* const k_json_jwt_encoder_content_type_w_charset_;
+                        static const std::set<std::string> k_supported_content_types_;
+                        
+                    private: // Static Data
+                        
+                        static bool s_signer_set_;
                         
                     private: // Data
                         
-                        std::string jwt_iss_;
-                        std::string jwt_public_rsa_key_;
-                        std::string jwt_private_rsa_key_;
-                        uint64_t    jwt_duration_;
+                        std::string       jwt_iss_;
+                        std::string       jwt_public_rsa_key_;
+                        std::string       jwt_private_rsa_key_;
+                        uint64_t          jwt_duration_;
+                        Signer::Algorithm jwt_algorithm_;
                         
                     protected: // Constructor(s)
                         
@@ -98,6 +98,14 @@ static ngx_command_t ngx_http_casper_broker_jwt_encoder_module_commands[] = {
         offsetof(ngx_http_casper_broker_jwt_encoder_module_loc_conf_t, duration),
         NULL
     },
+    {
+        ngx_string("nginx_casper_broker_jwt_encoder_algorithm"),
+        NGX_HTTP_LOC_CONF|NGX_CONF_TAKE1,
+        ngx_conf_set_str_slot,
+        NGX_HTTP_LOC_CONF_OFFSET,
+        offsetof(ngx_http_casper_broker_jwt_encoder_module_loc_conf_t, algorithm),
+        NULL
+    },
 
     ngx_null_command
 };
@@ -159,6 +167,7 @@ static void* ngx_http_casper_broker_jwt_encoder_module_create_loc_conf (ngx_conf
     conf->rsa_public_key  = ngx_null_string;
     conf->rsa_private_key = ngx_null_string;
     conf->duration        = NGX_CONF_UNSET_UINT;
+    conf->algorithm       = ngx_null_string;
 
     return conf;
 }
@@ -170,7 +179,7 @@ static void* ngx_http_casper_broker_jwt_encoder_module_create_loc_conf (ngx_conf
  * @param a_parent
  * @param a_child
  */
-static char* ngx_http_casper_broker_jwt_encoder_module_merge_loc_conf (ngx_conf_t* /* a_cf */, void* a_parent, void* a_child)
+static char* ngx_http_casper_broker_jwt_encoder_module_merge_loc_conf (ngx_conf_t* a_cf, void* a_parent, void* a_child)
 {
     ngx_http_casper_broker_jwt_encoder_module_loc_conf_t* prev = (ngx_http_casper_broker_jwt_encoder_module_loc_conf_t*) a_parent;
     ngx_http_casper_broker_jwt_encoder_module_loc_conf_t* conf = (ngx_http_casper_broker_jwt_encoder_module_loc_conf_t*) a_child;
@@ -181,6 +190,17 @@ static char* ngx_http_casper_broker_jwt_encoder_module_merge_loc_conf (ngx_conf_
     ngx_conf_merge_str_value (conf->rsa_public_key , prev->rsa_public_key ,                   "" );
     ngx_conf_merge_str_value (conf->rsa_private_key, prev->rsa_private_key,                   "" );
     ngx_conf_merge_uint_value(conf->duration       , prev->duration       ,                    0 );
+    ngx_conf_merge_str_value (conf->algorithm      , prev->algorithm      ,              "RS256" );
+    {
+        ngx::casper::broker::jwt::encoder::Signer::Algorithm algorithm;
+        const std::string value = std::string(reinterpret_cast<const char*>(conf->algorithm.data), conf->algorithm.len);
+        if ( false == ngx::casper::broker::jwt::encoder::Signer::ParseAlgorithm(value, algorithm) ) {
+            ngx_conf_log_error(NGX_LOG_EMERG, a_cf, 0,
+                               "invalid directive 'nginx_casper_broker_jwt_encoder_algorithm' value - unsupported algorithm '%s'", value.c_str()
+            );
+            return (char*) NGX_CONF_ERROR;
+        }
+    }
 
     NGX_BROKER_MODULE_LOC_CONF_MERGED();
     
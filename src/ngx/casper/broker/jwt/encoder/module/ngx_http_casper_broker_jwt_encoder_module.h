@@ -44,6 +44,7 @@ typedef struct {
     ngx_str_t  rsa_public_key;  //!< URI to JWT public key pem file
     ngx_str_t  rsa_private_key; //!< URI to JWT private key pem file
     ngx_uint_t duration;        //!< in seconds
+    ngx_str_t  algorithm;       //!< JWS algorithm: RS256, RS384, RS512, ES256 or EdDSA
 } ngx_http_casper_broker_jwt_encoder_module_loc_conf_t;
 
 extern ngx_module_t ngx_http_casper_broker_jwt_encoder_module;
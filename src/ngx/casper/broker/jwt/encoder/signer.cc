@@ -0,0 +1,340 @@
+/**
+ * @file signer.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ngx/casper/broker/jwt/encoder/signer.h"
+
+#include "cc/exception.h"
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/ecdsa.h>
+#include <openssl/evp.h>
+#include <openssl/obj_mac.h> // NID_X9_62_prime256v1
+#include <openssl/pem.h>
+
+#include <string.h> // strerror
+#include <errno.h>  // errno
+
+#include <vector> // std::vector
+
+const std::set<std::string> ngx::casper::broker::jwt::encoder::Signer::sk_registered_claims_ = {
+    "iss", "sub", "aud", "exp", "nbf", "iat", "jti"
+};
+
+/**
+ * @brief One-shot setup.
+ */
+void ngx::casper::broker::jwt::encoder::Signer::Startup ()
+{
+    if ( nullptr == md_ctx_ ) {
+        md_ctx_ = EVP_MD_CTX_new();
+        if ( nullptr == md_ctx_ ) {
+            throw ::cc::Exception("Unable to allocate JWT %s context!", "signing");
+        }
+    }
+    json_writer_.omitEndingLineFeed();
+}
+
+/**
+ * @brief Release all keys and signing context.
+ */
+void ngx::casper::broker::jwt::encoder::Signer::Shutdown ()
+{
+    for ( auto& it : keys_ ) {
+        EVP_PKEY_free(it.second.pkey_);
+    }
+    keys_.clear();
+    headers_.clear();
+    if ( nullptr != md_ctx_ ) {
+        EVP_MD_CTX_free(md_ctx_);
+        md_ctx_ = nullptr;
+    }
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Encode and sign a JWT.
+ *
+ * @param a_algorithm JWS algorithm.
+ * @param a_key_uri   PEM encoded private key file URI.
+ * @param a_payload   Claims, registered ones included.
+ * @param a_now       Current UTC time, in seconds.
+ *
+ * @return Encoded JWT.
+ */
+std::string ngx::casper::broker::jwt::encoder::Signer::Sign (const ngx::casper::broker::jwt::encoder::Signer::Algorithm a_algorithm, const std::string& a_key_uri,
+                                                             const Json::Value& a_payload, const int64_t a_now)
+{
+    EVP_PKEY* pkey = LoadKey(a_algorithm, a_key_uri, a_now);
+
+    // ... <header>.<payload> ...
+    const std::string payload = json_writer_.write(a_payload);
+    std::string jwt = Header(a_algorithm);
+    jwt += '.';
+    B64URLEncode(reinterpret_cast<const unsigned char*>(payload.c_str()), payload.length(), jwt);
+
+    const EVP_MD* md = nullptr;
+    switch (a_algorithm) {
+        case Algorithm::RS256:
+        case Algorithm::ES256:
+            md = EVP_sha256();
+            break;
+        case Algorithm::RS384:
+            md = EVP_sha384();
+            break;
+        case Algorithm::RS512:
+            md = EVP_sha512();
+            break;
+        case Algorithm::EdDSA:
+            // ... no pre-hash ...
+            break;
+    }
+
+    // ... sign, reusing context ...
+    size_t length = 0;
+    EVP_MD_CTX_reset(md_ctx_);
+    if (
+        1 != EVP_DigestSignInit(md_ctx_, nullptr, md, nullptr, pkey)
+            ||
+        1 != EVP_DigestSign(md_ctx_, nullptr, &length, reinterpret_cast<const unsigned char*>(jwt.c_str()), jwt.length())
+    ) {
+        throw ::cc::Exception("Unable to sign JWT: %s!", "initialization failed");
+    }
+    std::vector<unsigned char> signature(length);
+    if ( 1 != EVP_DigestSign(md_ctx_, signature.data(), &length, reinterpret_cast<const unsigned char*>(jwt.c_str()), jwt.length()) ) {
+        throw ::cc::Exception("Unable to sign JWT: %s!", "signature failed");
+    }
+    signature.resize(length);
+
+    // ... ES256 signature is r || s, not DER ...
+    if ( Algorithm::ES256 == a_algorithm ) {
+        const unsigned char* p      = signature.data();
+        ECDSA_SIG*           ec_sig = d2i_ECDSA_SIG(nullptr, &p, static_cast<long>(signature.size()));
+        if ( nullptr == ec_sig ) {
+            throw ::cc::Exception("Unable to sign JWT: %s!", "invalid ECDSA signature");
+        }
+        const BIGNUM* r = nullptr;
+        const BIGNUM* s = nullptr;
+        ECDSA_SIG_get0(ec_sig, &r, &s);
+        signature.resize(64);
+        const bool converted = ( 32 == BN_bn2binpad(r, signature.data(), 32) && 32 == BN_bn2binpad(s, signature.data() + 32, 32) );
+        ECDSA_SIG_free(ec_sig);
+        if ( false == converted ) {
+            throw ::cc::Exception("Unable to sign JWT: %s!", "invalid ECDSA signature");
+        }
+    }
+
+    // ... <header>.<payload>.<signature> ...
+    jwt += '.';
+    B64URLEncode(signature.data(), signature.size(), jwt);
+
+    return jwt;
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Translate a JWS algorithm name.
+ *
+ * @param a_name      'alg' value.
+ * @param o_algorithm Algorithm.
+ *
+ * @return True if algorithm is supported, false otherwise.
+ */
+bool ngx::casper::broker::jwt::encoder::Signer::ParseAlgorithm (const std::string& a_name, ngx::casper::broker::jwt::encoder::Signer::Algorithm& o_algorithm)
+{
+    static const std::map<std::string, Algorithm> k_algorithms = {
+        { "RS256", Algorithm::RS256 },
+        { "RS384", Algorithm::RS384 },
+        { "RS512", Algorithm::RS512 },
+        { "ES256", Algorithm::ES256 },
+        { "EdDSA", Algorithm::EdDSA }
+    };
+    const auto it = k_algorithms.find(a_name);
+    if ( k_algorithms.end() == it ) {
+        return false;
+    }
+    o_algorithm = it->second;
+    return true;
+}
+
+/**
+ * @return True if the provided name is a JWT registered claim name.
+ *
+ * @param a_name Claim name.
+ */
+bool ngx::casper::broker::jwt::encoder::Signer::IsRegisteredClaim (const std::string& a_name)
+{
+    return ( sk_registered_claims_.end() != sk_registered_claims_.find(a_name) );
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Load or reload a private key, if file changed ( checked at most once per second ).
+ *
+ * @param a_algorithm JWS algorithm the key will be used with.
+ * @param a_key_uri   PEM encoded private key file URI.
+ * @param a_now       Current UTC time, in seconds.
+ *
+ * @return Private key, owned by this instance.
+ */
+EVP_PKEY* ngx::casper::broker::jwt::encoder::Signer::LoadKey (const ngx::casper::broker::jwt::encoder::Signer::Algorithm a_algorithm, const std::string& a_key_uri,
+                                                              const int64_t a_now)
+{
+    // ... same file might be configured for more than one algorithm, each one is checked on it's own ...
+    const KeyID id = std::make_pair(a_key_uri, a_algorithm);
+    auto it = keys_.find(id);
+    if ( keys_.end() != it && a_now == it->second.checked_at_ ) {
+        return it->second.pkey_;
+    }
+
+    struct stat st;
+    if ( 0 != stat(a_key_uri.c_str(), &st) ) {
+        throw ::cc::Exception("Unable to access JWT private key file '%s': %s!", a_key_uri.c_str(), strerror(errno));
+    }
+
+    // ... unchanged?
+    if ( keys_.end() != it && st.st_ino == it->second.stat_.st_ino && st.st_size == it->second.stat_.st_size && st.st_mtime == it->second.stat_.st_mtime ) {
+        it->second.checked_at_ = a_now;
+        return it->second.pkey_;
+    }
+
+    BIO* bio = BIO_new_file(a_key_uri.c_str(), "r");
+    if ( nullptr == bio ) {
+        throw ::cc::Exception("Unable to open JWT private key file '%s'!", a_key_uri.c_str());
+    }
+    EVP_PKEY* pkey = PEM_read_bio_PrivateKey(bio, nullptr, nullptr, nullptr);
+    BIO_free(bio);
+    if ( nullptr == pkey ) {
+        throw ::cc::Exception("Unable to load JWT private key from '%s'!", a_key_uri.c_str());
+    }
+
+    // ... key must match algorithm ...
+    bool usable = false;
+    switch (a_algorithm) {
+        case Algorithm::RS256:
+        case Algorithm::RS384:
+        case Algorithm::RS512:
+            usable = ( EVP_PKEY_RSA == EVP_PKEY_id(pkey) );
+            break;
+        case Algorithm::ES256:
+            // ... P-256 only, other 256 bits curves ( secp256k1, brainpoolP256r1, ... ) are not ES256 ...
+            if ( EVP_PKEY_EC == EVP_PKEY_id(pkey) ) {
+                const EC_KEY* ec_key = EVP_PKEY_get0_EC_KEY(pkey);
+                usable = ( nullptr != ec_key && NID_X9_62_prime256v1 == EC_GROUP_get_curve_name(EC_KEY_get0_group(ec_key)) );
+            }
+            break;
+        case Algorithm::EdDSA:
+            usable = ( EVP_PKEY_ED25519 == EVP_PKEY_id(pkey) );
+            break;
+    }
+    if ( false == usable ) {
+        EVP_PKEY_free(pkey);
+        throw ::cc::Exception("JWT private key '%s' can't be used with the configured algorithm!", a_key_uri.c_str());
+    }
+
+    if ( keys_.end() != it ) {
+        EVP_PKEY_free(it->second.pkey_);
+        it->second = { pkey, st, a_now };
+    } else {
+        keys_[id] = { pkey, st, a_now };
+    }
+
+    return pkey;
+}
+
+/**
+ * @brief Obtain an encoded JOSE header.
+ *
+ * @param a_algorithm JWS algorithm.
+ *
+ * @return Encoded header, built only once per algorithm.
+ */
+const std::string& ngx::casper::broker::jwt::encoder::Signer::Header (const ngx::casper::broker::jwt::encoder::Signer::Algorithm a_algorithm)
+{
+    auto it = headers_.find(a_algorithm);
+    if ( headers_.end() != it ) {
+        return it->second;
+    }
+
+    const char* name = "RS256";
+    switch (a_algorithm) {
+        case Algorithm::RS256: name = "RS256"; break;
+        case Algorithm::RS384: name = "RS384"; break;
+        case Algorithm::RS512: name = "RS512"; break;
+        case Algorithm::ES256: name = "ES256"; break;
+        case Algorithm::EdDSA: name = "EdDSA"; break;
+    }
+
+    Json::Value header = Json::Value(Json::ValueType::objectValue);
+    header["alg"] = name;
+    header["typ"] = "JWT";
+
+    const std::string json = json_writer_.write(header);
+    std::string& encoded = headers_[a_algorithm];
+    B64URLEncode(reinterpret_cast<const unsigned char*>(json.c_str()), json.length(), encoded);
+    return encoded;
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Append base64url encoded data, without padding.
+ *
+ * @param a_data   Data to encode.
+ * @param a_length Data length.
+ * @param o_data   String to append encoded data to.
+ */
+void ngx::casper::broker::jwt::encoder::Signer::B64URLEncode (const unsigned char* a_data, const size_t a_length, std::string& o_data)
+{
+    static const char* const k_alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+    o_data.reserve(o_data.length() + ( ( a_length + 2 ) / 3 ) * 4);
+
+    size_t idx = 0;
+    for ( ; idx + 2 < a_length ; idx += 3 ) {
+        const uint32_t v = ( static_cast<uint32_t>(a_data[idx]) << 16 ) | ( static_cast<uint32_t>(a_data[idx + 1]) << 8 ) | static_cast<uint32_t>(a_data[idx + 2]);
+        o_data += k_alphabet[( v >> 18 ) & 0x3F];
+        o_data += k_alphabet[( v >> 12 ) & 0x3F];
+        o_data += k_alphabet[( v >>  6 ) & 0x3F];
+        o_data += k_alphabet[v & 0x3F];
+    }
+    if ( idx + 1 == a_length ) {
+        const uint32_t v = ( static_cast<uint32_t>(a_data[idx]) << 16 );
+        o_data += k_alphabet[( v >> 18 ) & 0x3F];
+        o_data += k_alphabet[( v >> 12 ) & 0x3F];
+    } else if ( idx + 2 == a_length ) {
+        const uint32_t v = ( static_cast<uint32_t>(a_data[idx]) << 16 ) | ( static_cast<uint32_t>(a_data[idx + 1]) << 8 );
+        o_data += k_alphabet[( v >> 18 ) & 0x3F];
+        o_data += k_alphabet[( v >> 12 ) & 0x3F];
+        o_data += k_alphabet[( v >>  6 ) & 0x3F];
+    }
+}
@@ -0,0 +1,144 @@
+/**
+ * @file signer.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_NGX_CASPER_BROKER_JWT_ENCODER_SIGNER_H_
+#define NRS_NGX_CASPER_BROKER_JWT_ENCODER_SIGNER_H_
+
+#include "osal/osal_singleton.h"
+
+#include "json/json.h"
+
+#include <openssl/ossl_typ.h> // EVP_PKEY, EVP_MD_CTX, EVP_MD
+
+#include <sys/stat.h> // struct stat
+
+#include <stdint.h> // int64_t, uint8_t
+#include <map>      // std::map
+#include <set>      // std::set
+#include <string>   // std::string
+#include <utility>  // std::pair
+
+namespace ngx
+{
+
+    namespace casper
+    {
+
+        namespace broker
+        {
+
+            namespace jwt
+            {
+
+                namespace encoder
+                {
+
+                    // ---- //
+                    class Signer;
+                    class SignerInitializer final : public ::osal::Initializer<Signer>
+                    {
+
+                    public: // Constructor(s) / Destructor
+
+                        SignerInitializer (Signer& a_instance)
+                            : ::osal::Initializer<Signer>(a_instance)
+                        {
+                            /* empty */
+                        }
+                        virtual ~SignerInitializer ()
+                        {
+                            /* empty */
+                        }
+
+                    }; // end of class 'SignerInitializer'
+
+                    // ---- //
+                    class Signer final : public osal::Singleton<Signer, SignerInitializer>
+                    {
+
+                    public: // Enum(s)
+
+                        enum class Algorithm : uint8_t {
+                            RS256,
+                            RS384,
+                            RS512,
+                            ES256,
+                            EdDSA
+                        };
+
+                    private: // Data Type(s)
+
+                        typedef struct {
+                            EVP_PKEY*   pkey_;
+                            struct stat stat_;
+                            int64_t     checked_at_;
+                        } Key;
+
+                        typedef std::pair<std::string, Algorithm> KeyID;
+
+                    private: // Static Const Data
+
+                        static const std::set<std::string> sk_registered_claims_;
+
+                    private: // Data
+
+                        std::map<KeyID, Key>             keys_;
+                        std::map<Algorithm, std::string> headers_;
+                        EVP_MD_CTX*                      md_ctx_ = nullptr;
+                        Json::FastWriter                 json_writer_;
+
+                    public: // One-shot Call Method(s) / Function(s)
+
+                        void Startup  ();
+                        void Shutdown ();
+
+                    public: // Method(s) / Function(s)
+
+                        std::string Sign (const Algorithm a_algorithm, const std::string& a_key_uri, const Json::Value& a_payload, const int64_t a_now);
+
+                    public: // Static Method(s) / Function(s)
+
+                        static bool ParseAlgorithm    (const std::string& a_name, Algorithm& o_algorithm);
+                        static bool IsRegisteredClaim (const std::string& a_name);
+
+                    private: // Method(s) / Function(s)
+
+                        EVP_PKEY*          LoadKey (const Algorithm a_algorithm, const std::string& a_key_uri, const int64_t a_now);
+                        const std::string& Header  (const Algorithm a_algorithm);
+
+                    private: // Static Method(s) / Function(s)
+
+                        static void B64URLEncode (const unsigned char* a_data, const size_t a_length, std::string& o_data);
+
+                    }; // end of class 'Signer'
+
+                } // end of namespace 'encoder'
+
+            } // end of namespace 'jwt'
+
+        } // end of namespace 'broker'
+
+    } // end of namespace 'casper'
+
+} // end of namespace 'ngx'
+
+#endif // NRS_NGX_CASPER_BROKER_JWT_ENCODER_SIGNER_H_
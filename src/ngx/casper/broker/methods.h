@@ -0,0 +1,85 @@
+/**
+ * @file methods.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_NGX_CASPER_BROKER_METHODS_H_
+#define NRS_NGX_CASPER_BROKER_METHODS_H_
+
+#include <initializer_list> // std::initializer_list
+
+#include "ev/ngx/includes.h"
+
+namespace ngx
+{
+
+    namespace casper
+    {
+
+        namespace broker
+        {
+
+            /**
+             * @brief A set of NGX_HTTP_* methods, kept as a bit mask - no allocations.
+             */
+            class Methods final
+            {
+                
+            private: // Data
+                
+                ngx_uint_t mask_;
+                
+            public: // Constructor(s) / Destructor
+                
+                Methods ()
+                    : mask_(0)
+                {
+                    /* empty */
+                }
+                
+                Methods (std::initializer_list<ngx_uint_t> a_methods)
+                    : mask_(0)
+                {
+                    for ( const auto method : a_methods ) {
+                        mask_ |= method;
+                    }
+                }
+                
+            public: // Inline Method(s) / Function(s)
+                
+                inline void insert (const ngx_uint_t a_method)
+                {
+                    mask_ |= a_method;
+                }
+                
+                inline bool contains (const ngx_uint_t a_method) const
+                {
+                    return ( 0 != ( mask_ & a_method ) );
+                }
+                
+            }; // end of class 'Methods'
+
+        } // end of namespace 'broker'
+
+    } // end of namespace 'casper'
+
+} // end of namespace 'ngx'
+
+#endif // NRS_NGX_CASPER_BROKER_METHODS_H_
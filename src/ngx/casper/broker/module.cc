@@ -41,10 +41,18 @@
 #include "ngx/casper/broker/module/ngx_http_casper_broker_module.h"
 
 #include <algorithm>
+#include <new>      // std::bad_alloc
 #include <string.h> // strcasestr
+#include <sys/mman.h> // mmap, munmap, madvise
+#include <vector>
 
 #include "ngx/ngx_utils.h"
 
+/**
+ * @brief Spooled request bodies are handed to interceptors in slices of this size.
+ */
+#define NRS_NGX_CASPER_BROKER_MODULE_BODY_SLICE_SIZE static_cast<size_t>(1024 * 1024)
+
 const char* const ngx::casper::broker::Module::k_content_type_header_key_             = "Content-Type";
 
 const char* const ngx::casper::broker::Module::k_service_id_key_lc_                   = "service_id";
@@ -162,8 +170,11 @@ ngx::casper::broker::Module::Module (const char* const a_name, const ngx::casper
             /* locale_                */ a_params.locale_,
             /* location_              */ "",
             /* content_type_          */ a_config.rx_content_type_,
-            /* headers_               */ {},
+            /* headers_               */ a_params.in_headers_,
             /* body_                  */ nullptr,
+            /* body_length_           */ 0,
+            /* body_chain_            */ nullptr,
+            /* body_mapped_           */ 0,
             /* body_interceptor_      */ {
                 /* dst_    */ nullptr,
                 /* writer_ */ nullptr,
@@ -222,6 +233,7 @@ ngx::casper::broker::Module::Module (const char* const a_name, const ngx::casper
         /* at_content_handler_ */ false,
         /* cycle_cnt_          */ 0,
         /* errors_ptr_         */ nullptr,
+        /* generation_         */ 0,
         /* logger_data_ref_    */ loggable_data_,
         /* log_body_           */ true
     }
@@ -232,12 +244,12 @@ ngx::casper::broker::Module::Module (const char* const a_name, const ngx::casper
     //
     ctx_.request_.connection_validity_ = static_cast<size_t>(std::atoi(a_params.config_.find(ngx::casper::broker::Module::k_connection_validity_key_lc_)->second.c_str()));
 
-    const std::map<std::string, std::string*> map = {
+    const std::pair<const char* const, std::string*> map [] = {
         { ngx::casper::broker::Module::k_session_cookie_name_key_lc_  , &ctx_.request_.session_cookie_.name_   },
         { ngx::casper::broker::Module::k_session_cookie_domain_key_lc_, &ctx_.request_.session_cookie_.domain_ },
         { ngx::casper::broker::Module::k_session_cookie_path_key_lc_  , &ctx_.request_.session_cookie_.path_   },
     };
-    for ( auto entry : map ) {
+    for ( const auto& entry : map ) {
         const auto it = a_params.config_.find(entry.first);
         if ( a_params.config_.end() != it ) {
             (*entry.second) = it->second;
@@ -284,15 +296,8 @@ ngx::casper::broker::Module::Module (const char* const a_name, const ngx::casper
     ctx_.response_.asynchronous_     = false;
     ctx_.response_.serialize_errors_ = a_config.serialize_errors_;
     
-    // ... copy headers ...
-    for ( auto it : a_params.in_headers_ ) {
-        ctx_.request_.headers_[it.first] = it.second;
-    }
     // ... grab request actual Content-Type ...
-    const auto content_type_it = ctx_.request_.headers_.find("content-type");
-    if ( ctx_.request_.headers_.end() != content_type_it ) {
-         ctx_.request_.content_type_ = content_type_it->second;
-    }
+    (void)ctx_.request_.headers_.Get("content-type", ctx_.request_.content_type_);
 
     // ... set browser ...
     if ( ctx_.ngx_ptr_->headers_in.msie ) {
@@ -347,25 +352,30 @@ ngx::casper::broker::Module::Module (const char* const a_name, const ngx::casper
                                       a_name, NGX_VERSION
     );
     
-    // ... output in headers ...
-    std::map<std::string, std::string> kv = ctx_.request_.headers_;
-    kv["uri"]    = ctx_.request_.uri_.c_str();
-    kv["method"] = ctx_.request_.method_.c_str();
-    
-    for ( auto header : { "user-agent", "host", "uri", "method", "content-type", "content-length", "connection", "accept" } ) {
-        const auto it = kv.find(header);
-        if ( kv.end() == it ) {
+    // ... output in headers, read from the view - nothing is copied ...
+    static const char* const k_logged_first [] = { "user-agent", "host", "uri", "method", "content-type", "content-length", "connection", "accept" };
+    for ( auto header : k_logged_first ) {
+        std::string value;
+        if ( 0 == strcmp(header, "uri") ) {
+            value = ctx_.request_.uri_;
+        } else if ( 0 == strcmp(header, "method") ) {
+            value = ctx_.request_.method_;
+        } else if ( false == ctx_.request_.headers_.Get(header, value) ) {
             continue;
         }
         std::string key = header;
         std::transform(key.begin(), key.end(), key.begin(), ::toupper);
         ::ev::LoggerV2::GetInstance().Log(logger_client_, "cc-modules",
                                           NRS_NGX_CASPER_BROKER_MODULE_LOGGER_KEY_FMT ",%s",
-                                          ( "IN : " + key ).c_str(), it->second.c_str()
+                                          ( "IN : " + key ).c_str(), value.c_str()
         );
-        kv.erase(it);
     }
-    for ( auto it : kv ) {
+    for ( const auto& it : ctx_.request_.headers_ ) {
+        if ( std::end(k_logged_first) != std::find_if(std::begin(k_logged_first), std::end(k_logged_first), [&it] (const char* const a_header) {
+            return ( 0 == strcmp(a_header, it.first.c_str()) );
+        }) ) {
+            continue;
+        }
         ::ev::LoggerV2::GetInstance().Log(logger_client_, "cc-modules",
                                           NRS_NGX_CASPER_BROKER_MODULE_LOGGER_KEY_FMT ",%s=%s",
                                           "IN : HEADER", it.first.c_str(), it.second.c_str()
@@ -399,9 +409,7 @@ ngx::casper::broker::Module::~Module ()
     if ( nullptr != executor_ ) {
         delete executor_;
     }
-    if ( nullptr != ctx_.request_.body_ ) {
-        delete [] ctx_.request_.body_;
-    }
+    ReleaseBody();
     // ... write to permanent log ...
     ::ev::LoggerV2::GetInstance().Log(logger_client_, "cc-modules",
                                       NRS_NGX_CASPER_BROKER_MODULE_LOGGER_KEY_FMT ",count=" SIZET_FMT,
@@ -415,6 +423,39 @@ ngx::casper::broker::Module::~Module ()
     delete logger_client_;
 }
 
+/**
+ * @brief Allocate a module instance from the request pool.
+ *
+ * @param a_size Instance size, in bytes.
+ * @param a_r    Request that will own this instance.
+ *
+ * @return Uninitialized memory, released along with the request pool.
+ */
+void* ngx::casper::broker::Module::operator new (size_t a_size, ngx_http_request_t* a_r)
+{
+    void* ptr = ngx_palloc(a_r->pool, a_size);
+    if ( nullptr == ptr ) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+/**
+ * @brief Called only when constructor throws - memory is released along with the request pool.
+ */
+void ngx::casper::broker::Module::operator delete (void* /* a_ptr */, ngx_http_request_t* /* a_r */)
+{
+    /* empty */
+}
+
+/**
+ * @brief Called by \link Cleanup \link after destructor - memory is released along with the request pool.
+ */
+void ngx::casper::broker::Module::operator delete (void* /* a_ptr */)
+{
+    /* empty */
+}
+
 #ifdef __APPLE__
 #pragma mark -
 #endif
@@ -458,7 +499,7 @@ ngx_int_t ngx::casper::broker::Module::Setup ()
 ngx_int_t ngx::casper::broker::Module::ValidateRequest (std::function<void()> a_callback)
 {
     // ... expecting body?
-    if ( body_read_supported_methods_.end() !=  body_read_supported_methods_.find(ctx_.ngx_ptr_->method) ) {
+    if ( true == body_read_supported_methods_.contains(ctx_.ngx_ptr_->method) ) {
         
         const auto validate_body = [this, a_callback] () {
             const bool from_asyn_read = ( NGX_AGAIN == ctx_.response_.return_code_ );
@@ -478,7 +519,7 @@ ngx_int_t ngx::casper::broker::Module::ValidateRequest (std::function<void()> a_
                 ctx_.response_.return_code_ = NGX_ERROR;
             }
             // ... empty body ? allowed?
-            if ( nullptr == ctx_.request_.body_interceptor_.writer_ && nullptr == ctx_.request_.body_ && body_read_allow_empty_methods_.end() == body_read_allow_empty_methods_.find(ctx_.ngx_ptr_->method) ) {
+            if ( nullptr == ctx_.request_.body_interceptor_.writer_ && nullptr == ctx_.request_.body_ && nullptr == ctx_.request_.body_chain_ && false == body_read_allow_empty_methods_.contains(ctx_.ngx_ptr_->method) ) {
                 ctx_.response_.errors_tracker_.add_i18n_("bad_request", ctx_.response_.status_code_,
                                                          "BROKER_MISSING_OR_INVALID_BODY_ERROR"
                 );
@@ -486,10 +527,10 @@ ngx_int_t ngx::casper::broker::Module::ValidateRequest (std::function<void()> a_
                 ctx_.response_.status_code_ = NGX_HTTP_BAD_REQUEST;
             }
             
-            // ... log
+            // ... log - without making body contiguous, see \link Body \link ...
             NGX_BROKER_MODULE_DEBUG_LOG(ctx_.module_, ctx_.ngx_ptr_, ctx_.log_token_.c_str(),
                                         "VR", "BODY",
-                                        "%s", nullptr != ctx_.request_.body_ ? ctx_.request_.body_ : ""
+                                        "%s", nullptr != ctx_.request_.body_ ? ctx_.request_.body_ : ( std::to_string(ctx_.request_.body_length_) + " byte(s)" ).c_str()
             );
             
             // ... notify caller ...
@@ -527,7 +568,7 @@ ngx_int_t ngx::casper::broker::Module::ValidateRequest (std::function<void()> a_
         
         validate_body();
         
-    } else if ( body_read_bypass_methods_.end() == body_read_bypass_methods_.find(ctx_.ngx_ptr_->method) ) {
+    } else if ( false == body_read_bypass_methods_.contains(ctx_.ngx_ptr_->method) ) {
         const auto method_it = ngx::casper::broker::Module::k_http_methods_map_.find((uint32_t)ctx_.ngx_ptr_->method);
         if ( ngx::casper::broker::Module::k_http_methods_map_.end() != method_it ) {
             U_ICU_NAMESPACE::Formattable args[] = {
@@ -570,6 +611,47 @@ ngx_int_t ngx::casper::broker::Module::ValidateRequest (std::function<void()> a_
     );
 }
 
+/**
+ * @brief Contiguous, '\0' terminated, request body.
+ *
+ * @remarks In-memory bodies are copied from \link body_chain \link on first call, consumers that can walk the chain should use it instead.
+ *
+ * @return Request body, nullptr if none.
+ */
+const char* ngx::casper::broker::Module::Body ()
+{
+    if ( nullptr == ctx_.request_.body_ && nullptr != ctx_.request_.body_chain_ ) {
+        char*  body   = new char [ctx_.request_.body_length_ + 1];
+        size_t offset = 0;
+        for ( const ngx_chain_t* chain = ctx_.request_.body_chain_ ; NULL != chain ; chain = chain->next ) {
+            const size_t size = static_cast<size_t>(chain->buf->last - chain->buf->pos);
+            memcpy(body + offset, reinterpret_cast<char const*>(chain->buf->pos), size);
+            offset += size;
+        }
+        body[offset] = '\0';
+        ctx_.request_.body_ = body;
+    }
+    return ctx_.request_.body_;
+}
+
+/**
+ * @brief Release request body memory, allocated or mapped.
+ */
+void ngx::casper::broker::Module::ReleaseBody ()
+{
+    if ( nullptr != ctx_.request_.body_ ) {
+        if ( ctx_.request_.body_mapped_ > 0 ) {
+            munmap(ctx_.request_.body_, ctx_.request_.body_mapped_);
+        } else {
+            delete [] ctx_.request_.body_;
+        }
+    }
+    ctx_.request_.body_        = nullptr;
+    ctx_.request_.body_length_ = 0;
+    ctx_.request_.body_chain_  = nullptr;
+    ctx_.request_.body_mapped_ = 0;
+}
+
 #ifdef __APPLE__
 #pragma mark -
 #endif
@@ -600,7 +682,7 @@ ngx_int_t ngx::casper::broker::Module::Initialize (const ngx::casper::broker::Mo
     //
     ngx::casper::broker::Errors* errors_ptr = a_config.errors_factory_(a_params.locale_);
     
-    ngx::casper::broker::Tracker::GetInstance().Register(a_config.ngx_ptr_, errors_ptr);
+    const uint64_t generation = ngx::casper::broker::Tracker::GetInstance().Register(a_config.ngx_ptr_, errors_ptr);
     
     // ... logging purposes ...
     NGX_BROKER_MODULE_DEBUG_LOG(a_config.ngx_module_, a_config.ngx_ptr_, a_config.log_token_.c_str(),
@@ -673,6 +755,7 @@ ngx_int_t ngx::casper::broker::Module::Initialize (const ngx::casper::broker::Mo
         
         // ... 'module' WILL BE RELEASED BY CLEANUP CALL! ...
         module_ptr = a_module();
+        module_ptr->ctx_.generation_ = generation;
                 
         // ... enable or disable module body data logging ...
         if ( broker_conf->cc_log.set ) {
@@ -841,91 +924,82 @@ void ngx::casper::broker::Module::ReadBody (ngx_module_t& a_module, ngx_http_req
 
     bool interceptor_error = false;
 
+    ngx::casper::broker::Module::Request& request = module->ctx_.request_;
+    
     ngx_chain_t* chain = a_r->request_body->bufs;
 
+    // ... forget previous body ( if any ) ...
+    module->ReleaseBody();
+    
     // read from file?
     if ( chain->buf->in_file ) {
-        u_char  buffer [1024];
-        off_t   offset   = 0;
-        ssize_t n        = 0;
-        size_t  max_size = 0;
-        bool    r_f_fd   = false;
-        //  ... read from file ...
-        const std::string file_uri = std::string(reinterpret_cast<char const*>(chain->buf->file->name.data), chain->buf->file->name.len);
-        // ... get file size ...
-        struct stat stat_info;
-        if ( stat(file_uri.c_str(), &stat_info) == 0 ) {
-            // exists?
-            if ( S_ISREG(stat_info.st_mode) != 0 ) {
-                // set size
-                max_size = static_cast<size_t>(stat_info.st_size);
-            } else {
-                module->ctx_.errors_ptr_->Track("server_error", NGX_HTTP_INTERNAL_SERVER_ERROR,
-                                                "BROKER_INTERNAL_ERROR",
-                                                "Unable to read body from file - it doesn't exist!"
-                );
-            }
+        ngx_file_t*     file   = chain->buf->file;
+        ngx_file_info_t info;
+        off_t           offset = 0;
+        ssize_t         n      = 0;
+        size_t          size   = 0;
+        // ... get file size from descriptor, spooled files might already be unlinked ...
+        if ( NGX_FILE_ERROR == ngx_fd_info(file->fd, &info) || 0 == S_ISREG(info.st_mode) ) {
+            module->ctx_.errors_ptr_->Track("server_error", NGX_HTTP_INTERNAL_SERVER_ERROR,
+                                            "BROKER_INTERNAL_ERROR",
+                                            "Unable to read body from file - it doesn't exist!"
+            );
         } else {
-            // ... directly from fd ...
-            r_f_fd = true;
+            size = static_cast<size_t>(ngx_file_size(&info));
         }
-        // ... prepare body buffer or using fw?
-        if ( nullptr == module->ctx_.request_.body_interceptor_.writer_ ) {
-            if ( nullptr != module->ctx_.request_.body_ ) {
-                delete [] module->ctx_.request_.body_;
+        // ... map it - private, so that in-place parsers can't touch the spooled file ...
+        char* map = nullptr;
+        if ( size > 0 ) {
+            void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file->fd, 0);
+            if ( MAP_FAILED != addr ) {
+                map = static_cast<char*>(addr);
             }
-            module->ctx_.request_.body_ = new char [max_size + 1];
-            module->ctx_.request_.body_[0] = '\0';
-        } /* else {} - using fw  */
-        // ... read it ...
-        const size_t max_read = sizeof(buffer) / sizeof(buffer[0]);
-        if ( true == r_f_fd ) {
-            // ... from fd - no size info available ...
-            if ( nullptr != module->ctx_.request_.body_interceptor_.writer_ ) {
-                while ( ( n = ngx_read_file(chain->buf->file, buffer, max_read, offset) ) > 0 ) {
-                    if ( n != module->ctx_.request_.body_interceptor_.writer_(buffer, static_cast<size_t>(n)) ) {
+        }
+        if ( nullptr != request.body_interceptor_.writer_ ) {
+            if ( nullptr != map ) {
+                // ... feed writer straight from mapped pages ...
+                (void)madvise(map, size, MADV_SEQUENTIAL);
+                while ( static_cast<size_t>(offset) < size ) {
+                    const size_t slice = std::min(NRS_NGX_CASPER_BROKER_MODULE_BODY_SLICE_SIZE, size - static_cast<size_t>(offset));
+                    if ( static_cast<ssize_t>(slice) != request.body_interceptor_.writer_(reinterpret_cast<const unsigned char*>(map + offset), slice) ) {
                         interceptor_error = true;
                         break;
                     }
-                    offset += n;
+                    offset += static_cast<off_t>(slice);
                 }
+                munmap(map, size);
             } else {
-                while ( ( n = ngx_read_file(chain->buf->file, buffer, max_read, offset) ) > 0 ) {
-                    if ( max_size < static_cast<size_t>(n) ) {
-                        size_t swp_size   = static_cast<size_t>(offset) + static_cast<size_t>(n);
-                        char*  swp_buffer = new char[swp_size + 1];
-                        memcpy(swp_buffer, module->ctx_.request_.body_, static_cast<size_t>(offset));
-                        delete [] module->ctx_.request_.body_;
-                        module->ctx_.request_.body_ = swp_buffer;
-                        max_size += static_cast<size_t>(n);
-                    }
-                    memcpy(module->ctx_.request_.body_ + offset, reinterpret_cast<char const*>(buffer), static_cast<size_t>(n));
-                    offset   += n;
-                    max_size -= static_cast<size_t>(n);
-                }
-            }
-        } else {
-             // ... from file - size previously calculated ...
-            if ( nullptr != module->ctx_.request_.body_interceptor_.writer_ ) {
-                while ( ( n = ngx_read_file(chain->buf->file, buffer, max_read, offset) ) > 0 ) {
-                    if ( n != module->ctx_.request_.body_interceptor_.writer_(buffer, static_cast<size_t>(n)) ) {
+                // ... fallback to large reads ...
+                std::vector<u_char> buffer(NRS_NGX_CASPER_BROKER_MODULE_BODY_SLICE_SIZE);
+                while ( ( n = ngx_read_file(file, buffer.data(), buffer.size(), offset) ) > 0 ) {
+                    if ( n != request.body_interceptor_.writer_(buffer.data(), static_cast<size_t>(n)) ) {
                         interceptor_error = true;
                         break;
                     }
-                }
-            } else {
-                while ( ( n = ngx_read_file(chain->buf->file, buffer, max_read, offset) ) > 0 ) {
-                    memcpy(module->ctx_.request_.body_ + offset, reinterpret_cast<char const*>(buffer), static_cast<size_t>(n));
                     offset += n;
                 }
             }
-        }
-        if ( nullptr != module->ctx_.request_.body_interceptor_.flush_ ) {
-            if ( 0 != module->ctx_.request_.body_interceptor_.flush_() ) {
-                interceptor_error = true;
+            if ( nullptr != request.body_interceptor_.flush_ ) {
+                if ( 0 != request.body_interceptor_.flush_() ) {
+                    interceptor_error = true;
+                }
             }
+        } else if ( nullptr != map && 0 != ( size % static_cast<size_t>(ngx_pagesize) ) ) {
+            // ... bytes past EOF up to the page boundary are zero-filled: already '\0' terminated, use it as is ...
+            request.body_        = map;
+            request.body_length_ = size;
+            request.body_mapped_ = size;
         } else {
-            module->ctx_.request_.body_[offset] = '\0';
+            // ... must be copied, so it can be '\0' terminated ...
+            if ( nullptr != map ) {
+                munmap(map, size);
+            }
+            request.body_ = new char [size + 1];
+            while ( static_cast<size_t>(offset) < size && ( n = ngx_read_file(file, reinterpret_cast<u_char*>(request.body_ + offset), size - static_cast<size_t>(offset), offset) ) > 0 ) {
+                offset += n;
+            }
+            request.body_[offset] = '\0';
+            request.body_length_  = static_cast<size_t>(offset);
         }
         // ... read error?
         if ( n < 0 ) {
@@ -935,53 +1009,38 @@ void ngx::casper::broker::Module::ReadBody (ngx_module_t& a_module, ngx_http_req
             );
         } /* else { // reached end } */
     } else {
-        //  ... read from memory ...
+        //  ... read from memory, chain is kept so it can be consumed without copies ...
+        request.body_chain_ = a_r->request_body->bufs;
         size_t chain_size = 0;
         size_t offset     = 0;
-        //  ... calculate size ...
-        while ( NULL != chain ) {
-            chain_size = static_cast<size_t>(chain->buf->last - chain->buf->pos);
-            offset    += chain_size;
-            chain      = chain->next;
-        }
-        // ... prepare body buffer or using fw?
-        if ( nullptr == module->ctx_.request_.body_interceptor_.writer_ ) {
-            if ( nullptr != module->ctx_.request_.body_ ) {
-                delete [] module->ctx_.request_.body_;
-            }
-            module->ctx_.request_.body_ = new char [offset + 1];
-            module->ctx_.request_.body_[0] = '\0';
-        }
-        // ... copy contents ..
-        chain      = a_r->request_body->bufs;
-        chain_size = 0;
-        offset     = 0;
-        
-        
-        if ( nullptr != module->ctx_.request_.body_interceptor_.writer_ ) {
+        if ( nullptr != request.body_interceptor_.writer_ ) {
             while ( NULL != chain ) {
                 chain_size = static_cast<size_t>(chain->buf->last - chain->buf->pos);
-                if ( static_cast<ssize_t>(chain_size) != module->ctx_.request_.body_interceptor_.writer_(chain->buf->pos, chain_size) ) {
+                if ( static_cast<ssize_t>(chain_size) != request.body_interceptor_.writer_(chain->buf->pos, chain_size) ) {
                     interceptor_error = true;
                     break;
                 }
                 offset += chain_size;
                 chain = chain->next;
             }
-            if ( nullptr != module->ctx_.request_.body_interceptor_.flush_ ) {
-                if ( 0 != module->ctx_.request_.body_interceptor_.flush_() ) {
+            if ( nullptr != request.body_interceptor_.flush_ ) {
+                if ( 0 != request.body_interceptor_.flush_() ) {
                     interceptor_error = true;
                 }
             }
         } else {
+            //  ... calculate size, a contiguous copy is only made if a consumer asks for it ( see \link Body \link ) ...
             while ( NULL != chain ) {
-                chain_size = static_cast<size_t>(chain->buf->last - chain->buf->pos);
-                memcpy(module->ctx_.request_.body_ + offset, reinterpret_cast<char const*>(chain->buf->pos), chain_size);
-                offset += chain_size;
-                chain = chain->next;
+                offset += static_cast<size_t>(chain->buf->last - chain->buf->pos);
+                chain   = chain->next;
+            }
+            // ... no buffers, empty but present body ...
+            if ( 0 == offset ) {
+                request.body_    = new char [1];
+                request.body_[0] = '\0';
             }
-            module->ctx_.request_.body_[offset] = '\0';
         }
+        request.body_length_ = offset;
     }
     
     if ( 0 == a_r->request_body_no_buffering && a_r->main->count > 1 ) {
@@ -997,13 +1056,30 @@ void ngx::casper::broker::Module::ReadBody (ngx_module_t& a_module, ngx_http_req
                                             ? module->ctx_.request_.body_interceptor_.dst_().c_str()
                                             : "<filtered>"
         );
-    } else {
+    } else if ( false == module->ctx_.log_body_ ) {
+        ::ev::LoggerV2::GetInstance().Log(module->logger_client_, "cc-modules",
+                                          NRS_NGX_CASPER_BROKER_MODULE_LOGGER_KEY_FMT ",%s",
+                                          "IN : BODY", "<filtered>"
+       );
+    } else if ( nullptr != request.body_ ) {
+        // ... already contiguous ( empty, mapped or copied ) ...
         ::ev::LoggerV2::GetInstance().Log(module->logger_client_, "cc-modules",
                                           NRS_NGX_CASPER_BROKER_MODULE_LOGGER_KEY_FMT ",%s",
+                                          "IN : BODY", request.body_
+       );
+    } else if ( nullptr != request.body_chain_ && NULL == request.body_chain_->next ) {
+        // ... single in-memory buffer, log it in place - \link Body \link would copy it ...
+        ::ev::LoggerV2::GetInstance().Log(module->logger_client_, "cc-modules",
+                                          NRS_NGX_CASPER_BROKER_MODULE_LOGGER_KEY_FMT ",%.*s",
                                           "IN : BODY",
-                                          true == module->ctx_.log_body_
-                                            ? ( nullptr != module->ctx_.request_.body_ ? module->ctx_.request_.body_ : "" )
-                                            : "<filtered>"
+                                          static_cast<int>(request.body_chain_->buf->last - request.body_chain_->buf->pos),
+                                          reinterpret_cast<const char*>(request.body_chain_->buf->pos)
+       );
+    } else {
+        // ... spread over several buffers, log it's length only ...
+        ::ev::LoggerV2::GetInstance().Log(module->logger_client_, "cc-modules",
+                                          NRS_NGX_CASPER_BROKER_MODULE_LOGGER_KEY_FMT ",<" SIZET_FMT " byte(s)>",
+                                          "IN : BODY", request.body_length_
        );
     }
 
@@ -1067,8 +1143,7 @@ void ngx::casper::broker::Module::WriteResponse (ngx_module_t& a_module, ngx_htt
                                                  const bool a_finalize,
                                                  const char* const a_log_token, const bool a_plain_module)
 {
-    ngx_int_t         rc  = NGX_OK;
-    const std::string uri = std::string((const char*)a_r->unparsed_uri.data, a_r->unparsed_uri.len);
+    ngx_int_t rc = NGX_OK;
     
     // ... debug only ...
     NGX_BROKER_MODULE_DEBUG_LOG(a_module, a_r, a_log_token,
@@ -1076,28 +1151,25 @@ void ngx::casper::broker::Module::WriteResponse (ngx_module_t& a_module, ngx_htt
                                 "%s", "writting response..."
     );
     
-    // ... first, copy headers ( if any ) ...
-    std::map<std::string, std::string, StringMapCaseInsensitiveComparator> ci_headers_map;
+    // ... first, pick Content-Type and Content-Length from headers ( if any ) - they must not be duplicated ...
+    const std::string* content_type_header   = nullptr;
+    const std::string* content_length_header = nullptr;
     if ( nullptr != a_headers ) {
-        for ( auto it : *a_headers ) {
-            ci_headers_map[it.first] = it.second;
+        for ( const auto& it : *a_headers ) {
+            if ( 0 == strcasecmp(it.first.c_str(), "content-type") ) {
+                content_type_header = &it.second;
+            } else if ( 0 == strcasecmp(it.first.c_str(), "content-length") ) {
+                content_length_header = &it.second;
+            }
         }
     }
     // ... grab custom content-type ( if any ) ...
-    std::string content_type;
-    const auto content_type_p = ci_headers_map.find("content-type");
-    if ( ci_headers_map.end() != content_type_p ) {
-        content_type = content_type_p->second;
-        // ... Content-Type must not be duplicated ...
-        ci_headers_map.erase(content_type_p);
-    } else {
-        content_type = nullptr != a_content_type ? std::string(a_content_type) : "";
-    }
+    const char* const content_type = ( nullptr != content_type_header ? content_type_header->c_str() : ( nullptr != a_content_type ? a_content_type : "" ) );
     
     // ... log write intentions ...
     NGX_BROKER_MODULE_DEBUG_LOG(a_module, a_r, a_log_token,
                                 "WR", "CONTENT TYPE",
-                                "%s", content_type.c_str()
+                                "%s", content_type
     );
 
     if ( NGX_HTTP_HEAD != a_r->method ) {
@@ -1123,39 +1195,37 @@ void ngx::casper::broker::Module::WriteResponse (ngx_module_t& a_module, ngx_htt
                 
         if ( NGX_HTTP_NO_CONTENT != a_status_code ) {
             
-            ngx_buf_t* buffer = (ngx_buf_t*) ngx_pcalloc(a_r->pool, sizeof(ngx_buf_t));
+            ngx_buf_t* buffer = ngx_calloc_buf(a_r->pool);
             if ( buffer == NULL ) {
                 throw ngx::casper::broker::Exception("BROKER_INTERNAL_ERROR",
                                                      "Failed to allocate response buffer."
                 );
             }
             
-            ngx_chain_t* chain = (ngx_chain_t*) ngx_pcalloc(a_r->pool, sizeof(ngx_chain_t));
+            ngx_chain_t* chain = ngx_alloc_chain_link(a_r->pool);
             if ( chain == NULL ) {
                 throw ngx::casper::broker::Exception("BROKER_INTERNAL_ERROR",
                                                      "Failed to allocate response chain."
                 );
             }
             
-            ngx_str_t* payload = (ngx_str_t*)ngx_pcalloc(a_r->pool, sizeof(ngx_str_t));
-            if ( NULL == payload ) {
-                throw ngx::casper::broker::Exception("BROKER_INTERNAL_ERROR",
-                                                     "Failed to allocate response payload."
-                );
-            }
-            
-            payload->len  = a_length;
-            payload->data = (u_char*)ngx_palloc(a_r->pool, payload->len);
-            if ( NULL == payload->data ) {
-                throw ngx::casper::broker::Exception("BROKER_INTERNAL_ERROR",
-                                                     "Failed to allocate response payload data."
-                );
+            if ( nullptr != module && a_data == module->ctx_.response_.body_.c_str() ) {
+                // ... module owned payload, it will outlive this request output - reference it ...
+                buffer->pos    = (u_char*) a_data;
+                buffer->last   = buffer->pos + a_length;
+                buffer->memory = 1;                                         // content is in read-only memory filters must copy to modify
+            } else if ( a_length > 0 ) {
+                // ... caller owned payload, must be copied ...
+                buffer->pos = (u_char*) ngx_pnalloc(a_r->pool, a_length);
+                if ( NULL == buffer->pos ) {
+                    throw ngx::casper::broker::Exception("BROKER_INTERNAL_ERROR",
+                                                         "Failed to allocate response payload data."
+                    );
+                }
+                buffer->last   = ngx_cpymem(buffer->pos, a_data, a_length);
+                buffer->memory = 1;
             }
-            ngx_memcpy(payload->data, a_data, payload->len);
             
-            buffer->pos           = buffer->last = (u_char*) payload->data; // first position in memory of the data
-            buffer->last         += payload->len;                           // last position
-            buffer->memory        = 1;                                      // content is in read-only memory filters must copy to modify,
             buffer->last_buf      = 1;                                      // there will be no more buffers in the request
             buffer->last_in_chain = 1;
             
@@ -1163,39 +1233,29 @@ void ngx::casper::broker::Module::WriteResponse (ngx_module_t& a_module, ngx_htt
             chain->next           = NULL;
             
             a_r->headers_out.status            = a_status_code;
-            a_r->headers_out.content_length_n  = static_cast<off_t>(payload->len);
+            a_r->headers_out.content_length_n  = static_cast<off_t>(a_length);
             
-            ngx::casper::broker::Module::SetOutHeaders(a_module, a_r, {
-                { "Content-Type", content_type }
-            });
-
-            // ... Content-Length...
-            const auto content_length_p = ci_headers_map.find("content-length");
-            if ( ci_headers_map.end() != content_length_p ) {
-                // ... must be changed, if it's a HEAD request ( else trust previous provided info ) ...
-                if ( NGX_HTTP_HEAD == a_r->method ) {
-                    a_r->headers_out.content_length_n = static_cast<ssize_t>(std::stoull(content_length_p->second));
-                }
-                // ... and must NOT be duplicated ...
-                ci_headers_map.erase(content_length_p);
-            }
-            
-            // ... create filtered headers map
-            std::map<std::string, std::string> filtered_headers;
-            for ( auto header : ci_headers_map ) {
-                filtered_headers[header.first] = header.second;
+            ngx::casper::broker::Module::SetOutHeader(a_r, "Content-Type", content_type);
+
+            // ... Content-Length must be changed, if it's a HEAD request ( else trust previous provided info ) ...
+            if ( nullptr != content_length_header && NGX_HTTP_HEAD == a_r->method ) {
+                a_r->headers_out.content_length_n = static_cast<ssize_t>(std::stoull(*content_length_header));
             }
             
-            // ... set out headers ...
-            ngx::casper::broker::Module::SetOutHeaders(a_module, a_r, filtered_headers);
-            
-            // ... write to permanent log ...
-            if ( nullptr != module ) {
-                for ( auto it : filtered_headers ) {
-                    ::ev::LoggerV2::GetInstance().Log(module->logger_client_, "cc-modules",
-                                                      NRS_NGX_CASPER_BROKER_MODULE_LOGGER_KEY_FMT ",%s=%s",
-                                                      "OUT: HEADER", it.first.c_str(), it.second.c_str()
-                      );
+            // ... set out headers, straight from the provided map ...
+            if ( nullptr != a_headers ) {
+                for ( const auto& it : *a_headers ) {
+                    if ( &it.second == content_type_header || &it.second == content_length_header ) {
+                        continue;
+                    }
+                    ngx::casper::broker::Module::SetOutHeader(a_r, it.first, it.second);
+                    // ... write to permanent log ...
+                    if ( nullptr != module ) {
+                        ::ev::LoggerV2::GetInstance().Log(module->logger_client_, "cc-modules",
+                                                          NRS_NGX_CASPER_BROKER_MODULE_LOGGER_KEY_FMT ",%s=%s",
+                                                          "OUT: HEADER", it.first.c_str(), it.second.c_str()
+                        );
+                    }
                 }
             }
 
@@ -1204,7 +1264,7 @@ void ngx::casper::broker::Module::WriteResponse (ngx_module_t& a_module, ngx_htt
             if ( rc == NGX_OK ) {
                 rc = ngx_http_send_header(a_r);
                 if ( rc == NGX_OK ) {
-                    if ( NGX_HTTP_HEAD == a_r->method && 0 == payload->len ) {
+                    if ( NGX_HTTP_HEAD == a_r->method && 0 == a_length ) {
                         // ... nothing to send ...
                         rc = NGX_OK;
                     } else {
@@ -1234,7 +1294,7 @@ void ngx::casper::broker::Module::WriteResponse (ngx_module_t& a_module, ngx_htt
             if ( nullptr != module ) {
                 ::ev::LoggerV2::GetInstance().Log(module->logger_client_, "cc-modules",
                                                   NRS_NGX_CASPER_BROKER_MODULE_LOGGER_KEY_FMT ",%s",
-                                                  "OUT: CONTENT-TYPE", content_type.c_str()
+                                                  "OUT: CONTENT-TYPE", content_type
                 );
 
                 ::ev::LoggerV2::GetInstance().Log(module->logger_client_, "cc-modules",
@@ -1439,92 +1499,101 @@ void ngx::casper::broker::Module::Redirect (ngx_module_t& a_module, ngx_http_req
 void ngx::casper::broker::Module::SetOutHeaders (ngx_module_t& /* a_module */, ngx_http_request_t* a_r,
                                                  const std::map<std::string, std::string>& a_headers)
 {
-    const std::map<const char* const, ngx_table_elt_t**, StringMapCaseInsensitiveComparator> special_out_headers_map = {
-        { "Location"        , &a_r->headers_out.location      },
-        { "Date"            , &a_r->headers_out.date          }
-    };
+    for ( const auto& header_it : a_headers ) {
+        ngx::casper::broker::Module::SetOutHeader(a_r, header_it.first.c_str(), header_it.first.length(), header_it.second.c_str(), header_it.second.length());
+    }
+}
+
+/**
+ * @brief Set a request 'out' header.
+ *
+ * @param a_r
+ * @param a_name
+ * @param a_value
+ */
+void ngx::casper::broker::Module::SetOutHeader (ngx_http_request_t* a_r, const std::string& a_name, const std::string& a_value)
+{
+    ngx::casper::broker::Module::SetOutHeader(a_r, a_name.c_str(), a_name.length(), a_value.c_str(), a_value.length());
+}
+
+/**
+ * @brief Set a request 'out' header.
+ *
+ * @param a_r
+ * @param a_name
+ * @param a_value
+ */
+void ngx::casper::broker::Module::SetOutHeader (ngx_http_request_t* a_r, const char* const a_name, const char* const a_value)
+{
+    ngx::casper::broker::Module::SetOutHeader(a_r, a_name, strlen(a_name), a_value, strlen(a_value));
+}
+
+/**
+ * @brief Set a request 'out' header, name and value are copied to request pool and set directly at 'headers_out'.
+ *
+ * @param a_r
+ * @param a_name
+ * @param a_name_length
+ * @param a_value
+ * @param a_value_length
+ */
+void ngx::casper::broker::Module::SetOutHeader (ngx_http_request_t* a_r,
+                                                const char* const a_name, const size_t a_name_length,
+                                                const char* const a_value, const size_t a_value_length)
+{
+    // ... set header value ...
+    u_char* value = (u_char*)ngx_pnalloc(a_r->pool, a_value_length);
+    if ( NULL == value ) {
+        throw ngx::casper::broker::Exception("BROKER_INTERNAL_ERROR",
+                                             "Failed to allocate header '%s' value payload.", a_name
+        );
+    }
+    ngx_memcpy(value, a_value, a_value_length);
     
-    const std::map<const char* const , ngx_str_t*, StringMapCaseInsensitiveComparator> std_out_headers {
-        { "Content-Type"    , &a_r->headers_out.content_type },
-        { "Charset"         , &a_r->headers_out.charset      },
-    };
+    // ... standard headers?
+    if ( 0 == strcasecmp(a_name, "Content-Type") ) {
+        a_r->headers_out.content_type.len  = a_value_length;
+        a_r->headers_out.content_type.data = value;
+        return;
+    } else if ( 0 == strcasecmp(a_name, "Charset") ) {
+        a_r->headers_out.charset.len  = a_value_length;
+        a_r->headers_out.charset.data = value;
+        return;
+    }
     
     // ... pre set clean up ...
-    if ( a_headers.end() != a_headers.find("Location") ) {
+    const bool location = ( 0 == strcasecmp(a_name, "Location") );
+    if ( true == location ) {
         ngx_http_clear_location(a_r);
     }
-
-    // ... set headers ...
-    for ( auto header_it : a_headers ) {
-        
-        const char* header_name = header_it.first.c_str();
-
-        ngx_table_elt_t* header_elt;
-        ngx_str_t*       value_str_ptr;
-        
-        const auto std_out_headers_it = std_out_headers.find(header_name);
-        if ( std_out_headers.end() != std_out_headers_it ) {
-            header_elt    = nullptr;
-            value_str_ptr = std_out_headers_it->second;
-        } else {
-            header_elt = (ngx_table_elt_t*)ngx_list_push(&a_r->headers_out.headers);
-            if ( NULL == header_elt ) {
-                throw ngx::casper::broker::Exception("BROKER_INTERNAL_ERROR",
-                                                     "Failed to allocate redirect header '%s' elt.", header_name
-                );
-            }
-            value_str_ptr = &header_elt->value;
-        }
-        
-        // ... set header name?
-        if ( nullptr != header_elt ) {
-            
-            header_elt->hash = 1;
-            
-            ngx_str_t* name_str = (ngx_str_t*)ngx_pcalloc(a_r->pool, sizeof(ngx_str_t));
-            if ( NULL == name_str ) {
-                throw ngx::casper::broker::Exception("BROKER_INTERNAL_ERROR",
-                                                     "Failed to allocate redirect header name '%s' string.", header_name
-                );
-            }
-            name_str->len  = strlen(header_name);
-            name_str->data = (u_char*)ngx_palloc(a_r->pool, name_str->len);
-            if ( NULL == name_str->data ) {
-                throw ngx::casper::broker::Exception("BROKER_INTERNAL_ERROR",
-                                                     "Failed to allocate redirect header name '%s' payload.", header_name
-                );
-            }
-            ngx_memcpy(name_str->data, header_name, name_str->len);
-            header_elt->key.len  = name_str->len;
-            header_elt->key.data = name_str->data;
-            
-        }
-        
-        // ... set header value ...
-        ngx_str_t* value_str = (ngx_str_t*)ngx_pcalloc(a_r->pool, sizeof(ngx_str_t));
-        if ( NULL == value_str ) {
-            throw ngx::casper::broker::Exception("BROKER_INTERNAL_ERROR",
-                                                 "Failed to allocate redirect header '%s' value string.", header_name
-            );
-        }
-        value_str->len  = header_it.second.length();
-        value_str->data = (u_char*)ngx_palloc(a_r->pool, value_str->len);
-        if ( NULL == value_str->data ) {
-            throw ngx::casper::broker::Exception("BROKER_INTERNAL_ERROR",
-                                                 "Failed to allocate redirect header '%s' value payload.", header_name
-            );
-        }
-        ngx_memcpy(value_str->data, header_it.second.c_str(), value_str->len);
-        value_str_ptr->len  = value_str->len;
-        value_str_ptr->data = value_str->data;
-        
-        const auto special_it = special_out_headers_map.find(header_name);
-        if ( special_out_headers_map.end() != special_it ) {
-            *special_it->second = header_elt;
-        }
-
+    
+    ngx_table_elt_t* header_elt = (ngx_table_elt_t*)ngx_list_push(&a_r->headers_out.headers);
+    if ( NULL == header_elt ) {
+        throw ngx::casper::broker::Exception("BROKER_INTERNAL_ERROR",
+                                             "Failed to allocate header '%s' elt.", a_name
+        );
     }
     
+    // ... set header name ...
+    header_elt->hash     = 1;
+    header_elt->key.len  = a_name_length;
+    header_elt->key.data = (u_char*)ngx_pnalloc(a_r->pool, a_name_length);
+    if ( NULL == header_elt->key.data ) {
+        header_elt->hash = 0;
+        throw ngx::casper::broker::Exception("BROKER_INTERNAL_ERROR",
+                                             "Failed to allocate header name '%s' payload.", a_name
+        );
+    }
+    ngx_memcpy(header_elt->key.data, a_name, a_name_length);
+    header_elt->value.len  = a_value_length;
+    header_elt->value.data = value;
+    
+    // ... special headers ...
+    if ( true == location ) {
+        a_r->headers_out.location = header_elt;
+    } else if ( 0 == strcasecmp(a_name, "Date") ) {
+        a_r->headers_out.date = header_elt;
+    }
 }
 
 /**
@@ -1581,6 +1650,7 @@ void ngx::casper::broker::Module::Cleanup (ngx_module_t& a_module_t, void* a_dat
         
         ngx_http_set_ctx(r, nullptr, a_module_t);
         
+        // ... destroy it, memory is released along with the request pool ...
         delete module;
         
     }
@@ -1679,7 +1749,6 @@ ngx_int_t ngx::casper::broker::Module::FinalizeRequest (ngx::casper::broker::Mod
                                                         const uint16_t* a_http_status_code, const ngx_int_t* a_ngx_return_code,
                                                         bool a_force)
 {
-    
     uint16_t  status_code = nullptr != a_http_status_code ? *a_http_status_code : a_module->ctx_.response_.status_code_;
     ngx_int_t return_code  = nullptr != a_ngx_return_code  ? *a_ngx_return_code  : a_module->ctx_.response_.return_code_;
     
@@ -2035,7 +2104,7 @@ void ngx::casper::broker::Module::Log (ngx_module_t& a_module_t, ngx_http_reques
  * @param a_log_token
  * @param o_params
  */
-ngx_int_t ngx::casper::broker::Module::WarmUp (ngx_module_t& a_module_t, ngx_http_request_t* a_r, const ngx_str_t& a_log_token,
+ngx_int_t ngx::casper::broker::Module::WarmUp (ngx_module_t& /* a_module_t */, ngx_http_request_t* a_r, const ngx_str_t& /* a_log_token */,
                                                ngx::casper::broker::Module::Params& o_params)
 {
     //
@@ -2047,28 +2116,10 @@ ngx_int_t ngx::casper::broker::Module::WarmUp (ngx_module_t& a_module_t, ngx_htt
     }
     
     //
-    // COLLECT REQUEST HEADERS
+    // REQUEST HEADERS - no copies, just a view
     //
-    ngx_list_part_t* list_part = &a_r->headers_in.headers.part;
-    while ( NULL != list_part ) {
-        // ... for each element ...
-        ngx_table_elt_t* header = (ngx_table_elt_t*)list_part->elts;
-        for ( ngx_uint_t index = 0 ; list_part->nelts > index ; ++index ) {
-            // ... if is set ...
-            if ( 0 < header[index].key.len && 0 < header[index].value.len ) {
-                // ... keep track of it ...
-                std::string key   = std::string(reinterpret_cast<char const*>(header[index].key.data), header[index].key.len);
-                std::transform(key.begin(), key.end(), key.begin(), ::tolower);
-                
-                o_params.in_headers_[key] = std::string(reinterpret_cast<char const*>(header[index].value.data), header[index].value.len);
-            }
-        }
-        // ... next...
-        list_part = list_part->next;
-    }
+    o_params.in_headers_.Bind(a_r);
     
-    const std::string log_token = std::string(reinterpret_cast<char*>(a_log_token.data), a_log_token.len);
-
     ngx_int_t ngx_return_code = NGX_OK;
     
     //
@@ -2079,24 +2130,27 @@ ngx_int_t ngx::casper::broker::Module::WarmUp (ngx_module_t& a_module_t, ngx_htt
     //
     // Accept-Language: fr-CH, fr;q=0.9, en;q=0.8, de;q=0.7, *;q=0.5
     //
-    const auto accept_language_it = o_params.in_headers_.find("accept-language");
-    if ( o_params.in_headers_.end() != accept_language_it ) {
+    const ngx_table_elt_t* accept_language = o_params.in_headers_.Find("accept-language");
+    if ( nullptr != accept_language ) {
         
         ngx::casper::broker::I18N& i18n = ngx::casper::broker::I18N::GetInstance();
         
-        std::string acceptable = accept_language_it->second;
-        
-        acceptable.erase(remove_if(acceptable.begin(), acceptable.end(), isspace), acceptable.end());
+        const char* const start = reinterpret_cast<const char*>(accept_language->value.data);
+        const char* const end   = start + accept_language->value.len;
         
-        const char* sep = strchr(acceptable.c_str(), ':');
+        const char* sep = static_cast<const char*>(memchr(start, ':', accept_language->value.len));
         if ( nullptr != sep ) {
-
-            std::stringstream ss;
-
-            ss << std::string(acceptable.c_str() + ( static_cast<size_t>(sep - acceptable.c_str()) + sizeof(char) ));
             
-            while( std::getline(ss, acceptable, ',') ) {
-                
+            std::string acceptable;
+            
+            // ... for each ',' separated value, ignoring whitespaces ...
+            for ( const char* p = sep + sizeof(char) ; p <= end ; ++p ) {
+                if ( p < end && ',' != (*p) ) {
+                    if ( 0 == isspace(*p) ) {
+                        acceptable += (*p);
+                    }
+                    continue;
+                }
                 const char* weight_ptr = strchr(acceptable.c_str(), ';');
                 if ( nullptr != weight_ptr ) {
                     if ( true == i18n.Contains(std::string(acceptable.c_str(), static_cast<size_t>(weight_ptr - acceptable.c_str()))) ) {
@@ -2107,7 +2161,7 @@ ngx_int_t ngx::casper::broker::Module::WarmUp (ngx_module_t& a_module_t, ngx_htt
                     o_params.locale_ = acceptable;
                     break;
                 }
-                
+                acceptable.clear();
             }
             
         }
@@ -2127,37 +2181,29 @@ ngx_int_t ngx::casper::broker::Module::WarmUp (ngx_module_t& a_module_t, ngx_htt
     //
     // 'Content-Type' Validation
     //
-    const auto content_type_it = o_params.in_headers_.find("content-type");
-    if ( o_params.in_headers_.end() != content_type_it ) {
+    const ngx_table_elt_t* content_type = o_params.in_headers_.Find("content-type");
+    if ( nullptr != content_type ) {
+        // ... nginx keeps header values '\0' terminated ...
+        const char* const value = reinterpret_cast<const char*>(content_type->value.data);
         //... explicitly reject 'multipart' content-type ...
-        if ( nullptr != strstr(content_type_it->second.c_str(), "multipart/") ) {
+        if ( nullptr != strstr(value, "multipart/") ) {
             ngx_return_code = NGX_HTTP_UNSUPPORTED_MEDIA_TYPE;
         } else {
             ngx_return_code = NGX_HTTP_UNSUPPORTED_MEDIA_TYPE;
-            if ( o_params.supported_content_types_.size() > 0 ) {
-                for ( auto ct : o_params.supported_content_types_ ) {
-                    if ( 0 == strcasecmp(ct.c_str(), content_type_it->second.c_str()) || 0 == strcasecmp("*/*", ct.c_str())  ) {
+            if ( nullptr != o_params.supported_content_types_ && o_params.supported_content_types_->size() > 0 ) {
+                for ( const auto& ct : *o_params.supported_content_types_ ) {
+                    if ( 0 == strcasecmp(ct.c_str(), value) || 0 == strcasecmp("*/*", ct.c_str())  ) {
                         ngx_return_code = NGX_OK;
                         break;
                     }
                 }
-            } else {
-                // ... check if content type is allowed ...
-                Json::Reader reader;
-                Json::Value  array_value;
-                if ( false == reader.parse(std::string(reinterpret_cast<const char*>(broker_conf->supported_content_types.data), broker_conf->supported_content_types.len), array_value)
-                    || Json::ValueType::arrayValue != array_value.type()
-                ) {
-                    NGX_BROKER_MODULE_ERROR_LOG(a_module_t, a_r, log_token.c_str(),
-                                                "WU", "LEAVING",
-                                                "%s", "invalid directive 'supported_content_types' value - unable to parse it as JSON array of strings"
-                    );
-                } else {
-                    for ( Json::ArrayIndex idx = 0 ; idx < array_value.size() ; ++idx ) {
-                        if ( false == array_value[idx].isNull() && true == array_value[idx].isString() && nullptr != strcasestr(content_type_it->second.c_str(), array_value[idx].asCString()) ) {
-                            ngx_return_code = NGX_OK;
-                            break;
-                        }
+            } else if ( NULL != broker_conf->supported_content_types_list ) {
+                // ... check if content type is allowed - directive parsed at configuration time ...
+                const ngx_str_t* supported = static_cast<const ngx_str_t*>(broker_conf->supported_content_types_list->elts);
+                for ( ngx_uint_t idx = 0 ; idx < broker_conf->supported_content_types_list->nelts ; ++idx ) {
+                    if ( nullptr != strcasestr(value, reinterpret_cast<const char*>(supported[idx].data)) ) {
+                        ngx_return_code = NGX_OK;
+                        break;
                     }
                 }
             }
@@ -2349,7 +2395,7 @@ ngx_int_t ngx::casper::broker::Module::InternalRedirect (ngx_module_t& a_module_
     ngx_memcpy(module->ctx_.ngx_ptr_->uri.data, module->ctx_.response_.redirect_.uri_.c_str(), module->ctx_.ngx_ptr_->uri.len);
 
     // ... if not supported, translate method to GET ...
-    if ( module->ctx_.response_.redirect_.supported_methods_.end() == module->ctx_.response_.redirect_.supported_methods_.find(module->ctx_.ngx_ptr_->method) ) {
+    if ( false == module->ctx_.response_.redirect_.supported_methods_.contains(module->ctx_.ngx_ptr_->method) ) {
         module->ctx_.ngx_ptr_->method      = NGX_HTTP_GET;
         module->ctx_.ngx_ptr_->method_name = ngx_http_core_get_method;
     }
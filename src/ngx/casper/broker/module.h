@@ -36,6 +36,9 @@ extern "C" {
 
 #include "ngx/casper/broker/executor.h"
 #include "ngx/casper/broker/errors.h"
+#include "ngx/casper/broker/in_headers.h"
+#include "ngx/casper/broker/tracker.h"
+#include "ngx/casper/broker/methods.h"
 
 #include <map>        // std::map
 #include <string>     // std::string
@@ -634,10 +637,10 @@ namespace ngx
                 } Config;
                                         
                 typedef struct _Params {
-                    std::map<std::string, std::string> in_headers_;
+                    InHeaders                          in_headers_;              //!< View over request headers, bound by \link WarmUp \link.
                     std::map<std::string, std::string> config_;
                     std::string                        locale_;
-                    std::set<std::string>              supported_content_types_;
+                    const std::set<std::string>*       supported_content_types_; //!< Module's immutable set, when nullptr 'supported_content_types' directive is used.
                 } Params;
                 
                 struct StringMapCaseInsensitiveComparator {
@@ -648,6 +651,8 @@ namespace ngx
                 
             protected: // Data Types
 
+                typedef broker::Methods Methods;
+
                 typedef struct _Cookie {
                     std::string name_;      //!<
                     std::string value_;     //!<
@@ -669,7 +674,7 @@ namespace ngx
                     bool                 internal_;
                     bool                 asynchronous_;
                     std::string          location_;
-                    std::set<ngx_uint_t> supported_methods_;
+                    Methods              supported_methods_;
                 } RedirectData;
                 
                 typedef struct {
@@ -685,8 +690,11 @@ namespace ngx
                     const std::string                  locale_;
                     std::string                        location_;
                     std::string                        content_type_;   //!< Payload HTTP content type.
-                    std::map<std::string, std::string> headers_;            //!<
-                    char*                              body_;
+                    InHeaders                          headers_;            //!< View over request headers, nothing is copied.
+                    char*                              body_;               //!< Contiguous, '\0' terminated, payload - allocated or privately mapped, see \link Module::Body \link.
+                    size_t                             body_length_;        //!< Payload length, in bytes.
+                    ngx_chain_t*                       body_chain_;         //!< In-memory nginx buffer chain ( not owned ), nullptr when spooled to a file.
+                    size_t                             body_mapped_;        //!< When > 0, body_ is a mapping of the spooled file with this length.
                     BodyInterceptor                    body_interceptor_;
                     std::string                        browser_;
                     ngx_http_client_body_handler_pt    ngx_body_read_handler_;
@@ -722,6 +730,7 @@ namespace ngx
                     bool                  at_content_handler_;
                     ngx_uint_t            cycle_cnt_;
                     Errors*               errors_ptr_;
+                    uint64_t              generation_;        //!< \link Tracker \link registration generation, see \link Deferred \link.
                     ::ev::Loggable::Data& loggable_data_ref_;
                     bool                  log_body_;
                 } CTX;
@@ -771,15 +780,21 @@ namespace ngx
                 CTX                     ctx_;
                 Executor*               executor_;
                 std::string             service_id_;
-                std::set<ngx_uint_t>    body_read_supported_methods_;
-                std::set<ngx_uint_t>    body_read_bypass_methods_;
-                std::set<ngx_uint_t>    body_read_allow_empty_methods_;
+                Methods                 body_read_supported_methods_;
+                Methods                 body_read_bypass_methods_;
+                Methods                 body_read_allow_empty_methods_;
                 
             public: // Constructor(s) / Destructor
                 
                 Module (const char* const a_name, const Config& a_config, const Params& a_params);
                 virtual ~Module();
                 
+            public: // Operator(s) - instances live in the nginx request pool, see \link Cleanup \link
+                
+                static void* operator new    (size_t a_size, ngx_http_request_t* a_r);
+                static void  operator delete (void* a_ptr, ngx_http_request_t* a_r);
+                static void  operator delete (void* a_ptr);
+                
             protected: // Virtual Method(s) / Function(s)
                 
                 virtual ngx_int_t Setup ();
@@ -792,6 +807,9 @@ namespace ngx
                 
                 ::ev::LoggerV2::Client* logger_client ();
                 
+                const char*             Body          ();
+                void                    ReleaseBody   ();
+                
             protected: // Static Method(s) / Function(s)
                 
                 static ngx_int_t Initialize (const Config& a_config, Params& a_params,
@@ -827,7 +845,13 @@ namespace ngx
 
                 static void SetOutHeaders (ngx_module_t& a_module, ngx_http_request_t* a_r,
                                            const std::map<std::string, std::string>& a_headers);
-                
+
+                static void SetOutHeader  (ngx_http_request_t* a_r, const std::string& a_name, const std::string& a_value);
+                static void SetOutHeader  (ngx_http_request_t* a_r, const char* const a_name, const char* const a_value);
+                static void SetOutHeader  (ngx_http_request_t* a_r,
+                                           const char* const a_name, const size_t a_name_length,
+                                           const char* const a_value, const size_t a_value_length);
+
                 static void Cleanup       (ngx_module_t& a_module_t, void* a_data);
                 
                 static void SetCookie     (const std::string& a_name, const std::string& a_value,
@@ -880,6 +904,13 @@ namespace ngx
                 void SetAtContentHandler ();
                 void SetAtRewriteHandler ();
                 
+            protected: // Inline Method(s) / Function(s)
+                
+                const ngx_chain_t* body_chain () const;
+                
+                template <typename... Args>
+                std::function<void(Args...)> Deferred (const std::function<void(Args...)>& a_callback) const;
+                
             }; // end of class 'Module'
 
             inline bool Module::ReadingBody () const
@@ -919,6 +950,44 @@ namespace ngx
                 return logger_client_;
             }
             
+            /**
+             * @return In-memory request body buffers, without copies, nullptr when body was spooled to a file ( or there's no body ).
+             */
+            inline const ngx_chain_t* Module::body_chain () const
+            {
+                return ctx_.request_.body_chain_;
+            }
+            
+            /**
+             * @brief Wrap a completion that will be delivered later ( bridge, worker threads, ... ).
+             *
+             *        The wrapper keeps only the request pointer and it's \link Tracker \link generation, it checks that pair before
+             *        resolving this module through the request context - so it never reads a module released along with it's request pool.
+             *
+             * @param a_callback Function to call if request is still tracked and this module is still it's context.
+             *
+             * @return Function to hand over to the deferred producer.
+             */
+            template <typename... Args>
+            inline std::function<void(Args...)> Module::Deferred (const std::function<void(Args...)>& a_callback) const
+            {
+                ngx_http_request_t* r          = ctx_.ngx_ptr_;
+                const uint64_t      generation = ctx_.generation_;
+                ngx_module_t*       module     = &ctx_.module_;
+                const void*         self       = this;
+                return [r, generation, module, self, a_callback] (Args... a_args) {
+                    // ... request finalized or address reused by another one? ...
+                    if ( false == ngx::casper::broker::Tracker::GetInstance().IsRegistered(r, generation) ) {
+                        return;
+                    }
+                    // ... request is alive, now it's safe to resolve module ...
+                    if ( self != ngx_http_get_module_ctx(r, (*module)) ) {
+                        return;
+                    }
+                    a_callback(a_args...);
+                };
+            }
+            
         } // end of namespace 'broker'
         
     } // end of namespace 'casper'
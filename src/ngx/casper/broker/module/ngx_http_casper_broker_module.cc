@@ -27,6 +27,10 @@
 
 #include "ngx/version.h"
 
+#include "json/json.h"
+
+#include <openssl/evp.h> // EVP_get_digestbyname
+
 #include <sys/stat.h>
 
 #ifdef __APPLE__
@@ -263,6 +267,22 @@ static ngx_command_t ngx_http_casper_broker_module_commands[] = {
         offsetof(ngx_http_casper_broker_module_loc_conf_t, session.cookie_path),
         NULL
     },
+    {
+        ngx_string("nginx_casper_broker_session_cache_max_entries"),
+        NGX_HTTP_MAIN_CONF | NGX_CONF_TAKE1,
+        ngx_conf_set_num_slot,
+        NGX_HTTP_LOC_CONF_OFFSET,
+        offsetof(ngx_http_casper_broker_module_loc_conf_t, session.cache.max_entries),
+        NULL
+    },
+    {
+        ngx_string("nginx_casper_broker_session_cache_ttl"),
+        NGX_HTTP_MAIN_CONF | NGX_CONF_TAKE1,
+        ngx_conf_set_msec_slot,
+        NGX_HTTP_LOC_CONF_OFFSET,
+        offsetof(ngx_http_casper_broker_module_loc_conf_t, session.cache.ttl),
+        NULL
+    },
     /* jwt */
     {
         ngx_string("nginx_casper_broker_jwt_iss"),
@@ -288,6 +308,14 @@ static ngx_command_t ngx_http_casper_broker_module_commands[] = {
         offsetof(ngx_http_casper_broker_module_loc_conf_t, jwt_allowed_patch_members_set),
         NULL
     },
+    {
+        ngx_string("nginx_casper_broker_jwt_cache_max_entries"),
+        NGX_HTTP_MAIN_CONF | NGX_CONF_TAKE1,
+        ngx_conf_set_num_slot,
+        NGX_HTTP_LOC_CONF_OFFSET,
+        offsetof(ngx_http_casper_broker_module_loc_conf_t, jwt_cache_max_entries),
+        NULL
+    },
     /* redirect config */
     {
         ngx_string("nginx_casper_broker_cdn_ast_config"),
@@ -369,6 +397,38 @@ static ngx_command_t ngx_http_casper_broker_module_commands[] = {
         offsetof(ngx_http_casper_broker_module_loc_conf_t, cdn.directories.archive_prefix),
         NULL
     },
+    {
+        ngx_string("nginx_casper_broker_cdn_xattrs_cache_max_size"),
+        NGX_HTTP_MAIN_CONF | NGX_CONF_TAKE1,
+        ngx_conf_set_size_slot,
+        NGX_HTTP_LOC_CONF_OFFSET,
+        offsetof(ngx_http_casper_broker_module_loc_conf_t, cdn.cache.xattrs),
+        NULL
+    },
+    {
+        ngx_string("nginx_casper_broker_cdn_integrity_threads"),
+        NGX_HTTP_MAIN_CONF | NGX_CONF_TAKE1,
+        ngx_conf_set_num_slot,
+        NGX_HTTP_LOC_CONF_OFFSET,
+        offsetof(ngx_http_casper_broker_module_loc_conf_t, cdn.integrity.threads),
+        NULL
+    },
+    {
+        ngx_string("nginx_casper_broker_cdn_integrity_buffer_size"),
+        NGX_HTTP_MAIN_CONF | NGX_CONF_TAKE1,
+        ngx_conf_set_size_slot,
+        NGX_HTTP_LOC_CONF_OFFSET,
+        offsetof(ngx_http_casper_broker_module_loc_conf_t, cdn.integrity.buffer_size),
+        NULL
+    },
+    {
+        ngx_string("nginx_casper_broker_cdn_integrity_digest"),
+        NGX_HTTP_MAIN_CONF | NGX_HTTP_LOC_CONF | NGX_CONF_TAKE1,
+        ngx_conf_set_str_slot,
+        NGX_HTTP_LOC_CONF_OFFSET,
+        offsetof(ngx_http_casper_broker_module_loc_conf_t, cdn.integrity.digest),
+        NULL
+    },
     /* cc log */
     {
          ngx_string("nginx_casper_broker_cc_log_set"),
@@ -562,14 +622,18 @@ static void* ngx_http_casper_broker_module_create_loc_conf (ngx_conf_t* a_cf)
     conf->location                         = ngx_null_string;
     conf->connection_validity              = NGX_CONF_UNSET;
     conf->supported_content_types          = ngx_null_string;
+    conf->supported_content_types_list     = NULL;
     // ... session cookie ...
     conf->session.cookie_name              = ngx_null_string;
     conf->session.cookie_domain            = ngx_null_string;
     conf->session.cookie_path              = ngx_null_string;
+    conf->session.cache.max_entries        = NGX_CONF_UNSET;
+    conf->session.cache.ttl                = NGX_CONF_UNSET_MSEC;
     // ... jwt ...
     conf->jwt_iss                          = ngx_null_string;
     conf->jwt_rsa_public_key_uri           = ngx_null_string;
     conf->jwt_allowed_patch_members_set    = ngx_null_string;
+    conf->jwt_cache_max_entries            = NGX_CONF_UNSET;
     // ... cdn config ...
     conf->cdn.ast                          = ngx_null_string;
     conf->cdn.h2e_map                      = ngx_null_string;
@@ -581,6 +645,10 @@ static void* ngx_http_casper_broker_module_create_loc_conf (ngx_conf_t* a_cf)
     conf->cdn.response.content_disposition = ngx_null_string;
     conf->cdn.directories.temporary_prefix = ngx_null_string;
     conf->cdn.directories.archive_prefix   = ngx_null_string;
+    conf->cdn.cache.xattrs                 = NGX_CONF_UNSET_SIZE;
+    conf->cdn.integrity.threads            = NGX_CONF_UNSET;
+    conf->cdn.integrity.buffer_size        = NGX_CONF_UNSET_SIZE;
+    conf->cdn.integrity.digest             = ngx_null_string;
     // ... cc log ...
     conf->cc_log.set                       = NGX_CONF_UNSET;
     conf->cc_log.write_body                = NGX_CONF_UNSET;
@@ -601,7 +669,7 @@ static void* ngx_http_casper_broker_module_create_loc_conf (ngx_conf_t* a_cf)
  * @param a_parent
  * @param a_child
  */
-static char* ngx_http_casper_broker_module_merge_loc_conf (ngx_conf_t* /* a_cf */, void* a_parent, void* a_child)
+static char* ngx_http_casper_broker_module_merge_loc_conf (ngx_conf_t* a_cf, void* a_parent, void* a_child)
 {
     ngx_http_casper_broker_module_loc_conf_t* prev = (ngx_http_casper_broker_module_loc_conf_t*) a_parent;
     ngx_http_casper_broker_module_loc_conf_t* conf = (ngx_http_casper_broker_module_loc_conf_t*) a_child;
@@ -611,16 +679,61 @@ static char* ngx_http_casper_broker_module_merge_loc_conf (ngx_conf_t* /* a_cf *
     ngx_conf_merge_str_value (conf->supported_content_types        , prev->supported_content_types,
                               "[\"application/json\",\"application/vnd.api+json\",\"application/text\",\"application/x-www-form-urlencoded\"]"
     );
+    // ... parse it once, inherited value shares parent's list ...
+    if ( NULL != prev->supported_content_types_list && conf->supported_content_types.data == prev->supported_content_types.data ) {
+        conf->supported_content_types_list = prev->supported_content_types_list;
+    } else if ( NULL == conf->supported_content_types_list ) {
+        conf->supported_content_types_list = ngx_array_create(a_cf->pool, 4, sizeof(ngx_str_t));
+        if ( NULL == conf->supported_content_types_list ) {
+            return (char*) NGX_CONF_ERROR;
+        }
+        Json::Value array_value;
+        try {
+            Json::Reader reader;
+            if ( false == reader.parse(std::string(reinterpret_cast<const char*>(conf->supported_content_types.data), conf->supported_content_types.len), array_value)
+                || Json::ValueType::arrayValue != array_value.type()
+            ) {
+                array_value = Json::Value::null;
+            }
+        } catch (const Json::Exception& /* a_json_exception */) {
+            array_value = Json::Value::null;
+        }
+        if ( true == array_value.isNull() ) {
+            ngx_conf_log_error(NGX_LOG_EMERG, a_cf, 0,
+                               "invalid directive 'nginx_casper_broker_supported_content_types' value - unable to parse it as JSON array of strings"
+            );
+            return (char*) NGX_CONF_ERROR;
+        }
+        for ( Json::ArrayIndex idx = 0 ; idx < array_value.size() ; ++idx ) {
+            if ( true == array_value[idx].isNull() || false == array_value[idx].isString() ) {
+                continue;
+            }
+            const std::string value = array_value[idx].asString();
+            ngx_str_t* elt = (ngx_str_t*) ngx_array_push(conf->supported_content_types_list);
+            if ( NULL == elt ) {
+                return (char*) NGX_CONF_ERROR;
+            }
+            elt->len  = value.length();
+            elt->data = (u_char*) ngx_pnalloc(a_cf->pool, elt->len + 1);
+            if ( NULL == elt->data ) {
+                return (char*) NGX_CONF_ERROR;
+            }
+            (void) ngx_cpystrn(elt->data, (u_char*) value.c_str(), elt->len + 1);
+        }
+    }
 
     // ... session cookie ...
     ngx_conf_merge_str_value (conf->session.cookie_name            , conf->session.cookie_name            ,            "" );
     ngx_conf_merge_str_value (conf->session.cookie_domain          , conf->session.cookie_domain          ,            "" );
     ngx_conf_merge_str_value (conf->session.cookie_path            , conf->session.cookie_path            ,            "" );
+    ngx_conf_merge_value     (conf->session.cache.max_entries      , prev->session.cache.max_entries      ,             0 ); /* 0 - disabled, revocations must be published to '<sid>:oauth:session:revoked' */
+    ngx_conf_merge_msec_value(conf->session.cache.ttl              , prev->session.cache.ttl              ,             0 ); /* 0 - disabled */
     
     // ... jwt ...
     ngx_conf_merge_str_value (conf->jwt_iss                        , prev->jwt_iss                        ,            "" );
     ngx_conf_merge_str_value (conf->jwt_rsa_public_key_uri         , prev->jwt_rsa_public_key_uri         ,            "" );
     ngx_conf_merge_str_value (conf->jwt_allowed_patch_members_set  , prev->jwt_allowed_patch_members_set  ,            "" );
+    ngx_conf_merge_value     (conf->jwt_cache_max_entries          , prev->jwt_cache_max_entries          ,          1024 ); /* 0 - disabled */
 
     // ... redirect config ...
     ngx_conf_merge_str_value (conf->cdn.ast                            , prev->cdn.ast                         ,          "{}" );
@@ -633,6 +746,19 @@ static char* ngx_http_casper_broker_module_merge_loc_conf (ngx_conf_t* /* a_cf *
     ngx_conf_merge_str_value (conf->cdn.response.content_disposition   , prev->cdn.response.content_disposition, "attachment"  );
     ngx_conf_merge_str_value (conf->cdn.directories.temporary_prefix   , prev->cdn.directories.temporary_prefix, "/tmp"        );
     ngx_conf_merge_str_value (conf->cdn.directories.archive_prefix     , prev->cdn.directories.archive_prefix  , "/tmp"        );
+    ngx_conf_merge_size_value(conf->cdn.cache.xattrs                   , prev->cdn.cache.xattrs                , 8 * 1024 * 1024 ); /* 8 MiB, 0 - disabled */
+    ngx_conf_merge_value     (conf->cdn.integrity.threads              , prev->cdn.integrity.threads           ,             2 ); /* 0 - disabled */
+    ngx_conf_merge_size_value(conf->cdn.integrity.buffer_size          , prev->cdn.integrity.buffer_size       , 4 * 1024 * 1024 ); /* 4 MiB */
+    ngx_conf_merge_str_value (conf->cdn.integrity.digest               , prev->cdn.integrity.digest            ,            "" ); /* "" - md5 only */
+    if ( 0 != conf->cdn.integrity.digest.len ) {
+        const std::string digest = std::string(reinterpret_cast<const char*>(conf->cdn.integrity.digest.data), conf->cdn.integrity.digest.len);
+        if ( NULL == EVP_get_digestbyname(digest.c_str()) ) {
+            ngx_conf_log_error(NGX_LOG_EMERG, a_cf, 0,
+                               "invalid directive 'nginx_casper_broker_cdn_integrity_digest' value - unknown or unsupported digest '%s'", digest.c_str()
+            );
+            return (char*) NGX_CONF_ERROR;
+        }
+    }
     
     // ... cc log ...
     ngx_conf_merge_value     (conf->cc_log.set                         , prev->cc_log.set                      ,             0 ); /* 0 - not set */
@@ -46,6 +46,16 @@ typedef struct {
     ngx_str_t archive_prefix;     //!<
 } ngx_http_casper_broker_directory_conf_t;
 
+typedef struct {
+    size_t xattrs; //!< Per-worker xattrs snapshot cache memory limit, 0 to disable.
+} ngx_http_casper_broker_cdn_cache_conf_t;
+
+typedef struct {
+    ngx_int_t threads;     //!< Per-worker number of threads used to calculate digests, 0 to calculate them in the event loop.
+    size_t    buffer_size; //!< Read buffer size, one per thread.
+    ngx_str_t digest;      //!< OpenSSL digest name ( e.g. BLAKE2b512 ) written next to MD5, empty to write MD5 only.
+} ngx_http_casper_broker_cdn_integrity_conf_t;
+
 /* CDN data types */
 
 typedef struct {
@@ -54,6 +64,8 @@ typedef struct {
     ngx_http_casper_broker_internal_redirect_conf_t redirect;    //!<
     ngx_http_casper_broker_response_conf_t          response;    //!<
     ngx_http_casper_broker_directory_conf_t         directories; //!<
+    ngx_http_casper_broker_cdn_cache_conf_t         cache;       //!<
+    ngx_http_casper_broker_cdn_integrity_conf_t     integrity;   //!<
 } ngx_http_casper_broker_cdn_conf_t;
 
 /* 😒 or 🤬 */
@@ -90,11 +102,18 @@ typedef struct {
 } ngx_http_casper_broker_jobs_conf_t;
 
 /* SESSION data types */
+typedef struct {
+    ngx_int_t  max_entries;             //!< Per-worker session cache entries limit, 0 to disable.
+    ngx_msec_t ttl;                     //!< Per-worker session cache entry maximum age, 0 to disable.
+} ngx_http_casper_broker_session_cache_conf_t;
+
 typedef struct {
     // ... session cookie ...
     ngx_str_t  cookie_name;             //!<
     ngx_str_t  cookie_domain;           //!<
     ngx_str_t  cookie_path;             //!<
+    // ... session cache ...
+    ngx_http_casper_broker_session_cache_conf_t cache; //!<
 } ngx_http_casper_broker_session_conf_t;
 
 #ifdef __APPLE__
@@ -106,6 +125,7 @@ typedef struct {
     ngx_str_t  location;
     ngx_int_t  connection_validity;
     ngx_str_t  supported_content_types;         //!< JSON array of strings with supported Content-Type prefix / values.
+    ngx_array_t* supported_content_types_list;  //!< 'supported_content_types' parsed at configuration time, '\0' terminated ngx_str_t elements.
 
     // ... session cookie ...
     ngx_http_casper_broker_session_conf_t session;
@@ -113,6 +133,7 @@ typedef struct {
     ngx_str_t  jwt_iss;
     ngx_str_t  jwt_rsa_public_key_uri;
     ngx_str_t  jwt_allowed_patch_members_set;
+    ngx_int_t  jwt_cache_max_entries;           //!< Per-worker verified JWT cache entries limit, 0 to disable.
     // ... redirect ...
     ngx_http_casper_broker_cdn_conf_t cdn;
     // ... awful code ...
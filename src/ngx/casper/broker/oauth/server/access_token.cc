@@ -141,71 +141,46 @@ void ngx::casper::broker::oauth::server::AccessToken::AsyncRun (ngx::casper::bro
     // ... run REDIS tasks ...
     NewTask([this] () -> ::ev::Object* {
         
-        // ... client exists?
-        return new ::ev::redis::Request(loggable_data_ref_, "EXISTS", {
-            client_key_,
+        // ... client exists, 'code' exists, 'code' properties and client settings, in one go ...
+        return NewFetchRequest(/* a_hash_key */ ( authorization_code_hash_prefix_ + ':' + code_ ), {
+            /* field  */ k_access_token_ttl_field_,
+            /* field  */ k_refresh_token_ttl_field_,
+            /* field  */ k_client_secret_field_
         });
         
     })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
 
         //
-        // EXISTS:
+        // FETCH:
         //
-        // - Integer reply is expected:
+        // - Array reply is expected:
         //
-        //  - n key(s) exist
-        //  - 0 the key(s) do(es) not exist
+        //  - [0] - client exists, [1] - 'code' exists, [2] - 3, [3..5] - client settings, [6...] - 'code' properties
         //
+        const ev::redis::Value& value = EnsureFetchReply(a_object);
+        if ( value.Size() < static_cast<size_t>(k_fetch_fields_offset_ + 3) ) {
+            // already set: body_["error"] = "server_error";
+            throw ev::Exception("Unexpected number of values in script reply!");
+        }
         
-        const ev::redis::Value& value = ev::redis::Reply::EnsureIntegerReply(a_object);
-        if ( 1 != value.Integer() ) {
+        if ( 1 != value[0].Integer() ) {
             body_["error"] = "unauthorized_client";
             throw ev::Exception("Client doesn't exist!");
         }
         
-        // ... 'code' exists?
-        return new ::ev::redis::Request(loggable_data_ref_, "EXISTS", {
-            /* key    */ ( authorization_code_hash_prefix_ + ':' + code_ ),
-        });
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        //
-        // EXISTS:
-        //
-        // - Integer reply is expected:
-        //
-        //  - n key(s) exist
-        //  - 0 the key(s) do(es) not exist
-        //
-        
-        const ev::redis::Value& value = ev::redis::Reply::EnsureIntegerReply(a_object);
-        if ( 1 != value.Integer() ) {
+        if ( 1 != value[1].Integer() ) {
             body_["error"] = "unauthorized_client";
             throw ev::Exception("Authorization code doesn't exist!");
         }
 
         //
-        // Get ALL 'authorization code' properties
+        // 'authorization code' properties
         //
-        return new ::ev::redis::Request(loggable_data_ref_, "HGETALL", {
-            /* key    */ ( authorization_code_hash_prefix_ + ':' + code_ )
-        });
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        //
-        // HGETALL:
-        //
-        // - Array reply is expected:
-        //
-        //  - list of fields and their values stored in the hash, or an empty list when key does not exist.
-        //
-        const ev::redis::Value& value = ev::redis::Reply::EnsureArrayReply(a_object);
+        const int first = k_fetch_fields_offset_ + 3;
         
         // ... search for 'count' and 'scope' values ...
         std::set<int> ignored_idxs;
-        for ( int idx = 0 ; idx < static_cast<int>(value.Size()) ; idx += 2 ) {
+        for ( int idx = first ; idx < static_cast<int>(value.Size()) ; idx += 2 ) {
             // ...'count' ?
             if ( 0 == value[idx].String().compare("count") ) {
                 // ... check 'count' ...
@@ -254,7 +229,7 @@ void ngx::casper::broker::oauth::server::AccessToken::AsyncRun (ngx::casper::bro
         }
         
         /* copy 'template' values */
-        for ( int idx = 0 ; idx < static_cast<int>(value.Size()) ; idx += 2 ) {
+        for ( int idx = first ; idx < static_cast<int>(value.Size()) ; idx += 2 ) {
             if ( ignored_idxs.end() != ignored_idxs.find(idx) ) {
                 continue;
             }
@@ -272,40 +247,23 @@ void ngx::casper::broker::oauth::server::AccessToken::AsyncRun (ngx::casper::bro
         GenNewToken(/* a_name*/ "refresh", /* a_error_code*/ "unauthorized_client" , /* o_value */ refresh_token_);
         
         //
-        // Get settings
+        // Client settings
         //
-        return new ::ev::redis::Request(loggable_data_ref_, "HMGET", {
-            /* key    */ client_key_,
-            /* field  */ k_access_token_ttl_field_,
-            /* field  */ k_refresh_token_ttl_field_,
-            /* field  */ k_client_secret_field_,
-        });
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        //
-        // HMGET:
-        //
-        // - Array reply is expected:
-        //
-        //  - list of values associated with the given fields, in the same order as they are requested.
-        //
-        const ev::redis::Value& value = ev::redis::Reply::EnsureArrayReply(a_object, 3);
         
         // ... set 'access' token ttl ...
-        const ev::redis::Value& access_token_ttl_value = value[0];
+        const ev::redis::Value& access_token_ttl_value = value[k_fetch_fields_offset_];
         if ( true == access_token_ttl_value.IsString() && access_token_ttl_value.String().length() > 0 ) {
             ttl_ = static_cast<int64_t>(std::atoll(access_token_ttl_value.String().c_str()));
         }
         
         // ... set 'refresh' token ttl ...
-        const ev::redis::Value& refresh_token_ttl_value = value[1];
+        const ev::redis::Value& refresh_token_ttl_value = value[k_fetch_fields_offset_ + 1];
         if ( true == refresh_token_ttl_value.IsString() && refresh_token_ttl_value.String().length() > 0 ) {
             refresh_token_ttl_ = static_cast<int64_t>(std::atoll(refresh_token_ttl_value.String().c_str()));
         }
 
         // ... compare 'client_secret' ...
-        const ev::redis::Value& client_secret_value = value[2];
+        const ev::redis::Value& client_secret_value = value[k_fetch_fields_offset_ + 2];
         if ( false == client_secret_value.IsString() || 0 == client_secret_value.String().length() ) {
             // already set: body_["error"] = "server_error";
             throw ev::Exception("Invalid client configuration - missing client secret field!");
@@ -316,152 +274,43 @@ void ngx::casper::broker::oauth::server::AccessToken::AsyncRun (ngx::casper::bro
         }
 
         //
-        // Check if 'access' token already exists
-        //
-        return new ::ev::redis::Request(loggable_data_ref_, "EXISTS", {
-            /* key */ ( access_token_hash_prefix_ + ':' + access_token_ )
-        });
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        //
-        // EXISTS:
-        //
-        // - Integer reply is expected:
-        //
-        //  - n key(s) exist
-        //  - 0 the key(s) do(es) not exist
-        //
-        
-        const ev::redis::Value& value = ev::redis::Reply::EnsureIntegerReply(a_object);
-        if ( 0 != value.Integer() ) {
-            // already set: body_["error"] = "server_error";
-            throw ev::Exception("Trying to insert a duplicated access token!");
-        }
-        
-        //
-        // Check if 'refresh' token already exists
-        //
-        return new ::ev::redis::Request(loggable_data_ref_, "EXISTS", {
-            /* key */ ( refresh_token_hash_prefix_ + ':' + refresh_token_ )
-        });
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        //
-        // EXISTS:
-        //
-        // - Integer reply is expected:
-        //
-        //  - n key(s) exist
-        //  - 0 the key(s) do(es) not exist
+        // Atomically: consume 'code', ensure tokens are new, set and expire 'access' and 'refresh' tokens properties.
         //
-        
-        const ev::redis::Value& value = ev::redis::Reply::EnsureIntegerReply(a_object);
-        if ( 0 != value.Integer() ) {
-            // already set: body_["error"] = "server_error";
-            throw ev::Exception("Trying to insert a duplicated refresh token!");
-        }
-        
-        //
-        // Set 'access token' properties...
-        //
-        
-        args_.insert(args_.begin(), ( access_token_hash_prefix_ + ':' + access_token_ ));
-        args_.push_back("refresh_token") ; args_.push_back(refresh_token_);
-
-        return new ::ev::redis::Request(loggable_data_ref_, "HMSET", args_);
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        //
-        // HMSET:
-        //
-        // - Status Reply is expected
-        //
-        //  - 'OK'
-        //
-        ev::redis::Reply::EnsureIsStatusReply(a_object, "OK");
-        
-        args_.erase(args_.begin());
-        args_.erase(args_.end()-1);
-        args_.erase(args_.end()-1);
-
-        //
-        // EXPIRE code.
-        //
-        return new ::ev::redis::Request(loggable_data_ref_, "EXPIRE", {
-            /* key */ ( access_token_hash_prefix_ + ':' + access_token_ ),
-            /* ttl */ std::to_string(ttl_)
-        });
-        
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        //
-        // EXPIRE:
-        //
-        // Integer reply, specifically:
-        // - 1 if the timeout was set.
-        // - 0 if key does not exist or the timeout could not be set.
-        //
-        ev::redis::Reply::EnsureIntegerReply(a_object, 1);
-        
-        //
-        // SET 'refresh token' properties...
-        //
-        args_.insert(args_.begin(), ( refresh_token_hash_prefix_ + ':' + refresh_token_ ));
-
-        return new ::ev::redis::Request(loggable_data_ref_, "HMSET", args_);
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        //
-        // HMSET:
-        //
-        // - Status Reply is expected
-        //
-        //  - 'OK'
-        //
-        ev::redis::Reply::EnsureIsStatusReply(a_object, "OK");
-        
-        args_.erase(args_.begin());
-        
-        std::vector<std::string> ac_update_args;
-        ac_update_args.insert(ac_update_args.begin(), ( authorization_code_hash_prefix_ + ':' + code_ ));
-        ac_update_args.push_back("count"); ac_update_args.push_back(std::to_string(2));
-        
-        return new ::ev::redis::Request(loggable_data_ref_, "HMSET", ac_update_args);
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        //
-        // HMSET:
-        //
-        // - Status Reply is expected
-        //
-        //  - 'OK'
-        //
-        ev::redis::Reply::EnsureIsStatusReply(a_object, "OK");
-
-        //
-        // EXPIRE code.
-        //
-        return new ::ev::redis::Request(loggable_data_ref_, "EXPIRE", {
-            /* key */ ( refresh_token_hash_prefix_ + ":" + refresh_token_ ),
-            /* ttl */ std::to_string(refresh_token_ttl_)
-        });
+        return NewStoreRequest(/* a_key          */ ( access_token_hash_prefix_ + ':' + access_token_ ),
+                               /* a_ttl          */ ttl_,
+                               /* a_second_key   */ ( refresh_token_hash_prefix_ + ':' + refresh_token_ ),
+                               /* a_second_ttl   */ refresh_token_ttl_,
+                               /* a_grant_check  */ "count",
+                               /* a_grant_key    */ ( authorization_code_hash_prefix_ + ':' + code_ ),
+                               /* a_extra_field  */ "refresh_token",
+                               /* a_extra_value  */ refresh_token_,
+                               /* a_fields       */ args_
+        );
         
     })->Finally([this, a_redirect_callback, a_json_callback] (::ev::Object* a_object) {
         
         //
-        // EXPIRE:
-        //
-        // Integer reply, specifically:
-        // - 1 if the timeout was set.
-        // - 0 if key does not exist or the timeout could not be set.
-        //
-        ev::redis::Reply::EnsureIntegerReply(a_object, 1);
+        // STORE:
+        //
+        // - Integer reply is expected: StoreStatus
+        //
+        const ev::redis::Value& value = EnsureStoreReply(a_object);
+        switch ( static_cast<StoreStatus>(value.Integer()) ) {
+            case StoreStatus::Stored:
+                break;
+            case StoreStatus::GrantNotValid:
+                body_["error"] = "unauthorized_client";
+                throw ev::Exception("Authorization code already used!");
+            case StoreStatus::KeyExists:
+                // already set: body_["error"] = "server_error";
+                throw ev::Exception("Trying to insert a duplicated access token!");
+            case StoreStatus::SecondKeyExists:
+                // already set: body_["error"] = "server_error";
+                throw ev::Exception("Trying to insert a duplicated refresh token!");
+            default:
+                // already set: body_["error"] = "server_error";
+                throw ev::Exception("Unexpected script reply!");
+        }
         
         /*
          * 4.1.4.  Access Token Response
@@ -503,7 +352,14 @@ void ngx::casper::broker::oauth::server::AccessToken::AsyncRun (ngx::casper::bro
         
         a_json_callback(200 /* NGX_HTTP_OK */, headers_, body_);
         
-    })->Catch([this, a_json_callback, a_log_callback] (const ::ev::Exception& a_ev_exception) {
+    })->Catch([this, a_redirect_callback, a_json_callback, a_log_callback] (const ::ev::Exception& a_ev_exception) {
+        
+        // ... server didn't know a script ( restart, failover or SCRIPT FLUSH ), nothing was run - send it again, once, now with EVAL ...
+        if ( true == ForgetScripts(a_ev_exception) ) {
+            args_.clear();
+            AsyncRun(/* a_preload_callback */ [] () {}, a_redirect_callback, a_json_callback, a_log_callback);
+            return;
+        }
         
         SetAndCallStandardJSONErrorResponse(body_["error"].asString(), /* a_error_description */ "", a_json_callback, a_log_callback, a_ev_exception);
         
@@ -125,49 +125,37 @@ void ngx::casper::broker::oauth::server::AuthorizationCode::AsyncRun (ngx::caspe
     // ... run REDIS tasks ...
     NewTask([this] () -> ::ev::Object* {
         
-        // ... client exists?
-        return new ::ev::redis::Request(loggable_data_ref_, "EXISTS", {
-             /* key */ client_key_
-        });
+        // ... client exists and settings, in one go ...
+        return NewFetchRequest(/* a_hash_key */ client_key_, /* a_fields */ {});
         
     })->Then([this, code] (::ev::Object* a_object) -> ::ev::Object* {
         
         //
-        // EXISTS:
+        // FETCH:
         //
-        // - Integer reply is expected:
+        // - Array reply is expected:
         //
-        //  - n key(s) exist
-        //  - 0 the key(s) do(es) not exist
+        //  - [0] - client exists, [1] - client exists, [2] - 0, [3...] - client properties
         //
+        const ev::redis::Value& value = EnsureFetchReply(a_object);
+        if ( value.Size() < static_cast<size_t>(k_fetch_fields_offset_) ) {
+            // already set: body_["error"] = "server_error";
+            throw ev::Exception("Unexpected number of values in script reply!");
+        }
         
-        const ev::redis::Value& value = ev::redis::Reply::EnsureIntegerReply(a_object);
-        if ( 1 != value.Integer() ) {
+        if ( 1 != value[0].Integer() ) {
             body_["error"] = "unauthorized_client";
             throw ev::Exception("Client doesn't exist!");
         }
         
         //
-        // Get settings
-        //
-        return new ::ev::redis::Request(loggable_data_ref_, "HGETALL", {
-            /* key    */ client_key_
-        });
-        
-    })->Then([this, code] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        //
-        // HGETALL:
-        //
-        // - Array reply is expected:
-        //
-        //  - list of fields and their values stored in the hash, or an empty list when key does not exist.
+        // Client properties
         //
-        const ev::redis::Value& value = ev::redis::Reply::EnsureArrayReply(a_object);
+        const int first = k_fetch_fields_offset_;
         
         // ... search for 'count' and 'scope' values ...
         std::set<int> ignored_idxs;
-        for ( int idx = 0 ; idx < static_cast<int>(value.Size()) ; idx += 2 ) {
+        for ( int idx = first ; idx < static_cast<int>(value.Size()) ; idx += 2 ) {
             if ( 0 == value[idx].String().compare(k_client_redirect_uri_field_) ) {
                 // ... validate and 'redirect_uri' ...
                 const std::string& acceptable_redirect_uri = value[idx+1].String();
@@ -210,7 +198,7 @@ void ngx::casper::broker::oauth::server::AuthorizationCode::AsyncRun (ngx::caspe
         }
         
         /* copy 'template' values */
-        for ( int idx = 0 ; idx < static_cast<int>(value.Size()) ; idx += 2 ) {
+        for ( int idx = first ; idx < static_cast<int>(value.Size()) ; idx += 2 ) {
             if ( ignored_idxs.end() != ignored_idxs.find(idx) ) {
                 continue;
             }
@@ -218,73 +206,44 @@ void ngx::casper::broker::oauth::server::AuthorizationCode::AsyncRun (ngx::caspe
             args_.push_back(value[idx + 1].IsNil() ? "" : value[idx + 1].String());
         }
         
-        //
-        // Check if 'code' already exists
-        //
-        return new ::ev::redis::Request(loggable_data_ref_, "EXISTS", {
-            /* key */ ( authorization_code_hash_prefix_ + ':' + code )
-        });
-        
-    })->Then([this, code] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        //
-        // EXISTS:
-        //
-        // - Integer reply is expected:
-        //
-        //  - n key(s) exist
-        //  - 0 the key(s) do(es) not exist
-        //
-        
-        const ev::redis::Value& value = ev::redis::Reply::EnsureIntegerReply(a_object);
-        if ( 0 != value.Integer() ) {
-            // alread set: body_["error"] = "server_error";
-            throw ev::Exception("Trying to insert a duplicated authorization code!");
-        }
-        
-        //
-        // Add new code
-        //
-        
-        args_.insert(args_.begin(), ( authorization_code_hash_prefix_ + ':' + code ));
         args_.push_back(k_client_redirect_uri_field_) ; args_.push_back(redirect_uri_);
         args_.push_back(k_client_scope_field_)        ; args_.push_back(granted_scope_);
         args_.push_back("count")                      ; args_.push_back(std::to_string(1));
         args_.push_back("issuer")                     ; args_.push_back("nginx-broker");
         args_.push_back("created_at")                 ; args_.push_back(cc::UTCTime::NowISO8601WithTZ());
         
-        return new ::ev::redis::Request(loggable_data_ref_, "HMSET", args_);
-   
-    })->Then([this, code] (::ev::Object* a_object) -> ::ev::Object* {
-        
         //
-        // HMSET:
+        // Atomically: ensure 'code' is new, set and expire it's properties.
         //
-        // - Status Reply is expected
-        //
-        //  - 'OK'
-        //
-        ev::redis::Reply::EnsureIsStatusReply(a_object, "OK");
-        
-        //
-        // EXPIRE code.
-        //
-        return new ::ev::redis::Request(loggable_data_ref_, "EXPIRE", {
-            /* key    */ ( authorization_code_hash_prefix_ + ':' + code ),
-            /* value  */ std::to_string(ttl_)
-        });
-        
+        return NewStoreRequest(/* a_key          */ ( authorization_code_hash_prefix_ + ':' + code ),
+                               /* a_ttl          */ ttl_,
+                               /* a_second_key   */ "",
+                               /* a_second_ttl   */ 0,
+                               /* a_grant_check  */ "",
+                               /* a_grant_key    */ "",
+                               /* a_extra_field  */ "",
+                               /* a_extra_value  */ "",
+                               /* a_fields       */ args_
+        );
     
     })->Finally([this, code, a_redirect_callback, a_json_callback] (::ev::Object* a_object) {
         
         //
-        // EXPIRE:
+        // STORE:
         //
-        // Integer reply, specifically:
-        // - 1 if the timeout was set.
-        // - 0 if key does not exist or the timeout could not be set.
+        // - Integer reply is expected: StoreStatus
         //
-        ev::redis::Reply::EnsureIntegerReply(a_object, 1);
+        const ev::redis::Value& value = EnsureStoreReply(a_object);
+        switch ( static_cast<StoreStatus>(value.Integer()) ) {
+            case StoreStatus::Stored:
+                break;
+            case StoreStatus::KeyExists:
+                // alread set: body_["error"] = "server_error";
+                throw ev::Exception("Trying to insert a duplicated authorization code!");
+            default:
+                // alread set: body_["error"] = "server_error";
+                throw ev::Exception("Unexpected script reply!");
+        }
         
         /*
          *
@@ -352,6 +311,12 @@ void ngx::casper::broker::oauth::server::AuthorizationCode::AsyncRun (ngx::caspe
         
         OSAL_DEBUG_STD_EXCEPTION(a_ev_exception);
         
+        // ... server didn't know a script ( restart, failover or SCRIPT FLUSH ), nothing was run - send it again, once, now with EVAL ...
+        if ( true == ForgetScripts(a_ev_exception) ) {
+            AsyncRun(/* a_preload_callback */ [] () {}, a_redirect_callback, a_json_callback, a_log_callback);
+            return;
+        }
+        
         /*
          * 4.1.2.1.  Error Response
          *
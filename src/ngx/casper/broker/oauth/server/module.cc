@@ -40,6 +40,8 @@ extern "C" {
 const char* const ngx::casper::broker::oauth::server::Module::k_json_oauth_server_content_type_           = "application/json";
 const char* const ngx::casper::broker::oauth::server::Module::k_json_oauth_server_content_type_w_charset_ = "application/json;charset=utf-8";
 
+const std::set<std::string> ngx::casper::broker::oauth::server::Module::k_supported_content_types_ = { "application/json", "application/text", "application/x-www-form-urlencoded", "application/x-www-form-urlencoded;charset=UTF-8" };
+
 /**
  * @brief Default constructor.
  *
@@ -139,9 +141,18 @@ ngx_int_t ngx::casper::broker::oauth::server::Module::Run ()
             args.len  = ctx_.ngx_ptr_->args.len;
             break;
         case NGX_HTTP_POST:
-            args.data = (u_char*)ctx_.request_.body_;
-            args.len  = nullptr != ctx_.request_.body_ ? strlen(ctx_.request_.body_) : 0;
+        {
+            // ... single in-memory buffer? parse it in place ...
+            const ngx_chain_t* chain = body_chain();
+            if ( nullptr != chain && NULL == chain->next ) {
+                args.data = chain->buf->pos;
+                args.len  = static_cast<size_t>(chain->buf->last - chain->buf->pos);
+            } else {
+                args.data = (u_char*)Body();
+                args.len  = ctx_.request_.body_length_;
+            }
             break;
+        }
         default:
             return NGX_BROKER_MODULE_SET_HTTP_METHOD_NOT_IMPLEMENTED(ctx_);
     }
@@ -478,7 +489,7 @@ ngx_int_t ngx::casper::broker::oauth::server::Module::Factory (ngx_http_request_
         /* in_headers_              */ {},
         /* config_                  */ {},
         /* locale_                  */ "",
-        /* supported_content_types_ */ { "application/json", "application/text", "application/x-www-form-urlencoded", "application/x-www-form-urlencoded;charset=UTF-8" }
+        /* supported_content_types_ */ &k_supported_content_types_
     };
     
     ngx_int_t rv = ngx::casper::broker::Module::WarmUp(ngx_http_casper_broker_oauth_server_module, a_r, loc_conf->log_token,
@@ -511,7 +522,7 @@ ngx_int_t ngx::casper::broker::oauth::server::Module::Factory (ngx_http_request_
     
     return ::ngx::casper::broker::Module::Initialize(config, params,
                                                      [&config, &params, &loc_conf] () -> ::ngx::casper::broker::Module* {
-                                                         return new ::ngx::casper::broker::oauth::server::Module(config, params, *loc_conf);
+                                                         return new (config.ngx_ptr_) ::ngx::casper::broker::oauth::server::Module(config, params, *loc_conf);
                                                      }
     );
 }
@@ -64,6 +64,7 @@ namespace ngx
                         
                         static const char* const k_json_oauth_server_content_type_;
                         static const char* const k_json_oauth_server_content_type_w_charset_;
+                        static const std::set<std::string> k_supported_content_types_;
                         
                     private: // Objects
                         
@@ -28,9 +28,70 @@
 
 #include "ngx/casper/broker/exception.h"
 
+#include "ev/redis/reply.h"
+
 const std::string ngx::casper::broker::oauth::server::Object::k_client_secret_field_       = "secret";
 const std::string ngx::casper::broker::oauth::server::Object::k_client_redirect_uri_field_ = "redirect_uri";
 const std::string ngx::casper::broker::oauth::server::Object::k_client_scope_field_        = "scope";
+const int         ngx::casper::broker::oauth::server::Object::k_fetch_fields_offset_       = 3;
+
+//
+// FETCH:
+//
+// KEYS[1] - client key
+// KEYS[2] - hash key ( grant or client )
+// ARGV    - client fields to read
+//
+// Array reply: <client exists>, <hash exists>, <#ARGV>, <client fields values...>, <HGETALL of KEYS[2]...>
+//
+ngx::casper::broker::Script ngx::casper::broker::oauth::server::Object::s_fetch_script_(
+    "local rv = { redis.call('EXISTS', KEYS[1]), redis.call('EXISTS', KEYS[2]), #ARGV }\n"
+    "if #ARGV > 0 then\n"
+    "  local values = redis.call('HMGET', KEYS[1], unpack(ARGV))\n"
+    "  for idx = 1, #ARGV do rv[#rv + 1] = values[idx] end\n"
+    "end\n"
+    "local hash = redis.call('HGETALL', KEYS[2])\n"
+    "for idx = 1, #hash do rv[#rv + 1] = hash[idx] end\n"
+    "return rv\n"
+);
+
+//
+// STORE:
+//
+// KEYS[1]        - hash to create
+// KEYS[2]        - second hash to create, '' if none
+// KEYS[3]        - grant key, '' if none
+// ARGV[1]        - KEYS[1] ttl
+// ARGV[2]        - KEYS[2] ttl
+// ARGV[3]        - grant check: '' none, 'count' grant 'count' field must be 1 and it's set to 2, 'exists' grant must exist
+// ARGV[4], [5]   - extra field / value to set on KEYS[1] only, '' if none
+// ARGV[6...]     - field / value pairs to set on both hashes
+//
+// Integer reply: \link StoreStatus \link
+//
+ngx::casper::broker::Script ngx::casper::broker::oauth::server::Object::s_store_script_(
+    "if 'count' == ARGV[3] then\n"
+    "  if 1 ~= tonumber(redis.call('HGET', KEYS[3], 'count')) then return 1 end\n"
+    "elseif 'exists' == ARGV[3] then\n"
+    "  if 1 ~= redis.call('EXISTS', KEYS[3]) then return 1 end\n"
+    "end\n"
+    "if 0 ~= redis.call('EXISTS', KEYS[1]) then return 2 end\n"
+    "if '' ~= KEYS[2] and 0 ~= redis.call('EXISTS', KEYS[2]) then return 3 end\n"
+    "local fields = {}\n"
+    "for idx = 6, #ARGV do fields[#fields + 1] = ARGV[idx] end\n"
+    "if '' ~= KEYS[2] then\n"
+    "  redis.call('HMSET', KEYS[2], unpack(fields))\n"
+    "  redis.call('EXPIRE', KEYS[2], ARGV[2])\n"
+    "end\n"
+    "if '' ~= ARGV[4] then\n"
+    "  fields[#fields + 1] = ARGV[4]\n"
+    "  fields[#fields + 1] = ARGV[5]\n"
+    "end\n"
+    "redis.call('HMSET', KEYS[1], unpack(fields))\n"
+    "redis.call('EXPIRE', KEYS[1], ARGV[1])\n"
+    "if 'count' == ARGV[3] then redis.call('HSET', KEYS[3], 'count', '2') end\n"
+    "return 0\n"
+);
 
 /**
  * @brief Default constructor.
@@ -71,7 +132,8 @@ ngx::casper::broker::oauth::server::Object::Object (const ::ev::Loggable::Data&
     refresh_token_hash_prefix_     ( service_id_ + ":oauth:" + "refresh_token"      )
 {
     ::ev::scheduler::Scheduler::GetInstance().Register(this);
-    ttl_ = 0;
+    ttl_             = 0;
+    scripts_retried_ = false;
 }
 
 /**
@@ -130,3 +192,90 @@ std::string ngx::casper::broker::oauth::server::Object::RandomString (std::size_
                                      }
     );
 }
+
+/**
+ * @brief Create a new request to read a client settings and a hash, in a single round trip.
+ *
+ * @param a_hash_key Key of the hash to read ( grant or client ).
+ * @param a_fields   Client fields to read.
+ *
+ * @return A new REDIS request, see \link s_fetch_script_ \link for reply format.
+ */
+::ev::Object* ngx::casper::broker::oauth::server::Object::NewFetchRequest (const std::string& a_hash_key, const std::vector<std::string>& a_fields)
+{
+    return s_fetch_script_.NewRequest(loggable_data_ref_, { client_key_, a_hash_key }, a_fields);
+}
+
+/**
+ * @brief Create a new request to atomically check a grant and store one or two new hashes.
+ *
+ * @param a_key          Key of the hash to create.
+ * @param a_ttl          Hash to create TTL, in seconds.
+ * @param a_second_key   Key of the second hash to create, empty if none.
+ * @param a_second_ttl   Second hash TTL, in seconds.
+ * @param a_grant_check  One of "", "count" or "exists".
+ * @param a_grant_key    Grant key, empty if none.
+ * @param a_extra_field  Field to set only on first hash, empty if none.
+ * @param a_extra_value  Value of \link a_extra_field \link.
+ * @param a_fields       Field / value pairs to set on both hashes.
+ *
+ * @return A new REDIS request, integer reply is a \link StoreStatus \link.
+ */
+::ev::Object* ngx::casper::broker::oauth::server::Object::NewStoreRequest (const std::string& a_key, const int64_t a_ttl,
+                                                                          const std::string& a_second_key, const int64_t a_second_ttl,
+                                                                          const char* const a_grant_check, const std::string& a_grant_key,
+                                                                          const std::string& a_extra_field, const std::string& a_extra_value,
+                                                                          const std::vector<std::string>& a_fields)
+{
+    std::vector<std::string> args = {
+        std::to_string(a_ttl), std::to_string(a_second_ttl), a_grant_check, a_extra_field, a_extra_value
+    };
+    args.insert(args.end(), a_fields.begin(), a_fields.end());
+    return s_store_script_.NewRequest(loggable_data_ref_, { a_key, a_second_key, a_grant_key }, args);
+}
+
+/**
+ * @brief Ensure a \link s_fetch_script_ \link reply is valid, confirming the script is cached by the server.
+ *
+ * @param a_object REDIS reply.
+ *
+ * @return Array reply.
+ */
+const ::ev::redis::Value& ngx::casper::broker::oauth::server::Object::EnsureFetchReply (::ev::Object* a_object)
+{
+    const ::ev::redis::Value& value = ::ev::redis::Reply::EnsureArrayReply(a_object);
+    s_fetch_script_.Loaded();
+    return value;
+}
+
+/**
+ * @brief Ensure a \link s_store_script_ \link reply is valid, confirming the script is cached by the server.
+ *
+ * @param a_object REDIS reply.
+ *
+ * @return Integer reply, a \link StoreStatus \link.
+ */
+const ::ev::redis::Value& ngx::casper::broker::oauth::server::Object::EnsureStoreReply (::ev::Object* a_object)
+{
+    const ::ev::redis::Value& value = ::ev::redis::Reply::EnsureIntegerReply(a_object);
+    s_store_script_.Loaded();
+    return value;
+}
+
+/**
+ * @brief Reload scripts on next request if a failure was caused by the server not knowing them ( restart, failover or SCRIPT FLUSH ).
+ *
+ * @param a_ev_exception
+ *
+ * @return True when the grant should be run again ( now with EVAL ), only once per object, false otherwise.
+ */
+bool ngx::casper::broker::oauth::server::Object::ForgetScripts (const ::ev::Exception& a_ev_exception)
+{
+    const bool fetch = s_fetch_script_.Forget(a_ev_exception);
+    const bool store = s_store_script_.Forget(a_ev_exception);
+    if ( ( false == fetch && false == store ) || true == scripts_retried_ ) {
+        return false;
+    }
+    scripts_retried_ = true;
+    return true;
+}
@@ -24,11 +24,16 @@
 #define NRS_NGX_CASPER_BROKER_OAUTH_SERVER_OBJECT_H_
 
 #include <string>
+#include <vector>
 
 #include "ev/loggable.h"
+#include "ev/exception.h"
+#include "ev/redis/value.h"
 
 #include "ev/scheduler/scheduler.h"
 
+#include "ngx/casper/broker/script.h"
+
 namespace ngx
 {
     
@@ -51,11 +56,26 @@ namespace ngx
                         
                         typedef std::function<void(const std::string& a_error)> FailureCallback;
                         
+                    protected: // Enum(s)
+                        
+                        enum class StoreStatus : int64_t {
+                            Stored          = 0,
+                            GrantNotValid   = 1,
+                            KeyExists       = 2,
+                            SecondKeyExists = 3
+                        };
+                        
                     protected: // Static Const Data
                         
                         static const std::string k_client_secret_field_;
                         static const std::string k_client_redirect_uri_field_;
                         static const std::string k_client_scope_field_;
+                        static const int         k_fetch_fields_offset_;
+                        
+                    protected: // Static Data
+                        
+                        static broker::Script    s_fetch_script_;
+                        static broker::Script    s_store_script_;
 
                     protected: // Const Data
                         
@@ -73,6 +93,7 @@ namespace ngx
                     protected: // Data
                         
                         int64_t ttl_;
+                        bool    scripts_retried_; //!< True when a grant was already run again because the server didn't know a script.
 
                     public: // Constructor (s) / Destructor
                         
@@ -84,8 +105,20 @@ namespace ngx
                         
                     protected: // Method(s) / Function(s)
                         
-                        std::string            RandomString (const size_t a_length);
-                        ::ev::scheduler::Task* NewTask      (const EV_TASK_PARAMS& a_callback);
+                        std::string            RandomString    (const size_t a_length);
+                        ::ev::scheduler::Task* NewTask         (const EV_TASK_PARAMS& a_callback);
+                        ::ev::Object*          NewFetchRequest (const std::string& a_hash_key, const std::vector<std::string>& a_fields);
+                        bool                   ForgetScripts   (const ::ev::Exception& a_ev_exception);
+                        ::ev::Object*          NewStoreRequest (const std::string& a_key, const int64_t a_ttl,
+                                                                const std::string& a_second_key, const int64_t a_second_ttl,
+                                                                const char* const a_grant_check, const std::string& a_grant_key,
+                                                                const std::string& a_extra_field, const std::string& a_extra_value,
+                                                                const std::vector<std::string>& a_fields);
+                        
+                    protected: // Static Method(s) / Function(s)
+                        
+                        static const ::ev::redis::Value& EnsureFetchReply (::ev::Object* a_object);
+                        static const ::ev::redis::Value& EnsureStoreReply (::ev::Object* a_object);
                         
                     }; // end of class 'Object'
                     
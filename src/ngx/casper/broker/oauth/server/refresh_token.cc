@@ -134,70 +134,46 @@ void ngx::casper::broker::oauth::server::RefreshToken::AsyncRun (ngx::casper::br
     // ... run REDIS tasks ...
     NewTask([this] () -> ::ev::Object* {
         
-        // ... client exists?
-        return new ::ev::redis::Request(loggable_data_ref_, "EXISTS", {
-            client_key_,
+        // ... client exists, 'refresh_token' exists, 'refresh_token' properties and client settings, in one go ...
+        return NewFetchRequest(/* a_hash_key */ ( refresh_token_hash_prefix_ + ':' + refresh_token_ ), {
+            /* field  */ k_access_token_ttl_field_,
+            /* field  */ k_refresh_token_ttl_field_,
+            /* field  */ k_client_secret_field_
         });
         
     })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
+
         //
-        // EXISTS:
+        // FETCH:
         //
-        // - Integer reply is expected:
+        // - Array reply is expected:
         //
-        //  - n key(s) exist
-        //  - 0 the key(s) do(es) not exist
+        //  - [0] - client exists, [1] - 'refresh_token' exists, [2] - 3, [3..5] - client settings, [6...] - 'refresh_token' properties
         //
+        const ev::redis::Value& value = EnsureFetchReply(a_object);
+        if ( value.Size() < static_cast<size_t>(k_fetch_fields_offset_ + 3) ) {
+            // already set: body_["error"] = "server_error";
+            throw ev::Exception("Unexpected number of values in script reply!");
+        }
         
-        const ev::redis::Value& value = ev::redis::Reply::EnsureIntegerReply(a_object);
-        if ( 1 != value.Integer() ) {
+        if ( 1 != value[0].Integer() ) {
             body_["error"] = "unauthorized_client";
             throw ev::Exception("Client doesn't exist!");
         }
         
-        // ... 'refresh_token' exists?
-        return new ::ev::redis::Request(loggable_data_ref_, "EXISTS", {
-            /* key    */ ( refresh_token_hash_prefix_ + ':' + refresh_token_ )
-        });
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-
-        //
-        // EXISTS:
-        //
-        // - Integer reply is expected:
-        //
-        //  - n key(s) exist
-        //  - 0 the key(s) do(es) not exist
-        //
-        const ev::redis::Value& value = ev::redis::Reply::EnsureIntegerReply(a_object);
-        if ( 1 != value.Integer() ) {
+        if ( 1 != value[1].Integer() ) {
             body_["error"] = "unauthorized_client";
             throw ev::Exception("Refresh token doesn't exist!");
         }
         
         //
-        // Get 'refresh code' properties
-        //
-        return new ::ev::redis::Request(loggable_data_ref_, "HGETALL", {
-            /* key    */ ( refresh_token_hash_prefix_ + ':' + refresh_token_ )
-        });
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-
-        //
-        // HGETALL:
-        //
-        // - Array reply is expected:
-        //
-        //  - list of fields and their values stored in the hash, or an empty list when key does not exist.
+        // 'refresh code' properties
         //
-        const ev::redis::Value& value = ev::redis::Reply::EnsureArrayReply(a_object);
+        const int first = k_fetch_fields_offset_ + 3;
         
         // ... search for 'count' and 'scope' values ...
         std::set<int> ignored_idxs;
-        for ( int idx = 0 ; idx < static_cast<int>(value.Size()) ; idx += 2 ) {
+        for ( int idx = first ; idx < static_cast<int>(value.Size()) ; idx += 2 ) {
              if ( 0 == value[idx].String().compare(k_client_scope_field_) ) {
                  // ... validate and 'grant' scope(s) ...
                  ngx::casper::broker::oauth::server::Scope scope(value[idx+1]);
@@ -231,7 +207,7 @@ void ngx::casper::broker::oauth::server::RefreshToken::AsyncRun (ngx::casper::br
         }
         
         /* copy 'template' values */
-        for ( int idx = 0 ; idx < static_cast<int>(value.Size()) ; idx += 2 ) {
+        for ( int idx = first ; idx < static_cast<int>(value.Size()) ; idx += 2 ) {
             if ( ignored_idxs.end() != ignored_idxs.find(idx) ) {
                 continue;
             }
@@ -248,40 +224,23 @@ void ngx::casper::broker::oauth::server::RefreshToken::AsyncRun (ngx::casper::br
         GenNewToken(/* a_name*/ "access", /* a_error_code*/ "unauthorized_client" , /* o_value */ new_access_token_);
          
         //
-        // Get settings
+        // Client settings
         //
-        return new ::ev::redis::Request(loggable_data_ref_, "HMGET", {
-            /* key    */ client_key_,
-            /* field  */ k_access_token_ttl_field_,
-            /* field  */ k_refresh_token_ttl_field_,
-            /* field  */ k_client_secret_field_
-        });
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        //
-        // HMGET:
-        //
-        // - Array reply is expected:
-        //
-        //  - list of values associated with the given fields, in the same order as they are requested.
-        //
-        const ev::redis::Value& value = ev::redis::Reply::EnsureArrayReply(a_object, 3);
         
         // ... set 'access' token ttl ...
-        const ev::redis::Value& access_token_ttl_value = value[0];
+        const ev::redis::Value& access_token_ttl_value = value[k_fetch_fields_offset_];
         if ( true == access_token_ttl_value.IsString() && access_token_ttl_value.String().length() > 0 ) {
             ttl_ = static_cast<int64_t>(std::atoll(access_token_ttl_value.String().c_str()));
         }
         
         // ... set 'refresh' token ttl ...
-        const ev::redis::Value& new_refresh_token_ttl_value = value[1];
+        const ev::redis::Value& new_refresh_token_ttl_value = value[k_fetch_fields_offset_ + 1];
         if ( true == new_refresh_token_ttl_value.IsString() && new_refresh_token_ttl_value.String().length() > 0 ) {
             new_refresh_token_ttl_ = static_cast<int64_t>(std::atoll(new_refresh_token_ttl_value.String().c_str()));
         }
         
         // ... compare 'client_secret' ...
-        const ev::redis::Value& client_secret_value = value[2];
+        const ev::redis::Value& client_secret_value = value[k_fetch_fields_offset_ + 2];
         if ( false == client_secret_value.IsString() || 0 == client_secret_value.String().length() ) {
             // already set: body_["error"] = "server_error";
             throw ev::Exception("Invalid client configuration - missing client secret field!");
@@ -291,161 +250,50 @@ void ngx::casper::broker::oauth::server::RefreshToken::AsyncRun (ngx::casper::br
             throw ev::Exception("Invalid credentials!");
         }
         
-        //
-        // Check if 'access' token already exists
-        //
-        return new ::ev::redis::Request(loggable_data_ref_, "EXISTS", {
-            /* key */ ( access_token_hash_prefix_ + ':' + new_access_token_ )
-        });
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        //
-        // EXISTS:
-        //
-        // - Integer reply is expected:
-        //
-        //  - n key(s) exist
-        //  - 0 the key(s) do(es) not exist
-        //
-        
-        const ev::redis::Value& value = ev::redis::Reply::EnsureIntegerReply(a_object);
-        if ( 0 != value.Integer() ) {
-            // alread set: body_["error"] = "server_error";
-            throw ev::Exception("Trying to insert a duplicated access token!");
-        }
-        
-        //
-        // Set 'access token' properties....
-        //
+        // ... generate new refresh token?
         if ( true == generate_new_refresh_token_ ) {
-            // ... generate new refresh token ...
             GenNewToken(/* a_name*/ "refresh", /* a_error_code*/ "unauthorized_client" , /* o_value */ new_refresh_token_);
-            // ... temporarily keep track of 'refresh_token' ...
-            args_.push_back("refresh_token") ; args_.push_back(new_refresh_token_);
-        } else {
-            // ... temporarily keep track of 'refresh_token' ...
-            args_.push_back("refresh_token") ; args_.push_back(refresh_token_);
-        }
-        
-        // ... temporarily set 'access token' value as REDIS key ...
-        args_.insert(args_.begin(), ( access_token_hash_prefix_ + ':' + new_access_token_ ));
-        
-        return new ::ev::redis::Request(loggable_data_ref_, "HMSET", args_);
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        //
-        // HMSET:
-        //
-        // - Status Reply is expected
-        //
-        //  - 'OK'
-        //
-        ev::redis::Reply::EnsureIsStatusReply(a_object, "OK");
-        
-        // ... erase temporarily data ...
-        args_.erase(args_.begin());
-        args_.erase(args_.end()-1);
-        args_.erase(args_.end()-1);
-        
-        //
-        // EXPIRE code.
-        //
-        return new ::ev::redis::Request(loggable_data_ref_, "EXPIRE", {
-            /* key */ ( access_token_hash_prefix_ + ':' + new_access_token_ ),
-            /* ttl */ std::to_string(ttl_)
-        });
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        //
-        // EXPIRE:
-        //
-        // Integer reply, specifically:
-        // - 1 if the timeout was set.
-        // - 0 if key does not exist or the timeout could not be set.
-        //
-        ev::redis::Reply::EnsureIntegerReply(a_object, 1);
-        
-        // ... if a new refresh is not required ...
-        if ( false == generate_new_refresh_token_ ) {
-            // ... nothing else to do ...
-            return nullptr;
         }
         
         //
-        // EXPIRE:
-        //
-        // Integer reply, specifically:
-        // - 1 if the timeout was set.
-        // - 0 if key does not exist or the timeout could not be set.
-        //
-        ev::redis::Reply::EnsureIntegerReply(a_object, 1);
-
-        // ... 'new_refresh_token_' exists?
-        return new ::ev::redis::Request(loggable_data_ref_, "EXISTS", {
-            /* key    */ ( refresh_token_hash_prefix_ + ':' + new_refresh_token_ )
-        });
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        // ... if a new refresh is not required ...
-        if ( false == generate_new_refresh_token_ ) {
-            // ... nothing else to do ...
-            return nullptr;
+        // Atomically: ensure 'refresh_token' still exists and new tokens are new, set and expire new tokens properties.
+        //
+        return NewStoreRequest(/* a_key          */ ( access_token_hash_prefix_ + ':' + new_access_token_ ),
+                               /* a_ttl          */ ttl_,
+                               /* a_second_key   */ ( true == generate_new_refresh_token_ ? ( refresh_token_hash_prefix_ + ':' + new_refresh_token_ ) : "" ),
+                               /* a_second_ttl   */ new_refresh_token_ttl_,
+                               /* a_grant_check  */ "exists",
+                               /* a_grant_key    */ ( refresh_token_hash_prefix_ + ':' + refresh_token_ ),
+                               /* a_extra_field  */ "refresh_token",
+                               /* a_extra_value  */ ( true == generate_new_refresh_token_ ? new_refresh_token_ : refresh_token_ ),
+                               /* a_fields       */ args_
+        );
+        
+    })->Finally([this, a_redirect_callback, a_json_callback] (::ev::Object* a_object) {
+        
+        //
+        // STORE:
+        //
+        // - Integer reply is expected: StoreStatus
+        //
+        const ev::redis::Value& value = EnsureStoreReply(a_object);
+        switch ( static_cast<StoreStatus>(value.Integer()) ) {
+            case StoreStatus::Stored:
+                break;
+            case StoreStatus::GrantNotValid:
+                body_["error"] = "unauthorized_client";
+                throw ev::Exception("Refresh token doesn't exist!");
+            case StoreStatus::KeyExists:
+                // alread set: body_["error"] = "server_error";
+                throw ev::Exception("Trying to insert a duplicated access token!");
+            case StoreStatus::SecondKeyExists:
+                // alread set: body_["error"] = "server_error";
+                throw ev::Exception("Trying to insert a duplicated refresh token!");
+            default:
+                // alread set: body_["error"] = "server_error";
+                throw ev::Exception("Unexpected script reply!");
         }
         
-        //
-        // EXISTS:
-        //
-        // - Integer reply is expected:
-        //
-        //  - n key(s) exist
-        //  - 0 the key(s) do(es) not exist
-        //
-        const ev::redis::Value& value = ev::redis::Reply::EnsureIntegerReply(a_object);
-        if ( 0 != value.Integer() ) {
-            // alread set: body_["error"] = "server_error";
-            throw ev::Exception("Trying to insert a duplicated refresh token!");
-        }
-        
-        //
-        // SET new 'refresh token' properties...
-        //
-        args_.insert(args_.begin(), ( refresh_token_hash_prefix_ + ':' + new_refresh_token_ ));
-        
-        return new ::ev::redis::Request(loggable_data_ref_, "HMSET", args_);
-        
-    })->Then([this] (::ev::Object* a_object) -> ::ev::Object* {
-        
-        // ... if a new refresh is not required ...
-        if ( false == generate_new_refresh_token_ ) {
-            // ... nothing else to do ...
-            return nullptr;
-        }
-        
-        //
-        // HMSET:
-        //
-        // - Status Reply is expected
-        //
-        //  - 'OK'
-        //
-        ev::redis::Reply::EnsureIsStatusReply(a_object, "OK");
-        
-        args_.erase(args_.begin());
-
-        //
-        // EXPIRE code.
-        //
-        return new ::ev::redis::Request(loggable_data_ref_, "EXPIRE", {
-            /* key */ ( refresh_token_hash_prefix_ + ":" + new_refresh_token_ ),
-            /* ttl */ std::to_string(new_refresh_token_ttl_)
-        });
-        
-    })->Finally([this, a_redirect_callback, a_json_callback] (::ev::Object* /* a_object */) {
-        
         /*
          * 5.1.  Successful Response
          *
@@ -476,7 +324,14 @@ void ngx::casper::broker::oauth::server::RefreshToken::AsyncRun (ngx::casper::br
                 
         a_json_callback(200 /* NGX_HTTP_OK */, headers_, body_);
         
-    })->Catch([this, a_json_callback, a_log_callback] (const ::ev::Exception& a_ev_exception) {
+    })->Catch([this, a_redirect_callback, a_json_callback, a_log_callback] (const ::ev::Exception& a_ev_exception) {
+        
+        // ... server didn't know a script ( restart, failover or SCRIPT FLUSH ), nothing was run - send it again, once, now with EVAL ...
+        if ( true == ForgetScripts(a_ev_exception) ) {
+            args_.clear();
+            AsyncRun(/* a_preload_callback */ [] () {}, a_redirect_callback, a_json_callback, a_log_callback);
+            return;
+        }
         
         SetAndCallStandardJSONErrorResponse(body_["error"].asString(), /* a_error_description */ "", a_json_callback, a_log_callback, a_ev_exception);
         
@@ -0,0 +1,108 @@
+/**
+ * @file script.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ngx/casper/broker/script.h"
+
+#include <string.h> // strstr
+
+#include <openssl/sha.h>
+
+/**
+ * @brief Default constructor.
+ *
+ * @param a_source LUA script source code.
+ */
+ngx::casper::broker::Script::Script (const char* const a_source)
+    : source_(a_source), loaded_(false)
+{
+    unsigned char digest[SHA_DIGEST_LENGTH];
+    SHA1(reinterpret_cast<const unsigned char*>(source_.c_str()), source_.length(), digest);
+    
+    static const char hex[] = "0123456789abcdef";
+    
+    sha1_.reserve(2 * SHA_DIGEST_LENGTH);
+    for ( size_t idx = 0 ; idx < SHA_DIGEST_LENGTH ; ++idx ) {
+        sha1_ += hex[digest[idx] >> 4];
+        sha1_ += hex[digest[idx] & 0xf];
+    }
+}
+
+/**
+ * @brief Destructor.
+ */
+ngx::casper::broker::Script::~Script ()
+{
+    /* empty */
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Create a new request to run this script.
+ *
+ * @param a_loggable_data_ref
+ * @param a_keys              Script KEYS.
+ * @param a_args              Script ARGV.
+ *
+ * @return A new EVALSHA request, or an EVAL request if script is not yet confirmed to be cached by the server.
+ */
+::ev::redis::Request* ngx::casper::broker::Script::NewRequest (const ::ev::Loggable::Data& a_loggable_data_ref,
+                                                             const std::vector<std::string>& a_keys, const std::vector<std::string>& a_args)
+{
+    std::vector<std::string> args;
+    args.reserve(2 + a_keys.size() + a_args.size());
+    args.push_back(( true == loaded_ ? sha1_ : source_ ));
+    args.push_back(std::to_string(a_keys.size()));
+    args.insert(args.end(), a_keys.begin(), a_keys.end());
+    args.insert(args.end(), a_args.begin(), a_args.end());
+    
+    // ... EVALSHA only after the server confirmed it ran the script, other connections might still be ahead of the first EVAL ...
+    const char* const command = ( true == loaded_ ? "EVALSHA" : "EVAL" );
+    
+    return new ::ev::redis::Request(a_loggable_data_ref, command, args);
+}
+
+/**
+ * @brief Mark this script as cached by the server, must be called only after a successful reply to one of it's requests.
+ */
+void ngx::casper::broker::Script::Loaded ()
+{
+    loaded_ = true;
+}
+
+/**
+ * @brief Check if a failure was caused by this script being unknown to the server ( flushed or server restarted ).
+ *        If so, the next request will be an EVAL.
+ *
+ * @param a_ev_exception
+ *
+ * @return True if so ( failed request was not run by the server, it can be sent again ), false otherwise.
+ */
+bool ngx::casper::broker::Script::Forget (const ::ev::Exception& a_ev_exception)
+{
+    if ( nullptr == strstr(a_ev_exception.what(), "NOSCRIPT") ) {
+        return false;
+    }
+    loaded_ = false;
+    return true;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file script.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_NGX_CASPER_BROKER_SCRIPT_H_
+#define NRS_NGX_CASPER_BROKER_SCRIPT_H_
+
+#include "cc/non-copyable.h"
+#include "cc/non-movable.h"
+
+#include <string>
+#include <vector>
+
+#include "ev/loggable.h"
+#include "ev/exception.h"
+#include "ev/redis/request.h"
+
+namespace ngx
+{
+    
+    namespace casper
+    {
+        
+        namespace broker
+        {
+            
+            /**
+             * @brief A REDIS LUA script, invoked by SHA1 once a reply confirmed it's loaded by the server.
+             */
+            class Script final : public ::cc::NonCopyable, public ::cc::NonMovable
+            {
+                
+            private: // Const Data
+                
+                const std::string source_;
+                
+            private: // Data
+                
+                std::string       sha1_;
+                bool              loaded_;
+                
+            public: // Constructor(s) / Destructor
+                
+                Script () = delete;
+                Script (const char* const a_source);
+                virtual ~Script ();
+                
+            public: // Method(s) / Function(s)
+                
+                ::ev::redis::Request* NewRequest (const ::ev::Loggable::Data& a_loggable_data_ref,
+                                                  const std::vector<std::string>& a_keys, const std::vector<std::string>& a_args);
+                void                  Loaded     ();
+                bool                  Forget     (const ::ev::Exception& a_ev_exception);
+                
+            }; // end of class 'Script'
+            
+        } // end of namespace 'broker'
+        
+    } // end of namespace 'casper'
+    
+} // end of namespace 'ngx'
+
+#endif // NRS_NGX_CASPER_BROKER_SCRIPT_H_
@@ -23,8 +23,11 @@
 #ifndef NRS_NGX_CASPER_BROKER_TRACKER_H_
 #define NRS_NGX_CASPER_BROKER_TRACKER_H_
 
-#include <string> // std::string
-#include <map>    // std::map
+#include <string>    // std::string
+#include <vector>    // std::vector
+#include <algorithm> // std::max
+#include <functional>
+#include <stdint.h>  // uint64_t, uintptr_t, SIZE_MAX
 
 #include "ev/exception.h"
 
@@ -76,13 +79,23 @@ namespace ngx
             private: // Data Type(s)
                 
                 typedef struct {
-                    Logger  logger_;
-                    Errors* errors_;
-                } Entry;
-
+                    ngx_http_request_t* r_;          //!< Tracked request, nullptr when slot is free.
+                    uint64_t            generation_; //!< Registration generation, to detect stale lookups of a reused request address.
+                    Logger              logger_;
+                    Errors*             errors_;
+                } Slot;
+                
+            private: // Static Const Data
+                
+                static constexpr size_t k_npos_             = SIZE_MAX;
+                static constexpr size_t k_initial_capacity_ = 1024;
+                
             private: // Data
                 
-                std::map<ngx_http_request_t*, Entry*> map_;
+                std::vector<Slot> slots_;           //!< Open addressing, linear probing, table - capacity is a power of 2.
+                size_t            mask_       = 0;
+                size_t            count_      = 0;
+                uint64_t          generation_ = 0;
                 
             public: // One-shot Call Method(s) / Function(s)
                 
@@ -91,16 +104,24 @@ namespace ngx
                 
             public: // Method(s) / Function(s)
                 
-                void              Register       (ngx_http_request_t* a_r, Errors* a_errors);
+                uint64_t          Register       (ngx_http_request_t* a_r, Errors* a_errors);
                 void              Bind           (ngx_http_request_t* a_r, Logger a_logger);
                 void              Unregister     (ngx_http_request_t* a_r);
                 bool              IsRegistered   (ngx_http_request_t* a_r) const;
+                bool              IsRegistered   (ngx_http_request_t* a_r, const uint64_t a_generation) const;
+                uint64_t          generation     (ngx_http_request_t* a_r) const;
                 Errors*           errors_ptr     (ngx_http_request_t* a_r);
                 void              Log            (ngx_http_request_t* a_r, const std::string& a_what, const std::string& a_message) const;
                 size_t            Count          () const;
                 size_t            Count          (ngx_http_request_t* a_r) const;
                 bool              ContainsErrors (ngx_http_request_t* a_r) const;
                 
+            private: // Method(s) / Function(s)
+                
+                size_t            Find           (const ngx_http_request_t* a_r) const;
+                size_t            Home           (const ngx_http_request_t* a_r) const;
+                void              Grow           ();
+                
             }; // end of class 'Tracker'
 
             /**
@@ -108,7 +129,9 @@ namespace ngx
              */
             inline void Tracker::Startup ()
             {
-                /* empty */
+                if ( 0 == slots_.size() ) {
+                    Grow();
+                }
             }
             
             /**
@@ -116,11 +139,14 @@ namespace ngx
              */
             inline void Tracker::Shutdown ()
             {
-                for ( auto it : map_ ) {
-                    delete it.second->errors_;
-                    delete it.second;
+                for ( auto& slot : slots_ ) {
+                    if ( nullptr != slot.r_ ) {
+                        delete slot.errors_;
+                    }
                 }
-                map_.clear();
+                slots_.clear();
+                mask_  = 0;
+                count_ = 0;
             }
             
             /**
@@ -128,14 +154,29 @@ namespace ngx
              *
              * @param a_r
              * @param a_errors
+             *
+             * @return Registration generation.
              */
-            inline void Tracker::Register (ngx_http_request_t* a_r, ngx::casper::broker::Errors* a_errors)
+            inline uint64_t Tracker::Register (ngx_http_request_t* a_r, ngx::casper::broker::Errors* a_errors)
             {
-                const auto it = map_.find(a_r);
-                if ( map_.end() != it ) {
-                    return;
+                const size_t idx = Find(a_r);
+                if ( k_npos_ != idx ) {
+                    return slots_[idx].generation_;
+                }
+                // ... keep load factor below 1/2 ...
+                if ( ( count_ + 1 ) * 2 > slots_.size() ) {
+                    Grow();
                 }
-                map_[a_r] = new Tracker::Entry({ /* a_logger */ nullptr, a_errors });
+                size_t i = Home(a_r);
+                while ( nullptr != slots_[i].r_ ) {
+                    i = ( i + 1 ) & mask_;
+                }
+                slots_[i].r_          = a_r;
+                slots_[i].generation_ = ++generation_;
+                slots_[i].logger_     = nullptr;
+                slots_[i].errors_     = a_errors;
+                count_++;
+                return slots_[i].generation_;
             }
         
            /**
@@ -146,11 +187,11 @@ namespace ngx
             */
             inline void Tracker::Bind (ngx_http_request_t* a_r, Logger a_logger)
             {
-                const auto it = map_.find(a_r);
-                if ( map_.end() == it ) {
+                const size_t idx = Find(a_r);
+                if ( k_npos_ == idx ) {
                     return;
                 }
-                it->second->logger_ = a_logger;
+                slots_[idx].logger_ = a_logger;
             }
             
             /**
@@ -160,13 +201,32 @@ namespace ngx
              */
             inline void Tracker::Unregister (ngx_http_request_t* a_r)
             {
-                const auto it = map_.find(a_r);
-                if ( map_.end() == it ) {
+                size_t i = Find(a_r);
+                if ( k_npos_ == i ) {
                     return;
                 }
-                delete it->second->errors_;
-                delete it->second;
-                map_.erase(it);
+                delete slots_[i].errors_;
+                slots_[i].r_      = nullptr;
+                slots_[i].logger_ = nullptr;
+                slots_[i].errors_ = nullptr;
+                count_--;
+                // ... backward shift deletion, no tombstones: move back entries whose probe sequence crossed the freed slot ...
+                size_t j = i;
+                while ( true ) {
+                    j = ( j + 1 ) & mask_;
+                    if ( nullptr == slots_[j].r_ ) {
+                        break;
+                    }
+                    const size_t k = Home(slots_[j].r_);
+                    if ( ( i <= j ) ? ( i < k && k <= j ) : ( i < k || k <= j ) ) {
+                        continue;
+                    }
+                    slots_[i] = std::move(slots_[j]);
+                    slots_[j].r_      = nullptr;
+                    slots_[j].logger_ = nullptr;
+                    slots_[j].errors_ = nullptr;
+                    i = j;
+                }
             }
             
             /**
@@ -178,7 +238,35 @@ namespace ngx
              */
             inline bool Tracker::IsRegistered (ngx_http_request_t* a_r) const
             {
-                return map_.end() != map_.find(a_r);
+                return k_npos_ != Find(a_r);
+            }
+            
+            /**
+             * @brief Check if a specific NGX HTTP request registration is still the same one.
+             *
+             * @param a_r
+             * @param a_generation Value returned by \link Register \link.
+             *
+             * @return True if so, false if it's not registered or if the address was reused by another request.
+             */
+            inline bool Tracker::IsRegistered (ngx_http_request_t* a_r, const uint64_t a_generation) const
+            {
+                const size_t idx = Find(a_r);
+                return k_npos_ != idx && a_generation == slots_[idx].generation_;
+            }
+            
+            /**
+             * @return A specific NGX HTTP request registration generation, 0 if not registered.
+             *
+             * @param a_r
+             */
+            inline uint64_t Tracker::generation (ngx_http_request_t* a_r) const
+            {
+                const size_t idx = Find(a_r);
+                if ( k_npos_ == idx ) {
+                    return 0;
+                }
+                return slots_[idx].generation_;
             }
 
             /**
@@ -186,7 +274,7 @@ namespace ngx
              */
             inline size_t Tracker::Count () const
             {
-                return map_.size();
+                return count_;
             }
             
             /**
@@ -196,11 +284,11 @@ namespace ngx
              */
             inline size_t Tracker::Count (ngx_http_request_t* a_r) const
             {
-                const auto it = map_.find(a_r);
-                if ( map_.end() == it ) {
+                const size_t idx = Find(a_r);
+                if ( k_npos_ == idx ) {
                     return 0;
                 }
-                return static_cast<size_t>(it->second->errors_->Count());
+                return static_cast<size_t>(slots_[idx].errors_->Count());
             }
             
             /**
@@ -210,11 +298,11 @@ namespace ngx
              */
             inline bool Tracker::ContainsErrors (ngx_http_request_t* a_r) const
             {
-                const auto it = map_.find(a_r);
-                if ( map_.end() == it ) {
+                const size_t idx = Find(a_r);
+                if ( k_npos_ == idx ) {
                     return false;
-                }                
-                return it->second->errors_->Count() > 0;
+                }
+                return slots_[idx].errors_->Count() > 0;
             }
 
             /**
@@ -226,11 +314,11 @@ namespace ngx
              */
              inline void Tracker::Log (ngx_http_request_t* a_r, const std::string& a_what, const std::string& a_message) const
              {
-                 const auto it = map_.find(a_r);
-                 if ( map_.end() == it || nullptr == it->second->logger_ ) {
+                 const size_t idx = Find(a_r);
+                 if ( k_npos_ == idx || nullptr == slots_[idx].logger_ ) {
                      return;
                  }
-                 it->second->logger_(a_what, a_message);
+                 slots_[idx].logger_(a_what, a_message);
              }
 
             /**
@@ -240,11 +328,67 @@ namespace ngx
              */
             inline Errors* Tracker::errors_ptr (ngx_http_request_t* a_r)
             {
-                const auto it = map_.find(a_r);
-                if ( map_.end() == it ) {
+                const size_t idx = Find(a_r);
+                if ( k_npos_ == idx ) {
                     return nullptr;
                 }
-                return it->second->errors_;
+                return slots_[idx].errors_;
+            }
+            
+            /**
+             * @return Slot index of a specific NGX HTTP request, k_npos_ if not registered.
+             *
+             * @param a_r
+             */
+            inline size_t Tracker::Find (const ngx_http_request_t* a_r) const
+            {
+                if ( 0 == count_ ) {
+                    return k_npos_;
+                }
+                size_t i = Home(a_r);
+                while ( nullptr != slots_[i].r_ ) {
+                    if ( a_r == slots_[i].r_ ) {
+                        return i;
+                    }
+                    i = ( i + 1 ) & mask_;
+                }
+                return k_npos_;
+            }
+            
+            /**
+             * @return Preferred slot index for a specific NGX HTTP request.
+             *
+             * @param a_r
+             */
+            inline size_t Tracker::Home (const ngx_http_request_t* a_r) const
+            {
+                // ... pointers are aligned, mix all bits ...
+                uint64_t h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(a_r));
+                h ^= ( h >> 33 );
+                h *= 0xff51afd7ed558ccdULL;
+                h ^= ( h >> 33 );
+                return static_cast<size_t>(h) & mask_;
+            }
+            
+            /**
+             * @brief Double table capacity and re-insert all tracked requests.
+             */
+            inline void Tracker::Grow ()
+            {
+                std::vector<Slot> old;
+                old.swap(slots_);
+                slots_.resize(std::max(k_initial_capacity_, old.size() * 2), { /* r_ */ nullptr, /* generation_ */ 0, /* logger_ */ nullptr, /* errors_ */ nullptr });
+                mask_ = slots_.size() - 1;
+                for ( auto& slot : old ) {
+                    if ( nullptr == slot.r_ ) {
+                        continue;
+                    }
+                    size_t i = Home(slot.r_);
+                    while ( nullptr != slots_[i].r_ ) {
+                        i = ( i + 1 ) & mask_;
+                    }
+                    slots_[i] = std::move(slot);
+                }
             }
 
         } // end of namespace 'broker'
@@ -0,0 +1,73 @@
+/**
+ * @file inspector.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ngx/casper/broker/ul/inspector.h"
+
+/**
+ * @brief One-shot setup.
+ *
+ * @param a_threads Number of worker threads to start, 0 disables asynchronous inspections.
+ */
+void ngx::casper::broker::ul::Inspector::Startup (const size_t a_threads)
+{
+    pool_.Startup(a_threads);
+}
+
+/**
+ * @brief Stop all worker threads and forget pending jobs.
+ *
+ * @remarks Running inspections see their abort flag set and bail out at their next step.
+ * @remarks Must be called before \link ::ev::ngx::Bridge \link shutdown.
+ */
+void ngx::casper::broker::ul::Inspector::Shutdown ()
+{
+    pool_.Shutdown();
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Schedule an inspection in a worker thread.
+ *
+ * @param a_work Function to call on a worker thread, it must not touch nginx or request data.
+ * @param a_done Function to call, on main thread, when \p a_work returns.
+ *
+ * @return Ticket to be used to cancel this job.
+ */
+uint64_t ngx::casper::broker::ul::Inspector::Submit (const ngx::casper::broker::ul::Inspector::Work& a_work,
+                                                     const ngx::casper::broker::ul::Inspector::Done& a_done)
+{
+    return pool_.Submit(a_work, a_done);
+}
+
+/**
+ * @brief Cancel a previously submitted job, it's completion function won't be called.
+ *
+ * @param a_ticket  Ticket returned by \link Submit \link.
+ * @param a_abandon Optional function to call, on main thread, instead of the completion function when work is done
+ *                  ( to release resources created by it ).
+ */
+void ngx::casper::broker::ul::Inspector::Cancel (const uint64_t a_ticket, const ngx::casper::broker::ul::Inspector::Done& a_abandon)
+{
+    pool_.Cancel(a_ticket, a_abandon);
+}
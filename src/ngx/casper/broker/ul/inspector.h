@@ -0,0 +1,111 @@
+/**
+ * @file inspector.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_NGX_CASPER_BROKER_UL_INSPECTOR_H_
+#define NRS_NGX_CASPER_BROKER_UL_INSPECTOR_H_
+
+#include "osal/osal_singleton.h"
+
+#include "ngx/casper/broker/worker_pool.h"
+
+#include <stdint.h> // uint64_t
+
+namespace ngx
+{
+
+    namespace casper
+    {
+
+        namespace broker
+        {
+
+            namespace ul
+            {
+
+                // ---- //
+                class Inspector;
+                class InspectorInitializer final : public ::osal::Initializer<Inspector>
+                {
+
+                public: // Constructor(s) / Destructor
+
+                    InspectorInitializer (Inspector& a_instance)
+                        : ::osal::Initializer<Inspector>(a_instance)
+                    {
+                        /* empty */
+                    }
+                    virtual ~InspectorInitializer ()
+                    {
+                        /* empty */
+                    }
+
+                }; // end of class 'InspectorInitializer'
+
+                /**
+                 * @brief Runs uploaded content inspections ( magic detection, security scans ) in a \link WorkerPool \link,
+                 *        with completion delivered back to the main thread.
+                 */
+                class Inspector final : public osal::Singleton<Inspector, InspectorInitializer>
+                {
+
+                public: // Data Type(s)
+
+                    typedef ::ngx::casper::broker::WorkerPool::Work Work;
+                    typedef ::ngx::casper::broker::WorkerPool::Done Done;
+
+                private: // Data
+
+                    ::ngx::casper::broker::WorkerPool pool_;
+
+                public: // One-shot Call Method(s) / Function(s)
+
+                    void Startup  (const size_t a_threads);
+                    void Shutdown ();
+
+                public: // Method(s) / Function(s)
+
+                    uint64_t Submit (const Work& a_work, const Done& a_done);
+                    void     Cancel (const uint64_t a_ticket, const Done& a_abandon = nullptr);
+
+                public: // Inline Method(s) / Function(s)
+
+                    bool enabled () const;
+
+                }; // end of class 'Inspector'
+
+                /**
+                 * @return True when worker threads are running, false otherwise.
+                 */
+                inline bool Inspector::enabled () const
+                {
+                    return pool_.enabled();
+                }
+
+            } // end of namespace 'ul'
+
+        } // end of namespace 'broker'
+
+    } // end of namespace 'casper'
+
+} // end of namespace 'ngx'
+
+#endif // NRS_NGX_CASPER_BROKER_UL_INSPECTOR_H_
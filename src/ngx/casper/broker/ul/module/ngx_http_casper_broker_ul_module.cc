@@ -30,24 +30,35 @@
 #include "cc/utc_time.h"
 
 #include <sys/stat.h>
+#include <fcntl.h> // open, fallocate
+#include <unistd.h> // close, access
 
 #include "curl/curl.h"
 
 #include "ngx/version.h"
 
 #include "cc/magic/mime_type.h"
+#include <magic.h> // magic_buffer
 
-#include <algorithm> // std::min
+#include <algorithm> // std::min, std::search
 #include <vector>
 
 #include "cc/modsecurity/processor.h"
 
+#include "ngx/casper/broker/ul/inspector.h"
+
+#include <atomic>     // std::atomic
+#include <functional> // std::function
+#include <memory>     // std::shared_ptr, std::unique_ptr
+
 #ifdef __APPLE__
 #pragma mark -
 #pragma mark - Module - Forward declarations
 #pragma mark -
 #endif
 
+static void*     ngx_http_casper_broker_ul_module_create_main_conf (ngx_conf_t* a_cf);
+static char*     ngx_http_casper_broker_ul_module_init_main_conf   (ngx_conf_t* a_cf, void* a_conf);
 static void*     ngx_http_casper_broker_ul_module_create_loc_conf  (ngx_conf_t* a_cf);
 static char*     ngx_http_casper_broker_ul_module_merge_loc_conf   (ngx_conf_t* a_cf, void* a_parent, void* a_child);
 static ngx_int_t ngx_http_casper_broker_ul_module_filter_init      (ngx_conf_t* a_cf);
@@ -55,9 +66,61 @@ static ngx_int_t ngx_http_casper_broker_ul_module_filter_init      (ngx_conf_t*
 static void      ngx_http_casper_broker_ul_module_read_body_callback (ngx_http_request_t* a_r);
 static void      ngx_http_casper_broker_ul_module_cleanup_handler    (void*);
 
+static ngx_int_t ngx_http_casper_broker_ul_module_request_body_filter (ngx_http_request_t* a_r, ngx_chain_t* a_in);
+
 static ngx_uint_t ngx_http_casper_broker_ul_ensure_output             (ngx_http_casper_broker_ul_module_context_t* a_context, std::string& o_uri);
+static void       ngx_http_casper_broker_ul_open_output               (ngx_http_casper_broker_ul_module_context_t* a_context, const size_t a_length);
+static void       ngx_http_casper_broker_ul_write_output              (ngx_http_casper_broker_ul_module_context_t* a_context, const u_char* a_data, const size_t a_length);
+static void       ngx_http_casper_broker_ul_flush_output              (ngx_http_casper_broker_ul_module_context_t* a_context);
+static void       ngx_http_casper_broker_ul_unique_uri                (const std::string& a_directory, const std::string& a_file_name, std::string& o_uri);
+static bool       ngx_http_casper_broker_ul_magic_matches             (const ngx_array_t* a_array, const std::string& a_value);
 static void       ngx_http_casper_broker_ul_addr_to_hr                (struct sockaddr* a_addr, const socklen_t a_len, ::cc::modsecurity::Processor::Addr& o_addr);
 
+/**
+ * @brief Magic fetch data, output is written by a worker thread.
+ */
+typedef struct {
+    std::string name_;      //!< in: original file name
+    std::string uri_;       //!< in: file to inspect, out: it's copy if leading bytes were skipped
+    size_t      offset_;    //!< out: number of leading bytes skipped by last copy
+    size_t      skipped_;   //!< out: total number of leading bytes skipped
+    std::string md5_value_; //!< out: copy MD5, if any
+    std::string type_;      //!< out: MAGIC_MIME_TYPE
+    std::string desc_;      //!< out: MAGIC_NONE
+    std::string error_;     //!< out: error message, if any
+} ngx_http_casper_broker_ul_magic_t;
+
+/**
+ * @brief Security scan data, output is written by a worker thread.
+ */
+typedef struct {
+    ::cc::modsecurity::Processor::HTTPPOSTRequest request_;     //!< in
+    size_t                                        head_;        //!< in: number of leading bytes to scan, 0 - whole file
+    size_t                                        tail_;        //!< in: number of trailing bytes to scan, 0 - whole file
+    std::shared_ptr<std::vector<std::string>>     log_;         //!< out: log lines
+    ::cc::modsecurity::Processor::Rule            rule_;        //!< out
+    int                                           status_code_; //!< out
+    std::string                                   error_;       //!< out: error message, if any
+} ngx_http_casper_broker_ul_scan_t;
+
+static bool       ngx_http_casper_broker_ul_module_sniff               (ngx_http_request_t* a_r, ngx_http_casper_broker_ul_module_context_t* a_context);
+static void       ngx_http_casper_broker_ul_module_inspect             (ngx_http_request_t* a_r, ngx_http_casper_broker_ul_module_context_t* a_context);
+static void       ngx_http_casper_broker_ul_module_on_magic            (ngx_http_request_t* a_r, ngx_http_casper_broker_ul_module_context_t* a_context, const ngx_http_casper_broker_ul_magic_t& a_magic);
+static void       ngx_http_casper_broker_ul_module_on_scan             (ngx_http_request_t* a_r, ngx_http_casper_broker_ul_module_context_t* a_context, const ngx_http_casper_broker_ul_scan_t& a_scan);
+static void       ngx_http_casper_broker_ul_module_on_inspection_error (ngx_http_request_t* a_r, ngx_http_casper_broker_ul_module_context_t* a_context, const std::string& a_what);
+static void       ngx_http_casper_broker_ul_module_schedule            (ngx_http_casper_broker_ul_module_context_t* a_context, const ::ngx::casper::broker::ul::Inspector::Work& a_work, const std::function<void()>& a_done,
+                                                                        const std::function<void()>& a_abandon);
+static void       ngx_http_casper_broker_ul_module_finish              (ngx_http_request_t* a_r, ngx_http_casper_broker_ul_module_context_t* a_context);
+static void       ngx_http_casper_broker_ul_module_load_part           (ngx_http_casper_broker_ul_module_context_t* a_context, const size_t a_index);
+static void       ngx_http_casper_broker_ul_module_respond             (ngx_http_request_t* a_r, ngx_http_casper_broker_ul_module_context_t* a_context, const ngx_uint_t a_http_status_code, const bool a_errors_set);
+
+static ::cc::magic::MIMEType& ngx_http_casper_broker_ul_magic         ();
+static magic_t                ngx_http_casper_broker_ul_magic_cookie  ();
+static void                   ngx_http_casper_broker_ul_magic_fetch   (ngx_http_casper_broker_ul_magic_t& a_magic, const std::atomic<bool>& a_abort);
+static void                   ngx_http_casper_broker_ul_scan          (ngx_http_casper_broker_ul_scan_t& a_scan, const std::atomic<bool>& a_abort);
+static void                   ngx_http_casper_broker_ul_scan_window   (const std::string& a_uri, const size_t a_size, const size_t a_head, const size_t a_tail, const std::atomic<bool>& a_abort,
+                                                                       std::string& o_uri);
+
 static const ngx_str_t  NGX_HTTP_CASPER_BROKER_UL_MODULE_ALLOW_ORIGIN  = ngx_string("Access-Control-Allow-Origin");
 static const ngx_str_t  NGX_HTTP_CASPER_BROKER_UL_MODULE_ALLOW_METHODS = ngx_string("Access-Control-Allow-Methods");
 static const ngx_str_t  NGX_HTTP_CASPER_BROKER_UL_MODULE_ALLOW_HEADERS = ngx_string("Access-Control-Allow-Headers");
@@ -65,6 +128,21 @@ static const ngx_str_t  NGX_HTTP_CASPER_BROKER_UL_MODULE_ALLOW_HEADERS = ngx_str
 static const ngx_str_t  NGX_HTTP_CASPER_BROKER_UL_MODULE_ALLOWED_METHODS = ngx_string("POST"); // , PUT
 static const ngx_str_t  NGX_HTTP_CASPER_BROKER_UL_MODULE_ALLOWED_HEADERS = ngx_string("Content-Length, Content-Type, Content-Disposition");
 
+// ... formats that can't be told apart by their leading bytes, validated only when whole file is available ...
+static ngx_str_t   NGX_HTTP_CASPER_BROKER_UL_MODULE_SNIFF_DEFER_TYPES[] = {
+    ngx_string("application/octet-stream"),
+    ngx_string("application/zip"),
+    ngx_string("application/CDFV2"),
+    ngx_string("text/plain")
+};
+static ngx_array_t NGX_HTTP_CASPER_BROKER_UL_MODULE_SNIFF_DEFER_TYPES_ARRAY = {
+    /* elts   */ NGX_HTTP_CASPER_BROKER_UL_MODULE_SNIFF_DEFER_TYPES,
+    /* nelts  */ sizeof(NGX_HTTP_CASPER_BROKER_UL_MODULE_SNIFF_DEFER_TYPES) / sizeof(ngx_str_t),
+    /* size   */ sizeof(ngx_str_t),
+    /* nalloc */ sizeof(NGX_HTTP_CASPER_BROKER_UL_MODULE_SNIFF_DEFER_TYPES) / sizeof(ngx_str_t),
+    /* pool   */ NULL
+};
+
 #ifdef DEBUG
 //    #define NGX_HTTP_CASPER_BROKER_UL_MODULE_SOCKET_WRITE_BUFFER_LIMIT 1 // bytes
 //    #define NGX_HTTP_CASPER_BROKER_UL_MODULE_SOCKET_READ_BUFFER_LIMIT  1 // bytes
@@ -84,6 +162,9 @@ static const ngx_str_t  NGX_HTTP_CASPER_BROKER_UL_MODULE_ALLOWED_HEADERS = ngx_s
     #define NGX_HTTP_CASPER_BROKER_UL_MODULE_BODY_BUFFER_SIZE 1048576
 #endif
 
+// 4MB output block, writes are coalesced up to this size
+#define NGX_HTTP_CASPER_BROKER_UL_MODULE_WRITE_BLOCK_SIZE 4194304
+
 #ifdef __APPLE__
 #pragma mark -
 #pragma mark - Data && Data Types
@@ -243,6 +324,47 @@ static ngx_command_t ngx_http_casper_broker_ul_module_commands[] = {
         offsetof(ngx_http_casper_broker_ul_module_loc_conf_t, scan_conf_file),
         NULL
     },
+    {
+        ngx_string("nginx_casper_broker_ul_scan_head"),
+        NGX_HTTP_LOC_CONF | NGX_CONF_TAKE1,
+        ngx_conf_set_size_slot,
+        NGX_HTTP_LOC_CONF_OFFSET,
+        offsetof(ngx_http_casper_broker_ul_module_loc_conf_t, scan_head),
+        NULL
+    },
+    {
+        ngx_string("nginx_casper_broker_ul_scan_tail"),
+        NGX_HTTP_LOC_CONF | NGX_CONF_TAKE1,
+        ngx_conf_set_size_slot,
+        NGX_HTTP_LOC_CONF_OFFSET,
+        offsetof(ngx_http_casper_broker_ul_module_loc_conf_t, scan_tail),
+        NULL
+    },
+    {
+        ngx_string("nginx_casper_broker_ul_sniff_size"),
+        NGX_HTTP_LOC_CONF | NGX_CONF_TAKE1,
+        ngx_conf_set_size_slot,
+        NGX_HTTP_LOC_CONF_OFFSET,
+        offsetof(ngx_http_casper_broker_ul_module_loc_conf_t, sniff_size),
+        NULL
+    },
+    {
+        ngx_string("nginx_casper_broker_ul_sniff_defer_type"),
+        NGX_HTTP_LOC_CONF | NGX_CONF_TAKE1,
+        ngx_conf_set_str_array_slot,
+        NGX_HTTP_LOC_CONF_OFFSET,
+        offsetof(ngx_http_casper_broker_ul_module_loc_conf_t, sniff_defer_types),
+        NULL
+    },
+    // ...
+    {
+        ngx_string("nginx_casper_broker_ul_inspection_threads"),
+        NGX_HTTP_MAIN_CONF | NGX_CONF_TAKE1,
+        ngx_conf_set_num_slot,
+        NGX_HTTP_MAIN_CONF_OFFSET,
+        offsetof(ngx_http_casper_broker_ul_module_main_conf_t, inspection_threads),
+        NULL
+    },
     // ...
     ngx_null_command
 };
@@ -253,8 +375,8 @@ static ngx_command_t ngx_http_casper_broker_ul_module_commands[] = {
 static ngx_http_module_t ngx_http_casper_broker_ul_module_ctx = {
     NULL,                                               /* preconfiguration              */
     ngx_http_casper_broker_ul_module_filter_init,       /* postconfiguration             */
-    NULL,                                               /* create main configuration     */
-    NULL,                                               /* init main configuration       */
+    ngx_http_casper_broker_ul_module_create_main_conf,  /* create main configuration     */
+    ngx_http_casper_broker_ul_module_init_main_conf,    /* init main configuration       */
     NULL,                                               /* create server configuration   */
     NULL,                                               /* merge server configuration    */
     ngx_http_casper_broker_ul_module_create_loc_conf,   /* create location configuration */
@@ -279,12 +401,48 @@ ngx_module_t ngx_http_casper_broker_ul_module = {
     NGX_MODULE_V1_PADDING
 };
 
+static ngx_http_request_body_filter_pt ngx_http_casper_broker_ul_module_next_request_body_filter;
+static bool                            ngx_http_casper_broker_ul_module_inspector_started = false;
+
 #ifdef __APPLE__
 #pragma mark -
 #pragma mark - Module - Implementation
 #pragma mark -
 #endif
 
+/**
+ * @brief Allocate the module 'main' configuration structure.
+ *
+ * @param a_cf
+ */
+static void* ngx_http_casper_broker_ul_module_create_main_conf (ngx_conf_t* a_cf)
+{
+    ngx_http_casper_broker_ul_module_main_conf_t* conf =
+        (ngx_http_casper_broker_ul_module_main_conf_t*) ngx_pcalloc(a_cf->pool, sizeof(ngx_http_casper_broker_ul_module_main_conf_t));
+    if ( NULL == conf ) {
+        return NGX_CONF_ERROR;
+    }
+
+    conf->inspection_threads = NGX_CONF_UNSET_UINT;
+
+    return conf;
+}
+
+/**
+ * @brief Initialize the module 'main' configuration structure.
+ *
+ * @param a_cf
+ * @param a_conf
+ */
+static char* ngx_http_casper_broker_ul_module_init_main_conf (ngx_conf_t* /* a_cf */, void* a_conf)
+{
+    ngx_http_casper_broker_ul_module_main_conf_t* conf = (ngx_http_casper_broker_ul_module_main_conf_t*) a_conf;
+
+    ngx_conf_init_uint_value(conf->inspection_threads, 2); /* 0 - main thread */
+
+    return NGX_CONF_OK;
+}
+
 /**
  * @brief Alocate the module configuration structure.
  *
@@ -316,6 +474,10 @@ static void* ngx_http_casper_broker_ul_module_create_loc_conf (ngx_conf_t* a_cf)
     conf->scan_magic_desc       = (ngx_array_t*)NGX_CONF_UNSET_PTR;
     conf->scan_conf_dir         = ngx_null_string;
     conf->scan_conf_file        = ngx_null_string;
+    conf->scan_head             = NGX_CONF_UNSET_SIZE;
+    conf->scan_tail             = NGX_CONF_UNSET_SIZE;
+    conf->sniff_size            = NGX_CONF_UNSET_SIZE;
+    conf->sniff_defer_types     = (ngx_array_t*)NGX_CONF_UNSET_PTR;
 
     return conf;
 }
@@ -350,6 +512,10 @@ static char* ngx_http_casper_broker_ul_module_merge_loc_conf (ngx_conf_t* /* a_c
     ngx_conf_merge_ptr_value (conf->scan_magic_desc      , prev->scan_magic_desc      ,      nullptr);
     ngx_conf_merge_str_value (conf->scan_conf_dir        , prev->scan_conf_dir        ,           "" );
     ngx_conf_merge_str_value (conf->scan_conf_file       , prev->scan_conf_file       ,           "" );
+    ngx_conf_merge_size_value(conf->scan_head            , prev->scan_head            ,           0 ); /* 0 - whole file */
+    ngx_conf_merge_size_value(conf->scan_tail            , prev->scan_tail            ,           0 ); /* 0 - whole file */
+    ngx_conf_merge_size_value(conf->sniff_size           , prev->sniff_size           ,       16384 ); /* 16KB, 0 - disabled */
+    ngx_conf_merge_ptr_value (conf->sniff_defer_types    , prev->sniff_defer_types    , &NGX_HTTP_CASPER_BROKER_UL_MODULE_SNIFF_DEFER_TYPES_ARRAY);
     
     NGX_BROKER_MODULE_LOC_CONF_MERGED();    
     
@@ -363,12 +529,68 @@ static char* ngx_http_casper_broker_ul_module_merge_loc_conf (ngx_conf_t* /* a_c
  */
 static ngx_int_t ngx_http_casper_broker_ul_module_filter_init (ngx_conf_t* a_cf)
 {
+    /**
+     * Install request body filter.
+     */
+    ngx_http_casper_broker_ul_module_next_request_body_filter = ngx_http_top_request_body_filter;
+    ngx_http_top_request_body_filter                          = ngx_http_casper_broker_ul_module_request_body_filter;
     /**
      * Install content handler.
      */
     return NGX_BROKER_MODULE_INSTALL_CONTENT_HANDLER(ngx_http_casper_broker_ul_module_content_handler);
 }
 
+/**
+ * @brief Request body filter, calculates body MD5 while nginx is still receiving it
+ *        ( before it's buffered or spooled to a temporary file ), so it never has to be read back.
+ *
+ * @param a_r  The http request.
+ * @param a_in Received body buffers.
+ */
+static ngx_int_t ngx_http_casper_broker_ul_module_request_body_filter (ngx_http_request_t* a_r, ngx_chain_t* a_in)
+{
+    ngx_http_casper_broker_ul_module_context_t* context = (ngx_http_casper_broker_ul_module_context_t*) ngx_http_get_module_ctx(a_r, ngx_http_casper_broker_ul_module);
+    // ... already rejected? drain it - nginx keeps reading until the end, nothing is kept or hashed ...
+    if ( NULL != context && true == context->sniff_rejected_ ) {
+        for ( ngx_chain_t* cl = a_in ; NULL != cl ; cl = cl->next ) {
+            if ( ngx_buf_in_memory(cl->buf) ) {
+                cl->buf->pos = cl->buf->last;
+            }
+        }
+        return ngx_http_casper_broker_ul_module_next_request_body_filter(a_r, a_in);
+    }
+    // ... multipart MD5 covers only the uploaded part, it's calculated while parsing it ...
+    if ( NULL != context && 0 == context->multipart_body_.enabled_ ) {
+        const ngx_http_casper_broker_ul_module_loc_conf_t* loc_conf = (const ngx_http_casper_broker_ul_module_loc_conf_t*) ngx_http_get_module_loc_conf(a_r, ngx_http_casper_broker_ul_module);
+        // ... sniff leading bytes?
+        const bool sniff = ( false == context->sniffed_ && 1 == loc_conf->magic_validation && loc_conf->sniff_size > 0 );
+        bool       last  = false;
+        for ( ngx_chain_t* cl = a_in ; NULL != cl ; cl = cl->next ) {
+            if ( ngx_buf_in_memory(cl->buf) && cl->buf->last > cl->buf->pos ) {
+                const size_t length = static_cast<size_t>(cl->buf->last - cl->buf->pos);
+                context->file_.md5_.Update(cl->buf->pos, length);
+                if ( true == sniff && context->sniff_.size() < loc_conf->sniff_size ) {
+                    context->sniff_.insert(context->sniff_.end(), cl->buf->pos, cl->buf->pos + std::min(length, loc_conf->sniff_size - context->sniff_.size()));
+                }
+            }
+            last = ( last || 1 == cl->buf->last_buf );
+        }
+        // ... enough data to sniff it?
+        if ( true == sniff && context->sniff_.size() > 0 && ( context->sniff_.size() >= loc_conf->sniff_size || true == last ) ) {
+            context->sniffed_ = true;
+            if ( false == ngx_http_casper_broker_ul_module_sniff(a_r, context) ) {
+                // ... reject it now, no need to write the rest of it: read body callback will answer ...
+                context->sniff_rejected_ = true;
+                context->error_tracker_->Track("BROKER_FORBIDDEN_ERROR", NGX_HTTP_FORBIDDEN, "BROKER_FORBIDDEN_ERROR",
+                                               "DENIED due to magic type of leading bytes!"
+                );
+                return ngx_http_casper_broker_ul_module_request_body_filter(a_r, a_in);
+            }
+        }
+    }
+    return ngx_http_casper_broker_ul_module_next_request_body_filter(a_r, a_in);
+}
+
 #ifdef __APPLE__
 #pragma mark - Content Handler
 #endif
@@ -639,6 +861,7 @@ ngx_int_t ngx_http_casper_broker_ul_module_content_handler (ngx_http_request_t*
         return NGX_HTTP_BAD_REQUEST;
     }
 
+	std::string multipart_boundary;
 	if ( nullptr != strstr(content_type_it->second.c_str(), "multipart/") ) {
 		if ( 0 == loc_conf->accept_multipart_body ) {
 			NGX_BROKER_MODULE_ERROR_LOG(ngx_http_casper_broker_ul_module, a_r, "ul_module",
@@ -656,8 +879,8 @@ ngx_int_t ngx_http_casper_broker_ul_module_content_handler (ngx_http_request_t*
 			// media-type - multipart/form-data
 			// boundary   - For multipart entities the boundary directive is required!
 			ngx::utls::nrs_ngx_multipart_header_info_t info;
-			ngx_int_t mph_rv = ngx::utls::nrs_ngx_parse_multipart_content_type(
-												(content_type_it->first + ": " + content_type_it->second), info);
+			const std::string content_type_header = ( content_type_it->first + ": " + content_type_it->second );
+			ngx_int_t mph_rv = ngx::utls::nrs_ngx_parse_multipart_content_type(content_type_header, info);
 			if ( NGX_OK != mph_rv ) {
 				NGX_BROKER_MODULE_ERROR_LOG(ngx_http_casper_broker_ul_module, a_r, "ul_module",
                                             "CH", "LEAVING",
@@ -666,6 +889,7 @@ ngx_int_t ngx_http_casper_broker_ul_module_content_handler (ngx_http_request_t*
 				delete context;
 				return NGX_HTTP_BAD_REQUEST;
 			}
+			multipart_boundary = std::string(reinterpret_cast<const char*>(info.boundary.data), info.boundary.len);
 		}
 	} else if ( nullptr == strstr(content_type_it->second.c_str(), "application/octet-stream") ) {
 		NGX_BROKER_MODULE_ERROR_LOG(ngx_http_casper_broker_ul_module, a_r, "ul_module",
@@ -726,16 +950,18 @@ ngx_int_t ngx_http_casper_broker_ul_module_content_handler (ngx_http_request_t*
 	}
     
     // ... nrs_ngx_multipart_body_t ...
-    context->multipart_body_.boundary_.set_            = 0;
-    context->multipart_body_.content_disposition_.set_ = 0;
-    context->multipart_body_.content_type_.set_        = 0;
-    context->multipart_body_.terminator_.set_          = 0;
-    context->multipart_body_.offset_                   = 0;
-    context->multipart_body_.done_                     = 0;
-    context->multipart_body_.last_                     = 0;
-    context->multipart_body_.enabled_                  = ( 1 == loc_conf->accept_multipart_body ) ? 1 : 0;
+    if ( NGX_OK != ngx::utls::nrs_ngx_init_multipart_body(multipart_boundary, ( 1 == loc_conf->accept_multipart_body ), context->multipart_body_) ) {
+        NGX_BROKER_MODULE_ERROR_LOG(ngx_http_casper_broker_ul_module, a_r, "ul_module",
+                                    "CH", "LEAVING",
+                                    "missing or invalid multipart '%s'...", "boundary"
+        );
+        delete context;
+        return NGX_HTTP_BAD_REQUEST;
+    }
     context->file_.offset_                             = 0;
     context->file_.writer_                             = nullptr;
+    context->part_                                     = 0;
+    context->file_.block_length_                       = 0;
     context->file_.bytes_written_                      = 0;
     context->file_.expires_in_                         = static_cast<int64_t>(loc_conf->expires_in);
     context->file_.directory_                          = std::string(reinterpret_cast<const char*>(loc_conf->output_dir.data), loc_conf->output_dir.len);
@@ -745,6 +971,17 @@ ngx_int_t ngx_http_casper_broker_ul_module_content_handler (ngx_http_request_t*
     context->error_tracker_                            = new ngx::casper::broker::ul::Errors("en_US");
     context->read_callback_again_                      = false;
     context->read_callback_count_                      = 0;
+    context->http_status_code_                         = NGX_HTTP_OK;
+    context->inspection_ticket_                        = 0;
+    context->inspection_deferred_                      = false;
+    context->inspection_abandon_                       = nullptr;
+    context->sniffed_                                  = false;
+    context->sniff_rejected_                           = false;
+    
+    // ... no multipart, MD5 is calculated by request body filter ...
+    if ( 0 == context->multipart_body_.enabled_ ) {
+        context->file_.md5_.Initialize();
+    }
     
     ngx_http_set_ctx(a_r, context, ngx_http_casper_broker_ul_module);
     
@@ -806,7 +1043,8 @@ ngx_int_t ngx_http_casper_broker_ul_module_content_handler (ngx_http_request_t*
         
         context->read_callback_again_ = ( NGX_AGAIN == rc );
         
-        return ( NGX_AGAIN == rc ? NGX_DONE : rc );
+        // ... body already read but inspection is running on a worker thread?
+        return ( ( NGX_AGAIN == rc || true == context->inspection_deferred_ ) ? NGX_DONE : rc );
     }
 
     // ... if no multipart ...
@@ -816,6 +1054,15 @@ ngx_int_t ngx_http_casper_broker_ul_module_content_handler (ngx_http_request_t*
         a_r->request_body_in_clean_file      = 0;
     }
     
+    // ... rejected while reading body ( e.g. by magic sniffing )?
+    if ( rc >= NGX_HTTP_SPECIAL_RESPONSE ) {
+        NGX_BROKER_MODULE_ERROR_LOG(ngx_http_casper_broker_ul_module, a_r, "ul_module",
+                                    "CH", "LEAVING",
+                                    "with http status code %d ...", rc
+        );
+        return rc;
+    }
+    
     NGX_BROKER_MODULE_ERROR_LOG(ngx_http_casper_broker_ul_module, a_r, "ul_module",
                                 "CH", "LEAVING",
                                 "with nginx error code %d ...", rc
@@ -870,6 +1117,12 @@ static void ngx_http_casper_broker_ul_module_read_body_callback (ngx_http_reques
                                 "READING BODY ( %d )", context->read_callback_count_
     );
 
+    // ... rejected by leading bytes sniffing, error is already tracked ...
+    if ( true == context->sniff_rejected_ ) {
+        http_status_code = NGX_HTTP_FORBIDDEN;
+        goto bailout;
+    }
+
     // ... nothing to read?
     if ( NULL == a_r->request_body || NULL == a_r->request_body->bufs ) {
         // ... no body!
@@ -935,13 +1188,9 @@ static void ngx_http_casper_broker_ul_module_read_body_callback (ngx_http_reques
                                         "%s", "reading body from memory buffers..."
 			);
 
-            // ... memory, write to file ...
-            context->file_.writer_ = new cc::fs::file::Writer();
-            
-            // ... open file now ...
+            // ... memory, open file now ...
             try {
-                context->file_.writer_->Open(context->file_.uri_, cc::fs::file::Writer::Mode::Write);
-                context->file_.md5_.Initialize();
+                ngx_http_casper_broker_ul_open_output(context, context->content_length_);
             } catch (const cc::Exception& a_cc_exception) {
                 ss.str("");
                 ss << "Error while opening file '" << context->file_.uri_ << "': " << a_cc_exception.what();
@@ -960,10 +1209,9 @@ static void ngx_http_casper_broker_ul_module_read_body_callback (ngx_http_reques
                 u_char* chain_buffer_ptr = chain->buf->pos;
                 size_t  chain_bytes_read = static_cast<size_t>(chain->buf->last - chain_buffer_ptr);
                 
-                // ... write data to file ...
+                // ... write data to file ( MD5 was already calculated by request body filter ) ...
                 try {
-                    context->file_.bytes_written_ += context->file_.writer_->Write(chain_buffer_ptr, chain_bytes_read, /* a_flush */ true);
-                    context->file_.md5_.Update(chain_buffer_ptr, chain_bytes_read);
+                    ngx_http_casper_broker_ul_write_output(context, chain_buffer_ptr, chain_bytes_read);
                 } catch (const cc::Exception& a_cc_exception) {
                     ss.str("");
                     ss << "Error while writing to file '" << context->file_.writer_->URI() << "': " << a_cc_exception.what();
@@ -996,128 +1244,86 @@ static void ngx_http_casper_broker_ul_module_read_body_callback (ngx_http_reques
     //
     // WARNING:
     //
-    // !!! At the moment of this module development:
-    //
-    // 1 ) non-blocking I/O was already set by nginx
-    // 2 ) relying on having NGX_HAVE_PREAD flag set to 1 ( at ngx_auto_config.h )
-    // 3 ) when this flag is defined, ngx_read_file calls pread which will return
-    //     EAGAIN - The file was marked for non-blocking I/O, and no data were ready to be read.
-    //
-    // !!! THIS info was confirmed to at macOS and Debian OS
+    // Body temporary file is a regular file: readiness notifications are never
+    // delivered for it, so nothing would call this handler again on EAGAIN -
+    // any short read is treated as a read error.
     //
-    // ... read data ...
-    while ( ( 0 == context->error_tracker_->Count() ) ) {
-        
-        // ... no more data to read?
-        if ( NULL == chain ) {
-            // ... done ...
-            break;
-        }
-
-        u_char* buffer_ptr;
-
-        // ... from file or memory?
-        if ( 1 == chain->buf->in_file ) {
-            // ... read from file ...
-            if ( ( bytes_read = ngx_read_file(chain->buf->file, buffer, NGX_HTTP_CASPER_BROKER_UL_MODULE_BODY_BUFFER_SIZE, read_offset) ) <= 0 ) {
-                break;
-            }
-            buffer_ptr = buffer;
-        } else {
-            // ... read fro memory ....
-            buffer_ptr = chain->buf->pos;
-            bytes_read = chain->buf->last - buffer_ptr;
-            // next ...
-            chain = chain->next;
-        }
-        
-        size_t write_offset = 0;
-        
-        if ( 0 == context->multipart_body_.done_ ) {
+    // ... scope, callbacks can't be crossed by 'goto' ...
+    {
+        // ... parts are streamed to file as they're parsed ...
+        const ngx::utls::nrs_ngx_multipart_callbacks_t callbacks = {
+            /* on_part_begin_ */ [&] (const ngx::utls::nrs_ngx_multipart_body_t& a_body) -> ngx_int_t {
             
-            size_t bytes_used = 0;
+                // ... each part is written to it's own file ...
+                context->file_.name_.clear();
+                context->file_.uri_.clear();
+                context->file_.offset_        = 0;
+                context->file_.bytes_written_ = 0;
             
-            ngx_int_t mpb_parse_rc = ngx::utls::nrs_ngx_parse_multipart_body(buffer_ptr, static_cast<size_t>(bytes_read), context->multipart_body_,
-                                                                             bytes_used);
-            if ( NGX_AGAIN == mpb_parse_rc ) {
-                
-                // ... still waiting for more data ...
-                read_offset += bytes_read;
-                continue;
-                
-            } else if ( NGX_DONE == mpb_parse_rc ) {
-                
                 //
                 // 'Content-Disposition'
                 //
-                if ( NGX_OK != ngx::utls::nrs_ngx_parse_content_disposition(context->multipart_body_.content_disposition_.value_,
+                if ( NGX_OK != ngx::utls::nrs_ngx_parse_content_disposition(a_body.content_disposition_,
                                                                             context->content_disposition_,
                                                                             context->field_name_, context->file_.name_) ) {
                     http_status_code = NGX_HTTP_BAD_REQUEST;
                     context->error_tracker_->Track("UL_AN_ERROR_OCCURRED_MESSAGE", http_status_code, "UL_AN_ERROR_OCCURRED_MESSAGE",
                                                    "Missing or invalid 'Content-Disposition' multipart body data!"
                     );
-                    break;
+                    return NGX_ERROR;
                 }
-                
+            
                 // ... we're only expecting a 'form-data' ...
                 if ( 0 != strcasecmp(context->content_disposition_.c_str(), "form-data") ) {
-                    
+                
                     ss.str("");
                     ss << "'Content-Disposition': " << context->content_disposition_.c_str();
                     ss << " is not supported, 'form-data' is expected!";
                     msg = ss.str().c_str();
-                    
+                
                     http_status_code = NGX_HTTP_BAD_REQUEST;
                     context->error_tracker_->Track("UL_AN_ERROR_OCCURRED_MESSAGE", http_status_code, "UL_AN_ERROR_OCCURRED_MESSAGE",
                                                    msg.c_str()
                     );
-                    break;
+                    return NGX_ERROR;
                 }
-                
+            
                 //
                 // 'Content-Type'
                 //
-                if ( NGX_OK != ngx::utls::nrs_ngx_parse_content_type(context->multipart_body_.content_type_.value_, context->content_type_) ) {
+                if ( NGX_OK != ngx::utls::nrs_ngx_parse_content_type(a_body.content_type_, context->content_type_) ) {
                     http_status_code = NGX_HTTP_BAD_REQUEST;
                     context->error_tracker_->Track("UL_AN_ERROR_OCCURRED_MESSAGE", http_status_code, "UL_AN_ERROR_OCCURRED_MESSAGE",
                                                    "Missing or invalid 'Content-Type' multipart body data!");
-                    break;
+                    return NGX_ERROR;
                 }
-                // ... final adjustment ..
-                context->content_length_ = static_cast<size_t>(a_r->headers_in.content_length_n - static_cast<off_t>( /* includes first boundary */
-                                                                                                                     context->multipart_body_.offset_ +
-                                                                                                                     /* last boundary */
-                                                                                                                     context->multipart_body_.boundary_.value_.length() + strlen(CRLF "--" CRLF)
-                                                                                                  )
-                );
-                
+            
+                // ... part length is only known when it ends, request's body length is an upper bound ...
+                context->content_length_ = static_cast<size_t>(a_r->headers_in.content_length_n);
+            
                 //
                 // Setup output file...
                 //
-                
+            
                 // ... sanity checkpoint ...
                 if ( nullptr != context->file_.writer_ ) {
                     http_status_code = NGX_HTTP_INTERNAL_SERVER_ERROR;
                     context->error_tracker_->Track("UL_AN_ERROR_OCCURRED_MESSAGE", http_status_code, "UL_AN_ERROR_OCCURRED_MESSAGE",
                                                    "Unexpected file writer state, shouldn't be set yet!"
                     );
-                    break;
+                    return NGX_ERROR;
                 }
-                
+            
                 // ... ensure output ...
                 http_status_code = ngx_http_casper_broker_ul_ensure_output(context, context->file_.uri_);
                 if ( NGX_HTTP_OK != http_status_code ) {
                     // ... at least one error should already be set ...
-                    break;
+                    return NGX_ERROR;
                 }
-                
-                // ... as is ...
-                context->file_.writer_ = new cc::fs::file::Writer();
-                
+            
                 // ... open file now ...
                 try {
-                    context->file_.writer_->Open(context->file_.uri_, cc::fs::file::Writer::Mode::Write);
+                    ngx_http_casper_broker_ul_open_output(context, context->content_length_);
                     context->file_.md5_.Initialize();
                 } catch (const cc::Exception& a_cc_exception) {
                     ss.str("");
@@ -1127,77 +1333,123 @@ static void ngx_http_casper_broker_ul_module_read_body_callback (ngx_http_reques
                     context->error_tracker_->Track("UL_AN_ERROR_OCCURRED_MESSAGE", http_status_code, "UL_AN_ERROR_OCCURRED_MESSAGE",
                                                    msg.c_str()
                     );
-                    break;
+                    return NGX_ERROR;
                 }
-                
-                if ( bytes_used > static_cast<size_t>(bytes_read) ) {
-                    // ... sanity check failed!
+            
+                return NGX_OK;
+            },
+            /* on_part_data_ */ [&] (const u_char* a_data, size_t a_length) -> ngx_int_t {
+                // ... write data to file ...
+                try {
+                    ngx_http_casper_broker_ul_write_output(context, a_data, a_length);
+                    context->file_.md5_.Update(a_data, a_length);
+                } catch (const cc::Exception& a_cc_exception) {
+                    ss.str("");
+                    ss << "Error while writing to file '" << context->file_.writer_->URI() << "': " << a_cc_exception.what();
+                    msg = ss.str();
                     http_status_code = NGX_HTTP_INTERNAL_SERVER_ERROR;
                     context->error_tracker_->Track("UL_AN_ERROR_OCCURRED_MESSAGE", http_status_code, "UL_AN_ERROR_OCCURRED_MESSAGE",
-                                                   "Error while parsing multipart body data - used more bytes than received!"
+                                                   msg.c_str()
                     );
-                    break;
-                } else if ( bytes_used == static_cast<size_t>(bytes_read) ) {
-                    read_offset += bytes_used;
+                    return NGX_ERROR;
+                }
+                return NGX_OK;
+            },
+            /* on_part_end_ */ [&] (const ngx::utls::nrs_ngx_multipart_body_t& /* a_body */) -> ngx_int_t {
+                // ... now part length is known ...
+                context->content_length_ = context->file_.bytes_written_;
+                // ... close it, next part will open it's own file ...
+                try {
+                    ngx_http_casper_broker_ul_flush_output(context);
+                    context->file_.writer_->Close();
+                } catch (const cc::Exception& a_cc_exception) {
+                    ss.str("");
+                    ss << "Error while closing file '" << context->file_.uri_ << "': " << a_cc_exception.what();
+                    msg = ss.str();
+                    http_status_code = NGX_HTTP_INTERNAL_SERVER_ERROR;
+                    context->error_tracker_->Track("UL_AN_ERROR_OCCURRED_MESSAGE", http_status_code, "UL_AN_ERROR_OCCURRED_MESSAGE",
+                                                   msg.c_str()
+                    );
+                    return NGX_ERROR;
+                }
+                delete context->file_.writer_;
+                context->file_.writer_ = nullptr;
+                // ... keep track of it, inspection and response will need it ...
+                context->parts_.push_back({
+                    /* name_          */ context->file_.name_,
+                    /* uri_           */ context->file_.uri_,
+                    /* md5_value_     */ context->file_.md5_.Finalize(),
+                    /* offset_        */ 0,
+                    /* bytes_written_ */ context->file_.bytes_written_
+                });
+                context->part_ = context->parts_.size();
+                return NGX_OK;
+            }
+        };
+    
+        // ... read data ...
+        while ( ( 0 == context->error_tracker_->Count() ) && 0 == context->multipart_body_.done_ ) {
+        
+            // ... no more data to read?
+            if ( NULL == chain ) {
+                // ... done ...
+                break;
+            }
+
+            u_char* buffer_ptr;
+
+            // ... from file or memory?
+            if ( 1 == chain->buf->in_file ) {
+                // ... end of this file buffer?
+                const off_t remaining = chain->buf->file_last - ( chain->buf->file_pos + read_offset );
+                if ( remaining <= 0 ) {
+                    // ... next ...
+                    chain       = chain->next;
+                    read_offset = 0;
                     continue;
-                } else {
-                    write_offset = context->multipart_body_.offset_;
-                    read_offset += bytes_read;
                 }
-                
+                // ... read from file ...
+                if ( ( bytes_read = ngx_read_file(chain->buf->file, buffer, std::min(static_cast<size_t>(NGX_HTTP_CASPER_BROKER_UL_MODULE_BODY_BUFFER_SIZE), static_cast<size_t>(remaining)),
+                                                  chain->buf->file_pos + read_offset) ) <= 0 ) {
+                    // ... read error ( EAGAIN included ) or unexpected EOF ...
+                    break;
+                }
+                buffer_ptr   = buffer;
+                read_offset += bytes_read;
             } else {
-                http_status_code = NGX_HTTP_INTERNAL_SERVER_ERROR;
-                context->error_tracker_->Track("UL_AN_ERROR_OCCURRED_MESSAGE", http_status_code, "UL_AN_ERROR_OCCURRED_MESSAGE",
-                                               "Error while parsing multipart body data!"
-                );
-                break;
+                // ... read fro memory ....
+                buffer_ptr = chain->buf->pos;
+                bytes_read = chain->buf->last - buffer_ptr;
+                // next ...
+                chain = chain->next;
             }
-            
-        } else {
-            // ... next ...
-            read_offset += bytes_read;
-        }
         
-        // ... adjust buffer pointer and amount of bytes to write ...
-        size_t bytes_to_write = static_cast<size_t>(bytes_read) - write_offset;
-        if ( ( context->file_.bytes_written_ + bytes_to_write ) > context->content_length_ ) {
-            size_t diff = context->content_length_ - context->file_.bytes_written_;
-            if ( 0 == diff ) {
-                bytes_to_write = 0;
+            // ... parse, part(s) data is written by callbacks ...
+            if ( NGX_ERROR == ngx::utls::nrs_ngx_parse_multipart_body(buffer_ptr, static_cast<size_t>(bytes_read), context->multipart_body_, callbacks) ) {
+                // ... if not set by a callback, it's a syntax error ...
+                if ( 0 == context->error_tracker_->Count() ) {
+                    http_status_code = NGX_HTTP_BAD_REQUEST;
+                    context->error_tracker_->Track("UL_AN_ERROR_OCCURRED_MESSAGE", http_status_code, "UL_AN_ERROR_OCCURRED_MESSAGE",
+                                                   "Error while parsing multipart body data!"
+                    );
+                }
                 break;
             }
-            bytes_to_write = diff;
+
         }
-        
-        // ... write data to file ...
-        try {
-            context->file_.bytes_written_ += context->file_.writer_->Write(buffer_ptr + write_offset, bytes_to_write, /* a_flush */ true);
-            context->file_.md5_.Update(buffer_ptr + write_offset, bytes_to_write);
-        } catch (const cc::Exception& a_cc_exception) {
-            ss.str("");
-            ss << "Error while writing to file '" << context->file_.writer_->URI() << "': " << a_cc_exception.what();
-            msg = ss.str();
-            http_status_code = NGX_HTTP_INTERNAL_SERVER_ERROR;
+    
+        // ... body ended before close delimiter or without any part?
+        if ( 0 == context->error_tracker_->Count() && bytes_read >= 0
+            && ( 0 == context->multipart_body_.done_ || 0 == context->multipart_body_.parts_ ) ) {
+            http_status_code = NGX_HTTP_BAD_REQUEST;
             context->error_tracker_->Track("UL_AN_ERROR_OCCURRED_MESSAGE", http_status_code, "UL_AN_ERROR_OCCURRED_MESSAGE",
-                                           msg.c_str()
+                                           "Incomplete multipart body data!"
             );
-            break;
         }
-
     }
     
 done:
     
-    // ... I/O ...
-    if ( EAGAIN == bytes_read ) {
-        NGX_BROKER_MODULE_DEBUG_LOG(ngx_http_casper_broker_ul_module, a_r, "ul_module",
-                                    "RB", "EAGAIN",
-                                    "%s", ""
-        );
-        // .... this method should be called again by nginx when fd is ready ...
-        return;
-    }
-    
     // ... done?
     clean_exit = ( 0 == ( context->content_length_ - context->file_.bytes_written_ ) );
     errors_set = ( context->error_tracker_->Count() > 0 || bytes_read < 0 );
@@ -1232,6 +1484,7 @@ done:
         if ( nullptr != context->file_.writer_ ) {
             const std::string uri = context->file_.writer_->URI();
             try {
+                ngx_http_casper_broker_ul_flush_output(context);
                 context->file_.writer_->Close();
             } catch (const cc::Exception& a_cc_exception) {
                 ss.str("");
@@ -1244,315 +1497,586 @@ done:
             }
         }
         
-        std::string magic_type;
-        std::string magic_desc;
-        
-        // ... magic fetch / validation ...
-        const ngx_http_casper_broker_ul_module_loc_conf_t* loc_conf = (const ngx_http_casper_broker_ul_module_loc_conf_t*) ngx_http_get_module_loc_conf(a_r, ngx_http_casper_broker_ul_module);
-        try {
-            
-            // ... calculate md5 ...
+        // ... calculate md5 ( or, for a multipart body, start with first part - each one was finalized when it ended ) ...
+        if ( 0 == context->error_tracker_->Count() && context->parts_.size() > 0 ) {
+            ngx_http_casper_broker_ul_module_load_part(context, 0);
+        } else {
             context->file_.md5_value_ = context->file_.md5_.Finalize();
-            
-            // ...
-            typedef struct {
-                const int          flags_;
-                const char* const  via_;
-                const ngx_array_t* array_;
-                std::string        match_;
-                std::string        value_;
-                size_t             offset_;
-            } _Entry;
-            std::vector<_Entry> entries = {
-                { MAGIC_MIME_TYPE, "MIME Type"  , nullptr,  "", "", 0 },
-                { MAGIC_NONE     , "Description", nullptr , "", "", 0 }
-            };
-
-            // ... magic fetch ...
-            {
-                cc::magic::MIMEType magic; magic.Initialize(std::string(NGX_SHARED_DIR));
-                for ( size_t idx = 0 ; idx < entries.size() ; ++idx ) {
-                    // ... reset ...
-                    magic.Reset(entries[idx].flags_);
-                    // ... test ...
-                    entries[idx].value_ = magic.WithoutCharsetOf(context->file_.uri_, entries[idx].offset_);
-                    // ... f'ed up PDF?
-                    if ( 0 != entries[0].offset_ ) {
-                        std::string tmp;
-                        // ... new temporary file ...
-                        http_status_code = ngx_http_casper_broker_ul_ensure_output(context, tmp);
-                        if ( NGX_HTTP_OK == http_status_code ) {
-                            // ... copy file ( from offset ) and calculate new MD5 value ...
-                            ::cc::fs::File::Copy(context->file_.uri_, tmp, /* a_overwrite */ true, entries[idx].offset_, context->file_.md5_value_);
-                            // ... adjust other info ...
-                            context->file_.offset_         = entries[idx].offset_;
-                            context->file_.bytes_written_ -= entries[idx].offset_;
-                            context->content_length_      -= entries[idx].offset_;
-                            context->file_.uri_            = tmp;
-                            // ... again ...
-                            entries[idx].value_ = magic.WithoutCharsetOf(context->file_.uri_, entries[0].offset_);
-                        }
-                    }
-                }
-            }
+        }
+        
+        // ... inspect data ( possibly on a worker thread ), xattrs and response will follow ...
+        context->http_status_code_ = http_status_code;
+        ngx_http_casper_broker_ul_module_inspect(a_r, context);
+        return;
+    }
+    
+bailout:
+        
+    errors_set = ( context->error_tracker_->Count() > 0 || bytes_read < 0 );
 
-            // ... track type ...
-            magic_type = entries[0].value_; // MAGIC_MIME_TYPE
-            magic_desc = entries[1].value_; // MAGIC_NONE
+    if ( true == wtf_bailout ) {
+        
+        NGX_BROKER_MODULE_ERROR_LOG(ngx_http_casper_broker_ul_module, a_r, "ul_module",
+                                    "RB", "LEAVING",
+                                    "%s", "WTF bailout!"
+        );
+        
+        a_r->connection->read->eof = 1;
+        ngx_http_finalize_request(a_r, NGX_HTTP_INTERNAL_SERVER_ERROR);
+        
+    } else if ( true == clean_exit || true == errors_set ) {
+        ngx_http_casper_broker_ul_module_respond(a_r, context, http_status_code, errors_set);
+    }
 
-            // ... validate?
-            if ( 200 == http_status_code && 1 == loc_conf->magic_validation ) {
-                // ... yes ...
-                entries[0].array_ = loc_conf->allowed_magic_types; // MAGIC_MIME_TYPE
-                entries[1].array_ = loc_conf->allowed_magic_desc;  // MAGIC_NONE
-                // ... log ...
-                NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
-                                        "CH", "VALIDATING",
-                                        "Magically validating: %s", context->file_.uri_.c_str()
-                );
-                // ... log ...
-                NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
-                                        "CH", "VALIDATING",
-                                        "Magically translated to '%s' ( %s )", magic_type.c_str(), magic_desc.c_str()
-                );
-                // ... validate ...
-                if ( nullptr != loc_conf->allowed_magic_types || nullptr != loc_conf->allowed_magic_desc ) {
-                    ssize_t allowed = -1;
-                    for ( size_t idx = 0 ; idx < entries.size() && -1 == allowed ; ++idx ) {
-                        // ... no data?
-                        auto entry = entries[idx];
-                        if ( nullptr == entry.array_ ) {
-                            // ... next ...
-                            continue;
-                        }
-                        // ... test ...
-                        const ngx_str_t* array = ((ngx_str_t*) entry.array_->elts);
-                        for ( ngx_uint_t idx2 = 0; idx2 < entry.array_->nelts; idx2++ ) {
-                            const ngx_str_t value = array[idx2];
-                            if ( 0 == value.len ) {
-                                continue;
-                            }
-                            if ( 0 == strncasecmp((const char*)(value.data), entry.value_.c_str(), std::min(value.len, entry.value_.length())) ) {
-                                entries[idx].match_ = entry.value_;
-                                allowed = static_cast<ssize_t>(idx);
-                                break;
-                            }
-                        }
-                    }
-                    // ... allowed?
-                    if ( -1 != allowed ) {
-                        // ... yes, log it ...
-                        NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
-                                                "CH", "VALIDATING",
-                                                "Magically allowed via '%s' rule '%s'",
-                                                ( MAGIC_MIME_TYPE == entries[static_cast<size_t>(allowed)].flags_ ? "MIME Type" : "Description" ), entries[static_cast<size_t>(allowed)].match_.c_str()
-                        );
-                    } else {
-                        // ... no ...
-                        http_status_code = NGX_HTTP_FORBIDDEN;
-                        // ... log it ...
-                        NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
-                                                "CH", "VALIDATING",
-                                                "Magically %s!", "DENIED"
-                        );
-                    }
-                } else {
-                    // ... no rules specified, denied by default ...
-                    http_status_code = NGX_HTTP_FORBIDDEN;
-                    // ... log it ...
-                    NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
-                                            "CH", "VALIDATING",
-                                            "Magically %s!", "DENIED - no rules provided"
-                    );
-                }
-                // ... track error?
-                if ( NGX_HTTP_FORBIDDEN == http_status_code ) {
-                    context->error_tracker_->Track("BROKER_FORBIDDEN_ERROR", NGX_HTTP_FORBIDDEN, "BROKER_FORBIDDEN_ERROR",
-                                                   ( "The uploaded data MIME-Type '" + magic_type + "' ( " + magic_desc  + " ) is not allowed!" ).c_str()
-                    );
-                }
-            }
-            
-            // ... 'scan magic'?
-            if ( NGX_HTTP_OK == http_status_code && 1 == loc_conf->scan_magic ) {
-                // ... use 'scan magic' arrays
-                entries[0].array_ = loc_conf->scan_magic_types; // MAGIC_MIME_TYPE
-                entries[1].array_ = loc_conf->scan_magic_desc;  // MAGIC_NONE
-                // ...
-                ssize_t scan = -1;
-                for ( size_t idx = 0 ; idx < entries.size() && -1 == scan ; ++idx ) {
-                    // ... no data?
-                    auto entry = entries[idx];
-                    if ( nullptr == entry.array_ ) {
-                        // ... next ...
-                        continue;
-                    }
-                    // ... test ...
-                    const ngx_str_t* array = ((ngx_str_t*) entry.array_->elts);
-                    for ( ngx_uint_t idx2 = 0; idx2 < entry.array_->nelts; idx2++ ) {
-                        const ngx_str_t value = array[idx2];
-                        if ( 0 == value.len ) {
-                            continue;
-                        }
-                        if ( 0 == strncasecmp((const char*)(value.data), entry.value_.c_str(), std::min(value.len, entry.value_.length())) ) {
-                            entries[idx].match_ = entry.value_;
-                            scan = static_cast<ssize_t>(idx);
-                            break;
-                        }
-                    }
-                }
-                // ... scan using libmodsecurity=
-                if ( -1 != scan ) {
-                    ::cc::modsecurity::Processor& processor = ::cc::modsecurity::Processor::GetInstance();
-                    // ... yes ... this always a POST request ...
-                    ::cc::modsecurity::Processor::HTTPPOSTRequest request = {
-                        /* id_             */ "",
-                        /* module_         */ "ul_module",
-                        /* content_type_   */ magic_type,
-                        /* content_length_ */ context->file_.bytes_written_,
-                        /* client_         */ { "", 0 },
-                        /* server_         */ { "", 0 },
-                        /* uri_            */ std::string(reinterpret_cast<char const*>(a_r->uri.data), a_r->uri.len),
-                        /* version_        */ std::to_string(a_r->http_major) + '.' + std::to_string(a_r->http_minor),
-                        /* body_file_uri_  */ context->file_.uri_,
-                        /* logger_         */ [&] (const std::string& a_line) {
-                            NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
-                                                    "CH", "SCANNING",
-                                                    "%s", a_line.c_str()
-                            );
-                        }
-                    };
-                    cc::fs::File::Name(request.body_file_uri_, request.id_);
-                    ngx_http_casper_broker_ul_addr_to_hr(a_r->connection->sockaddr, a_r->connection->socklen, request.client_);
-                    ngx_http_casper_broker_ul_addr_to_hr(a_r->connection->local_sockaddr, a_r->connection->local_socklen, request.server_);
-                    // ... allowed by modsecurity?
-                    ::cc::modsecurity::Processor::Rule rule;
-                    // ... scan ...
-                    if ( false == processor.IsEnabled(request.module_) ) {
-                        processor.Enable(request.module_,
-                                         /* a_path */ std::string(reinterpret_cast<const char* const>(loc_conf->scan_conf_dir.data), static_cast<size_t>(loc_conf->scan_conf_dir.len)),
-                                         /* a_file */ std::string(reinterpret_cast<const char* const>(loc_conf->scan_conf_file.data), static_cast<size_t>(loc_conf->scan_conf_file.len))
-                        );
-                    }
-                    if ( 200 != processor.Validate(request, rule) ) {
-                        // ... provided data is NOT allowed ...
-                        http_status_code = NGX_HTTP_FORBIDDEN;
-                        // ... track error ...
-                        if ( 0 != rule.id_.length() ) {
-                            context->error_tracker_->Track("BROKER_FORBIDDEN_ERROR", NGX_HTTP_FORBIDDEN, "BROKER_FORBIDDEN_ERROR",
-                                                           ( "DENIED due to security rule #" + rule.id_ + ": " + rule.msg_ + "!").c_str()
-                            );
-                        } else {
-                            context->error_tracker_->Track("BROKER_FORBIDDEN_ERROR", NGX_HTTP_FORBIDDEN, "BROKER_FORBIDDEN_ERROR",
-                                                           ( "DENIED due to " + rule.data_ ).c_str()
-                            );
-                        }
-                    }
-                }
-            }
-            
-        } catch (const cc::Exception& a_cc_exception) {
-            // ... if validation is madatory ...
-            if ( 1 == loc_conf->magic_validation ) {
-                // ... report error ...
-                ss.str("");
-                ss << "Error while magically validating file '" << context->file_.uri_ << "': " << a_cc_exception.what();
-                msg = ss.str();
-                http_status_code = NGX_HTTP_INTERNAL_SERVER_ERROR;
-                context->error_tracker_->Track("UL_AN_ERROR_OCCURRED_MESSAGE", NGX_HTTP_INTERNAL_SERVER_ERROR, "UL_AN_ERROR_OCCURRED_MESSAGE",
-                                               msg.c_str()
-                );
-            }
-        }
-        
-        // ... write xattrs ...
-        try {
-                            
-            // ... and write xattrs ...
-            ::cc::fs::file::XAttr xattrs(context->file_.uri_);
-            
-            // ... upload id is same as file name ...
-            std::string id;  ::cc::fs::File::Name(context->file_.uri_, id);
+}
 
-            // ... set upload id ...
-            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.id", id);
+#ifdef __APPLE__
+#pragma mark - Inspection
+#endif
 
-            // ... http info ...
-            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.protocol"   ,
-                       std::string(reinterpret_cast<char const*>(a_r->http_protocol.data), a_r->http_protocol.len)
-            );
-            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.method"   ,
-                       std::string(reinterpret_cast<char const*>(a_r->method_name.data), a_r->method_name.len)
+/**
+ * @brief Validate leading body bytes magic, while body is still being received.
+ *
+ * @param a_r       The http request.
+ * @param a_context Module context.
+ *
+ * @return False if body must be rejected now, true if it's allowed or if only the whole file can tell.
+ */
+static bool ngx_http_casper_broker_ul_module_sniff (ngx_http_request_t* a_r, ngx_http_casper_broker_ul_module_context_t* a_context)
+{
+    const ngx_http_casper_broker_ul_module_loc_conf_t* loc_conf = (const ngx_http_casper_broker_ul_module_loc_conf_t*) ngx_http_get_module_loc_conf(a_r, ngx_http_casper_broker_ul_module);
+    
+    std::string magic_type;
+    std::string magic_desc;
+    
+    // ... a signature preceded by junk is only found by the whole file check ( which copies data from it's offset ) ...
+    static const char* const k_offset_detected_signatures [] = { "%PDF-" };
+    for ( const char* const signature : k_offset_detected_signatures ) {
+        const u_char* const begin = reinterpret_cast<const u_char*>(signature);
+        const auto          it    = std::search(a_context->sniff_.begin(), a_context->sniff_.end(), begin, begin + strlen(signature));
+        if ( a_context->sniff_.end() != it && a_context->sniff_.begin() != it ) {
+            NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
+                                    "RB", "SNIFFING",
+                                    "'%s' at offset " SIZET_FMT ", deferred to whole file check", signature, static_cast<size_t>(it - a_context->sniff_.begin())
             );
-            if ( nullptr != a_r->headers_in.user_agent && a_r->headers_in.user_agent->value.len > 0 ) {
-                xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.user-agent"    ,
-                           std::string(reinterpret_cast<char const*>(a_r->headers_in.user_agent->value.data), a_r->headers_in.user_agent->value.len)
-               );
+            std::vector<u_char>().swap(a_context->sniff_);
+            return true;
+        }
+    }
+
+    // ... leading bytes are tested in memory, no I/O on event loop ...
+    try {
+        const magic_t cookie    = ngx_http_casper_broker_ul_magic_cookie();
+        const int     flags [2] = { MAGIC_MIME_TYPE, MAGIC_NONE };
+        std::string*  values[2] = { &magic_type, &magic_desc };
+        for ( size_t idx = 0 ; idx < 2 ; ++idx ) {
+            magic_setflags(cookie, flags[idx]);
+            const char* const value = magic_buffer(cookie, a_context->sniff_.data(), a_context->sniff_.size());
+            if ( nullptr == value ) {
+                throw ::cc::Exception("%s", nullptr != magic_error(cookie) ? magic_error(cookie) : "magic_buffer failed");
             }
+            (*values[idx]) = value;
+        }
+    } catch (const cc::Exception& a_cc_exception) {
+        NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
+                                "RB", "SNIFFING",
+                                "Unable to sniff: %s", a_cc_exception.what()
+        );
+        magic_type = "";
+    }
+    
+    // ... no longer needed ...
+    std::vector<u_char>().swap(a_context->sniff_);
+    
+    // ... unknown or too generic, whole file check will decide ...
+    if ( 0 == magic_type.length() || true == ngx_http_casper_broker_ul_magic_matches(loc_conf->sniff_defer_types, magic_type) ) {
+        return true;
+    }
+    
+    NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
+                            "RB", "SNIFFING",
+                            "Magically sniffed '%s' ( %s )", magic_type.c_str(), magic_desc.c_str()
+    );
+    
+    // ... allowed?
+    if ( true == ngx_http_casper_broker_ul_magic_matches(loc_conf->allowed_magic_types, magic_type)
+            || true == ngx_http_casper_broker_ul_magic_matches(loc_conf->allowed_magic_desc, magic_desc) ) {
+        return true;
+    }
+    
+    NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
+                            "RB", "SNIFFING",
+                            "Magically %s!", "DENIED"
+    );
+    
+    return false;
+}
 
-            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.ip",
-                       std::string(reinterpret_cast<char const*>(a_r->connection->addr_text.data), a_r->connection->addr_text.len)
-            );
+/**
+ * @brief Start uploaded data inspection: magic fetch, validation and, if required, a security scan.
+ *
+ * @param a_r       The http request.
+ * @param a_context Module context.
+ */
+static void ngx_http_casper_broker_ul_module_inspect (ngx_http_request_t* a_r, ngx_http_casper_broker_ul_module_context_t* a_context)
+{
+    // ... start workers on first use ( after fork ), pool is per worker so it's size comes from the main conf ...
+    if ( false == ngx_http_casper_broker_ul_module_inspector_started ) {
+        const ngx_http_casper_broker_ul_module_main_conf_t* main_conf = (const ngx_http_casper_broker_ul_module_main_conf_t*) ngx_http_get_module_main_conf(a_r, ngx_http_casper_broker_ul_module);
+        ::ngx::casper::broker::ul::Inspector::GetInstance().Startup(static_cast<size_t>(main_conf->inspection_threads));
+        ngx_http_casper_broker_ul_module_inspector_started = true;
+    }
+    
+    // ... magic fetch ...
+    const std::shared_ptr<ngx_http_casper_broker_ul_magic_t> magic = std::make_shared<ngx_http_casper_broker_ul_magic_t>();
+    magic->name_    = a_context->file_.name_;
+    magic->uri_     = a_context->file_.uri_;
+    magic->offset_  = 0;
+    magic->skipped_ = 0;
+    ngx_http_casper_broker_ul_module_schedule(a_context,
+                                              [magic] (const std::atomic<bool>& a_abort) {
+                                                  ngx_http_casper_broker_ul_magic_fetch(*magic, a_abort);
+                                              },
+                                              [a_r, a_context, magic] () {
+                                                  ngx_http_casper_broker_ul_module_on_magic(a_r, a_context, *magic);
+                                              },
+                                              // ... request gone, forget copy made by a f'ed up PDF fetch ...
+                                              [magic] () {
+                                                  if ( 0 != magic->skipped_ ) {
+                                                      unlink(magic->uri_.c_str());
+                                                  }
+                                              }
+    );
+}
 
-            for ( auto header : { "origin", "referer" } ) {
-                const auto it = context->in_headers_.find(header);
-                if ( context->in_headers_.end() == it ) {
+/**
+ * @brief Called on main thread when magic fetch is done, validates it and, if required, schedules a security scan.
+ *
+ * @param a_r       The http request.
+ * @param a_context Module context.
+ * @param a_magic   Magic fetch result.
+ */
+static void ngx_http_casper_broker_ul_module_on_magic (ngx_http_request_t* a_r, ngx_http_casper_broker_ul_module_context_t* a_context,
+                                                       const ngx_http_casper_broker_ul_magic_t& a_magic)
+{
+    const ngx_http_casper_broker_ul_module_loc_conf_t* loc_conf = (const ngx_http_casper_broker_ul_module_loc_conf_t*) ngx_http_get_module_loc_conf(a_r, ngx_http_casper_broker_ul_module);
+    
+    ngx_uint_t& http_status_code = a_context->http_status_code_;
+    
+    // ... f'ed up PDF, data was copied from offset ...
+    if ( 0 != a_magic.skipped_ ) {
+        a_context->file_.offset_         = a_magic.offset_;
+        a_context->file_.bytes_written_ -= a_magic.skipped_;
+        a_context->content_length_      -= a_magic.skipped_;
+        a_context->file_.uri_            = a_magic.uri_;
+        a_context->file_.md5_value_      = a_magic.md5_value_;
+    }
+    
+    // ... failed?
+    if ( 0 != a_magic.error_.length() ) {
+        ngx_http_casper_broker_ul_module_on_inspection_error(a_r, a_context, a_magic.error_);
+        ngx_http_casper_broker_ul_module_finish(a_r, a_context);
+        return;
+    }
+    
+    // ...
+    typedef struct {
+        const int          flags_;
+        const char* const  via_;
+        const ngx_array_t* array_;
+        std::string        match_;
+        std::string        value_;
+    } _Entry;
+    std::vector<_Entry> entries = {
+        { MAGIC_MIME_TYPE, "MIME Type"  , nullptr,  "", a_magic.type_ },
+        { MAGIC_NONE     , "Description", nullptr , "", a_magic.desc_ }
+    };
+    
+    // ... track type ...
+    a_context->magic_type_ = entries[0].value_; // MAGIC_MIME_TYPE
+    a_context->magic_desc_ = entries[1].value_; // MAGIC_NONE
+    
+    const std::string& magic_type = a_context->magic_type_;
+    const std::string& magic_desc = a_context->magic_desc_;
+    
+    // ... validate?
+    if ( 200 == http_status_code && 1 == loc_conf->magic_validation ) {
+        // ... yes ...
+        entries[0].array_ = loc_conf->allowed_magic_types; // MAGIC_MIME_TYPE
+        entries[1].array_ = loc_conf->allowed_magic_desc;  // MAGIC_NONE
+        // ... log ...
+        NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
+                                "CH", "VALIDATING",
+                                "Magically validating: %s", a_context->file_.uri_.c_str()
+        );
+        // ... log ...
+        NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
+                                "CH", "VALIDATING",
+                                "Magically translated to '%s' ( %s )", magic_type.c_str(), magic_desc.c_str()
+        );
+        // ... validate ...
+        if ( nullptr != loc_conf->allowed_magic_types || nullptr != loc_conf->allowed_magic_desc ) {
+            ssize_t allowed = -1;
+            for ( size_t idx = 0 ; idx < entries.size() && -1 == allowed ; ++idx ) {
+                // ... no data?
+                auto entry = entries[idx];
+                if ( nullptr == entry.array_ ) {
+                    // ... next ...
                     continue;
                 }
-                xattrs.Set(std::string(XATTR_ARCHIVE_PREFIX "com.cldware.upload.") + header,
-                           it->second
+                // ... test ...
+                if ( true == ngx_http_casper_broker_ul_magic_matches(entry.array_, entry.value_) ) {
+                    entries[idx].match_ = entry.value_;
+                    allowed = static_cast<ssize_t>(idx);
+                }
+            }
+            // ... allowed?
+            if ( -1 != allowed ) {
+                // ... yes, log it ...
+                NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
+                                        "CH", "VALIDATING",
+                                        "Magically allowed via '%s' rule '%s'",
+                                        ( MAGIC_MIME_TYPE == entries[static_cast<size_t>(allowed)].flags_ ? "MIME Type" : "Description" ), entries[static_cast<size_t>(allowed)].match_.c_str()
+                );
+            } else {
+                // ... no ...
+                http_status_code = NGX_HTTP_FORBIDDEN;
+                // ... log it ...
+                NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
+                                        "CH", "VALIDATING",
+                                        "Magically %s!", "DENIED"
                 );
             }
-            
-            // ... magic type and desc ...
-            if ( magic_type.length() > 0 ) {
-                xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.magic.type", magic_type);
+        } else {
+            // ... no rules specified, denied by default ...
+            http_status_code = NGX_HTTP_FORBIDDEN;
+            // ... log it ...
+            NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
+                                    "CH", "VALIDATING",
+                                    "Magically %s!", "DENIED - no rules provided"
+            );
+        }
+        // ... track error?
+        if ( NGX_HTTP_FORBIDDEN == http_status_code ) {
+            a_context->error_tracker_->Track("BROKER_FORBIDDEN_ERROR", NGX_HTTP_FORBIDDEN, "BROKER_FORBIDDEN_ERROR",
+                                             ( "The uploaded data MIME-Type '" + magic_type + "' ( " + magic_desc  + " ) is not allowed!" ).c_str()
+            );
+        }
+    }
+    
+    // ... 'scan magic'?
+    if ( NGX_HTTP_OK == http_status_code && 1 == loc_conf->scan_magic ) {
+        // ... use 'scan magic' arrays
+        entries[0].array_ = loc_conf->scan_magic_types; // MAGIC_MIME_TYPE
+        entries[1].array_ = loc_conf->scan_magic_desc;  // MAGIC_NONE
+        // ...
+        ssize_t scan = -1;
+        for ( size_t idx = 0 ; idx < entries.size() && -1 == scan ; ++idx ) {
+            // ... no data?
+            auto entry = entries[idx];
+            if ( nullptr == entry.array_ ) {
+                // ... next ...
+                continue;
             }
-            if ( magic_desc.length() > 0 ) {
-                xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.magic.description", magic_desc);
+            // ... test ...
+            if ( true == ngx_http_casper_broker_ul_magic_matches(entry.array_, entry.value_) ) {
+                entries[idx].match_ = entry.value_;
+                scan = static_cast<ssize_t>(idx);
             }
-            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.magic.validation", ( 1 == loc_conf->magic_validation ? "yes" : "no" ));
-            
-            // ... module & timestamp info ...
-            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.created.by", NGX_CASPER_BROKER_UL_MODULE_INFO);
-            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.created.at", cc::UTCTime::NowISO8601WithTZ());
-            
-            // ... content info ...
-            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.uri", "file://" + context->file_.uri_);
-            if ( nullptr != a_r->headers_in.content_type && a_r->headers_in.content_type->value.len > 0 ) {
-                xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.content-type",
-                           std::string(reinterpret_cast<char const*>(a_r->headers_in.content_type->value.data), a_r->headers_in.content_type->value.len)
-                );
+        }
+        // ... scan using libmodsecurity ...
+        if ( -1 != scan ) {
+            // ... log lines are collected by worker and written here ...
+            const std::shared_ptr<std::vector<std::string>> log = std::make_shared<std::vector<std::string>>();
+            // ... yes ... this always a POST request ...
+            const std::shared_ptr<ngx_http_casper_broker_ul_scan_t> data = std::make_shared<ngx_http_casper_broker_ul_scan_t>(ngx_http_casper_broker_ul_scan_t {
+                /* request_ */ {
+                    /* id_             */ "",
+                    /* module_         */ "ul_module",
+                    /* content_type_   */ magic_type,
+                    /* content_length_ */ a_context->file_.bytes_written_,
+                    /* client_         */ { "", 0 },
+                    /* server_         */ { "", 0 },
+                    /* uri_            */ std::string(reinterpret_cast<char const*>(a_r->uri.data), a_r->uri.len),
+                    /* version_        */ std::to_string(a_r->http_major) + '.' + std::to_string(a_r->http_minor),
+                    /* body_file_uri_  */ a_context->file_.uri_,
+                    /* logger_         */ [log] (const std::string& a_line) {
+                        log->push_back(a_line);
+                    }
+                },
+                /* head_        */ loc_conf->scan_head,
+                /* tail_        */ loc_conf->scan_tail,
+                /* log_         */ log,
+                /* rule_        */ {},
+                /* status_code_ */ 0,
+                /* error_       */ ""
+            });
+            try {
+                cc::fs::File::Name(data->request_.body_file_uri_, data->request_.id_);
+                ngx_http_casper_broker_ul_addr_to_hr(a_r->connection->sockaddr, a_r->connection->socklen, data->request_.client_);
+                ngx_http_casper_broker_ul_addr_to_hr(a_r->connection->local_sockaddr, a_r->connection->local_socklen, data->request_.server_);
+                // ... rules are loaded here, once, so workers only run them ...
+                ::cc::modsecurity::Processor& processor = ::cc::modsecurity::Processor::GetInstance();
+                if ( false == processor.IsEnabled(data->request_.module_) ) {
+                    processor.Enable(data->request_.module_,
+                                     /* a_path */ std::string(reinterpret_cast<const char* const>(loc_conf->scan_conf_dir.data), static_cast<size_t>(loc_conf->scan_conf_dir.len)),
+                                     /* a_file */ std::string(reinterpret_cast<const char* const>(loc_conf->scan_conf_file.data), static_cast<size_t>(loc_conf->scan_conf_file.len))
+                    );
+                }
+            } catch (const cc::Exception& a_cc_exception) {
+                ngx_http_casper_broker_ul_module_on_inspection_error(a_r, a_context, a_cc_exception.what());
+                ngx_http_casper_broker_ul_module_finish(a_r, a_context);
+                return;
             }
-            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.content-length", std::to_string(context->file_.bytes_written_));
-            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.md5"           , context->file_.md5_value_);
-            if ( 0 != context->file_.offset_ ) {
-                xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.suspicious.type"        , magic_type);
-                xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.suspicious.offsetted.by", std::to_string(context->file_.offset_));
+            // ... scan ...
+            ngx_http_casper_broker_ul_module_schedule(a_context,
+                                                      [data] (const std::atomic<bool>& a_abort) {
+                                                          ngx_http_casper_broker_ul_scan(*data, a_abort);
+                                                      },
+                                                      [a_r, a_context, data] () {
+                                                          ngx_http_casper_broker_ul_module_on_scan(a_r, a_context, *data);
+                                                      },
+                                                      /* a_abandon - scan window is removed by worker */ nullptr
+            );
+            return;
+        }
+    }
+    
+    ngx_http_casper_broker_ul_module_finish(a_r, a_context);
+}
+
+/**
+ * @brief Called on main thread when security scan is done.
+ *
+ * @param a_r       The http request.
+ * @param a_context Module context.
+ * @param a_scan    Security scan result.
+ */
+static void ngx_http_casper_broker_ul_module_on_scan (ngx_http_request_t* a_r, ngx_http_casper_broker_ul_module_context_t* a_context,
+                                                      const ngx_http_casper_broker_ul_scan_t& a_scan)
+{
+    for ( const auto& line : *a_scan.log_ ) {
+        NGX_BROKER_MODULE_LOG(ngx_http_casper_broker_ul_module, a_r, NGX_LOG_DEBUG, "ul_module",
+                                "CH", "SCANNING",
+                                "%s", line.c_str()
+        );
+    }
+    // ... failed?
+    if ( 0 != a_scan.error_.length() ) {
+        ngx_http_casper_broker_ul_module_on_inspection_error(a_r, a_context, a_scan.error_);
+    } else if ( 200 != a_scan.status_code_ ) {
+        // ... provided data is NOT allowed ...
+        a_context->http_status_code_ = NGX_HTTP_FORBIDDEN;
+        // ... track error ...
+        if ( 0 != a_scan.rule_.id_.length() ) {
+            a_context->error_tracker_->Track("BROKER_FORBIDDEN_ERROR", NGX_HTTP_FORBIDDEN, "BROKER_FORBIDDEN_ERROR",
+                                             ( "DENIED due to security rule #" + a_scan.rule_.id_ + ": " + a_scan.rule_.msg_ + "!").c_str()
+            );
+        } else {
+            a_context->error_tracker_->Track("BROKER_FORBIDDEN_ERROR", NGX_HTTP_FORBIDDEN, "BROKER_FORBIDDEN_ERROR",
+                                             ( "DENIED due to " + a_scan.rule_.data_ ).c_str()
+            );
+        }
+    }
+    ngx_http_casper_broker_ul_module_finish(a_r, a_context);
+}
+
+/**
+ * @brief Track an inspection error, if validation is mandatory.
+ *
+ * @param a_r       The http request.
+ * @param a_context Module context.
+ * @param a_what    Error message.
+ */
+static void ngx_http_casper_broker_ul_module_on_inspection_error (ngx_http_request_t* a_r, ngx_http_casper_broker_ul_module_context_t* a_context,
+                                                                  const std::string& a_what)
+{
+    const ngx_http_casper_broker_ul_module_loc_conf_t* loc_conf = (const ngx_http_casper_broker_ul_module_loc_conf_t*) ngx_http_get_module_loc_conf(a_r, ngx_http_casper_broker_ul_module);
+    // ... if validation is madatory ...
+    if ( 1 == loc_conf->magic_validation ) {
+        // ... report error ...
+        const std::string msg = "Error while magically validating file '" + a_context->file_.uri_ + "': " + a_what;
+        a_context->http_status_code_ = NGX_HTTP_INTERNAL_SERVER_ERROR;
+        a_context->error_tracker_->Track("UL_AN_ERROR_OCCURRED_MESSAGE", NGX_HTTP_INTERNAL_SERVER_ERROR, "UL_AN_ERROR_OCCURRED_MESSAGE",
+                                         msg.c_str()
+        );
+    }
+}
+
+/**
+ * @brief Run an inspection step on a worker thread or, if there are no workers, on the calling thread.
+ *
+ * @param a_context Module context.
+ * @param a_work    Function to call on a worker thread, with a flag that is set when it should bail out.
+ * @param a_done    Function to call on main thread, after \p a_work.
+ * @param a_abandon Function to call on main thread, after \p a_work, instead of \p a_done if request is gone, may be nullptr.
+ */
+static void ngx_http_casper_broker_ul_module_schedule (ngx_http_casper_broker_ul_module_context_t* a_context,
+                                                       const ::ngx::casper::broker::ul::Inspector::Work& a_work, const std::function<void()>& a_done,
+                                                       const std::function<void()>& a_abandon)
+{
+    ::ngx::casper::broker::ul::Inspector& inspector = ::ngx::casper::broker::ul::Inspector::GetInstance();
+    // ... no workers?
+    if ( false == inspector.enabled() ) {
+        const std::atomic<bool> never { false };
+        a_work(never);
+        a_done();
+        return;
+    }
+    // ... request will be finalized when inspection is done ...
+    a_context->inspection_deferred_ = true;
+    a_context->inspection_abandon_  = a_abandon;
+    a_context->inspection_ticket_   = inspector.Submit(a_work, [a_context, a_done] () {
+        a_context->inspection_ticket_  = 0;
+        a_context->inspection_abandon_ = nullptr;
+        a_done();
+    });
+}
+
+/**
+ * @brief Called when inspection is done, write xattrs and response.
+ *
+ * @param a_r       The http request.
+ * @param a_context Module context.
+ */
+static void ngx_http_casper_broker_ul_module_finish (ngx_http_request_t* a_r, ngx_http_casper_broker_ul_module_context_t* a_context)
+{
+    const ngx_http_casper_broker_ul_module_loc_conf_t* loc_conf = (const ngx_http_casper_broker_ul_module_loc_conf_t*) ngx_http_get_module_loc_conf(a_r, ngx_http_casper_broker_ul_module);
+
+    const std::string& magic_type = a_context->magic_type_;
+    const std::string& magic_desc = a_context->magic_desc_;
+
+    // ... write xattrs ...
+    try {
+                        
+        // ... and write xattrs ...
+        ::cc::fs::file::XAttr xattrs(a_context->file_.uri_);
+        
+        // ... upload id is same as file name ...
+        std::string id;  ::cc::fs::File::Name(a_context->file_.uri_, id);
+
+        // ... set upload id ...
+        xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.id", id);
+
+        // ... http info ...
+        xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.protocol"   ,
+                   std::string(reinterpret_cast<char const*>(a_r->http_protocol.data), a_r->http_protocol.len)
+        );
+        xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.method"   ,
+                   std::string(reinterpret_cast<char const*>(a_r->method_name.data), a_r->method_name.len)
+        );
+        if ( nullptr != a_r->headers_in.user_agent && a_r->headers_in.user_agent->value.len > 0 ) {
+            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.user-agent"    ,
+                       std::string(reinterpret_cast<char const*>(a_r->headers_in.user_agent->value.data), a_r->headers_in.user_agent->value.len)
+           );
+        }
+
+        xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.ip",
+                   std::string(reinterpret_cast<char const*>(a_r->connection->addr_text.data), a_r->connection->addr_text.len)
+        );
+
+        for ( auto header : { "origin", "referer" } ) {
+            const auto it = a_context->in_headers_.find(header);
+            if ( a_context->in_headers_.end() == it ) {
+                continue;
             }
-            xattrs.Seal(XATTR_ARCHIVE_PREFIX "com.cldware.upload.seal"         ,
-                        reinterpret_cast<const unsigned char*>(NGX_CASPER_BROKER_UL_MODULE_INFO), strlen(NGX_CASPER_BROKER_UL_MODULE_INFO),
-                        /* a_excluding_attrs */ nullptr
+            xattrs.Set(std::string(XATTR_ARCHIVE_PREFIX "com.cldware.upload.") + header,
+                       it->second
             );
-            
-        } catch (const cc::Exception& a_cc_exception) {
-            ss.str("");
-            ss << "Error while writting xattrs '" << context->file_.uri_ << "': " << a_cc_exception.what();
-            msg = ss.str();
-            http_status_code = NGX_HTTP_INTERNAL_SERVER_ERROR;
-            context->error_tracker_->Track("UL_AN_ERROR_OCCURRED_MESSAGE", NGX_HTTP_INTERNAL_SERVER_ERROR, "UL_AN_ERROR_OCCURRED_MESSAGE",
-                                           msg.c_str()
+        }
+        
+        // ... magic type and desc ...
+        if ( magic_type.length() > 0 ) {
+            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.magic.type", magic_type);
+        }
+        if ( magic_desc.length() > 0 ) {
+            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.magic.description", magic_desc);
+        }
+        xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.magic.validation", ( 1 == loc_conf->magic_validation ? "yes" : "no" ));
+        
+        // ... module & timestamp info ...
+        xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.created.by", NGX_CASPER_BROKER_UL_MODULE_INFO);
+        xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.created.at", cc::UTCTime::NowISO8601WithTZ());
+        
+        // ... content info ...
+        xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.uri", "file://" + a_context->file_.uri_);
+        if ( nullptr != a_r->headers_in.content_type && a_r->headers_in.content_type->value.len > 0 ) {
+            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.content-type",
+                       std::string(reinterpret_cast<char const*>(a_r->headers_in.content_type->value.data), a_r->headers_in.content_type->value.len)
             );
         }
+        xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.content-length", std::to_string(a_context->file_.bytes_written_));
+        xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.md5"           , a_context->file_.md5_value_);
+        if ( 0 != a_context->file_.offset_ ) {
+            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.suspicious.type"        , magic_type);
+            xattrs.Set(XATTR_ARCHIVE_PREFIX "com.cldware.upload.suspicious.offsetted.by", std::to_string(a_context->file_.offset_));
+        }
+        xattrs.Seal(XATTR_ARCHIVE_PREFIX "com.cldware.upload.seal"         ,
+                    reinterpret_cast<const unsigned char*>(NGX_CASPER_BROKER_UL_MODULE_INFO), strlen(NGX_CASPER_BROKER_UL_MODULE_INFO),
+                    /* a_excluding_attrs */ nullptr
+        );
         
-        errors_set = ( context->error_tracker_->Count() > 0 );
+    } catch (const cc::Exception& a_cc_exception) {
+        const std::string msg = "Error while writting xattrs '" + a_context->file_.uri_ + "': " + a_cc_exception.what();
+        a_context->http_status_code_ = NGX_HTTP_INTERNAL_SERVER_ERROR;
+        a_context->error_tracker_->Track("UL_AN_ERROR_OCCURRED_MESSAGE", NGX_HTTP_INTERNAL_SERVER_ERROR, "UL_AN_ERROR_OCCURRED_MESSAGE",
+                                         msg.c_str()
+        );
     }
     
-bailout:
-        
-    errors_set = ( context->error_tracker_->Count() > 0 || bytes_read < 0 );
+    // ... multipart body, inspect next part?
+    if ( a_context->part_ < a_context->parts_.size() ) {
+        ngx_http_casper_broker_ul_part_t& part = a_context->parts_[a_context->part_];
+        // ... inspection might have moved it ( f'ed up PDF ) ...
+        part.uri_           = a_context->file_.uri_;
+        part.md5_value_     = a_context->file_.md5_value_;
+        part.offset_        = a_context->file_.offset_;
+        part.bytes_written_ = a_context->file_.bytes_written_;
+        if ( NGX_HTTP_OK == a_context->http_status_code_ && 0 == a_context->error_tracker_->Count() && a_context->part_ + 1 < a_context->parts_.size() ) {
+            ngx_http_casper_broker_ul_module_load_part(a_context, a_context->part_ + 1);
+            ngx_http_casper_broker_ul_module_inspect(a_r, a_context);
+            return;
+        }
+    }
+    
+    ngx_http_casper_broker_ul_module_respond(a_r, a_context, a_context->http_status_code_, ( a_context->error_tracker_->Count() > 0 ));
+}
 
-    if ( true == errors_set && 0 == context->multipart_body_.enabled_ && NULL != chain && 1 == chain->buf->in_file && chain->buf->file->name.len > 0 ) {
+/**
+ * @brief Load a multipart body part into module context file, so it can be inspected.
+ *
+ * @param a_context Module context.
+ * @param a_index   Part index.
+ */
+static void ngx_http_casper_broker_ul_module_load_part (ngx_http_casper_broker_ul_module_context_t* a_context, const size_t a_index)
+{
+    const ngx_http_casper_broker_ul_part_t& part = a_context->parts_[a_index];
+    
+    a_context->part_                = a_index;
+    a_context->file_.name_          = part.name_;
+    a_context->file_.uri_           = part.uri_;
+    a_context->file_.md5_value_     = part.md5_value_;
+    a_context->file_.offset_        = part.offset_;
+    a_context->file_.bytes_written_ = part.bytes_written_;
+    a_context->content_length_      = part.bytes_written_;
+    a_context->magic_type_.clear();
+    a_context->magic_desc_.clear();
+}
+
+/**
+ * @brief Write module response.
+ *
+ * @param a_r                The http request.
+ * @param a_context          Module context.
+ * @param a_http_status_code HTTP status code.
+ * @param a_errors_set       True if errors were tracked.
+ */
+static void ngx_http_casper_broker_ul_module_respond (ngx_http_request_t* a_r, ngx_http_casper_broker_ul_module_context_t* a_context,
+                                                      const ngx_uint_t a_http_status_code, const bool a_errors_set)
+{
+    ngx_chain_t* chain = ( NULL != a_r->request_body ? a_r->request_body->bufs : NULL );
+    
+    if ( true == a_errors_set && 0 == a_context->multipart_body_.enabled_ && NULL != chain && 1 == chain->buf->in_file && chain->buf->file->name.len > 0 ) {
         try {
             const std::string tmp_file = std::string(reinterpret_cast<const char*>(chain->buf->file->name.data), chain->buf->file->name.len);
             if ( true == ::cc::fs::File::Exists(tmp_file) ) {
@@ -1566,70 +2090,251 @@ bailout:
         }
     }
     
-    if ( true == wtf_bailout ) {
+    try {
+
+        Json::FastWriter json_writer;
+
+        const char* content_type;
+        std::string content_value;
         
-        NGX_BROKER_MODULE_ERROR_LOG(ngx_http_casper_broker_ul_module, a_r, "ul_module",
+        if ( true == a_errors_set ) {
+            
+            content_type  = a_context->error_tracker_->content_type_.c_str();
+            content_value = json_writer.write(a_context->error_tracker_->Serialize2JSON());
+            
+        } else { /* true == clean_exit */
+
+            Json::Value response = Json::Value(Json::ValueType::objectValue);
+            
+            const std::string& directory = a_context->file_.directory_;
+            if ( a_context->parts_.size() > 0 ) {
+                // ... multipart body, first part is also reported as 'file' ...
+                response["file"]  = a_context->parts_[0].uri_.substr(directory.length());
+                response["files"] = Json::Value(Json::ValueType::arrayValue);
+                for ( const auto& part : a_context->parts_ ) {
+                    response["files"].append(part.uri_.substr(directory.length()));
+                }
+            } else {
+                response["file"] = std::string(a_context->file_.uri_.c_str(),  directory.length(), a_context->file_.uri_.length() - directory.length());
+            }
+
+            content_type  = "application/json";
+            content_value = json_writer.write(response);
+
+        }
+
+        NGX_BROKER_MODULE_DEBUG_LOG(ngx_http_casper_broker_ul_module, a_r, "ul_module",
                                     "RB", "LEAVING",
-                                    "%s", "WTF bailout!"
+                                    "%s", "done"
+        );
+
+        ngx::casper::broker::Module::WriteResponse(ngx_http_casper_broker_ul_module, a_r,
+                                                   /* a_headers      */ nullptr,
+                                                   /* a_status_code  */ a_http_status_code,
+                                                   /* a_content_type */ content_type,
+                                                   /* a_data         */ content_value.c_str(),
+                                                   /* a_length       */ content_value.length(),
+                                                   /* a_binary       */ false,
+                                                   /* a_finalize     */ ( true == a_context->read_callback_again_ || true == a_context->inspection_deferred_ ),
+                                                   /* a_log_token    */ "ul_module",
+                                                   /* a_plain_module */ true
+        );
+
+    } catch (const Json::Exception& a_json_exception) {
+
+        NGX_BROKER_MODULE_DEBUG_LOG(ngx_http_casper_broker_ul_module, a_r, "ul_module",
+                                    "RB", "LEAVING",
+                                    "%s", a_json_exception.what()
         );
         
         a_r->connection->read->eof = 1;
         ngx_http_finalize_request(a_r, NGX_HTTP_INTERNAL_SERVER_ERROR);
         
-    } else if ( true == clean_exit || true == errors_set )
-    
-        try {
-
-            Json::FastWriter json_writer;
+    }
+}
 
-            const char* content_type;
-            std::string content_value;
-            
-            if ( true == errors_set ) {
-                
-                content_type  = context->error_tracker_->content_type_.c_str();
-                content_value = json_writer.write(context->error_tracker_->Serialize2JSON());
-                
-            } else { /* true == clean_exit */
+#ifdef __APPLE__
+#pragma mark - Inspection - Worker Thread
+#endif
 
-                Json::Value response = Json::Value(Json::ValueType::objectValue);
-                
-                response["file"] = std::string(context->file_.uri_.c_str(),  context->file_.directory_.length(), context->file_.uri_.length() - context->file_.directory_.length());
+/**
+ * @return This thread magic database, loaded once.
+ */
+static ::cc::magic::MIMEType& ngx_http_casper_broker_ul_magic ()
+{
+    thread_local ::cc::magic::MIMEType magic;
+    thread_local bool                  loaded = false;
+    if ( false == loaded ) {
+        magic.Initialize(std::string(NGX_SHARED_DIR));
+        loaded = true;
+    }
+    return magic;
+}
 
-                content_type  = "application/json";
-                content_value = json_writer.write(response);
+/**
+ * @return This thread libmagic cookie, for in memory tests, loaded once.
+ *
+ * @remarks \link ::cc::magic::MIMEType \link only tests files, this cookie loads the same shared database ( if present ).
+ */
+static magic_t ngx_http_casper_broker_ul_magic_cookie ()
+{
+    thread_local std::unique_ptr<struct magic_set, decltype(&magic_close)> cookie(nullptr, &magic_close);
+    if ( nullptr == cookie ) {
+        cookie.reset(magic_open(MAGIC_NONE));
+        if ( nullptr == cookie ) {
+            throw ::cc::Exception("Unable to open magic cookie: %s!", strerror(errno));
+        }
+        // ... shared database or, if not installed, libmagic default one ...
+        std::string database = std::string(NGX_SHARED_DIR);
+        if ( 0 == database.length() || '/' != database[database.length() - 1] ) {
+            database += '/';
+        }
+        database += "magic.mgc";
+        if ( 0 != magic_load(cookie.get(), ( 0 == access(database.c_str(), R_OK) ? database.c_str() : nullptr )) ) {
+            const std::string reason = ( nullptr != magic_error(cookie.get()) ? magic_error(cookie.get()) : "?" );
+            cookie.reset();
+            throw ::cc::Exception("Unable to load magic database: %s!", reason.c_str());
+        }
+    }
+    return cookie.get();
+}
 
+/**
+ * @brief Fetch magic type and description of an uploaded file.
+ *
+ * @param a_magic Input and output data.
+ * @param a_abort Set when workers are shutting down, checked between steps.
+ *
+ * @remarks Runs on a worker thread, it must not touch nginx or request data.
+ */
+static void ngx_http_casper_broker_ul_magic_fetch (ngx_http_casper_broker_ul_magic_t& a_magic, const std::atomic<bool>& a_abort)
+{
+    try {
+        ::cc::magic::MIMEType& magic = ngx_http_casper_broker_ul_magic();
+        const int   flags  [2] = { MAGIC_MIME_TYPE, MAGIC_NONE };
+        std::string values [2];
+        size_t      offsets[2] = { 0, 0 };
+        for ( size_t idx = 0 ; idx < 2 ; ++idx ) {
+            // ... shutting down?
+            if ( true == a_abort.load() ) {
+                throw ::cc::Exception("Magic fetch of '%s' interrupted!", a_magic.uri_.c_str());
             }
+            // ... reset ...
+            magic.Reset(flags[idx]);
+            // ... test ...
+            values[idx] = magic.WithoutCharsetOf(a_magic.uri_, offsets[idx]);
+            // ... f'ed up PDF?
+            if ( 0 != offsets[0] ) {
+                if ( true == a_abort.load() ) {
+                    throw ::cc::Exception("Magic fetch of '%s' interrupted!", a_magic.uri_.c_str());
+                }
+                std::string tmp;
+                // ... new temporary file, at same directory ...
+                ngx_http_casper_broker_ul_unique_uri(a_magic.uri_.substr(0, a_magic.uri_.rfind('/') + 1), a_magic.name_, tmp);
+                // ... copy file ( from offset ) and calculate new MD5 value ...
+                ::cc::fs::File::Copy(a_magic.uri_, tmp, /* a_overwrite */ true, offsets[idx], a_magic.md5_value_);
+                // ... adjust other info ...
+                a_magic.offset_   = offsets[idx];
+                a_magic.skipped_ += offsets[idx];
+                a_magic.uri_      = tmp;
+                // ... again ...
+                values[idx] = magic.WithoutCharsetOf(a_magic.uri_, offsets[0]);
+            }
+        }
+        a_magic.type_ = values[0]; // MAGIC_MIME_TYPE
+        a_magic.desc_ = values[1]; // MAGIC_NONE
+    } catch (const cc::Exception& a_cc_exception) {
+        a_magic.error_ = a_cc_exception.what();
+    }
+    // ... interrupted? nothing will be delivered, forget copy made by a f'ed up PDF fetch ...
+    if ( true == a_abort.load() && 0 != a_magic.skipped_ ) {
+        unlink(a_magic.uri_.c_str());
+    }
+}
 
-            NGX_BROKER_MODULE_DEBUG_LOG(ngx_http_casper_broker_ul_module, a_r, "ul_module",
-                                        "RB", "LEAVING",
-                                        "%s", "done"
-            );
-
-            ngx::casper::broker::Module::WriteResponse(ngx_http_casper_broker_ul_module, a_r,
-                                                       /* a_headers      */ nullptr,
-                                                       /* a_status_code  */ http_status_code,
-                                                       /* a_content_type */ content_type,
-                                                       /* a_data         */ content_value.c_str(),
-                                                       /* a_length       */ content_value.length(),
-                                                       /* a_binary       */ false,
-                                                       /* a_finalize     */ ( true == context->read_callback_again_ ),
-                                                       /* a_log_token    */ "ul_module",
-                                                       /* a_plain_module */ true
-            );
-
-        } catch (const Json::Exception& a_json_exception) {
-
-            NGX_BROKER_MODULE_DEBUG_LOG(ngx_http_casper_broker_ul_module, a_r, "ul_module",
-                                        "RB", "LEAVING",
-                                        "%s", a_json_exception.what()
-            );
-            
-            a_r->connection->read->eof = 1;
-            ngx_http_finalize_request(a_r, NGX_HTTP_INTERNAL_SERVER_ERROR);
-            
+/**
+ * @brief Run libmodsecurity rules against an uploaded file.
+ *
+ * @param a_scan  Input and output data.
+ * @param a_abort Set when workers are shutting down, checked between steps.
+ *
+ * @remarks Runs on a worker thread, it must not touch nginx or request data.
+ * @remarks libmodsecurity validation itself can't be interrupted.
+ */
+static void ngx_http_casper_broker_ul_scan (ngx_http_casper_broker_ul_scan_t& a_scan, const std::atomic<bool>& a_abort)
+{
+    std::string window_uri;
+    try {
+        // ... scan only leading and / or trailing bytes?
+        struct stat stat_data;
+        if ( ( a_scan.head_ > 0 || a_scan.tail_ > 0 ) && 0 == stat(a_scan.request_.body_file_uri_.c_str(), &stat_data)
+                && static_cast<size_t>(stat_data.st_size) > ( a_scan.head_ + a_scan.tail_ ) ) {
+            ngx_http_casper_broker_ul_scan_window(a_scan.request_.body_file_uri_, static_cast<size_t>(stat_data.st_size), a_scan.head_, a_scan.tail_, a_abort,
+                                                  window_uri);
+            a_scan.request_.body_file_uri_  = window_uri;
+            a_scan.request_.content_length_ = a_scan.head_ + a_scan.tail_;
+        }
+        // ... shutting down?
+        if ( true == a_abort.load() ) {
+            throw ::cc::Exception("Scan of '%s' interrupted!", a_scan.request_.body_file_uri_.c_str());
         }
+        // ... scan ...
+        a_scan.status_code_ = ::cc::modsecurity::Processor::GetInstance().Validate(a_scan.request_, a_scan.rule_);
+    } catch (const cc::Exception& a_cc_exception) {
+        a_scan.error_ = a_cc_exception.what();
+    }
+    // ... forget window copy ...
+    if ( 0 != window_uri.length() ) {
+        unlink(window_uri.c_str());
+    }
+}
 
+/**
+ * @brief Copy leading and trailing bytes of a file to a new file.
+ *
+ * @param a_uri   Source file URI.
+ * @param a_size  Source file size, in bytes.
+ * @param a_head  Number of leading bytes to copy.
+ * @param a_tail  Number of trailing bytes to copy.
+ * @param a_abort When set, copy is interrupted as soon as it's true.
+ * @param o_uri   New file URI.
+ */
+static void ngx_http_casper_broker_ul_scan_window (const std::string& a_uri, const size_t a_size, const size_t a_head, const size_t a_tail, const std::atomic<bool>& a_abort,
+                                                   std::string& o_uri)
+{
+    std::vector<u_char> buffer(a_head + a_tail);
+    
+    const int fd = open(a_uri.c_str(), O_RDONLY);
+    if ( -1 == fd ) {
+        throw ::cc::Exception("Unable to open '%s': %s!", a_uri.c_str(), strerror(errno));
+    }
+    size_t done = 0;
+    while ( done < buffer.size() ) {
+        if ( true == a_abort.load() ) {
+            close(fd);
+            throw ::cc::Exception("Copy of '%s' scan window interrupted!", a_uri.c_str());
+        }
+        const size_t  offset = ( done < a_head ? done          : a_size - a_tail + ( done - a_head ) );
+        const size_t  length = ( done < a_head ? a_head - done : buffer.size() - done );
+        const ssize_t rv     = pread(fd, buffer.data() + done, length, static_cast<off_t>(offset));
+        if ( rv <= 0 ) {
+            if ( -1 == rv && EINTR == errno ) {
+                continue;
+            }
+            const int error_number = errno;
+            close(fd);
+            throw ::cc::Exception("Unable to read from '%s': %s!", a_uri.c_str(), ( 0 == rv ? "unexpected end of file" : strerror(error_number) ));
+        }
+        done += static_cast<size_t>(rv);
+    }
+    close(fd);
+    
+    o_uri = a_uri + ".scan";
+    
+    cc::fs::file::Writer writer;
+    writer.Open(o_uri, cc::fs::file::Writer::Mode::Write);
+    writer.Write(buffer.data(), buffer.size(), /* a_flush */ true);
+    writer.Close();
 }
 
 #ifdef __APPLE__
@@ -1658,6 +2363,10 @@ static void ngx_http_casper_broker_ul_module_cleanup_handler (void* a_data)
                                     "%s", ""
         );
 
+        if ( 0 != context->inspection_ticket_ ) {
+            ::ngx::casper::broker::ul::Inspector::GetInstance().Cancel(context->inspection_ticket_, context->inspection_abandon_);
+        }
+        
         if ( nullptr != context->file_.writer_ ) {
             delete context->file_.writer_;
         }
@@ -1666,10 +2375,17 @@ static void ngx_http_casper_broker_ul_module_cleanup_handler (void* a_data)
             delete context->error_tracker_;
         }
         
-        if ( 0 == context->multipart_body_.enabled_ ) {
-            ngx_chain_t* chain = request->request_body->bufs;
-            if ( NULL != chain && 1 == chain->buf->in_file && chain->buf->file->name.len > 0 ) {
-                const std::string tmp_file = std::string(reinterpret_cast<const char*>(chain->buf->file->name.data), chain->buf->file->name.len);
+        if ( 0 == context->multipart_body_.enabled_ && NULL != request->request_body ) {
+            // ... body rejected while being read ( partially written ) or not moved to final destination?
+            const ngx_temp_file_t* temp_file = request->request_body->temp_file;
+            ngx_chain_t*           chain     = request->request_body->bufs;
+            std::string            tmp_file;
+            if ( NULL != temp_file && temp_file->file.name.len > 0 ) {
+                tmp_file = std::string(reinterpret_cast<const char*>(temp_file->file.name.data), temp_file->file.name.len);
+            } else if ( NULL != chain && 1 == chain->buf->in_file && chain->buf->file->name.len > 0 ) {
+                tmp_file = std::string(reinterpret_cast<const char*>(chain->buf->file->name.data), chain->buf->file->name.len);
+            }
+            if ( 0 != tmp_file.length() ) {
                 try {
                     NGX_BROKER_MODULE_DEBUG_LOG(ngx_http_casper_broker_ul_module, request, "ul_module",
                                                 "FH", "DELETE",
@@ -1778,19 +2494,7 @@ static ngx_uint_t ngx_http_casper_broker_ul_ensure_output (ngx_http_casper_broke
     // ... ensure a unique file ...
     try {
         
-        std::string name;
-        std::string extension;
-        
-        const char* ext_ptr = strrchr(a_context->file_.name_.c_str(), '.');
-        if ( nullptr != ext_ptr ) {
-            name      = std::string(a_context->file_.name_.c_str(), static_cast<size_t>(ext_ptr - a_context->file_.name_.c_str()));
-            extension = std::string(ext_ptr + 1);
-        } else {
-            name      = a_context->file_.name_;
-            extension = "ul";
-        }
-        
-        cc::fs::File::Unique(tmp_uri, name, extension, tmp_uri);
+        ngx_http_casper_broker_ul_unique_uri(tmp_uri, a_context->file_.name_, tmp_uri);
         
     } catch (const cc::Exception& a_cc_exception) {
         ss << "Unable to create a unique file name: " << a_cc_exception.what() << "!";
@@ -1807,6 +2511,121 @@ static ngx_uint_t ngx_http_casper_broker_ul_ensure_output (ngx_http_casper_broke
     return NGX_HTTP_OK;
 }
 
+/**
+ * @brief Pick a unique file URI.
+ *
+ * @param a_directory Directory, '/' terminated.
+ * @param a_file_name Original file name.
+ * @param o_uri       Unique file URI.
+ */
+static void ngx_http_casper_broker_ul_unique_uri (const std::string& a_directory, const std::string& a_file_name, std::string& o_uri)
+{
+    std::string name;
+    std::string extension;
+    
+    const char* ext_ptr = strrchr(a_file_name.c_str(), '.');
+    if ( nullptr != ext_ptr ) {
+        name      = std::string(a_file_name.c_str(), static_cast<size_t>(ext_ptr - a_file_name.c_str()));
+        extension = std::string(ext_ptr + 1);
+    } else {
+        name      = a_file_name;
+        extension = "ul";
+    }
+    
+    cc::fs::File::Unique(a_directory, name, extension, o_uri);
+}
+
+/**
+ * @brief Check if a magic value matches one of the configured values.
+ *
+ * @param a_array Configured values, can be nullptr.
+ * @param a_value Magic value.
+ *
+ * @return True if a configured value is a case insensitive prefix of \p a_value.
+ */
+static bool ngx_http_casper_broker_ul_magic_matches (const ngx_array_t* a_array, const std::string& a_value)
+{
+    if ( nullptr == a_array ) {
+        return false;
+    }
+    const ngx_str_t* array = ((ngx_str_t*) a_array->elts);
+    for ( ngx_uint_t idx = 0; idx < a_array->nelts; idx++ ) {
+        const ngx_str_t value = array[idx];
+        if ( 0 == value.len ) {
+            continue;
+        }
+        if ( 0 == strncasecmp((const char*)(value.data), a_value.c_str(), std::min(value.len, a_value.length())) ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Open output file and prepare it's write block.
+ *
+ * @param a_context
+ * @param a_length  Expected number of bytes to write, 0 if unknown.
+ */
+static void ngx_http_casper_broker_ul_open_output (ngx_http_casper_broker_ul_module_context_t* a_context, const size_t a_length)
+{
+    a_context->file_.writer_ = new cc::fs::file::Writer();
+    a_context->file_.writer_->Open(a_context->file_.uri_, cc::fs::file::Writer::Mode::Write);
+    
+    // ... small uploads don't need a full block ...
+    a_context->file_.block_.resize(( a_length > 0 && a_length < NGX_HTTP_CASPER_BROKER_UL_MODULE_WRITE_BLOCK_SIZE ) ? a_length : NGX_HTTP_CASPER_BROKER_UL_MODULE_WRITE_BLOCK_SIZE);
+    a_context->file_.block_length_ = 0;
+    
+#ifdef __linux__
+    // ... best effort, reserve disk space for the whole upload so it's written contiguously ...
+    if ( a_length > 0 ) {
+        const int fd = open(a_context->file_.uri_.c_str(), O_WRONLY);
+        if ( -1 != fd ) {
+            (void)fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(a_length));
+            close(fd);
+        }
+    }
+#endif
+}
+
+/**
+ * @brief Append data to output file, writes are coalesced in blocks.
+ *
+ * @param a_context
+ * @param a_data    Data to write.
+ * @param a_length  Number of bytes to write.
+ */
+static void ngx_http_casper_broker_ul_write_output (ngx_http_casper_broker_ul_module_context_t* a_context, const u_char* a_data, const size_t a_length)
+{
+    std::vector<u_char>& block = a_context->file_.block_;
+    // ... no room left in block?
+    if ( a_context->file_.block_length_ + a_length > block.size() ) {
+        ngx_http_casper_broker_ul_flush_output(a_context);
+    }
+    if ( a_length >= block.size() ) {
+        // ... larger than a block, write it as is ...
+        a_context->file_.writer_->Write(a_data, a_length, /* a_flush */ false);
+    } else {
+        memcpy(block.data() + a_context->file_.block_length_, a_data, a_length);
+        a_context->file_.block_length_ += a_length;
+    }
+    a_context->file_.bytes_written_ += a_length;
+}
+
+/**
+ * @brief Write pending block data to output file.
+ *
+ * @param a_context
+ */
+static void ngx_http_casper_broker_ul_flush_output (ngx_http_casper_broker_ul_module_context_t* a_context)
+{
+    if ( a_context->file_.block_length_ > 0 ) {
+        const size_t length = a_context->file_.block_length_;
+        a_context->file_.block_length_ = 0;
+        a_context->file_.writer_->Write(a_context->file_.block_.data(), length, /* a_flush */ false);
+    }
+}
+
 /**
  * @brief Translate a sockaddr to a human readable string.
  *
@@ -32,7 +32,9 @@ extern "C" {
 
 #include "json/json.h"
 
+#include <functional>
 #include <string>
+#include <vector>
 #include "ngx/ngx_utils.h"
 
 #include "cc/fs/file.h"
@@ -40,6 +42,17 @@ extern "C" {
 
 #include "ngx/casper/broker/ul/errors.h"
 
+#ifdef __APPLE__
+#pragma mark - module main_conf_t
+#endif
+
+/**
+ * @brief Module configuration structure, applicable to the http block ( shared by all locations of a worker ).
+ */
+typedef struct {
+    ngx_uint_t                inspection_threads;    //!< number of inspection worker threads, 0 - inspect on main thread
+} ngx_http_casper_broker_ul_module_main_conf_t;
+
 #ifdef __APPLE__
 #pragma mark - module loc_conf_t
 #endif
@@ -66,6 +79,10 @@ typedef struct {
     ngx_array_t*              scan_magic_desc;       //!<
     ngx_str_t                 scan_conf_dir;         //!<
     ngx_str_t                 scan_conf_file;        //!<
+    size_t                    scan_head;             //!< number of leading bytes to scan, 0 - scan whole file
+    size_t                    scan_tail;             //!< number of trailing bytes to scan, 0 - scan whole file
+    size_t                    sniff_size;            //!< number of leading body bytes to validate while receiving it, 0 - disabled
+    ngx_array_t*              sniff_defer_types;     //!< MIME types that need the whole file to be validated
 } ngx_http_casper_broker_ul_module_loc_conf_t;
 
 typedef struct {
@@ -76,10 +93,23 @@ typedef struct {
     std::string           md5_value_;
     size_t                offset_;
     cc::fs::file::Writer* writer_;
+    std::vector<u_char>   block_;
+    size_t                block_length_;
     size_t                bytes_written_;
     int64_t               expires_in_;
 } ngx_http_casper_broker_ul_file_t;
 
+/**
+ * @brief A multipart body part that was already written to it's own file.
+ */
+typedef struct {
+    std::string           name_;
+    std::string           uri_;
+    std::string           md5_value_;
+    size_t                offset_;
+    size_t                bytes_written_;
+} ngx_http_casper_broker_ul_part_t;
+
 typedef struct {
     ngx::utls::HeadersMap               in_headers_;
     std::string                         content_type_;
@@ -88,9 +118,20 @@ typedef struct {
     ngx::utls::nrs_ngx_multipart_body_t multipart_body_;
     std::string                         field_name_;
     ngx_http_casper_broker_ul_file_t    file_;
+    std::vector<ngx_http_casper_broker_ul_part_t> parts_;      //!< multipart body parts, in body order, each one is inspected in turn by file_
+    size_t                              part_;                 //!< index of the part loaded in file_, parts_.size() if none
     ngx::casper::broker::ul::Errors*    error_tracker_;
     bool                                read_callback_again_;
     unsigned int                        read_callback_count_;
+    ngx_uint_t                          http_status_code_;
+    std::string                         magic_type_;
+    std::string                         magic_desc_;
+    uint64_t                            inspection_ticket_;
+    std::function<void()>               inspection_abandon_;
+    bool                                inspection_deferred_;
+    std::vector<u_char>                 sniff_;
+    bool                                sniffed_;
+    bool                                sniff_rejected_;       //!< true when leading bytes were rejected, remaining body is drained and a 403 follows
 } ngx_http_casper_broker_ul_module_context_t;
 
 extern ngx_module_t ngx_http_casper_broker_ul_module;
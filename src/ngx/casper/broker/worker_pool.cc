@@ -0,0 +1,187 @@
+/**
+ * @file worker_pool.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ngx/casper/broker/worker_pool.h"
+
+#include "ev/ngx/bridge.h"
+
+#include "cc/exception.h"
+
+/**
+ * @brief Default constructor.
+ */
+ngx::casper::broker::WorkerPool::WorkerPool ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor.
+ */
+ngx::casper::broker::WorkerPool::~WorkerPool ()
+{
+    // ... joinable threads can't be destroyed ...
+    Shutdown();
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief One-shot setup.
+ *
+ * @param a_threads Number of worker threads to start, 0 disables this pool.
+ */
+void ngx::casper::broker::WorkerPool::Startup (const size_t a_threads)
+{
+    stop_ = false;
+    for ( size_t idx = 0 ; idx < a_threads ; ++idx ) {
+        threads_.emplace_back(&ngx::casper::broker::WorkerPool::Loop, this);
+    }
+}
+
+/**
+ * @brief Stop all worker threads and forget pending jobs.
+ *
+ * @remarks Running work sees it's abort flag set, there's no need to wait for it to be fully done.
+ * @remarks Must be called before \link ::ev::ngx::Bridge \link shutdown.
+ */
+void ngx::casper::broker::WorkerPool::Shutdown ()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        queue_.clear();
+    }
+    cv_.notify_all();
+    for ( auto& thread : threads_ ) {
+        thread.join();
+    }
+    threads_.clear();
+    pending_.clear();
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Schedule work in a worker thread.
+ *
+ * @param a_work Function to call on a worker thread, it must not touch nginx or request data.
+ * @param a_done Function to call, on main thread, when \p a_work returns.
+ *
+ * @return Ticket to be used to cancel this job.
+ */
+uint64_t ngx::casper::broker::WorkerPool::Submit (const ngx::casper::broker::WorkerPool::Work& a_work,
+                                                  const ngx::casper::broker::WorkerPool::Done& a_done)
+{
+    if ( false == enabled() ) {
+        throw ::cc::Exception("%s can't be called when no worker threads are running!", __FUNCTION__);
+    }
+    const uint64_t ticket = ++next_ticket_;
+    pending_[ticket] = a_done;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back({ ticket, a_work });
+    }
+    cv_.notify_one();
+    return ticket;
+}
+
+/**
+ * @brief Cancel a previously submitted job, it's completion function won't be called.
+ *
+ * @param a_ticket  Ticket returned by \link Submit \link.
+ * @param a_abandon Optional function to call, on main thread, instead of the completion function when work is done
+ *                  ( to release resources created by it ).
+ */
+void ngx::casper::broker::WorkerPool::Cancel (const uint64_t a_ticket, const ngx::casper::broker::WorkerPool::Done& a_abandon)
+{
+    const auto it = pending_.find(a_ticket);
+    if ( pending_.end() == it ) {
+        return;
+    }
+    if ( nullptr != a_abandon ) {
+        it->second = a_abandon;
+    } else {
+        pending_.erase(it);
+    }
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Worker thread loop.
+ */
+void ngx::casper::broker::WorkerPool::Loop ()
+{
+    while ( true ) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] () {
+                return ( true == stop_ || queue_.size() > 0 );
+            });
+            if ( true == stop_ ) {
+                break;
+            }
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        // ... work functions report their own errors, nothing should escape ...
+        try {
+            job.work_(stop_);
+        } catch (...) {
+            /* ignored */
+        }
+        // ... interrupted by shutdown? nothing to deliver ...
+        if ( true == stop_ ) {
+            break;
+        }
+        // ... deliver completion on main thread ...
+        const uint64_t ticket = job.ticket_;
+        ::ev::ngx::Bridge::GetInstance().CallOnMainThread([this, ticket] () {
+            OnCompleted(ticket);
+        });
+    }
+}
+
+/**
+ * @brief Called on main thread when a job is done.
+ *
+ * @param a_ticket Job ticket.
+ */
+void ngx::casper::broker::WorkerPool::OnCompleted (const uint64_t a_ticket)
+{
+    // ... cancelled?
+    const auto it = pending_.find(a_ticket);
+    if ( pending_.end() == it ) {
+        return;
+    }
+    const Done done = it->second;
+    pending_.erase(it);
+    // ... notify ...
+    done();
+}
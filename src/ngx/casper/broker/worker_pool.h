@@ -0,0 +1,120 @@
+/**
+ * @file worker_pool.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_NGX_CASPER_BROKER_WORKER_POOL_H_
+#define NRS_NGX_CASPER_BROKER_WORKER_POOL_H_
+
+#include <stdint.h> // uint64_t
+
+#include <atomic>             // std::atomic
+#include <condition_variable> // std::condition_variable
+#include <deque>              // std::deque
+#include <functional>         // std::function
+#include <mutex>              // std::mutex
+#include <thread>             // std::thread
+#include <unordered_map>      // std::unordered_map
+#include <vector>             // std::vector
+
+namespace ngx
+{
+
+    namespace casper
+    {
+
+        namespace broker
+        {
+
+            /**
+             * @brief A small pool of worker threads, for blocking work that must stay out of the event loop,
+             *        with completion delivered back to the main thread through \link ::ev::ngx::Bridge \link.
+             *
+             *        Work functions receive an abort flag, set by \link Shutdown \link, and should poll it between blocking steps.
+             */
+            class WorkerPool final
+            {
+
+            public: // Data Type(s)
+
+                typedef std::function<void(const std::atomic<bool>& a_abort)> Work;
+                typedef std::function<void()>                                 Done;
+
+            private: // Data Type(s)
+
+                typedef struct {
+                    uint64_t ticket_;
+                    Work     work_;
+                } Job;
+
+            private: // Data - shared with workers
+
+                std::mutex                         mutex_;
+                std::condition_variable            cv_;
+                std::deque<Job>                    queue_;
+                std::atomic<bool>                  stop_ { false }; //!< Also interrupts running work.
+
+            private: // Data - main thread only
+
+                std::vector<std::thread>           threads_;
+                std::unordered_map<uint64_t, Done> pending_;
+                uint64_t                           next_ticket_ = 0;
+
+            public: // Constructor(s) / Destructor
+
+                WorkerPool ();
+                virtual ~WorkerPool ();
+
+            public: // One-shot Call Method(s) / Function(s)
+
+                void Startup  (const size_t a_threads);
+                void Shutdown ();
+
+            public: // Method(s) / Function(s)
+
+                uint64_t Submit (const Work& a_work, const Done& a_done);
+                void     Cancel (const uint64_t a_ticket, const Done& a_abandon = nullptr);
+
+            public: // Inline Method(s) / Function(s)
+
+                bool enabled () const;
+
+            private: // Method(s) / Function(s)
+
+                void Loop        ();
+                void OnCompleted (const uint64_t a_ticket);
+
+            }; // end of class 'WorkerPool'
+
+            /**
+             * @return True when worker threads are running, false otherwise.
+             */
+            inline bool WorkerPool::enabled () const
+            {
+                return ( threads_.size() > 0 );
+            }
+
+        } // end of namespace 'broker'
+
+    } // end of namespace 'casper'
+
+} // end of namespace 'ngx'
+
+#endif // NRS_NGX_CASPER_BROKER_WORKER_POOL_H_
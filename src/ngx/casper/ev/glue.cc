@@ -38,6 +38,10 @@
 #include "ev/ngx/bridge.h"
 
 #include "ngx/casper/broker/module.h"
+#include "ngx/casper/broker/ext/session_cache.h"
+#include "ngx/casper/broker/ext/job_channels.h"
+#include "ngx/casper/broker/cdn-common/hasher.h"
+#include "ngx/casper/broker/ul/inspector.h"
 
 #include "ev/redis/subscriptions/manager.h"
 
@@ -231,6 +235,14 @@ void ngx::casper::ev::Glue::Startup (const ::ev::Loggable::Data& a_loggable_data
 void ngx::casper::ev::Glue::Shutdown (int a_sig_no)
 {
     OSALITE_DEBUG_TRACE("ev_glue", "~> Shutdown()");
+    // ... forget cached sessions, they depend on 'redis' subscriptions ...
+    ngx::casper::broker::ext::SessionCache::GetInstance().Shutdown();
+    // ... forget jobs listeners and their shared pattern subscriptions ...
+    ngx::casper::broker::ext::JobChannels::GetInstance().Shutdown();
+    // ... stop digest workers, they post results through 'bridge' ...
+    ngx::casper::broker::cdn::Hasher::GetInstance().Shutdown();
+    // ... stop upload inspection workers, for the same reason ...
+    ngx::casper::broker::ul::Inspector::GetInstance().Shutdown();
     // ... first shutdown 'redis' subscriptions ...
     ::ev::redis::subscriptions::Manager::GetInstance().Shutdown();
     // ... then shutdown 'scheduler' ...
@@ -537,92 +537,241 @@ ngx_int_t ngx::utls::nrs_ngx_parse_multipart_content_type (const std::string& a_
     }
     boundary_start += strlen("boundary=");
     
-    o_info.offset = strlen(boundary_start);
+    // ... boundary value, optionally quoted, ends at ';' or at the end of the header ...
+    const char* boundary_end = boundary_start;
+    if ( '"' == boundary_start[0] ) {
+        boundary_start++;
+        boundary_end = strchr(boundary_start, '"');
+        if ( nullptr == boundary_end ) {
+            return NGX_ERROR;
+        }
+    } else {
+        while ( '\0' != boundary_end[0] && ';' != boundary_end[0] && ' ' != boundary_end[0] && '\t' != boundary_end[0] ) {
+            boundary_end++;
+        }
+    }
+    
+    // ... RFC 2046 - 1 to 70 characters ...
+    const size_t boundary_length = static_cast<size_t>(boundary_end - boundary_start);
+    if ( 0 == boundary_length || boundary_length > 70 ) {
+        return NGX_ERROR;
+    }
+    
+    // ... o_info.boundary points to a_content_type data ...
+    o_info.offset        = static_cast<size_t>(boundary_start - a_content_type.c_str());
+    o_info.boundary.data = reinterpret_cast<u_char*>(const_cast<char*>(boundary_start));
+    o_info.boundary.len  = boundary_length;
     
     return NGX_OK;
 }
 
 /**
- * @brief Parse a 'multipart/form-data' w/ 'boundary' body.
+ * @brief Prepare a 'multipart/form-data' body parser.
  *
- * @param a_data
- * @param a_length
- * @param o_length Number of u_char consumed
+ * @param a_boundary Boundary, as provided by 'Content-Type' header.
+ * @param a_enabled  True when the body is expected to be a multipart body.
+ * @param o_body     Parser state to initialize.
  *
- * @return
+ * @return NGX_OK or NGX_ERROR if boundary is not valid.
  */
-ngx_int_t ngx::utls::nrs_ngx_parse_multipart_body (const u_char* a_data, size_t a_length,
-                                                   ngx::utls::nrs_ngx_multipart_body_t& o_body,
-                                                   size_t& o_length)
+ngx_int_t ngx::utls::nrs_ngx_init_multipart_body (const std::string& a_boundary, bool a_enabled,
+                                                  ngx::utls::nrs_ngx_multipart_body_t& o_body)
 {
-    
-    o_length = 0;
-    
-    if ( 1 == o_body.done_ ) {
-        return NGX_DONE;
+    o_body.delimiter_           = CRLF "--" + a_boundary;
+    o_body.line_                = "";
+    o_body.content_disposition_ = "";
+    o_body.content_type_        = "";
+    o_body.state_               = ngx::utls::nrs_ngx_multipart_state_preamble;
+    // ... the first delimiter might not be preceded by CRLF, act as if it was ...
+    o_body.matched_             = 2;
+    o_body.headers_length_      = 0;
+    o_body.parts_               = 0;
+    o_body.done_                = 0;
+    o_body.enabled_             = ( true == a_enabled ? 1 : 0 );
+    
+    // ... RFC 2046 - boundary must not contain CR or LF ...
+    if ( true == a_enabled && ( 0 == a_boundary.length() || a_boundary.length() > 70 || std::string::npos != a_boundary.find_first_of(CRLF) ) ) {
+        return NGX_ERROR;
     }
     
+    return NGX_OK;
+}
+
+/**
+ * @brief Parse a 'multipart/form-data' w/ 'boundary' body, incrementally.
+ *
+ * @param a_data      Next chunk of body data.
+ * @param a_length    Number of bytes in \p a_data.
+ * @param a_body      Parser state, initialized by \link nrs_ngx_init_multipart_body \link.
+ * @param a_callbacks Functions to call when a part starts, has data or ends.
+ *
+ * @return NGX_AGAIN when more data is needed, NGX_DONE when the close delimiter was found or NGX_ERROR.
+ */
+ngx_int_t ngx::utls::nrs_ngx_parse_multipart_body (const u_char* a_data, size_t a_length,
+                                                   ngx::utls::nrs_ngx_multipart_body_t& a_body,
+                                                   const ngx::utls::nrs_ngx_multipart_callbacks_t& a_callbacks)
+{
     //
     // expected:
     //
-    // <boundary>\r\n
-    // Content-Disposition:...\r\n
-    // Content-Type:...\r\n\r\n
+    // [preamble]CRLF--<boundary>CRLF
+    // Content-Disposition:...CRLF
+    // Content-Type:...CRLFCRLF
+    // <data>CRLF--<boundary>CRLF
+    // ...
+    // <data>CRLF--<boundary>--[epilogue]
     //
-     
-    const char* chr = reinterpret_cast<const char*>(a_data);
     
-    auto pieces = { &o_body.boundary_, &o_body.content_disposition_, &o_body.content_type_, &o_body.terminator_ };
-    for ( auto piece : pieces ) {
-        
-        if ( 1 == piece->set_ ) {
-            continue;
-        }
+    // ... max part headers length ...
+    static const size_t k_max_headers_length = 16 * 1024;
+    
+    const u_char*       p         = a_data;
+    const u_char* const end       = a_data + a_length;
+    const u_char* const delimiter = reinterpret_cast<const u_char*>(a_body.delimiter_.c_str());
+    const size_t        dlen      = a_body.delimiter_.length();
+    
+    while ( p < end ) {
         
-        while ( o_length < a_length && ( not ( '\r' == chr[0] || '\n' == chr[0] ) ) ) {
-            piece->value_ += chr[0];
-            o_body.last_   = (u_char)chr[0];
-            o_body.offset_++;
-            o_length++;
-            chr++;
-        }
-
-        if ( &o_body.terminator_ == piece ) {
-            while ( o_length < a_length && ( '\r' == chr[0] || '\n' == chr[0] ) ) {
-                piece->value_ += chr[0];
-                o_body.last_   = (u_char)chr[0];
-                o_body.offset_++;
-                o_length++;
-                chr++;
+        switch (a_body.state_) {
+                
+            case ngx::utls::nrs_ngx_multipart_state_preamble:
+            case ngx::utls::nrs_ngx_multipart_state_body:
+            {
+                const bool body = ( ngx::utls::nrs_ngx_multipart_state_body == a_body.state_ );
+                // ... complete a delimiter held back from previous data?
+                if ( a_body.matched_ > 0 ) {
+                    const size_t n = std::min(dlen - a_body.matched_, static_cast<size_t>(end - p));
+                    if ( 0 == memcmp(p, delimiter + a_body.matched_, n) ) {
+                        p += n;
+                        a_body.matched_ += n;
+                        if ( a_body.matched_ < dlen ) {
+                            // ... still incomplete ...
+                            return NGX_AGAIN;
+                        }
+                        a_body.matched_ = 0;
+                        a_body.state_   = ngx::utls::nrs_ngx_multipart_state_delimiter;
+                        if ( true == body && NGX_OK != a_callbacks.on_part_end_(a_body) ) {
+                            return NGX_ERROR;
+                        }
+                        break;
+                    }
+                    // ... not a delimiter, since boundary has no CR held back bytes can't start another one: they're data ...
+                    if ( true == body && NGX_OK != a_callbacks.on_part_data_(delimiter, a_body.matched_) ) {
+                        return NGX_ERROR;
+                    }
+                    a_body.matched_ = 0;
+                }
+                // ... search for next delimiter, CR first ...
+                const u_char* start = p;
+                const u_char* cr    = p;
+                while ( nullptr != ( cr = reinterpret_cast<const u_char*>(memchr(cr, '\r', static_cast<size_t>(end - cr))) ) ) {
+                    const size_t n = std::min(dlen, static_cast<size_t>(end - cr));
+                    if ( 0 == memcmp(cr, delimiter, n) ) {
+                        break;
+                    }
+                    cr++;
+                }
+                const u_char* data_end = ( nullptr != cr ? cr : end );
+                if ( true == body && data_end > start && NGX_OK != a_callbacks.on_part_data_(start, static_cast<size_t>(data_end - start)) ) {
+                    return NGX_ERROR;
+                }
+                if ( nullptr == cr ) {
+                    // ... all data consumed ...
+                    p = end;
+                } else if ( static_cast<size_t>(end - cr) < dlen ) {
+                    // ... partial delimiter at the end of data, hold it back ...
+                    a_body.matched_ = static_cast<size_t>(end - cr);
+                    p = end;
+                } else {
+                    // ... delimiter found ...
+                    p = cr + dlen;
+                    a_body.state_ = ngx::utls::nrs_ngx_multipart_state_delimiter;
+                    if ( true == body && NGX_OK != a_callbacks.on_part_end_(a_body) ) {
+                        return NGX_ERROR;
+                    }
+                }
+                break;
             }
-        } else {
-            size_t ctn = 0;
-            while ( o_length < a_length && ( '\r' == chr[0] || '\n' == chr[0] ) && ctn < 2 ) {
-                o_body.last_   = (u_char)chr[0];
-                o_body.offset_++;
-                o_length++;
-                chr++;
-                ctn++;
+                
+            case ngx::utls::nrs_ngx_multipart_state_delimiter:
+                // ... after a delimiter: '--' ( close ), optional linear white space and CRLF ...
+                if ( '-' == (*p) ) {
+                    a_body.state_ = ngx::utls::nrs_ngx_multipart_state_close;
+                } else if ( '\r' == (*p) ) {
+                    a_body.state_ = ngx::utls::nrs_ngx_multipart_state_delimiter_lf;
+                } else if ( ' ' != (*p) && '\t' != (*p) ) {
+                    return NGX_ERROR;
+                }
+                p++;
+                break;
+                
+            case ngx::utls::nrs_ngx_multipart_state_delimiter_lf:
+                if ( '\n' != (*p) ) {
+                    return NGX_ERROR;
+                }
+                p++;
+                // ... new part ...
+                a_body.line_.clear();
+                a_body.content_disposition_.clear();
+                a_body.content_type_.clear();
+                a_body.headers_length_ = 0;
+                a_body.parts_++;
+                a_body.state_ = ngx::utls::nrs_ngx_multipart_state_headers;
+                break;
+                
+            case ngx::utls::nrs_ngx_multipart_state_close:
+                if ( '-' != (*p) ) {
+                    return NGX_ERROR;
+                }
+                // ... epilogue ( if any ) is ignored ...
+                a_body.state_ = ngx::utls::nrs_ngx_multipart_state_done;
+                a_body.done_  = 1;
+                return NGX_DONE;
+                
+            case ngx::utls::nrs_ngx_multipart_state_headers:
+            {
+                const u_char* lf = reinterpret_cast<const u_char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+                const u_char* le = ( nullptr != lf ? lf : end );
+                a_body.headers_length_ += static_cast<size_t>(le - p) + ( nullptr != lf ? 1 : 0 );
+                if ( a_body.headers_length_ > k_max_headers_length ) {
+                    return NGX_ERROR;
+                }
+                a_body.line_.append(reinterpret_cast<const char*>(p), static_cast<size_t>(le - p));
+                if ( nullptr == lf ) {
+                    // ... line continues in next data ...
+                    p = end;
+                    break;
+                }
+                p = lf + 1;
+                // ... strip CR ...
+                if ( a_body.line_.length() > 0 && '\r' == a_body.line_.back() ) {
+                    a_body.line_.pop_back();
+                }
+                if ( 0 == a_body.line_.length() ) {
+                    // ... empty line, part data follows ...
+                    a_body.state_ = ngx::utls::nrs_ngx_multipart_state_body;
+                    if ( NGX_OK != a_callbacks.on_part_begin_(a_body) ) {
+                        return NGX_ERROR;
+                    }
+                } else if ( 0 == strncasecmp(a_body.line_.c_str(), "Content-Disposition:", sizeof("Content-Disposition:") - 1) ) {
+                    a_body.content_disposition_ = a_body.line_;
+                } else if ( 0 == strncasecmp(a_body.line_.c_str(), "Content-Type:", sizeof("Content-Type:") - 1) ) {
+                    a_body.content_type_ = a_body.line_;
+                }
+                a_body.line_.clear();
+                break;
             }
-        }
-        
-        piece->set_ = ( '\n' == o_body.last_ );
-        
-        if ( o_length >= a_length ) {
-            break;
+                
+            case ngx::utls::nrs_ngx_multipart_state_done:
+                return NGX_DONE;
+                
         }
         
     }
     
-    // ... we're done?
-    if ( 1 == o_body.boundary_.set_ && 1 == o_body.content_disposition_.set_ && 1 == o_body.content_type_.set_ && 1 == o_body.terminator_.set_ ) {        
-        o_body.done_ = 1;        
-    }
-    
-    return ( 1 == o_body.done_ ? NGX_DONE : NGX_AGAIN );
+    return ( ngx::utls::nrs_ngx_multipart_state_done == a_body.state_ ? NGX_DONE : NGX_AGAIN );
 }
 
-
 /**
  * @brief Parse an argument as an uri.
  *
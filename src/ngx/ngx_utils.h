@@ -30,6 +30,7 @@ extern "C" {
     #include <ngx_palloc.h>
 }
 
+#include <functional>
 #include <map>
 #include <string>
 
@@ -50,26 +51,38 @@ namespace ngx
             ngx_array_t  ranges;
         } nrs_ngx_multipart_header_info_t;
         
-        typedef struct {
-            std::string value_;
-            unsigned    set_:1;
-            
-        } nrs_ngx_multipart_string_piece_t;
+        typedef enum {
+            nrs_ngx_multipart_state_preamble = 0,
+            nrs_ngx_multipart_state_delimiter,
+            nrs_ngx_multipart_state_delimiter_lf,
+            nrs_ngx_multipart_state_close,
+            nrs_ngx_multipart_state_headers,
+            nrs_ngx_multipart_state_body,
+            nrs_ngx_multipart_state_done
+        } nrs_ngx_multipart_state_t;
         
         typedef struct {
 
-            nrs_ngx_multipart_string_piece_t boundary_;
-            nrs_ngx_multipart_string_piece_t content_disposition_;
-            nrs_ngx_multipart_string_piece_t content_type_;
-            nrs_ngx_multipart_string_piece_t terminator_;
+            std::string                      delimiter_;           //!< CRLF "--" boundary
+            std::string                      line_;                //!< Part header line being read.
+            std::string                      content_disposition_; //!< Current part 'Content-Disposition' header line.
+            std::string                      content_type_;        //!< Current part 'Content-Type' header line.
             
-            size_t                           offset_;
-            unsigned                         done_:1;
-            u_char                           last_;
+            nrs_ngx_multipart_state_t        state_;
+            size_t                           matched_;             //!< Delimiter bytes matched at the end of previous data ( held back ).
+            size_t                           headers_length_;      //!< Current part headers length.
+            size_t                           parts_;               //!< Number of parts found so far.
             
+            unsigned                         done_:1;
             unsigned                         enabled_:1;
 
         } nrs_ngx_multipart_body_t;
+        
+        typedef struct {
+            std::function<ngx_int_t(const nrs_ngx_multipart_body_t& a_body)> on_part_begin_;
+            std::function<ngx_int_t(const u_char* a_data, size_t a_length)>  on_part_data_;
+            std::function<ngx_int_t(const nrs_ngx_multipart_body_t& a_body)> on_part_end_;
+        } nrs_ngx_multipart_callbacks_t;
 
     
     public: // Static Method(s) / Function(s)
@@ -103,9 +116,11 @@ namespace ngx
         static ngx_int_t        nrs_ngx_parse_multipart_content_type (const std::string& a_content_type,
                                                                       ngx::utls::nrs_ngx_multipart_header_info_t& o_info);        
 
+        static ngx_int_t        nrs_ngx_init_multipart_body          (const std::string& a_boundary, bool a_enabled,
+                                                                      nrs_ngx_multipart_body_t& o_body);
         static ngx_int_t        nrs_ngx_parse_multipart_body         (const u_char* a_data, size_t a_length,
-                                                                      nrs_ngx_multipart_body_t& o_body,
-                                                                      size_t& o_length);
+                                                                      nrs_ngx_multipart_body_t& a_body,
+                                                                      const nrs_ngx_multipart_callbacks_t& a_callbacks);
         
         static ngx_int_t       nrs_ngx_parse_arg_as_uri              (ngx_http_request_t* a_r, const char* const a_name,
                                                                       std::string& o_value);
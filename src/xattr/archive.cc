@@ -28,6 +28,8 @@
 #include "ngx/casper/broker/cdn-common/archive.h"
 
 #include <algorithm>  // std::transform
+#include <string.h>   // memset
+#include <vector>     // std::vector
 
 /**
  * @brief Default constructor.
@@ -112,6 +114,28 @@ void nb::Archive::Create (const nb::Archive::CreateArgs& a_args)
         headers[key] = value;
     }
     
+    // ... consumers read headers as nginx lays them out, a single part list backed by the map ...
+    std::vector<ngx_table_elt_t> elts;
+    elts.reserve(headers.size());
+    for ( const auto& it : headers ) {
+        ngx_table_elt_t elt;
+        memset(&elt, 0, sizeof(ngx_table_elt_t));
+        elt.hash       = 1;
+        elt.key.data   = reinterpret_cast<u_char*>(const_cast<char*>(it.first.c_str()));
+        elt.key.len    = it.first.length();
+        elt.value.data = reinterpret_cast<u_char*>(const_cast<char*>(it.second.c_str()));
+        elt.value.len  = it.second.length();
+        elts.push_back(elt);
+    }
+    ngx_list_t list;
+    memset(&list, 0, sizeof(ngx_list_t));
+    list.part.elts  = elts.data();
+    list.part.nelts = elts.size();
+    list.last       = &list.part;
+    
+    ngx::casper::broker::InHeaders in_headers;
+    in_headers.Bind(&list);
+    
     ngx::casper::broker::cdn::XNumericID   numeric_id("X-NUMERIC-ID");
     ngx::casper::broker::cdn::XFilename    filename;
     ngx::casper::broker::cdn::XContentType content_type("application/octet-stream");
@@ -120,22 +144,22 @@ void nb::Archive::Create (const nb::Archive::CreateArgs& a_args)
     ngx::casper::broker::cdn::XBillingID   billing_id;
     ngx::casper::broker::cdn::XBillingType billing_type;
     
-    archived_by.Set({"X-CASPER-ARCHIVED-BY", "USER-AGENT"}, headers);
+    archived_by.Set({"X-CASPER-ARCHIVED-BY", "USER-AGENT"}, in_headers);
 
     ngx::casper::broker::cdn::Archive::LoadH2EMap   (a_args.config_file_uri_, h2e_map);
     ngx::casper::broker::cdn::Archive::LoadACTConfig(a_args.config_file_uri_, act_config);
     
     ngx::casper::broker::cdn::Archive a (/* a_archivist */ archivist_, /* a_writer */ writer_,
                                          /* a_act_config */ act_config,
-                                         /* a_headers    */ headers, /* a_h2e_map */ h2e_map,
+                                         /* a_headers    */ in_headers, /* a_h2e_map */ h2e_map,
                                          /* a_dir_prefix */ a_args.dir_prefix_
     );
     
-    numeric_id.Set({"X-CASPER-ENTITY-ID", "X-CASPER-USER-ID"}, headers);
-    filename.Set(headers);
-    access.Set(headers);
-    billing_id.Set(headers);
-    billing_type.Set(headers);
+    numeric_id.Set({"X-CASPER-ENTITY-ID", "X-CASPER-USER-ID"}, in_headers);
+    filename.Set(in_headers);
+    access.Set(in_headers);
+    billing_id.Set(in_headers);
+    billing_type.Set(in_headers);
 
     a.Create(/* a_id */ numeric_id, /* a_size */ 0, /* a_reserved_id */ &a_args.reserved_id_);
     
@@ -81,7 +81,7 @@ namespace nb
         cc::fs::file::XAttr*               xattr_;        
         ngx::casper::broker::cdn::H2EMap   h2e_map_;
         Json::Value                        act_config_;
-        std::map<std::string, std::string> act_headers_;
+        ngx::casper::broker::InHeaders     act_headers_;
         ngx::casper::broker::cdn::ACT*     act_;
         
     public: // Constructor(s) / Destructor
@@ -0,0 +1,202 @@
+/**
+ * @file ast_program.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "harness.h"
+
+#include "ngx/casper/broker/cdn-common/ast/program.h"
+
+#include "cc/exception.h"
+
+#include <chrono> // std::chrono
+#include <map>    // std::map
+#include <memory> // std::unique_ptr
+#include <random> // std::mt19937
+#include <string> // std::string
+#include <vector> // std::vector
+
+typedef ngx::casper::broker::cdn::common::ast::Program Program;
+
+static const char* const sk_variables_[] = { "role", "owner", "user", "flags", "entity", "module" };
+
+/**
+ * @brief Resolve variables to their index in sk_variables_.
+ */
+static size_t Resolve (const std::string& a_name)
+{
+    for ( size_t idx = 0 ; idx < sizeof(sk_variables_) / sizeof(sk_variables_[0]) ; ++idx ) {
+        if ( a_name == sk_variables_[idx] ) {
+            return idx;
+        }
+    }
+    throw ::cc::Exception("ACT variable '%s' is not defined!", a_name.c_str());
+}
+
+/**
+ * @return Result of running \p a_expression against \p a_slots.
+ */
+static uint64_t Run (const std::string& a_expression, const std::vector<uint64_t>& a_slots)
+{
+    return Program(a_expression, Resolve).Run(a_slots.data());
+}
+
+/**
+ * @brief Write a random expression, as \link Tree \link does, and return it's expected value.
+ */
+static uint64_t Random (std::mt19937& a_rng, const std::vector<uint64_t>& a_slots, const size_t a_depth, std::string& o_expression)
+{
+    static const char* const k_operators[] = { "||", "&&", "|", "&", "==", "!=" };
+    if ( a_depth > 0 && 0 != ( a_rng() % 3 ) ) {
+        const size_t op = a_rng() % 6;
+        std::string  left, right;
+        const uint64_t l = Random(a_rng, a_slots, a_depth - 1, left);
+        const uint64_t r = Random(a_rng, a_slots, a_depth - 1, right);
+        o_expression = std::string(k_operators[op]) + "(" + left + "," + right + ")";
+        switch (op) {
+            case 0:  return ( l || r ) ? 1 : 0;
+            case 1:  return ( l && r ) ? 1 : 0;
+            case 2:  return ( 0 != ( l | r ) ) ? 1 : 0;
+            case 3:  return ( 0 != ( l & r ) ) ? 1 : 0;
+            case 4:  return ( l == r ) ? 1 : 0;
+            default: return ( l != r ) ? 1 : 0;
+        }
+    }
+    const uint64_t value = ( 0 == ( a_rng() % 2 ) ? a_rng() % 4 : ( static_cast<uint64_t>(a_rng()) << 32 ) | a_rng() );
+    char           buffer[32];
+    switch (a_rng() % 3) {
+        case 0:
+            snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+            o_expression = buffer;
+            return value;
+        case 1:
+            snprintf(buffer, sizeof(buffer), ( 0 == ( a_rng() % 2 ) ? "0x%llx" : "0x%llX" ), static_cast<unsigned long long>(value));
+            o_expression = buffer;
+            return value;
+        default:
+        {
+            const size_t slot = a_rng() % a_slots.size();
+            o_expression = sk_variables_[slot];
+            return a_slots[slot];
+        }
+    }
+}
+
+int main ()
+{
+    // ... role, owner, user, flags, entity, module ...
+    const std::vector<uint64_t> slots = { 0x2, 7, 7, 0x14, 0, 0xFFFFFFFFFFFFFFFFULL };
+
+    // ... items and operators ...
+    TEST_CHECK(1  == Run("1;", slots));
+    TEST_CHECK(31 == Run("0x1F;", slots));
+    TEST_CHECK(31 == Run("0x1f;", slots));
+    TEST_CHECK(0x14 == Run("flags;", slots)); // ... bare item evaluates to it's value ...
+    TEST_CHECK(0xFFFFFFFFFFFFFFFFULL == Run("module;", slots));
+    TEST_CHECK(1 == Run("==(owner,user);", slots));
+    TEST_CHECK(0 == Run("!=(owner,user);", slots));
+    TEST_CHECK(1 == Run("&(flags,0x4);", slots)); // ... bitwise operators yield 0 / 1 ...
+    TEST_CHECK(0 == Run("&(flags,0x8);", slots));
+    TEST_CHECK(1 == Run("|(entity,role);", slots));
+    TEST_CHECK(0 == Run("|(entity,0);", slots));
+    TEST_CHECK(1 == Run("||(entity,role);", slots));
+    TEST_CHECK(0 == Run("&&(entity,role);", slots));
+    TEST_CHECK(1 == Run("&&(||(==(role,0x1),&(role,0x2)),==(owner,user));", slots));
+
+    // ... one program, many runs, different values ...
+    {
+        const Program program("&&(==(owner,user),&(flags,0x4));", Resolve);
+        std::vector<uint64_t> other = slots;
+        TEST_CHECK(1 == program.Run(other.data()));
+        other[2] = 8;
+        TEST_CHECK(0 == program.Run(other.data()));
+        TEST_CHECK("&&(==(owner,user),&(flags,0x4));" == program.expression());
+    }
+
+    // ... deeper than the inline stack ...
+    {
+        std::string expression = "1";
+        for ( size_t idx = 0 ; idx < 100 ; ++idx ) {
+            expression = "&&(1," + expression + ")";
+        }
+        TEST_CHECK(1 == Run(expression + ";", slots));
+        TEST_CHECK(0 == Run("||(0," + expression.substr(0, expression.length() - 101) + "0" + std::string(100, ')') + ");", slots));
+    }
+
+    // ... errors ...
+    TEST_CHECK_THROWS(Run("", slots));
+    TEST_CHECK_THROWS(Run("1", slots));
+    TEST_CHECK_THROWS(Run("1;;", slots));
+    TEST_CHECK_THROWS(Run("==(1,2", slots));
+    TEST_CHECK_THROWS(Run("==(1,2);x", slots));
+    TEST_CHECK_THROWS(Run("==(1;2);", slots));
+    TEST_CHECK_THROWS(Run("==(1,2,3);", slots));
+    TEST_CHECK_THROWS(Run("== (1,2);", slots));
+    TEST_CHECK_THROWS(Run("undefined;", slots));
+    TEST_CHECK_THROWS(Run("==(role,undefined);", slots));
+
+    // ... random expressions against a direct evaluation of the same tree ...
+    {
+        std::mt19937 rng(2);
+        size_t       mismatches = 0;
+        for ( size_t idx = 0 ; idx < 20000 ; ++idx ) {
+            std::vector<uint64_t> values(slots.size());
+            for ( auto& value : values ) {
+                value = ( 0 == ( rng() % 2 ) ? rng() % 4 : rng() );
+            }
+            std::string    expression;
+            const uint64_t expected = Random(rng, values, 1 + ( idx % 8 ), expression);
+            try {
+                if ( expected != Run(expression + ";", values) ) {
+                    mismatches++;
+                    fprintf(stderr, "%s: mismatch: %s\n", __FILE__, expression.c_str());
+                }
+            } catch (const ::cc::Exception& a_cc_exception) {
+                mismatches++;
+                fprintf(stderr, "%s: %s\n", __FILE__, a_cc_exception.what());
+            }
+        }
+        TEST_CHECK(0 == mismatches);
+    }
+
+    // ... timing: cached program vs compiling it on every check, as a permission barrier would without the cache ...
+    {
+        const std::string expression = "||(&&(==(owner,user),&(flags,0x4)),||(==(role,0x1),&(role,0x2)));";
+        const size_t      count      = 1000000;
+        const Program     program(expression, Resolve);
+        uint64_t          sum        = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for ( size_t idx = 0 ; idx < count ; ++idx ) {
+            sum += program.Run(slots.data());
+        }
+        const double run_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+
+        start = std::chrono::steady_clock::now();
+        for ( size_t idx = 0 ; idx < count / 10 ; ++idx ) {
+            sum += Program(expression, Resolve).Run(slots.data());
+        }
+        const double compile_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ( count / 10 );
+
+        TEST_CHECK(count + count / 10 == sum);
+        fprintf(stdout, "Program: %.1f ns/run, compiled per run: %.1f ns/run\n", run_ns, compile_ns);
+    }
+
+    return TEST_RESULT();
+}
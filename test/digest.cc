@@ -0,0 +1,125 @@
+/**
+ * @file digest.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "harness.h"
+
+#include "ngx/casper/broker/cdn-common/digest.h"
+
+#include "cc/exception.h"
+
+#include <openssl/evp.h>
+
+#include <algorithm> // std::min
+#include <random>    // std::mt19937
+#include <string>    // std::string
+#include <vector>    // std::vector
+
+/**
+ * @return '<algorithm>:<hex>' of \p a_data, fed in \p a_chunk bytes updates.
+ */
+static std::string Calculate (const EVP_MD* a_md, const std::vector<unsigned char>& a_data, const size_t a_chunk)
+{
+    ngx::casper::broker::cdn::Digest digest;
+    digest.Initialize(a_md);
+    for ( size_t offset = 0 ; offset < a_data.size() ; offset += a_chunk ) {
+        digest.Update(a_data.data() + offset, std::min(a_chunk, a_data.size() - offset));
+    }
+    return digest.Finalize();
+}
+
+int main ()
+{
+    // ... known values ...
+    {
+        const std::vector<unsigned char> abc = { 'a', 'b', 'c' };
+        TEST_CHECK("SHA256:ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" == Calculate(EVP_sha256(), abc, 1));
+        TEST_CHECK("SHA256:ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" == Calculate(EVP_sha256(), abc, 3));
+        TEST_CHECK("SHA256:e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" == Calculate(EVP_sha256(), {}, 1));
+    }
+
+    // ... names, as configured and as stored ...
+    {
+        TEST_CHECK(EVP_sha256() == ngx::casper::broker::cdn::Digest::Lookup("SHA256"));
+        TEST_CHECK(nullptr != ngx::casper::broker::cdn::Digest::Lookup("BLAKE2b512"));
+        TEST_CHECK(nullptr != ngx::casper::broker::cdn::Digest::Lookup("SHA512-256"));
+        TEST_CHECK_THROWS(ngx::casper::broker::cdn::Digest::Lookup("NOT-A-DIGEST"));
+        TEST_CHECK("SHA256" == ngx::casper::broker::cdn::Digest::Name(EVP_sha256()));
+        TEST_CHECK("<unknown>" == ngx::casper::broker::cdn::Digest::Name(nullptr));
+
+        // ... every stored value parses back to the algorithm that wrote it ...
+        const std::vector<unsigned char> data(1000, 0x5A);
+        for ( auto name : { "SHA256", "SHA512-256", "BLAKE2b512", "SHA1" } ) {
+            const EVP_MD*     md    = ngx::casper::broker::cdn::Digest::Lookup(name);
+            const std::string value = Calculate(md, data, data.size());
+            std::string       hex;
+            TEST_CHECK(md == ngx::casper::broker::cdn::Digest::Parse(value, hex));
+            TEST_CHECK(static_cast<size_t>(2 * EVP_MD_size(md)) == hex.length());
+            TEST_CHECK(value == ngx::casper::broker::cdn::Digest::Name(md) + ":" + hex);
+        }
+
+        std::string hex;
+        TEST_CHECK_THROWS(ngx::casper::broker::cdn::Digest::Parse("d41d8cd98f00b204e9800998ecf8427e", hex));
+        TEST_CHECK_THROWS(ngx::casper::broker::cdn::Digest::Parse(":abcd", hex));
+        TEST_CHECK_THROWS(ngx::casper::broker::cdn::Digest::Parse("NOT-A-DIGEST:abcd", hex));
+    }
+
+    // ... single pass MD5 + digest matches two separate passes, whatever the update sizes ...
+    {
+        std::vector<unsigned char> data(300 * 1024 + 17);
+        std::mt19937               rng(16);
+        for ( auto& byte : data ) {
+            byte = static_cast<unsigned char>(rng());
+        }
+
+        ::cc::hash::MD5 md5;
+        md5.Initialize();
+        md5.Update(data.data(), data.size());
+        const std::string expected_md5 = md5.Finalize();
+
+        for ( auto name : { "SHA256", "BLAKE2b512" } ) {
+            const EVP_MD*     md       = ngx::casper::broker::cdn::Digest::Lookup(name);
+            const std::string expected = Calculate(md, data, data.size());
+            for ( size_t chunk : { static_cast<size_t>(1000), static_cast<size_t>(32 * 1024), static_cast<size_t>(32 * 1024 + 1), data.size() } ) {
+                ::cc::hash::MD5                  both_md5;
+                ngx::casper::broker::cdn::Digest both;
+                both_md5.Initialize();
+                both.Initialize(md);
+                for ( size_t offset = 0 ; offset < data.size() ; offset += chunk ) {
+                    both.Update(data.data() + offset, std::min(chunk, data.size() - offset), both_md5);
+                }
+                TEST_CHECK(expected == both.Finalize());
+                TEST_CHECK(expected_md5 == both_md5.Finalize());
+            }
+        }
+
+        // ... same object, new calculation ...
+        ngx::casper::broker::cdn::Digest digest;
+        digest.Initialize(EVP_sha256());
+        digest.Update(data.data(), data.size());
+        digest.Finalize();
+        digest.Initialize(EVP_sha256());
+        digest.Update(reinterpret_cast<const unsigned char*>("abc"), 3);
+        TEST_CHECK("SHA256:ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" == digest.Finalize());
+        TEST_CHECK(EVP_sha256() == digest.md());
+    }
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,140 @@
+/**
+ * @file digest_bench.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Content digest throughput, next to MD5 and to sequential disk writes, run by run.sh only when NRS_TEST_BENCH is set.
+//
+
+#include "ngx/casper/broker/cdn-common/digest.h"
+
+#include <fcntl.h>  // open
+#include <stdio.h>  // fprintf
+#include <stdlib.h> // atoi, getenv
+#include <unistd.h> // write, fsync, close, unlink
+
+#include <openssl/evp.h>
+
+#include <chrono>     // std::chrono
+#include <functional> // std::function
+#include <string>     // std::string
+#include <vector>     // std::vector
+
+static const size_t k_buffer = 4 * 1024 * 1024; // same as Hasher's default read buffer
+
+/**
+ * @brief Feed \p a_size_mb MiB to a function, one buffer at a time, and report throughput.
+ */
+static void Measure (const char* const a_what, const size_t a_size_mb, const std::vector<unsigned char>& a_buffer,
+                     const std::function<void(const unsigned char*, size_t)>& a_update)
+{
+    const size_t count = a_size_mb * 1024 * 1024 / a_buffer.size();
+    const auto   start = std::chrono::steady_clock::now();
+    for ( size_t idx = 0 ; idx < count ; ++idx ) {
+        a_update(a_buffer.data(), a_buffer.size());
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stdout, "digest_bench: %-24s " "%zu MiB in %.3f s - %.2f GiB/s\n", a_what, a_size_mb, seconds,
+            ( static_cast<double>(count * a_buffer.size()) / seconds ) / ( 1024.0 * 1024.0 * 1024.0 ));
+}
+
+int main ()
+{
+    const char* env      = getenv("NRS_TEST_BENCH_MB");
+    const size_t size_mb = ( nullptr != env && atoi(env) > 0 ? static_cast<size_t>(atoi(env)) : 1024 );
+
+    std::vector<unsigned char> buffer(k_buffer);
+    for ( size_t idx = 0 ; idx < buffer.size() ; ++idx ) {
+        buffer[idx] = static_cast<unsigned char>(( idx * 2654435761u ) >> 13);
+    }
+
+    // ... legacy MD5 alone ...
+    {
+        ::cc::hash::MD5 md5;
+        md5.Initialize();
+        Measure("MD5", size_mb, buffer, [&md5] (const unsigned char* a_data, size_t a_length) {
+            md5.Update(a_data, a_length);
+        });
+        md5.Finalize();
+    }
+
+    // ... each content digest alone, then with MD5 in the same pass ...
+    for ( auto name : { "SHA1", "SHA256", "SHA512-256", "BLAKE2b512", "BLAKE2s256" } ) {
+        const EVP_MD* md = nullptr;
+        try {
+            md = ngx::casper::broker::cdn::Digest::Lookup(name);
+        } catch (...) {
+            fprintf(stdout, "digest_bench: %-24s not supported by this OpenSSL\n", name);
+            continue;
+        }
+        {
+            ngx::casper::broker::cdn::Digest digest;
+            digest.Initialize(md);
+            Measure(name, size_mb, buffer, [&digest] (const unsigned char* a_data, size_t a_length) {
+                digest.Update(a_data, a_length);
+            });
+            digest.Finalize();
+        }
+        {
+            ngx::casper::broker::cdn::Digest digest;
+            ::cc::hash::MD5                  md5;
+            digest.Initialize(md);
+            md5.Initialize();
+            Measure(( std::string("MD5 + ") + name ).c_str(), size_mb, buffer, [&digest, &md5] (const unsigned char* a_data, size_t a_length) {
+                digest.Update(a_data, a_length, md5);
+            });
+            digest.Finalize();
+            md5.Finalize();
+        }
+    }
+
+    // ... what an upload is bound by: sequential writes, flushed to disk ...
+    {
+        const char* dir      = getenv("NRS_TEST_BENCH_DIR");
+        std::string uri      = std::string(nullptr != dir ? dir : ".") + "/digest_bench.tmp";
+        const int   fd       = open(uri.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        if ( -1 == fd ) {
+            fprintf(stderr, "digest_bench: unable to open '%s'\n", uri.c_str());
+            return 1;
+        }
+        bool failed = false;
+        Measure("disk write + fsync", size_mb, buffer, [fd, &failed] (const unsigned char* a_data, size_t a_length) {
+            for ( size_t done = 0 ; false == failed && done < a_length ; ) {
+                const ssize_t rv = write(fd, a_data + done, a_length - done);
+                if ( rv <= 0 ) {
+                    failed = true;
+                } else {
+                    done += static_cast<size_t>(rv);
+                }
+            }
+        });
+        const auto start = std::chrono::steady_clock::now();
+        fsync(fd);
+        fprintf(stdout, "digest_bench: %-24s %.3f s\n", "final fsync", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        close(fd);
+        unlink(uri.c_str());
+        if ( true == failed ) {
+            fprintf(stderr, "digest_bench: unable to write to '%s'\n", uri.c_str());
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file harness.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_TEST_HARNESS_H_
+#define NRS_TEST_HARNESS_H_
+
+//
+// Minimal standalone checks - no nginx, no event loop, see run.sh.
+//
+
+#include <stdio.h>  // fprintf
+#include <stddef.h> // size_t
+
+static size_t s_test_checks_   = 0;
+static size_t s_test_failures_ = 0;
+
+#define TEST_CHECK(a_condition) \
+    do { \
+        s_test_checks_++; \
+        if ( !( a_condition ) ) { \
+            s_test_failures_++; \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #a_condition); \
+        } \
+    } while(0)
+
+#define TEST_CHECK_THROWS(a_statement) \
+    do { \
+        bool __thrown = false; \
+        try { \
+            a_statement; \
+        } catch (...) { \
+            __thrown = true; \
+        } \
+        TEST_CHECK(true == __thrown && #a_statement); \
+    } while(0)
+
+#define TEST_RESULT() \
+    ( fprintf(stdout, "%s: " "%zu check(s), %zu failure(s)\n", __FILE__, s_test_checks_, s_test_failures_), ( 0 == s_test_failures_ ? 0 : 1 ) )
+
+#endif // NRS_TEST_HARNESS_H_
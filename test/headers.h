@@ -0,0 +1,90 @@
+/**
+ * @file headers.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_TEST_HEADERS_H_
+#define NRS_TEST_HEADERS_H_
+
+#include "ev/ngx/includes.h"
+
+#include <string>  // std::string
+#include <utility> // std::pair
+#include <vector>  // std::vector
+
+/**
+ * @brief A fake request 'in' headers list, laid out as nginx does: elements spread over linked parts.
+ */
+class Headers final
+{
+
+public: // Data Type(s)
+
+    typedef std::vector<std::pair<std::string, std::string>> Part;
+
+private: // Data
+
+    std::vector<std::string>     storage_;
+    std::vector<ngx_table_elt_t> first_;
+    std::vector<ngx_table_elt_t> second_;
+    ngx_list_part_t              next_;
+    ngx_http_request_t           r_;
+
+public: // Constructor(s) / Destructor
+
+    Headers (const Part& a_first, const Part& a_second = {})
+    {
+        storage_.reserve(2 * ( a_first.size() + a_second.size() ));
+        Fill(a_first, first_);
+        Fill(a_second, second_);
+        next_ = { second_.data(), second_.size(), nullptr };
+        r_.headers_in.headers.part = { first_.data(), first_.size(), ( second_.size() > 0 ? &next_ : nullptr ) };
+        r_.headers_in.headers.last = ( second_.size() > 0 ? &next_ : &r_.headers_in.headers.part );
+    }
+
+public: // Method(s) / Function(s)
+
+    ngx_http_request_t* request ()
+    {
+        return &r_;
+    }
+
+private: // Method(s) / Function(s)
+
+    void Fill (const Part& a_part, std::vector<ngx_table_elt_t>& o_elts)
+    {
+        for ( const auto& header : a_part ) {
+            storage_.push_back(header.first);
+            const std::string& key = storage_.back();
+            storage_.push_back(header.second);
+            const std::string& value = storage_.back();
+            o_elts.push_back({
+                /* hash        */ 1,
+                /* key         */ { key.length()  , (u_char*)key.c_str()   },
+                /* value       */ { value.length(), (u_char*)value.c_str() },
+                /* lowcase_key */ nullptr,
+                /* next        */ nullptr
+            });
+        }
+    }
+
+}; // end of class 'Headers'
+
+#endif // NRS_TEST_HEADERS_H_
@@ -0,0 +1,127 @@
+/**
+ * @file id_matcher.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "harness.h"
+
+#include "ngx/casper/broker/cdn-common/id_matcher.h"
+
+#include <stdio.h>  // fprintf
+#include <stdlib.h> // rand_r
+
+#include <chrono> // std::chrono
+#include <regex>  // std::regex
+#include <string> // std::string
+
+typedef ngx::casper::broker::cdn::IDMatcher IDMatcher;
+
+//
+// The patterns IDMatcher replaced, as archive.cc and cdn-download/module.cc used to build them.
+//
+static const std::regex k_archive_expr_  ("([a-z]{1})([a-zA-Z]{2})([a-zA-Z0-9]{6})(\\..+)?"   , std::regex_constants::ECMAScript);
+static const std::regex k_redirect_expr_ ("([a-z]{1})([a-zA-Z0-9]{2})([a-zA-Z0-9]{6})(\\.[a-z]*)?", std::regex_constants::ECMAScript);
+
+/**
+ * @return True if IDMatcher and std::regex_search agree on \p a_value: found, ID position and extension.
+ */
+static bool Agree (const std::string& a_value, const IDMatcher::Dialect a_dialect)
+{
+    std::smatch      expected;
+    IDMatcher::Match match = { 0, 0 };
+    
+    const bool found = std::regex_search(a_value, expected, ( IDMatcher::Dialect::Archive == a_dialect ? k_archive_expr_ : k_redirect_expr_ ));
+    if ( found != IDMatcher::Search(a_value, a_dialect, &match) ) {
+        return false;
+    }
+    if ( false == found ) {
+        return true;
+    }
+    return static_cast<size_t>(expected.position(0)) == match.offset_ && static_cast<size_t>(expected[4].length()) == match.ext_length_;
+}
+
+int main ()
+{
+    const IDMatcher::Dialect dialects [] = { IDMatcher::Dialect::Archive, IDMatcher::Dialect::Redirect };
+    
+    // ... known cases ...
+    const std::string cases [] = {
+        "", "aBc123456", "aBc12345", "/dl/aBc123456.pdf", "xx aBc123456.tar.gz", "aB1123456.Pdf",
+        "ABc123456", "a12345678", "aBc123456.", "aBc123456.\npdf", "aBc123456.pdf\r\nx",
+        "aBc12345!aBc123456.x", "zzaBc123456..", std::string("aBc123456.p\0f", 13)
+    };
+    for ( const auto dialect : dialects ) {
+        for ( const auto& value : cases ) {
+            TEST_CHECK(true == Agree(value, dialect));
+        }
+    }
+    
+    // ... extension stops at a line terminator ( ECMAScript '.' ) or, for redirects, at anything but [a-z] ...
+    {
+        IDMatcher::Match match = { 0, 0 };
+        TEST_CHECK(true == IDMatcher::Search("/aBc123456.pdf\nrest", IDMatcher::Dialect::Archive, &match));
+        TEST_CHECK(1 == match.offset_ && 4 == match.ext_length_);
+        TEST_CHECK(true == IDMatcher::Search("/aBc123456.pdf\rrest", IDMatcher::Dialect::Archive, &match));
+        TEST_CHECK(1 == match.offset_ && 4 == match.ext_length_);
+        TEST_CHECK(true == IDMatcher::Search("aBc123456.\n", IDMatcher::Dialect::Archive, &match));
+        TEST_CHECK(0 == match.offset_ && 0 == match.ext_length_);
+        TEST_CHECK(true == IDMatcher::Search("a12123456.pDf", IDMatcher::Dialect::Redirect, &match));
+        TEST_CHECK(0 == match.offset_ && 2 == match.ext_length_);
+        TEST_CHECK(false == IDMatcher::Search("a12123456", IDMatcher::Dialect::Archive));
+    }
+    
+    // ... randomized, alphabet biased towards IDs, dots and line terminators ...
+    static const char k_alphabet [] = "abzAZ09.\n\r-_/ ";
+    unsigned int seed = 2020;
+    for ( size_t iteration = 0 ; iteration < 100000 ; ++iteration ) {
+        std::string value;
+        for ( size_t length = static_cast<size_t>(rand_r(&seed)) % 32 ; length > 0 ; --length ) {
+            value += k_alphabet[static_cast<size_t>(rand_r(&seed)) % ( sizeof(k_alphabet) - 1 )];
+        }
+        for ( const auto dialect : dialects ) {
+            if ( false == Agree(value, dialect) ) {
+                TEST_CHECK(false && "IDMatcher and std::regex_search disagree");
+                fprintf(stderr, "    value: '%s'\n", value.c_str());
+            }
+        }
+    }
+    
+    // ... cost per call, informative only: old code built the regex on every call ...
+    {
+        const std::string value = "/dl/aBc123456.pdf";
+        const size_t      count = 100000;
+        size_t            found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for ( size_t idx = 0 ; idx < count ; ++idx ) {
+            found += ( true == IDMatcher::Search(value, IDMatcher::Dialect::Archive) ? 1 : 0 );
+        }
+        const double matcher = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+        start = std::chrono::steady_clock::now();
+        for ( size_t idx = 0 ; idx < count / 100 ; ++idx ) {
+            const std::regex id_expr("([a-z]{1})([a-zA-Z]{2})([a-zA-Z0-9]{6})(\\..+)?", std::regex_constants::ECMAScript);
+            std::smatch match;
+            found += ( true == std::regex_search(value, match, id_expr) ? 1 : 0 );
+        }
+        const double regex = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ( count / 100 );
+        TEST_CHECK(count + count / 100 == found);
+        fprintf(stdout, "IDMatcher: %.1f ns/call, std::regex built per call: %.1f ns/call\n", matcher, regex);
+    }
+    
+    return TEST_RESULT();
+}
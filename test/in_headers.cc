@@ -0,0 +1,81 @@
+/**
+ * @file in_headers.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "harness.h"
+#include "headers.h"
+
+#include "ngx/casper/broker/in_headers.h"
+
+#include <map>    // std::map
+#include <string> // std::string
+
+int main ()
+{
+    // ... repeated header, empty value and headers split across two list parts ...
+    Headers headers({
+        { "Host"        , "example.com"      },
+        { "X-Casper-Id" , "1"                },
+        { "Accept"      , ""                 }
+    }, {
+        { "x-casper-id" , "2"                },
+        { "Content-Type", "application/json" }
+    });
+
+    ngx::casper::broker::InHeaders view;
+    TEST_CHECK(view.end() == view.begin());
+    TEST_CHECK(view.end() == view.find("host"));
+
+    view.Bind(headers.request());
+
+    // ... case-insensitive lookups, last occurrence wins ...
+    TEST_CHECK(view.end() != view.find("HOST"));
+    TEST_CHECK("example.com" == view.find("host")->second);
+    TEST_CHECK("2" == view.find("X-CASPER-ID")->second);
+    TEST_CHECK("x-casper-id" == view.find("X-CASPER-ID")->first);
+    TEST_CHECK(view.end() == view.find("accept"));
+    TEST_CHECK(view.end() == view.find("content"));
+
+    std::string value = "untouched";
+    TEST_CHECK(false == view.Get("accept", value) && "untouched" == value);
+    TEST_CHECK(true  == view.Get("content-type", value) && "application/json" == value);
+
+    // ... iteration matches what a lowercased std::map copy used to hold ...
+    std::map<std::string, std::string> visited;
+    for ( const auto& it : view ) {
+        TEST_CHECK(visited.end() == visited.find(it.first));
+        visited[it.first] = it.second;
+    }
+    const std::map<std::string, std::string> expected = {
+        { "host"        , "example.com"      },
+        { "x-casper-id" , "2"                },
+        { "content-type", "application/json" }
+    };
+    TEST_CHECK(expected == visited);
+    TEST_CHECK(3 == view.size());
+
+    // ... bound to a bare headers list ( no request ), as nb-xattr does ...
+    ngx::casper::broker::InHeaders list_view;
+    list_view.Bind(&headers.request()->headers_in.headers);
+    TEST_CHECK("2" == list_view.find("x-casper-id")->second);
+    TEST_CHECK(3 == list_view.size());
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,127 @@
+/**
+ * @file module_allocations.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "harness.h"
+
+#include "ngx/casper/broker/methods.h"
+
+#include <stdint.h> // intptr_t
+#include <stdlib.h> // malloc, free
+
+#include <functional> // std::function
+#include <new>        // std::bad_alloc
+#include <set>        // std::set
+#include <string>     // std::string
+
+//
+// Counting allocator: every heap allocation made by this process goes through here.
+//
+
+static size_t s_allocations_ = 0;
+
+void* operator new (size_t a_size)
+{
+    s_allocations_++;
+    void* ptr = malloc(0 == a_size ? 1 : a_size);
+    if ( nullptr == ptr ) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete (void* a_ptr) noexcept
+{
+    free(a_ptr);
+}
+
+void operator delete (void* a_ptr, size_t /* a_size */) noexcept
+{
+    free(a_ptr);
+}
+
+/**
+ * @return Number of heap allocations performed by a callable.
+ */
+template <typename F>
+static size_t CountAllocations (F a_callable)
+{
+    const size_t before = s_allocations_;
+    a_callable();
+    return s_allocations_ - before;
+}
+
+/**
+ * @brief Same shape as the lambdas installed in a module's errors tracker.
+ */
+class Owner
+{
+
+public:
+
+    uint16_t status_code_ = 0;
+
+    std::function<void(const char* const, const uint16_t, const char* const)> Tracker ()
+    {
+        return [this] (const char* const /* a_error_code */, const uint16_t a_http_status_code, const char* const /* a_i18n_key */) {
+            status_code_ = a_http_status_code;
+        };
+    }
+
+};
+
+int main ()
+{
+    // ... redirect supported methods: a std::set node per request versus a bit mask ...
+    const size_t set_allocations = CountAllocations([] () {
+        std::set<ngx_uint_t> methods = { NGX_HTTP_GET };
+        methods.insert(NGX_HTTP_HEAD);
+        TEST_CHECK(methods.end() != methods.find(NGX_HTTP_HEAD));
+    });
+    const size_t mask_allocations = CountAllocations([] () {
+        ngx::casper::broker::Methods methods = { NGX_HTTP_GET };
+        methods.insert(NGX_HTTP_HEAD);
+        TEST_CHECK(true  == methods.contains(NGX_HTTP_GET));
+        TEST_CHECK(true  == methods.contains(NGX_HTTP_HEAD));
+        TEST_CHECK(false == methods.contains(NGX_HTTP_POST));
+    });
+    TEST_CHECK(2 == set_allocations);
+    TEST_CHECK(0 == mask_allocations);
+
+    // ... errors tracker lambdas only capture 'this', std::function keeps them inline ...
+    Owner owner;
+    const size_t tracker_allocations = CountAllocations([&owner] () {
+        auto tracker = owner.Tracker();
+        tracker("bad_request", 400, "BROKER_BAD_REQUEST");
+    });
+    TEST_CHECK(0   == tracker_allocations);
+    TEST_CHECK(400 == owner.status_code_);
+
+    // ... loggable tag, a user space address in decimal fits std::string's inline buffer ...
+    const size_t tag_allocations = CountAllocations([&owner] () {
+        const std::string tag = std::to_string(reinterpret_cast<intptr_t>(&owner));
+        TEST_CHECK(tag.length() > 0);
+    });
+    TEST_CHECK(0 == tag_allocations);
+
+    fprintf(stdout, "std::set methods: %zu allocation(s), bit mask: %zu allocation(s)\n", set_allocations, mask_allocations);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,199 @@
+/**
+ * @file multipart.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "harness.h"
+#include "multipart.h"
+
+#include <dirent.h> // opendir, readdir
+#include <stdlib.h> // rand_r
+
+#include <fstream>  // std::ifstream
+#include <iterator> // std::istreambuf_iterator
+#include <string>   // std::string
+#include <vector>   // std::vector
+
+#ifndef NRS_TEST_MULTIPART_CORPUS_DIR
+    #define NRS_TEST_MULTIPART_CORPUS_DIR "corpus/multipart"
+#endif
+
+static const std::string k_boundary_ = "----casper-boundary-7MA4YWxkTrZu0gW";
+
+/**
+ * @return A body with \p a_parts, preamble and epilogue.
+ */
+static std::string Body (const std::vector<std::string>& a_parts, const std::string& a_preamble = "", const std::string& a_epilogue = "")
+{
+    std::string body = a_preamble;
+    if ( a_preamble.length() > 0 ) {
+        body += "\r\n";
+    }
+    for ( size_t idx = 0 ; idx < a_parts.size() ; ++idx ) {
+        body += "--" + k_boundary_ + "\r\n";
+        body += "Content-Disposition: form-data; name=\"file\"; filename=\"part-" + std::to_string(idx) + ".bin\"\r\n";
+        body += "Content-Type: application/octet-stream\r\n";
+        body += "\r\n";
+        body += a_parts[idx] + "\r\n";
+    }
+    body += "--" + k_boundary_ + "--" + a_epilogue;
+    return body;
+}
+
+/**
+ * @brief Check that every way of splitting \p a_body reports exactly what parsing it at once does.
+ */
+static void CheckSplits (const std::string& a_boundary, const std::string& a_body)
+{
+    const Multipart whole(a_boundary, a_body);
+    // ... one split, at every position ...
+    for ( size_t at = 1 ; at < a_body.length() ; ++at ) {
+        TEST_CHECK(whole == Multipart(a_boundary, a_body, { at, 0 }));
+    }
+    // ... fixed size chunks, byte by byte included ...
+    for ( size_t chunk = 1 ; chunk <= 17 ; ++chunk ) {
+        TEST_CHECK(whole == Multipart(a_boundary, a_body, { chunk }));
+    }
+}
+
+/**
+ * @return Files of the seed corpus, also used by multipart_fuzz.cc.
+ */
+static std::vector<std::string> Corpus ()
+{
+    std::vector<std::string> files;
+    DIR* dir = opendir(NRS_TEST_MULTIPART_CORPUS_DIR);
+    if ( nullptr == dir ) {
+        return files;
+    }
+    for ( struct dirent* entry = readdir(dir) ; nullptr != entry ; entry = readdir(dir) ) {
+        if ( '.' == entry->d_name[0] ) {
+            continue;
+        }
+        std::ifstream stream(std::string(NRS_TEST_MULTIPART_CORPUS_DIR) + '/' + entry->d_name, std::ios::binary);
+        files.push_back(std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()));
+    }
+    closedir(dir);
+    return files;
+}
+
+int main ()
+{
+    // ... binary data with CRs, LFs and near miss delimiters ...
+    const std::vector<std::string> data = {
+        "hello",
+        "",
+        std::string("\0\r\n\r\r\n-\r\n--\xff", 12),
+        "\r\n--" + k_boundary_.substr(0, k_boundary_.length() - 1) + "X\r\n--" + k_boundary_.substr(0, 5),
+        "line 1\r\nline 2\r\n--not-the-boundary\r\n"
+    };
+    
+    // ... all parts, in order, each with it's own headers ...
+    {
+        const Multipart multipart(k_boundary_, Body(data, "this is the preamble", "\r\nthis is the epilogue"));
+        TEST_CHECK(NGX_DONE == multipart.rv_);
+        TEST_CHECK(true == multipart.done_);
+        TEST_CHECK(data.size() == multipart.parts_.size());
+        for ( size_t idx = 0 ; idx < data.size() && idx < multipart.parts_.size() ; ++idx ) {
+            TEST_CHECK(data[idx] == multipart.parts_[idx].data_);
+            TEST_CHECK(true == multipart.parts_[idx].ended_);
+            TEST_CHECK("Content-Type: application/octet-stream" == multipart.parts_[idx].content_type_);
+            std::string disposition, field, file;
+            TEST_CHECK(NGX_OK == ngx::utls::nrs_ngx_parse_content_disposition(multipart.parts_[idx].content_disposition_, disposition, field, file));
+            TEST_CHECK("form-data" == disposition);
+            TEST_CHECK("part-" + std::to_string(idx) + ".bin" == file);
+        }
+    }
+    
+    // ... same outcome no matter how data is split across nginx buffers ...
+    CheckSplits(k_boundary_, Body(data));
+    CheckSplits(k_boundary_, Body(data, "preamble", "\r\nepilogue"));
+    
+    // ... first delimiter without a leading CRLF or after a preamble, LWSP after a delimiter ...
+    {
+        const Multipart multipart(k_boundary_, "--" + k_boundary_ + " \t\r\n\r\nx\r\n--" + k_boundary_ + "--");
+        TEST_CHECK(NGX_DONE == multipart.rv_ && 1 == multipart.parts_.size() && "x" == multipart.parts_[0].data_);
+    }
+    
+    // ... truncated bodies need more data, they are not done ...
+    {
+        const std::string body = Body(data);
+        for ( size_t length : { static_cast<size_t>(0), static_cast<size_t>(10), body.length() / 2, body.length() - 1 } ) {
+            const Multipart multipart(k_boundary_, body.substr(0, length));
+            TEST_CHECK(NGX_AGAIN == multipart.rv_ && false == multipart.done_);
+        }
+    }
+    
+    // ... malformed ...
+    TEST_CHECK(NGX_ERROR == Multipart(k_boundary_, "--" + k_boundary_ + "X\r\n\r\nx").rv_);
+    TEST_CHECK(NGX_ERROR == Multipart(k_boundary_, "--" + k_boundary_ + "\rX").rv_);
+    TEST_CHECK(NGX_ERROR == Multipart(k_boundary_, "--" + k_boundary_ + "-X").rv_);
+    TEST_CHECK(NGX_ERROR == Multipart(k_boundary_, "--" + k_boundary_ + "\r\n" + std::string(16 * 1024 + 1, 'h')).rv_);
+    
+    // ... boundary must be 1 to 70 characters without CR or LF ...
+    {
+        ngx::utls::nrs_ngx_multipart_body_t body;
+        TEST_CHECK(NGX_ERROR == ngx::utls::nrs_ngx_init_multipart_body(""                   , true , body));
+        TEST_CHECK(NGX_ERROR == ngx::utls::nrs_ngx_init_multipart_body(std::string(71, 'b') , true , body));
+        TEST_CHECK(NGX_ERROR == ngx::utls::nrs_ngx_init_multipart_body("a\rb"               , true , body));
+        TEST_CHECK(NGX_OK    == ngx::utls::nrs_ngx_init_multipart_body(std::string(70, 'b') , true , body));
+        TEST_CHECK(NGX_OK    == ngx::utls::nrs_ngx_init_multipart_body(""                   , false, body));
+    }
+    
+    // ... 'Content-Type' header boundary, quoted or not ...
+    {
+        ngx::utls::nrs_ngx_multipart_header_info_t info;
+        const std::string quoted = "Content-Type: multipart/form-data; boundary=\"a b\"; charset=utf-8";
+        TEST_CHECK(NGX_OK == ngx::utls::nrs_ngx_parse_multipart_content_type(quoted, info));
+        TEST_CHECK("a b" == std::string(reinterpret_cast<const char*>(info.boundary.data), info.boundary.len));
+        const std::string plain = "Content-Type: multipart/form-data; boundary=" + k_boundary_;
+        TEST_CHECK(NGX_OK == ngx::utls::nrs_ngx_parse_multipart_content_type(plain, info));
+        TEST_CHECK(k_boundary_ == std::string(reinterpret_cast<const char*>(info.boundary.data), info.boundary.len));
+        TEST_CHECK(NGX_ERROR == ngx::utls::nrs_ngx_parse_multipart_content_type("Content-Type: text/plain; boundary=x", info));
+    }
+    
+    // ... seed corpus ( see multipart_fuzz.cc ) and random mutations of it ...
+    const std::vector<std::string> corpus = Corpus();
+    TEST_CHECK(corpus.size() > 0);
+    unsigned int seed = 2020;
+    for ( const auto& entry : corpus ) {
+        CheckSplits(k_boundary_, entry);
+        for ( size_t iteration = 0 ; iteration < 200 ; ++iteration ) {
+            std::string mutated = entry;
+            for ( size_t count = 1 + static_cast<size_t>(rand_r(&seed)) % 4 ; count > 0 && mutated.length() > 0 ; --count ) {
+                const size_t at = static_cast<size_t>(rand_r(&seed)) % mutated.length();
+                switch ( rand_r(&seed) % 3 ) {
+                    case 0:
+                        mutated[at] = "\r\n-x"[rand_r(&seed) % 4];
+                        break;
+                    case 1:
+                        mutated.erase(at, 1 + static_cast<size_t>(rand_r(&seed)) % 8);
+                        break;
+                    default:
+                        mutated.insert(at, "\r\n--" + k_boundary_.substr(0, static_cast<size_t>(rand_r(&seed)) % ( k_boundary_.length() + 1 )));
+                        break;
+                }
+            }
+            const Multipart whole(k_boundary_, mutated);
+            TEST_CHECK(whole == Multipart(k_boundary_, mutated, { 1 + static_cast<size_t>(rand_r(&seed)) % 64 }));
+        }
+    }
+    
+    return TEST_RESULT();
+}
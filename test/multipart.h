@@ -0,0 +1,111 @@
+/**
+ * @file multipart.h
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_TEST_MULTIPART_H_
+#define NRS_TEST_MULTIPART_H_
+
+#include "ngx/ngx_utils.h"
+
+#include <string> // std::string
+#include <vector> // std::vector
+
+/**
+ * @brief Everything a multipart body parser reported, so two runs can be compared.
+ */
+class Multipart final
+{
+
+public: // Data Type(s)
+
+    typedef struct {
+        std::string content_disposition_;
+        std::string content_type_;
+        std::string data_;
+        bool        ended_;
+    } Part;
+
+public: // Data
+
+    ngx_int_t         rv_;
+    bool              done_;
+    std::vector<Part> parts_;
+
+public: // Constructor(s) / Destructor
+
+    /**
+     * @brief Parse \p a_body, delivered in chunks of \p a_chunks sizes ( cycled ), 0 means all at once.
+     */
+    Multipart (const std::string& a_boundary, const std::string& a_body, const std::vector<size_t>& a_chunks = { 0 })
+        : rv_(NGX_ERROR), done_(false)
+    {
+        ngx::utls::nrs_ngx_multipart_body_t body;
+        if ( NGX_OK != ngx::utls::nrs_ngx_init_multipart_body(a_boundary, true, body) ) {
+            return;
+        }
+        const ngx::utls::nrs_ngx_multipart_callbacks_t callbacks = {
+            /* on_part_begin_ */ [this] (const ngx::utls::nrs_ngx_multipart_body_t& a_body) -> ngx_int_t {
+                parts_.push_back({ a_body.content_disposition_, a_body.content_type_, "", false });
+                return NGX_OK;
+            },
+            /* on_part_data_ */ [this] (const u_char* a_data, size_t a_length) -> ngx_int_t {
+                parts_.back().data_.append(reinterpret_cast<const char*>(a_data), a_length);
+                return NGX_OK;
+            },
+            /* on_part_end_ */ [this] (const ngx::utls::nrs_ngx_multipart_body_t& /* a_body */) -> ngx_int_t {
+                parts_.back().ended_ = true;
+                return NGX_OK;
+            }
+        };
+        const u_char* data   = reinterpret_cast<const u_char*>(a_body.data());
+        size_t        offset = 0;
+        size_t        idx    = 0;
+        rv_ = NGX_AGAIN;
+        while ( offset < a_body.length() && NGX_AGAIN == rv_ ) {
+            const size_t chunk  = a_chunks[idx++ % a_chunks.size()];
+            const size_t length = ( 0 == chunk || chunk > a_body.length() - offset ? a_body.length() - offset : chunk );
+            rv_     = ngx::utls::nrs_ngx_parse_multipart_body(data + offset, length, body, callbacks);
+            offset += length;
+        }
+        done_ = ( 1 == body.done_ );
+    }
+
+public: // Operator(s) Overloading
+
+    bool operator == (const Multipart& a_other) const
+    {
+        if ( rv_ != a_other.rv_ || done_ != a_other.done_ || parts_.size() != a_other.parts_.size() ) {
+            return false;
+        }
+        for ( size_t idx = 0 ; idx < parts_.size() ; ++idx ) {
+            const Part& lhs = parts_[idx];
+            const Part& rhs = a_other.parts_[idx];
+            if ( lhs.content_disposition_ != rhs.content_disposition_ || lhs.content_type_ != rhs.content_type_
+                || lhs.data_ != rhs.data_ || lhs.ended_ != rhs.ended_ ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+}; // end of class 'Multipart'
+
+#endif // NRS_TEST_MULTIPART_H_
@@ -0,0 +1,79 @@
+/**
+ * @file multipart_bench.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Multipart body parser throughput, run by run.sh only when NRS_TEST_BENCH is set.
+//
+
+#include "ngx/ngx_utils.h"
+
+#include <stdio.h>  // fprintf
+#include <stdlib.h> // atoi, getenv
+
+#include <chrono> // std::chrono
+#include <string> // std::string
+
+int main ()
+{
+    static const std::string k_boundary = "----casper-boundary-7MA4YWxkTrZu0gW";
+    static const size_t      k_buffer   = 64 * 1024; // same as NGX_HTTP_CASPER_BROKER_UL_MODULE_BODY_BUFFER_SIZE
+    
+    const char* env      = getenv("NRS_TEST_BENCH_MB");
+    const size_t size_mb = ( nullptr != env && atoi(env) > 0 ? static_cast<size_t>(atoi(env)) : 1024 );
+    
+    // ... one big part, data with a CR every 64 bytes so the delimiter search can't skip it all at once ...
+    std::string data(k_buffer, 'x');
+    for ( size_t idx = 63 ; idx < data.length() ; idx += 64 ) {
+        data[idx] = '\r';
+    }
+    const std::string head = "--" + k_boundary + "\r\nContent-Disposition: form-data; name=\"file\"; filename=\"big.bin\"\r\nContent-Type: application/octet-stream\r\n\r\n";
+    const std::string tail = "\r\n--" + k_boundary + "--\r\n";
+    
+    size_t received = 0;
+    const ngx::utls::nrs_ngx_multipart_callbacks_t callbacks = {
+        /* on_part_begin_ */ [] (const ngx::utls::nrs_ngx_multipart_body_t&) -> ngx_int_t { return NGX_OK; },
+        /* on_part_data_  */ [&received] (const u_char*, size_t a_length) -> ngx_int_t { received += a_length; return NGX_OK; },
+        /* on_part_end_   */ [] (const ngx::utls::nrs_ngx_multipart_body_t&) -> ngx_int_t { return NGX_OK; }
+    };
+    
+    ngx::utls::nrs_ngx_multipart_body_t body;
+    ngx::utls::nrs_ngx_init_multipart_body(k_boundary, true, body);
+    
+    const size_t count = size_mb * 1024 * 1024 / k_buffer;
+    const auto   start = std::chrono::steady_clock::now();
+    
+    ngx_int_t rv = ngx::utls::nrs_ngx_parse_multipart_body(reinterpret_cast<const u_char*>(head.data()), head.length(), body, callbacks);
+    for ( size_t idx = 0 ; idx < count && NGX_AGAIN == rv ; ++idx ) {
+        rv = ngx::utls::nrs_ngx_parse_multipart_body(reinterpret_cast<const u_char*>(data.data()), data.length(), body, callbacks);
+    }
+    if ( NGX_AGAIN == rv ) {
+        rv = ngx::utls::nrs_ngx_parse_multipart_body(reinterpret_cast<const u_char*>(tail.data()), tail.length(), body, callbacks);
+    }
+    
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    if ( NGX_DONE != rv || received != count * data.length() ) {
+        fprintf(stderr, "multipart_bench: parse failed ( rv %d, " "%zu of %zu byte(s) )\n", static_cast<int>(rv), received, count * data.length());
+        return 1;
+    }
+    fprintf(stdout, "multipart_bench: " "%zu MiB in %.3f s - %.2f GiB/s\n", size_mb, seconds, ( received / seconds ) / ( 1024.0 * 1024.0 * 1024.0 ));
+    return 0;
+}
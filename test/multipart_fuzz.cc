@@ -0,0 +1,55 @@
+/**
+ * @file multipart_fuzz.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// libFuzzer target, seeded by test/corpus/multipart ( not built by run.sh ):
+//
+// clang++ -std=c++11 -g -O1 -fsanitize=fuzzer,address -I test/stubs -I src -I test -I /usr/include/jsoncpp \
+//     -o multipart_fuzz test/multipart_fuzz.cc src/ngx/ngx_utils.cc -ljsoncpp
+// ./multipart_fuzz test/corpus/multipart
+//
+
+#include "multipart.h"
+
+#include <stdint.h> // uint8_t
+#include <stdlib.h> // abort
+
+#include <string> // std::string
+
+extern "C" int LLVMFuzzerTestOneInput (const uint8_t* a_data, size_t a_size)
+{
+    static const std::string k_boundary = "----casper-boundary-7MA4YWxkTrZu0gW";
+    
+    if ( 0 == a_size ) {
+        return 0;
+    }
+    
+    // ... first byte picks how the body is split across buffers ...
+    const size_t      chunk = 1 + a_data[0];
+    const std::string body  = std::string(reinterpret_cast<const char*>(a_data + 1), a_size - 1);
+    
+    // ... whatever the input, splitting it must not change what is reported ...
+    if ( false == ( Multipart(k_boundary, body) == Multipart(k_boundary, body, { chunk }) ) ) {
+        abort();
+    }
+    
+    return 0;
+}
@@ -0,0 +1,48 @@
+#!/bin/sh
+#
+# Build and run the standalone checks - no nginx or event loop required.
+#
+# Usage: test/run.sh [ CXX ]
+#
+
+set -e
+
+TEST_DIR=$(cd "$(dirname "$0")" && pwd)
+SRC_DIR="${TEST_DIR}/../src"
+OUT_DIR="${TEST_DIR}/.build"
+CXX=${1:-${CXX:-c++}}
+CXXFLAGS="-std=c++11 -O2 -Wall -I${TEST_DIR}/stubs -I${SRC_DIR} -I${TEST_DIR}"
+
+mkdir -p "${OUT_DIR}"
+
+FAILED=0
+
+# name | extra sources | extra flags
+run () {
+    NAME=$1; shift
+    SOURCES=$1; shift
+    ${CXX} ${CXXFLAGS} -o "${OUT_DIR}/${NAME}" "${TEST_DIR}/${NAME}.cc" ${SOURCES} "$@"
+    if ! "${OUT_DIR}/${NAME}" ; then
+        FAILED=1
+    fi
+}
+
+run module_allocations ""
+run in_headers         "${SRC_DIR}/ngx/casper/broker/in_headers.cc"
+run id_matcher         "${SRC_DIR}/ngx/casper/broker/cdn-common/id_matcher.cc"
+run ast_program        "${SRC_DIR}/ngx/casper/broker/cdn-common/ast/program.cc"
+run tracker            ""
+run digest             "${SRC_DIR}/ngx/casper/broker/cdn-common/digest.cc" -lcrypto
+run xattrs_batch       "${SRC_DIR}/ngx/casper/broker/cdn-common/xattrs_batch.cc" -DNRS_TEST_XATTRS_DIR="\"${OUT_DIR}\""
+run worker_pool        "${SRC_DIR}/ngx/casper/broker/worker_pool.cc" -pthread
+run signer             "${SRC_DIR}/ngx/casper/broker/jwt/encoder/signer.cc" -I/usr/include/jsoncpp -ljsoncpp -lcrypto -Wno-deprecated-declarations -DNRS_TEST_SIGNER_DIR="\"${OUT_DIR}\""
+run multipart          "${SRC_DIR}/ngx/ngx_utils.cc" -I/usr/include/jsoncpp -ljsoncpp -DNRS_TEST_MULTIPART_CORPUS_DIR="\"${TEST_DIR}/corpus/multipart\""
+
+# ... benchmarks, on demand ...
+if [ -n "${NRS_TEST_BENCH}" ] ; then
+    run multipart_bench "${SRC_DIR}/ngx/ngx_utils.cc" -I/usr/include/jsoncpp -ljsoncpp
+    NRS_TEST_BENCH_DIR=${NRS_TEST_BENCH_DIR:-${OUT_DIR}} ; export NRS_TEST_BENCH_DIR
+    run digest_bench    "${SRC_DIR}/ngx/casper/broker/cdn-common/digest.cc" -lcrypto
+fi
+
+exit ${FAILED}
@@ -0,0 +1,314 @@
+/**
+ * @file signer.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "harness.h"
+
+#include "ngx/casper/broker/jwt/encoder/signer.h"
+
+#include <openssl/bn.h>
+#include <openssl/ecdsa.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+
+#include <stdio.h>  // rename
+#include <unistd.h> // unlink
+
+#include <chrono> // std::chrono
+#include <string> // std::string
+#include <vector> // std::vector
+
+#ifndef NRS_TEST_SIGNER_DIR
+    #define NRS_TEST_SIGNER_DIR "/tmp"
+#endif
+
+typedef ngx::casper::broker::jwt::encoder::Signer Signer;
+
+/**
+ * @return New private key of type \p a_type, an EC curve name when \p a_curve is set.
+ */
+static EVP_PKEY* Generate (const char* const a_type, const char* const a_curve, const unsigned int a_bits)
+{
+    EVP_PKEY* pkey = nullptr;
+    if ( nullptr != a_curve ) {
+        pkey = EVP_PKEY_Q_keygen(nullptr, nullptr, a_type, a_curve);
+    } else if ( 0 != a_bits ) {
+        pkey = EVP_PKEY_Q_keygen(nullptr, nullptr, a_type, static_cast<size_t>(a_bits));
+    } else {
+        pkey = EVP_PKEY_Q_keygen(nullptr, nullptr, a_type);
+    }
+    return pkey;
+}
+
+/**
+ * @brief Write \p a_pkey, PEM encoded, to \p a_uri ( through a rename, so a rewrite is a new file ).
+ */
+static bool Write (EVP_PKEY* a_pkey, const std::string& a_uri)
+{
+    const std::string tmp = a_uri + ".tmp";
+    FILE* file = fopen(tmp.c_str(), "w");
+    if ( nullptr == file ) {
+        return false;
+    }
+    const bool written = ( 1 == PEM_write_PrivateKey(file, a_pkey, nullptr, nullptr, 0, nullptr, nullptr) );
+    fclose(file);
+    return ( true == written && 0 == rename(tmp.c_str(), a_uri.c_str()) );
+}
+
+/**
+ * @return \p a_data base64url decoded, padding not expected.
+ */
+static std::string B64URLDecode (const std::string& a_data)
+{
+    static const std::string k_alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    std::string decoded;
+    uint32_t    v    = 0;
+    int         bits = 0;
+    for ( const char c : a_data ) {
+        const size_t idx = k_alphabet.find(c);
+        if ( std::string::npos == idx ) {
+            return "<invalid>";
+        }
+        v     = ( v << 6 ) | static_cast<uint32_t>(idx);
+        bits += 6;
+        if ( bits >= 8 ) {
+            bits -= 8;
+            decoded += static_cast<char>(( v >> bits ) & 0xFF);
+        }
+    }
+    return decoded;
+}
+
+/**
+ * @brief Split a JWT and verify it's signature with \p a_pkey.
+ *
+ * @param o_header  Decoded header.
+ * @param o_payload Decoded payload.
+ *
+ * @return True when signature is valid.
+ */
+static bool Verify (const std::string& a_jwt, EVP_PKEY* a_pkey, const EVP_MD* a_md, const bool a_raw_ecdsa,
+                    std::string& o_header, std::string& o_payload)
+{
+    const size_t first = a_jwt.find('.');
+    const size_t last  = a_jwt.rfind('.');
+    if ( std::string::npos == first || first == last || std::string::npos != a_jwt.find('=') ) {
+        return false;
+    }
+    o_header  = B64URLDecode(a_jwt.substr(0, first));
+    o_payload = B64URLDecode(a_jwt.substr(first + 1, last - first - 1));
+
+    const std::string input     = a_jwt.substr(0, last);
+    std::string       signature = B64URLDecode(a_jwt.substr(last + 1));
+
+    // ... r || s back to DER ...
+    if ( true == a_raw_ecdsa ) {
+        if ( 64 != signature.length() ) {
+            return false;
+        }
+        ECDSA_SIG* ec_sig = ECDSA_SIG_new();
+        ECDSA_SIG_set0(ec_sig,
+                       BN_bin2bn(reinterpret_cast<const unsigned char*>(signature.data()), 32, nullptr),
+                       BN_bin2bn(reinterpret_cast<const unsigned char*>(signature.data()) + 32, 32, nullptr)
+        );
+        unsigned char* der    = nullptr;
+        const int      length = i2d_ECDSA_SIG(ec_sig, &der);
+        signature.assign(reinterpret_cast<const char*>(der), static_cast<size_t>(length));
+        OPENSSL_free(der);
+        ECDSA_SIG_free(ec_sig);
+    }
+
+    EVP_MD_CTX* ctx   = EVP_MD_CTX_new();
+    const bool  valid = (
+        1 == EVP_DigestVerifyInit(ctx, nullptr, a_md, nullptr, a_pkey)
+            &&
+        1 == EVP_DigestVerify(ctx, reinterpret_cast<const unsigned char*>(signature.data()), signature.length(),
+                              reinterpret_cast<const unsigned char*>(input.data()), input.length())
+    );
+    EVP_MD_CTX_free(ctx);
+    return valid;
+}
+
+/**
+ * @brief Sign as the encoder did before keys were resident: read and parse the PEM file, new context, on every token.
+ */
+static size_t SignPerRequest (const std::string& a_uri, const EVP_MD* a_md, const std::string& a_input)
+{
+    BIO*      bio  = BIO_new_file(a_uri.c_str(), "r");
+    EVP_PKEY* pkey = PEM_read_bio_PrivateKey(bio, nullptr, nullptr, nullptr);
+    BIO_free(bio);
+    EVP_MD_CTX*                ctx    = EVP_MD_CTX_new();
+    size_t                     length = 0;
+    std::vector<unsigned char> signature;
+    if ( 1 == EVP_DigestSignInit(ctx, nullptr, a_md, nullptr, pkey) && 1 == EVP_DigestSign(ctx, nullptr, &length, reinterpret_cast<const unsigned char*>(a_input.data()), a_input.length()) ) {
+        signature.resize(length);
+        if ( 1 != EVP_DigestSign(ctx, signature.data(), &length, reinterpret_cast<const unsigned char*>(a_input.data()), a_input.length()) ) {
+            length = 0;
+        }
+    }
+    EVP_MD_CTX_free(ctx);
+    EVP_PKEY_free(pkey);
+    return length;
+}
+
+/**
+ * @return Microseconds per call of \p a_function, \p a_count calls.
+ */
+template <typename F> static double Time (const size_t a_count, F a_function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for ( size_t idx = 0 ; idx < a_count ; ++idx ) {
+        a_function();
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / a_count;
+}
+
+int main ()
+{
+    const std::string dir   = NRS_TEST_SIGNER_DIR;
+    const std::string rsa   = dir + "/signer-rsa.pem";
+    const std::string p256  = dir + "/signer-p256.pem";
+    const std::string p384  = dir + "/signer-p384.pem";
+    const std::string ed    = dir + "/signer-ed25519.pem";
+
+    EVP_PKEY* rsa_key     = Generate("RSA", nullptr, 2048);
+    EVP_PKEY* rsa_key_2   = Generate("RSA", nullptr, 2048);
+    EVP_PKEY* p256_key    = Generate("EC", "P-256", 0);
+    EVP_PKEY* p384_key    = Generate("EC", "P-384", 0);
+    EVP_PKEY* ed_key      = Generate("ED25519", nullptr, 0);
+    TEST_CHECK(nullptr != rsa_key && nullptr != rsa_key_2 && nullptr != p256_key && nullptr != p384_key && nullptr != ed_key);
+    TEST_CHECK(true == Write(rsa_key, rsa));
+    TEST_CHECK(true == Write(p256_key, p256));
+    TEST_CHECK(true == Write(p384_key, p384));
+    TEST_CHECK(true == Write(ed_key, ed));
+
+    // ... names ...
+    Signer::Algorithm algorithm = Signer::Algorithm::RS256;
+    TEST_CHECK(true == Signer::ParseAlgorithm("RS384", algorithm) && Signer::Algorithm::RS384 == algorithm);
+    TEST_CHECK(true == Signer::ParseAlgorithm("ES256", algorithm) && Signer::Algorithm::ES256 == algorithm);
+    TEST_CHECK(true == Signer::ParseAlgorithm("EdDSA", algorithm) && Signer::Algorithm::EdDSA == algorithm);
+    TEST_CHECK(false == Signer::ParseAlgorithm("HS256", algorithm));
+    TEST_CHECK(false == Signer::ParseAlgorithm("none", algorithm));
+    TEST_CHECK(false == Signer::ParseAlgorithm("es256", algorithm));
+    TEST_CHECK(true == Signer::IsRegisteredClaim("exp") && true == Signer::IsRegisteredClaim("iss"));
+    TEST_CHECK(false == Signer::IsRegisteredClaim("role"));
+
+    Signer& signer = Signer::GetInstance();
+    signer.Startup();
+
+    Json::Value payload = Json::Value(Json::ValueType::objectValue);
+    payload["iss"]  = "broker";
+    payload["iat"]  = 1000;
+    payload["role"] = "admin";
+    Json::FastWriter writer;
+    writer.omitEndingLineFeed();
+    const std::string expected_payload = writer.write(payload);
+
+    // ... every algorithm, verified with the public key ...
+    {
+        const struct {
+            const char*       name_;
+            Signer::Algorithm algorithm_;
+            const std::string uri_;
+            EVP_PKEY*         pkey_;
+            const EVP_MD*     md_;
+            bool              raw_ecdsa_;
+        } k_cases[] = {
+            { "RS256", Signer::Algorithm::RS256, rsa , rsa_key , EVP_sha256(), false },
+            { "RS384", Signer::Algorithm::RS384, rsa , rsa_key , EVP_sha384(), false },
+            { "RS512", Signer::Algorithm::RS512, rsa , rsa_key , EVP_sha512(), false },
+            { "ES256", Signer::Algorithm::ES256, p256, p256_key, EVP_sha256(), true  },
+            { "EdDSA", Signer::Algorithm::EdDSA, ed  , ed_key  , nullptr     , false }
+        };
+        for ( const auto& entry : k_cases ) {
+            std::string header, decoded;
+            const std::string jwt = signer.Sign(entry.algorithm_, entry.uri_, payload, 1000);
+            TEST_CHECK(true == Verify(jwt, entry.pkey_, entry.md_, entry.raw_ecdsa_, header, decoded));
+            TEST_CHECK(std::string("{\"alg\":\"") + entry.name_ + "\",\"typ\":\"JWT\"}" == header);
+            TEST_CHECK(expected_payload == decoded);
+            // ... signature must not verify with an other key ...
+            if ( Signer::Algorithm::RS256 == entry.algorithm_ ) {
+                TEST_CHECK(false == Verify(jwt, rsa_key_2, entry.md_, false, header, decoded));
+            }
+        }
+    }
+
+    // ... key / algorithm mismatches ...
+    TEST_CHECK_THROWS(signer.Sign(Signer::Algorithm::ES256, p384, payload, 1000));
+    TEST_CHECK_THROWS(signer.Sign(Signer::Algorithm::ES256, rsa , payload, 1000));
+    TEST_CHECK_THROWS(signer.Sign(Signer::Algorithm::RS256, p256, payload, 1000));
+    TEST_CHECK_THROWS(signer.Sign(Signer::Algorithm::EdDSA, rsa , payload, 1000));
+    TEST_CHECK_THROWS(signer.Sign(Signer::Algorithm::RS256, dir + "/signer-missing.pem", payload, 1000));
+
+    // ... same file, other algorithm, is checked on it's own ...
+    {
+        std::string header, decoded;
+        TEST_CHECK_THROWS(signer.Sign(Signer::Algorithm::EdDSA, p256, payload, 1000));
+        TEST_CHECK(true == Verify(signer.Sign(Signer::Algorithm::ES256, p256, payload, 1000), p256_key, EVP_sha256(), true, header, decoded));
+    }
+
+    // ... key rotation: not seen within the same second, picked up on the next one ...
+    {
+        std::string header, decoded;
+        TEST_CHECK(true == Write(rsa_key_2, rsa));
+        const std::string same = signer.Sign(Signer::Algorithm::RS256, rsa, payload, 1000);
+        TEST_CHECK(true == Verify(same, rsa_key, EVP_sha256(), false, header, decoded));
+        const std::string next = signer.Sign(Signer::Algorithm::RS256, rsa, payload, 1001);
+        TEST_CHECK(true  == Verify(next, rsa_key_2, EVP_sha256(), false, header, decoded));
+        TEST_CHECK(false == Verify(next, rsa_key  , EVP_sha256(), false, header, decoded));
+        // ... gone: last good key must not be used silently ...
+        TEST_CHECK(0 == unlink(rsa.c_str()));
+        TEST_CHECK_THROWS(signer.Sign(Signer::Algorithm::RS256, rsa, payload, 1002));
+        TEST_CHECK(true == Write(rsa_key, rsa));
+    }
+
+    // ... timing: key read and parsed on every token, as the encoder did, vs resident keys ...
+    {
+        const size_t      count = 200;
+        const std::string input = "eyJhbGciOiJSUzI1NiIsInR5cCI6IkpXVCJ9." + expected_payload;
+        size_t            bytes = 0;
+        int64_t           now   = 2000;
+
+        const double rs256_load = Time(count, [&] () { bytes += SignPerRequest(rsa, EVP_sha256(), input); });
+        const double rs256      = Time(count, [&] () { bytes += signer.Sign(Signer::Algorithm::RS256, rsa , payload, ++now).length(); });
+        const double es256_load = Time(count, [&] () { bytes += SignPerRequest(p256, EVP_sha256(), input); });
+        const double es256      = Time(count, [&] () { bytes += signer.Sign(Signer::Algorithm::ES256, p256, payload, ++now).length(); });
+        const double eddsa_load = Time(count, [&] () { bytes += SignPerRequest(ed, nullptr, input); });
+        const double eddsa      = Time(count, [&] () { bytes += signer.Sign(Signer::Algorithm::EdDSA, ed  , payload, ++now).length(); });
+
+        TEST_CHECK(bytes > 0);
+        fprintf(stdout, "Signer: RS256 %.1f us/token ( per-request key load %.1f ), ES256 %.1f ( %.1f ), EdDSA %.1f ( %.1f )\n",
+                rs256, rs256_load, es256, es256_load, eddsa, eddsa_load);
+    }
+
+    signer.Shutdown();
+
+    EVP_PKEY_free(rsa_key);
+    EVP_PKEY_free(rsa_key_2);
+    EVP_PKEY_free(p256_key);
+    EVP_PKEY_free(p384_key);
+    EVP_PKEY_free(ed_key);
+    unlink(rsa.c_str());
+    unlink(p256.c_str());
+    unlink(p384.c_str());
+    unlink(ed.c_str());
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,74 @@
+/**
+ * @file tracker.h - test stub
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_TEST_STUBS_CC_ERRORS_TRACKER_H_
+#define NRS_TEST_STUBS_CC_ERRORS_TRACKER_H_
+
+//
+// Counts live instances, so checks can tell when a tracker deleted it's errors.
+//
+
+#include <stddef.h> // size_t
+
+namespace cc
+{
+
+    namespace errors
+    {
+
+        class Tracker
+        {
+
+        public: // Static Data
+
+            static size_t s_alive_;
+
+        private: // Data
+
+            size_t count_;
+
+        public: // Constructor(s) / Destructor
+
+            Tracker (const size_t a_count = 0)
+                : count_(a_count)
+            {
+                s_alive_++;
+            }
+            virtual ~Tracker ()
+            {
+                s_alive_--;
+            }
+
+        public: // Method(s) / Function(s)
+
+            size_t Count () const
+            {
+                return count_;
+            }
+
+        }; // end of class 'Tracker'
+
+    } // end of namespace 'errors'
+
+} // end of namespace 'cc'
+
+#endif // NRS_TEST_STUBS_CC_ERRORS_TRACKER_H_
@@ -0,0 +1,74 @@
+/**
+ * @file exception.h - test stub
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_TEST_STUBS_CC_EXCEPTION_H_
+#define NRS_TEST_STUBS_CC_EXCEPTION_H_
+
+//
+// Just enough of casper-connectors' exception for the standalone checks.
+//
+
+#include <stdarg.h> // va_list
+#include <stdio.h>  // vsnprintf
+
+#include <exception> // std::exception
+#include <string>    // std::string
+
+namespace cc
+{
+
+    class Exception : public std::exception
+    {
+
+    private: // Data
+
+        std::string what_;
+
+    public: // Constructor(s) / Destructor
+
+        Exception (const char* const a_format, ...) __attribute__((format(printf, 2, 3)))
+        {
+            char    buffer[1024];
+            va_list args;
+            va_start(args, a_format);
+            vsnprintf(buffer, sizeof(buffer), a_format, args);
+            va_end(args);
+            what_ = buffer;
+        }
+
+        virtual ~Exception ()
+        {
+            /* empty */
+        }
+
+    public: // Overridden Method(s) / Function(s) - from std::exception
+
+        virtual const char* what () const throw ()
+        {
+            return what_.c_str();
+        }
+
+    }; // end of class 'Exception'
+
+} // end of namespace 'cc'
+
+#endif // NRS_TEST_STUBS_CC_EXCEPTION_H_
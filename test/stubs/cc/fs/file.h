@@ -0,0 +1,137 @@
+/**
+ * @file file.h - test stub
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_TEST_STUBS_CC_FS_FILE_H_
+#define NRS_TEST_STUBS_CC_FS_FILE_H_
+
+//
+// casper-connectors' XAttr interface on Linux xattr syscalls, counting every syscall made.
+//
+
+#include <sys/types.h>
+#include <sys/xattr.h> // listxattr, getxattr, setxattr, removexattr
+#include <errno.h>     // errno, ENODATA
+#include <string.h>    // strlen
+
+#include <functional> // std::function
+#include <string>     // std::string
+#include <vector>     // std::vector
+
+#include "cc/exception.h"
+
+namespace cc
+{
+
+    namespace fs
+    {
+
+        namespace file
+        {
+
+            class XAttr
+            {
+
+            public: // Static Data
+
+                static size_t s_syscalls_;
+
+            private: // Data
+
+                const std::string uri_;
+
+            public: // Constructor(s) / Destructor
+
+                XAttr (const std::string& a_uri)
+                    : uri_(a_uri)
+                {
+                    /* empty */
+                }
+                virtual ~XAttr ()
+                {
+                    /* empty */
+                }
+
+            public: // Method(s) / Function(s)
+
+                bool Exists (const std::string& a_name) const
+                {
+                    s_syscalls_++;
+                    return ( getxattr(uri_.c_str(), a_name.c_str(), nullptr, 0) >= 0 );
+                }
+
+                void Get (const std::string& a_name, std::string& o_value) const
+                {
+                    s_syscalls_++;
+                    const ssize_t size = getxattr(uri_.c_str(), a_name.c_str(), nullptr, 0);
+                    if ( size < 0 ) {
+                        throw ::cc::Exception("Unable to read attribute '%s'!", a_name.c_str());
+                    }
+                    std::vector<char> value(static_cast<size_t>(size) + 1, 0);
+                    s_syscalls_++;
+                    if ( getxattr(uri_.c_str(), a_name.c_str(), value.data(), static_cast<size_t>(size)) != size ) {
+                        throw ::cc::Exception("Unable to read attribute '%s'!", a_name.c_str());
+                    }
+                    o_value.assign(value.data(), static_cast<size_t>(size));
+                }
+
+                void Set (const std::string& a_name, const std::string& a_value)
+                {
+                    s_syscalls_++;
+                    if ( 0 != setxattr(uri_.c_str(), a_name.c_str(), a_value.c_str(), a_value.length(), 0) ) {
+                        throw ::cc::Exception("Unable to write attribute '%s'!", a_name.c_str());
+                    }
+                }
+
+                void Remove (const std::string& a_name)
+                {
+                    s_syscalls_++;
+                    if ( 0 != removexattr(uri_.c_str(), a_name.c_str()) && ENODATA != errno ) {
+                        throw ::cc::Exception("Unable to remove attribute '%s'!", a_name.c_str());
+                    }
+                }
+
+                void Iterate (const std::function<void(const char* const a_name, const char* const a_value)>& a_callback) const
+                {
+                    s_syscalls_++;
+                    const ssize_t size = listxattr(uri_.c_str(), nullptr, 0);
+                    if ( size <= 0 ) {
+                        return;
+                    }
+                    std::vector<char> names(static_cast<size_t>(size), 0);
+                    s_syscalls_++;
+                    const ssize_t length = listxattr(uri_.c_str(), names.data(), names.size());
+                    std::string   value;
+                    for ( ssize_t offset = 0 ; offset < length ; offset += static_cast<ssize_t>(strlen(names.data() + offset)) + 1 ) {
+                        Get(names.data() + offset, value);
+                        a_callback(names.data() + offset, value.c_str());
+                    }
+                }
+
+            }; // end of class 'XAttr'
+
+        } // end of namespace 'file'
+
+    } // end of namespace 'fs'
+
+} // end of namespace 'cc'
+
+#endif // NRS_TEST_STUBS_CC_FS_FILE_H_
@@ -0,0 +1,92 @@
+/**
+ * @file md5.h - test stub
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_TEST_STUBS_CC_HASH_MD5_H_
+#define NRS_TEST_STUBS_CC_HASH_MD5_H_
+
+//
+// casper-connectors' MD5 interface, backed by OpenSSL: lowercase hex on Finalize.
+//
+
+#include <openssl/evp.h>
+
+#include <stddef.h> // size_t
+#include <string>   // std::string
+
+namespace cc
+{
+
+    namespace hash
+    {
+
+        class MD5
+        {
+
+        private: // Data
+
+            EVP_MD_CTX* ctx_;
+
+        public: // Constructor(s) / Destructor
+
+            MD5 ()
+                : ctx_(EVP_MD_CTX_new())
+            {
+                /* empty */
+            }
+            virtual ~MD5 ()
+            {
+                EVP_MD_CTX_free(ctx_);
+            }
+
+        public: // Method(s) / Function(s)
+
+            void Initialize ()
+            {
+                EVP_DigestInit_ex(ctx_, EVP_md5(), nullptr);
+            }
+
+            void Update (const unsigned char* a_data, const size_t a_length)
+            {
+                EVP_DigestUpdate(ctx_, a_data, a_length);
+            }
+
+            std::string Finalize ()
+            {
+                static const char k_hex [] = "0123456789abcdef";
+                unsigned char value[EVP_MAX_MD_SIZE];
+                unsigned int  length = 0;
+                EVP_DigestFinal_ex(ctx_, value, &length);
+                std::string rv;
+                for ( unsigned int idx = 0 ; idx < length ; ++idx ) {
+                    rv += k_hex[( value[idx] >> 4 ) & 0x0F];
+                    rv += k_hex[value[idx] & 0x0F];
+                }
+                return rv;
+            }
+
+        }; // end of class 'MD5'
+
+    } // end of namespace 'hash'
+
+} // end of namespace 'cc'
+
+#endif // NRS_TEST_STUBS_CC_HASH_MD5_H_
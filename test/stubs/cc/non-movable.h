@@ -0,0 +1,56 @@
+/**
+ * @file non-movable.h - test stub
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_TEST_STUBS_CC_NON_MOVABLE_H_
+#define NRS_TEST_STUBS_CC_NON_MOVABLE_H_
+
+//
+// Same contract as casper-connectors' base class.
+//
+
+namespace cc
+{
+
+    class NonMovable
+    {
+
+    protected: // Constructor(s) / Destructor
+
+        NonMovable ()
+        {
+            /* empty */
+        }
+        virtual ~NonMovable ()
+        {
+            /* empty */
+        }
+
+    private: // Operator(s)
+
+        NonMovable (NonMovable&&) = delete;
+        NonMovable& operator= (NonMovable&&) = delete;
+
+    }; // end of class 'NonMovable'
+
+} // end of namespace 'cc'
+
+#endif // NRS_TEST_STUBS_CC_NON_MOVABLE_H_
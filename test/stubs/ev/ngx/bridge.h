@@ -0,0 +1,86 @@
+/**
+ * @file bridge.h - test stub
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_TEST_STUBS_EV_NGX_BRIDGE_H_
+#define NRS_TEST_STUBS_EV_NGX_BRIDGE_H_
+
+//
+// Main thread callbacks are queued and only run when a check calls Drain().
+//
+
+#include <deque>      // std::deque
+#include <functional> // std::function
+#include <mutex>      // std::mutex
+
+namespace ev
+{
+
+    namespace ngx
+    {
+
+        class Bridge final
+        {
+
+        private: // Data
+
+            std::mutex                        mutex_;
+            std::deque<std::function<void()>> queue_;
+
+        public: // Static Method(s) / Function(s)
+
+            static Bridge& GetInstance ()
+            {
+                static Bridge s_instance;
+                return s_instance;
+            }
+
+        public: // Method(s) / Function(s)
+
+            void CallOnMainThread (const std::function<void()>& a_callback)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queue_.push_back(a_callback);
+            }
+
+            /**
+             * @return Number of callbacks called.
+             */
+            size_t Drain ()
+            {
+                std::deque<std::function<void()>> queue;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    queue.swap(queue_);
+                }
+                for ( auto& callback : queue ) {
+                    callback();
+                }
+                return queue.size();
+            }
+
+        }; // end of class 'Bridge'
+
+    } // end of namespace 'ngx'
+
+} // end of namespace 'ev'
+
+#endif // NRS_TEST_STUBS_EV_NGX_BRIDGE_H_
@@ -0,0 +1,165 @@
+/**
+ * @file includes.h - test stub
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_TEST_STUBS_EV_NGX_INCLUDES_H_
+#define NRS_TEST_STUBS_EV_NGX_INCLUDES_H_
+
+//
+// Just enough of nginx's types and constants for the standalone checks.
+//
+
+#include <stdint.h> // uintptr_t, intptr_t
+#include <stddef.h> // size_t
+#include <ctype.h>  // tolower
+#include <errno.h>  // errno
+#include <stdlib.h> // malloc, calloc
+#include <string.h> // memchr, memcmp, memcpy, strcasestr
+
+typedef uintptr_t ngx_uint_t;
+typedef intptr_t  ngx_int_t;
+
+#define NGX_OK          0
+#define NGX_ERROR      -1
+#define NGX_AGAIN      -2
+#define NGX_DONE       -4
+#define NGX_DECLINED   -5
+
+#define CRLF           "\r\n"
+
+#define NGX_HTTP_SPECIAL_RESPONSE      300
+#define NGX_HTTP_INTERNAL_SERVER_ERROR 500
+
+#define NGX_UNESCAPE_URI 1
+
+#define ngx_errno                      errno
+#define ngx_max(a_val1, a_val2)        ( ( a_val1 < a_val2 ) ? ( a_val2 ) : ( a_val1 ) )
+#define ngx_memcpy(a_dst, a_src, a_n)  (void) memcpy(a_dst, a_src, a_n)
+#define ngx_base64_decoded_length(a_len) ( ( ( a_len + 3 ) / 4 ) * 3 )
+
+#define NGX_HTTP_UNKNOWN   0x0001
+#define NGX_HTTP_GET       0x0002
+#define NGX_HTTP_HEAD      0x0004
+#define NGX_HTTP_POST      0x0008
+#define NGX_HTTP_PUT       0x0010
+#define NGX_HTTP_DELETE    0x0020
+#define NGX_HTTP_OPTIONS   0x0200
+#define NGX_HTTP_PATCH     0x4000
+
+typedef unsigned char u_char;
+
+typedef struct {
+    size_t  len;
+    u_char* data;
+} ngx_str_t;
+
+typedef struct ngx_table_elt_s ngx_table_elt_t;
+struct ngx_table_elt_s {
+    ngx_uint_t       hash;
+    ngx_str_t        key;
+    ngx_str_t        value;
+    u_char*          lowcase_key;
+    ngx_table_elt_t* next;
+};
+
+typedef struct ngx_list_part_s ngx_list_part_t;
+struct ngx_list_part_s {
+    void*            elts;
+    ngx_uint_t       nelts;
+    ngx_list_part_t* next;
+};
+
+typedef struct {
+    ngx_list_part_t* last;
+    ngx_list_part_t  part;
+} ngx_list_t;
+
+typedef struct {
+    void*      elts;
+    ngx_uint_t nelts;
+    size_t     size;
+    ngx_uint_t nalloc;
+    void*      pool;
+} ngx_array_t;
+
+typedef struct ngx_pool_s ngx_pool_t;
+
+typedef struct {
+    ngx_str_t value;
+} ngx_http_complex_value_t;
+
+typedef struct {
+    ngx_list_t headers;
+} ngx_http_headers_in_t;
+
+typedef struct {
+    ngx_list_t headers;
+    ngx_uint_t status;
+    off_t      content_length_n;
+} ngx_http_headers_out_t;
+
+typedef struct ngx_http_request_s ngx_http_request_t;
+struct ngx_http_request_s {
+    ngx_pool_t*            pool;
+    ngx_str_t              uri;
+    ngx_http_headers_in_t  headers_in;
+    ngx_http_headers_out_t headers_out;
+    unsigned               header_only:1;
+};
+
+//
+// nginx functions referenced by ngx_utils.cc - the standalone checks don't reach them.
+//
+
+static inline void* ngx_palloc  (ngx_pool_t*, size_t a_size) { return malloc(a_size); }
+static inline void* ngx_pnalloc (ngx_pool_t*, size_t a_size) { return malloc(a_size); }
+static inline void* ngx_pcalloc (ngx_pool_t*, size_t a_size) { return calloc(1, a_size); }
+static inline void* ngx_list_push (ngx_list_t*) { return NULL; }
+
+static inline ngx_int_t ngx_http_send_header    (ngx_http_request_t*) { return NGX_ERROR; }
+static inline ngx_int_t ngx_http_complex_value  (ngx_http_request_t*, ngx_http_complex_value_t*, ngx_str_t*) { return NGX_ERROR; }
+static inline ngx_int_t ngx_http_arg            (ngx_http_request_t*, u_char*, size_t, ngx_str_t*) { return NGX_DECLINED; }
+static inline ngx_int_t ngx_decode_base64       (ngx_str_t*, ngx_str_t*) { return NGX_ERROR; }
+static inline void      ngx_unescape_uri        (u_char**, u_char**, size_t, ngx_uint_t) {}
+
+static inline u_char* ngx_strlchr (u_char* a_p, u_char* a_last, u_char a_c)
+{
+    return reinterpret_cast<u_char*>(memchr(a_p, a_c, static_cast<size_t>(a_last - a_p)));
+}
+
+static inline u_char* ngx_strlcasestrn (u_char*, u_char*, u_char*, size_t) { return NULL; }
+
+static inline ngx_int_t ngx_strncasecmp (const u_char* a_s1, const u_char* a_s2, size_t a_n)
+{
+    for ( ; a_n > 0 ; --a_n, ++a_s1, ++a_s2 ) {
+        const int c1 = tolower(*a_s1);
+        const int c2 = tolower(*a_s2);
+        if ( c1 != c2 ) {
+            return c1 - c2;
+        }
+        if ( 0 == c1 ) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+#endif // NRS_TEST_STUBS_EV_NGX_INCLUDES_H_
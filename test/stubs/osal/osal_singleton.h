@@ -0,0 +1,64 @@
+/**
+ * @file osal_singleton.h - test stub
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NRS_TEST_STUBS_OSAL_OSAL_SINGLETON_H_
+#define NRS_TEST_STUBS_OSAL_OSAL_SINGLETON_H_
+
+//
+// Just enough of osal's singleton for the standalone checks.
+//
+
+namespace osal
+{
+
+    template <class T> class Initializer
+    {
+
+    public: // Constructor(s) / Destructor
+
+        Initializer (T& /* a_instance */)
+        {
+            /* empty */
+        }
+        virtual ~Initializer ()
+        {
+            /* empty */
+        }
+
+    }; // end of class 'Initializer'
+
+    template <class T, class I> class Singleton
+    {
+
+    public: // Static Method(s) / Function(s)
+
+        static T& GetInstance ()
+        {
+            static T s_instance;
+            return s_instance;
+        }
+
+    }; // end of class 'Singleton'
+
+} // end of namespace 'osal'
+
+#endif // NRS_TEST_STUBS_OSAL_OSAL_SINGLETON_H_
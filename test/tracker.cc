@@ -0,0 +1,275 @@
+/**
+ * @file tracker.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "harness.h"
+
+#include "ngx/casper/broker/tracker.h"
+
+#include <stdlib.h> // malloc, free
+
+#include <algorithm> // std::min
+#include <chrono>    // std::chrono
+#include <map>       // std::map
+#include <new>       // std::bad_alloc
+#include <random>    // std::mt19937
+#include <vector>    // std::vector
+
+size_t cc::errors::Tracker::s_alive_ = 0;
+
+//
+// Counting allocator: every heap allocation made by this process goes through here.
+//
+
+static size_t s_allocations_ = 0;
+
+void* operator new (size_t a_size)
+{
+    s_allocations_++;
+    void* ptr = malloc(0 == a_size ? 1 : a_size);
+    if ( nullptr == ptr ) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete (void* a_ptr) noexcept
+{
+    free(a_ptr);
+}
+
+void operator delete (void* a_ptr, size_t /* a_size */) noexcept
+{
+    free(a_ptr);
+}
+
+/**
+ * @return Number of heap allocations performed by a callable.
+ */
+template <typename F>
+static size_t CountAllocations (F a_callable)
+{
+    const size_t before = s_allocations_;
+    a_callable();
+    return s_allocations_ - before;
+}
+
+/**
+ * @return Home slot of a request in the initial, 1024 slots, table - same mix as Tracker::Home.
+ */
+static size_t initial_home (const ngx_http_request_t* a_r)
+{
+    uint64_t h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(a_r));
+    h ^= ( h >> 33 );
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= ( h >> 33 );
+    return static_cast<size_t>(h) & 1023;
+}
+
+int main ()
+{
+    ngx::casper::broker::Tracker& tracker = ngx::casper::broker::Tracker::GetInstance();
+
+    std::vector<ngx_http_request_t> requests(8000);
+
+    // ... nothing tracked yet ...
+    TEST_CHECK(false == tracker.IsRegistered(&requests[0]));
+    TEST_CHECK(nullptr == tracker.errors_ptr(&requests[0]));
+    TEST_CHECK(0 == tracker.generation(&requests[0]));
+
+    tracker.Startup();
+
+    // ... register, re-register and address reuse ...
+    {
+        const uint64_t g1 = tracker.Register(&requests[0], new ngx::casper::broker::Errors(2));
+        TEST_CHECK(0 != g1);
+        TEST_CHECK(g1 == tracker.Register(&requests[0], nullptr));
+        TEST_CHECK(true == tracker.IsRegistered(&requests[0], g1));
+        TEST_CHECK(2 == tracker.Count(&requests[0]));
+        TEST_CHECK(true == tracker.ContainsErrors(&requests[0]));
+        TEST_CHECK(1 == tracker.Count());
+        TEST_CHECK(1 == cc::errors::Tracker::s_alive_);
+
+        std::string logged;
+        tracker.Log(&requests[0], "what", "unbound");
+        tracker.Bind(&requests[0], [&logged] (const std::string& a_what, const std::string& a_message) {
+            logged = a_what + ":" + a_message;
+        });
+        tracker.Bind(&requests[1], [&logged] (const std::string&, const std::string&) {
+            logged = "wrong request";
+        });
+        tracker.Log(&requests[0], "what", "bound");
+        tracker.Log(&requests[1], "what", "untracked");
+        TEST_CHECK("what:bound" == logged);
+
+        tracker.Unregister(&requests[0]);
+        TEST_CHECK(0 == cc::errors::Tracker::s_alive_);
+        TEST_CHECK(0 == tracker.Count());
+
+        // ... same address, new request: stale generation must not match ...
+        const uint64_t g2 = tracker.Register(&requests[0], new ngx::casper::broker::Errors());
+        TEST_CHECK(g2 > g1);
+        TEST_CHECK(false == tracker.IsRegistered(&requests[0], g1));
+        TEST_CHECK(true == tracker.IsRegistered(&requests[0], g2));
+        TEST_CHECK(false == tracker.ContainsErrors(&requests[0]));
+        tracker.Unregister(&requests[0]);
+        tracker.Unregister(&requests[0]);
+        TEST_CHECK(0 == tracker.Count());
+    }
+
+    // ... random register / unregister against a std::map, growing past initial capacity ...
+    {
+        std::map<const ngx_http_request_t*, uint64_t> expected;
+        std::mt19937                                  rng(2020);
+        std::uniform_int_distribution<size_t>         pick(0, requests.size() - 1);
+        size_t                                        mismatches = 0;
+        for ( size_t step = 0 ; step < 200000 ; ++step ) {
+            ngx_http_request_t* r = &requests[pick(rng)];
+            // ... bias towards registration on the first half, to make the table grow ...
+            const bool add = ( 0 != ( rng() % ( step < 100000 ? 3 : 2 ) ) );
+            if ( true == add ) {
+                ngx::casper::broker::Errors* errors = new ngx::casper::broker::Errors(1);
+                const uint64_t               g      = tracker.Register(r, errors);
+                if ( expected.end() != expected.find(r) ) {
+                    // ... duplicate registration, errors object was not taken ...
+                    delete errors;
+                    if ( g != expected[r] ) {
+                        mismatches++;
+                    }
+                } else {
+                    expected[r] = g;
+                }
+            } else {
+                tracker.Unregister(r);
+                expected.erase(r);
+            }
+            if ( 0 == ( step % 997 ) ) {
+                for ( auto& request : requests ) {
+                    const auto it = expected.find(&request);
+                    if ( ( expected.end() != it ) != tracker.IsRegistered(&request) ) {
+                        mismatches++;
+                    } else if ( expected.end() != it && false == tracker.IsRegistered(&request, it->second) ) {
+                        mismatches++;
+                    }
+                }
+            }
+        }
+        TEST_CHECK(0 == mismatches);
+        TEST_CHECK(expected.size() == tracker.Count());
+        TEST_CHECK(expected.size() == cc::errors::Tracker::s_alive_);
+
+        // ... everything left is released on shutdown ...
+        tracker.Shutdown();
+        TEST_CHECK(0 == tracker.Count());
+        TEST_CHECK(0 == cc::errors::Tracker::s_alive_);
+        TEST_CHECK(false == tracker.IsRegistered(&requests[0]));
+    }
+
+    // ... churn of requests whose home slot is near the end of the initial table, so clusters wrap around, checking every entry after each step ...
+    {
+        tracker.Startup();
+        std::vector<ngx_http_request_t*> wrapping;
+        for ( auto& request : requests ) {
+            const size_t home = initial_home(&request);
+            if ( home >= 1024 - 8 || home < 4 ) {
+                wrapping.push_back(&request);
+            }
+        }
+        TEST_CHECK(wrapping.size() >= 32);
+        wrapping.resize(std::min(wrapping.size(), static_cast<size_t>(32)));
+
+        std::vector<bool>                     expected(wrapping.size(), false);
+        std::mt19937                          rng(1024);
+        std::uniform_int_distribution<size_t> pick(0, expected.size() - 1);
+        size_t                                mismatches = 0;
+        for ( size_t step = 0 ; step < 200000 ; ++step ) {
+            const size_t idx = pick(rng);
+            if ( false == expected[idx] ) {
+                tracker.Register(wrapping[idx], nullptr);
+            } else {
+                tracker.Unregister(wrapping[idx]);
+            }
+            expected[idx] = ! expected[idx];
+            for ( size_t other = 0 ; other < expected.size() ; ++other ) {
+                if ( expected[other] != tracker.IsRegistered(wrapping[other]) ) {
+                    mismatches++;
+                }
+            }
+        }
+        TEST_CHECK(0 == mismatches);
+        tracker.Shutdown();
+    }
+
+    // ... 100k requests in flight: once the table has grown, no allocations - timing next to the std::map it replaced ...
+    {
+        std::vector<ngx_http_request_t> in_flight(100000);
+        tracker.Startup();
+        for ( auto& request : in_flight ) {
+            tracker.Register(&request, nullptr);
+        }
+        for ( auto& request : in_flight ) {
+            tracker.Unregister(&request);
+        }
+
+        const size_t rounds      = 10;
+        size_t       found       = 0;
+        size_t       allocations = 0;
+        const auto   start       = std::chrono::steady_clock::now();
+        for ( size_t round = 0 ; round < rounds ; ++round ) {
+            allocations += CountAllocations([&tracker, &in_flight, &found] () {
+                for ( auto& request : in_flight ) {
+                    tracker.Register(&request, nullptr);
+                }
+                for ( auto& request : in_flight ) {
+                    found += ( true == tracker.IsRegistered(&request) ? 1 : 0 );
+                }
+                for ( auto& request : in_flight ) {
+                    tracker.Unregister(&request);
+                }
+            });
+        }
+        const double tracker_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        TEST_CHECK(rounds * in_flight.size() == found);
+        TEST_CHECK(0 == allocations);
+        tracker.Shutdown();
+
+        std::map<ngx_http_request_t*, ngx::casper::broker::Errors*> map;
+        found = 0;
+        const auto map_start = std::chrono::steady_clock::now();
+        for ( size_t round = 0 ; round < rounds ; ++round ) {
+            for ( auto& request : in_flight ) {
+                map[&request] = nullptr;
+            }
+            for ( auto& request : in_flight ) {
+                found += ( map.end() != map.find(&request) ? 1 : 0 );
+            }
+            for ( auto& request : in_flight ) {
+                map.erase(&request);
+            }
+        }
+        const double map_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - map_start).count();
+        TEST_CHECK(rounds * in_flight.size() == found);
+
+        const double ops = static_cast<double>(rounds * in_flight.size());
+        fprintf(stdout, "Tracker: %.1f ns per register + lookup + unregister, std::map: %.1f ns\n", tracker_ns / ops, map_ns / ops);
+    }
+
+    return TEST_RESULT();
+}
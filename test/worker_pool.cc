@@ -0,0 +1,171 @@
+/**
+ * @file worker_pool.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "harness.h"
+
+#include "ngx/casper/broker/worker_pool.h"
+
+#include "ev/ngx/bridge.h"
+
+#include <atomic> // std::atomic
+#include <chrono> // std::chrono
+#include <set>    // std::set
+#include <thread> // std::this_thread
+
+//
+// Drain main thread callbacks until a condition holds or a few seconds went by.
+//
+template <typename C>
+static bool drain_until (C a_condition)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ( false == a_condition() ) {
+        if ( std::chrono::steady_clock::now() > deadline ) {
+            return false;
+        }
+        if ( 0 == ::ev::ngx::Bridge::GetInstance().Drain() ) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    return true;
+}
+
+int main ()
+{
+    ::ev::ngx::Bridge& bridge = ::ev::ngx::Bridge::GetInstance();
+
+    // ... no workers ...
+    {
+        ngx::casper::broker::WorkerPool pool;
+        TEST_CHECK(false == pool.enabled());
+        TEST_CHECK_THROWS(pool.Submit([] (const std::atomic<bool>&) {}, [] () {}));
+    }
+
+    // ... every job runs once, completion on 'main' thread ...
+    {
+        ngx::casper::broker::WorkerPool pool;
+        pool.Startup(4);
+        TEST_CHECK(true == pool.enabled());
+
+        const std::thread::id main_id = std::this_thread::get_id();
+        std::atomic<size_t>   worked { 0 };
+        size_t                done   = 0;
+        bool                  off_main = true;
+        bool                  on_main  = true;
+        std::set<uint64_t>    tickets;
+        for ( size_t idx = 0 ; idx < 200 ; ++idx ) {
+            tickets.insert(pool.Submit([&worked, &off_main, main_id] (const std::atomic<bool>& a_abort) {
+                if ( std::this_thread::get_id() == main_id || true == a_abort.load() ) {
+                    off_main = false;
+                }
+                worked++;
+            }, [&done, &on_main, main_id] () {
+                if ( std::this_thread::get_id() != main_id ) {
+                    on_main = false;
+                }
+                done++;
+            }));
+        }
+        TEST_CHECK(200 == tickets.size());
+        TEST_CHECK(true == drain_until([&done] () { return 200 == done; }));
+        TEST_CHECK(200 == worked.load());
+        TEST_CHECK(true == off_main);
+        TEST_CHECK(true == on_main);
+
+        // ... cancelled: nothing, or abandon function instead ...
+        bool           gate      = false;
+        std::mutex     gate_mutex;
+        size_t         cancelled = 0;
+        size_t         abandoned = 0;
+        const auto     wait_gate = [&gate, &gate_mutex] (const std::atomic<bool>&) {
+            while ( true ) {
+                {
+                    std::lock_guard<std::mutex> lock(gate_mutex);
+                    if ( true == gate ) {
+                        return;
+                    }
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        };
+        const uint64_t t1 = pool.Submit(wait_gate, [&cancelled] () { cancelled++; });
+        const uint64_t t2 = pool.Submit(wait_gate, [&cancelled] () { cancelled++; });
+        pool.Cancel(t1);
+        pool.Cancel(t2, [&abandoned] () { abandoned++; });
+        pool.Cancel(t2 + 1000); // ... unknown, ignored ...
+        {
+            std::lock_guard<std::mutex> lock(gate_mutex);
+            gate = true;
+        }
+        TEST_CHECK(true == drain_until([&abandoned] () { return 1 == abandoned; }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        bridge.Drain();
+        TEST_CHECK(0 == cancelled);
+        TEST_CHECK(1 == abandoned);
+
+        pool.Shutdown();
+        TEST_CHECK(false == pool.enabled());
+    }
+
+    // ... shutdown interrupts running work and delivers nothing ...
+    {
+        ngx::casper::broker::WorkerPool pool;
+        pool.Startup(2);
+
+        std::atomic<size_t> running     { 0 };
+        std::atomic<size_t> interrupted { 0 };
+        size_t              done        = 0;
+        const auto          endless     = [&running, &interrupted] (const std::atomic<bool>& a_abort) {
+            running++;
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+            while ( false == a_abort.load() && std::chrono::steady_clock::now() < deadline ) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if ( true == a_abort.load() ) {
+                interrupted++;
+            }
+        };
+        for ( size_t idx = 0 ; idx < 4 ; ++idx ) {
+            pool.Submit(endless, [&done] () { done++; });
+        }
+        const auto start = std::chrono::steady_clock::now();
+        while ( running.load() < 2 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5) ) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        TEST_CHECK(2 == running.load());
+
+        pool.Shutdown();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        TEST_CHECK(elapsed < std::chrono::seconds(5));
+        TEST_CHECK(2 == interrupted.load());
+        TEST_CHECK(2 == running.load()); // ... queued jobs were dropped ...
+        TEST_CHECK(0 == bridge.Drain());
+        TEST_CHECK(0 == done);
+
+        // ... and it can be started again ...
+        pool.Startup(1);
+        pool.Submit([] (const std::atomic<bool>&) {}, [&done] () { done++; });
+        TEST_CHECK(true == drain_until([&done] () { return 1 == done; }));
+    }
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,251 @@
+/**
+ * @file xattrs_batch.cc
+ *
+ * Copyright (c) 2017-2020 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-nginx-broker.
+ *
+ * casper-nginx-broker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-nginx-broker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper-nginx-broker. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "harness.h"
+
+#include "ngx/casper/broker/cdn-common/xattrs_batch.h"
+
+#include <fcntl.h>  // open
+#include <unistd.h> // close, unlink
+
+#include <map>    // std::map
+#include <set>    // std::set
+#include <string> // std::string
+
+#ifndef NRS_TEST_XATTRS_DIR
+    #define NRS_TEST_XATTRS_DIR "."
+#endif
+
+#define XATTR_ARCHIVE_PREFIX "user."
+
+size_t cc::fs::file::XAttr::s_syscalls_ = 0;
+
+/**
+ * @brief Attributes an upload brings, as written by Archive::Close.
+ */
+static const std::map<std::string, std::string> sk_upload_attrs_ = {
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.id"        , "0f8c7c2e"            },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.protocol"  , "HTTP/1.1"            },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.method"    , "POST"                },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.user-agent", "curl/7.68.0"         },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.ip"        , "10.0.0.1"            },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.origin"    , "https://example.com" },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.upload.magic.type", "application/pdf"     },
+    { XATTR_ARCHIVE_PREFIX "com.cldware.archive.billing"  , "123"                 },
+};
+
+/**
+ * @brief Create an empty file.
+ */
+static std::string Touch (const char* const a_name)
+{
+    const std::string uri = std::string(NRS_TEST_XATTRS_DIR) + "/" + a_name;
+    unlink(uri.c_str());
+    const int fd = open(uri.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if ( -1 != fd ) {
+        close(fd);
+    }
+    return uri;
+}
+
+/**
+ * @return All attributes of a file.
+ */
+static std::map<std::string, std::string> Read (const std::string& a_uri)
+{
+    std::map<std::string, std::string> rv;
+    ::cc::fs::file::XAttr(a_uri).Iterate([&rv] (const char* const a_name, const char* const a_value) {
+        rv[a_name] = a_value;
+    });
+    return rv;
+}
+
+/**
+ * @brief Same XAttr calls Archive::Close made, one per attribute, before the batch.
+ */
+static void CloseUnbatched (::cc::fs::file::XAttr& a_xattr)
+{
+    for ( auto it : sk_upload_attrs_ ) {
+        a_xattr.Set(it.first, it.second);
+    }
+    if ( true == a_xattr.Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.created.by") ) {
+        /* not a new file */
+    } else {
+        a_xattr.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.created.by", "writer");
+        a_xattr.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.created.at", "2020-01-01T00:00:00+00:00");
+    }
+    for ( auto name : { XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5", XATTR_ARCHIVE_PREFIX "com.cldware.archive.digest" } ) {
+        if ( true == a_xattr.Exists(name) ) {
+            a_xattr.Remove(name);
+        }
+    }
+    a_xattr.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5"      , "d41d8cd98f00b204e9800998ecf8427e");
+    a_xattr.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.digest"   , "SHA256:e3b0c442");
+    a_xattr.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5.stamp", "0:0");
+    for ( auto name : { "archivist", "archived.at", "created.by", "created.at" } ) {
+        const std::string attr = std::string(XATTR_ARCHIVE_PREFIX "com.cldware.archive.") + name;
+        if ( false == a_xattr.Exists(attr) ) {
+            a_xattr.Set(attr, "value");
+        }
+    }
+}
+
+/**
+ * @brief Same changes, staged by Archive::StageXAttrs and Archive::CloseXAttrs and flushed once.
+ */
+static void CloseBatched (::cc::fs::file::XAttr& a_xattr)
+{
+    ngx::casper::broker::cdn::XAttrsBatch batch(a_xattr);
+    for ( auto it : sk_upload_attrs_ ) {
+        batch.Set(it.first, it.second);
+    }
+    if ( true == batch.Exists(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.created.by") ) {
+        /* not a new file */
+    } else {
+        batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.created.by", "writer");
+        batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.xattrs.created.at", "2020-01-01T00:00:00+00:00");
+    }
+    for ( auto name : { XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5", XATTR_ARCHIVE_PREFIX "com.cldware.archive.digest" } ) {
+        batch.Remove(name);
+    }
+    batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5"      , "d41d8cd98f00b204e9800998ecf8427e");
+    batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.digest"   , "SHA256:e3b0c442");
+    batch.Set(XATTR_ARCHIVE_PREFIX "com.cldware.archive.md5.stamp", "0:0");
+    for ( auto name : { "archivist", "archived.at", "created.by", "created.at" } ) {
+        const std::string attr = std::string(XATTR_ARCHIVE_PREFIX "com.cldware.archive.") + name;
+        if ( false == batch.Exists(attr) ) {
+            batch.Set(attr, "value");
+        }
+    }
+    batch.Flush();
+}
+
+int main ()
+{
+    const std::string uri = Touch("xattrs_batch.tmp");
+    try {
+        ::cc::fs::file::XAttr(uri).Set(XATTR_ARCHIVE_PREFIX "probe", "1");
+        ::cc::fs::file::XAttr(uri).Remove(XATTR_ARCHIVE_PREFIX "probe");
+    } catch (...) {
+        fprintf(stdout, "%s: user extended attributes not supported at '%s', skipped\n", __FILE__, NRS_TEST_XATTRS_DIR);
+        unlink(uri.c_str());
+        return TEST_RESULT();
+    }
+
+    // ... staging semantics ...
+    {
+        ::cc::fs::file::XAttr xattr(uri);
+        xattr.Set(XATTR_ARCHIVE_PREFIX "a", "1");
+        xattr.Set(XATTR_ARCHIVE_PREFIX "b", "2");
+        xattr.Set(XATTR_ARCHIVE_PREFIX "c", "3");
+
+        ngx::casper::broker::cdn::XAttrsBatch batch(xattr);
+        TEST_CHECK(3 == batch.attrs().size());
+        TEST_CHECK(false == batch.dirty());
+
+        // ... reads are served from memory ...
+        const size_t before = ::cc::fs::file::XAttr::s_syscalls_;
+        std::string  value;
+        batch.Get(XATTR_ARCHIVE_PREFIX "b", value);
+        TEST_CHECK("2" == value);
+        TEST_CHECK(true  == batch.Exists(XATTR_ARCHIVE_PREFIX "a"));
+        TEST_CHECK(false == batch.Exists(XATTR_ARCHIVE_PREFIX "z"));
+        TEST_CHECK_THROWS(batch.Get(XATTR_ARCHIVE_PREFIX "z", value));
+
+        // ... same value, or removal of something that is not on disk, is not a change ...
+        batch.Set(XATTR_ARCHIVE_PREFIX "a", "1");
+        batch.Remove(XATTR_ARCHIVE_PREFIX "z");
+        TEST_CHECK(false == batch.dirty());
+
+        batch.Set(XATTR_ARCHIVE_PREFIX "a", "10");    // ... changed ...
+        batch.Set(XATTR_ARCHIVE_PREFIX "b", "20");
+        batch.Set(XATTR_ARCHIVE_PREFIX "b", "2");     // ... changed back ...
+        batch.Remove(XATTR_ARCHIVE_PREFIX "c");       // ... removed ...
+        batch.Set(XATTR_ARCHIVE_PREFIX "d", "4");     // ... new ...
+        batch.Set(XATTR_ARCHIVE_PREFIX "e", "5");
+        batch.Remove(XATTR_ARCHIVE_PREFIX "e");       // ... new, then removed ...
+        TEST_CHECK(true == batch.dirty());
+        TEST_CHECK(false == batch.Exists(XATTR_ARCHIVE_PREFIX "c"));
+        TEST_CHECK(before == ::cc::fs::file::XAttr::s_syscalls_);
+
+        // ... nothing written until flushed ...
+        TEST_CHECK("1" == Read(uri)[XATTR_ARCHIVE_PREFIX "a"]);
+
+        TEST_CHECK(3 == batch.Flush()); // ... a, c and d ...
+        TEST_CHECK(false == batch.dirty());
+        TEST_CHECK(batch.attrs() == Read(uri));
+        TEST_CHECK(0 == batch.Flush());
+
+        // ... removed, then set again ...
+        batch.Remove(XATTR_ARCHIVE_PREFIX "d");
+        batch.Set(XATTR_ARCHIVE_PREFIX "d", "4");
+        TEST_CHECK(false == batch.dirty());
+        batch.Remove(XATTR_ARCHIVE_PREFIX "a");
+        batch.Set(XATTR_ARCHIVE_PREFIX "a", "100");
+        TEST_CHECK(1 == batch.Flush());
+        TEST_CHECK(batch.attrs() == Read(uri));
+    }
+
+    // ... closing a new upload: same result, a fraction of the syscalls ...
+    {
+        const std::string unbatched_uri = Touch("xattrs_batch.unbatched.tmp");
+        const std::string batched_uri   = Touch("xattrs_batch.batched.tmp");
+
+        ::cc::fs::file::XAttr unbatched(unbatched_uri);
+        ::cc::fs::file::XAttr batched(batched_uri);
+
+        size_t start = ::cc::fs::file::XAttr::s_syscalls_;
+        CloseUnbatched(unbatched);
+        const size_t unbatched_syscalls = ::cc::fs::file::XAttr::s_syscalls_ - start;
+
+        start = ::cc::fs::file::XAttr::s_syscalls_;
+        CloseBatched(batched);
+        const size_t batched_syscalls = ::cc::fs::file::XAttr::s_syscalls_ - start;
+
+        TEST_CHECK(Read(unbatched_uri) == Read(batched_uri));
+        TEST_CHECK(17 == Read(batched_uri).size());
+        // ... one listxattr for an empty file, then one setxattr per attribute ...
+        TEST_CHECK(1 + 17 == batched_syscalls);
+        TEST_CHECK(batched_syscalls < unbatched_syscalls);
+
+        // ... closing it again, nothing changed: the batch only reads, but it reads everything ...
+        start = ::cc::fs::file::XAttr::s_syscalls_;
+        CloseUnbatched(unbatched);
+        const size_t unbatched_again = ::cc::fs::file::XAttr::s_syscalls_ - start;
+
+        start = ::cc::fs::file::XAttr::s_syscalls_;
+        CloseBatched(batched);
+        const size_t batched_again = ::cc::fs::file::XAttr::s_syscalls_ - start;
+
+        TEST_CHECK(Read(unbatched_uri) == Read(batched_uri));
+        TEST_CHECK(2 + 2 * 17 == batched_again); // ... listxattr x 2, getxattr x 2 per attribute ...
+
+        fprintf(stdout, "XAttrsBatch: new upload %zu syscall(s), unbatched %zu - closed again %zu, unbatched %zu\n",
+                batched_syscalls, unbatched_syscalls, batched_again, unbatched_again);
+
+        unlink(unbatched_uri.c_str());
+        unlink(batched_uri.c_str());
+    }
+
+    unlink(uri.c_str());
+
+    return TEST_RESULT();
+}